@@ -0,0 +1,27 @@
+# The Float version of bm_MatrixBenchmark.rb. As the README says, the
+# Hilbert matrix is too poorly conditioned for m * m.inv to come out as the
+# identity in floating point, so this only times the arithmetic.
+require 'matrix'
+require 'benchmark'
+
+# return a Hilbert matrix of Floats of the given dimension
+def float_hilbert(dimension)
+  rows = Array.new
+  (1..dimension).each do |i|
+    row = Array.new
+    (1..dimension).each do |j|
+      row.push(1.0 / (i + j - 1))
+    end
+    rows.push(row)
+  end
+  return(Matrix.rows(rows))
+end
+
+dimension = 64
+dimension = ARGV[0].to_i if ARGV.length > 0
+
+puts Benchmark.measure {
+  m = float_hilbert(dimension)
+  k = m * m.inv
+  print "Float Hilbert matrix of dimension #{dimension}, trace of m * m.inv = #{k.trace}\n"
+}
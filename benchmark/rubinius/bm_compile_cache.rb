@@ -0,0 +1,40 @@
+require 'benchmark'
+require 'fileutils'
+
+# Loads a generated app of TOTAL files through the compile cache, first
+# with an empty cache and then again once it's filled. The sources are
+# touched in between, as a fresh checkout would leave them.
+
+total = (ENV['TOTAL'] || 200).to_i
+
+root = "/tmp/bm_compile_cache.#{Process.pid}"
+src = "#{root}/app"
+FileUtils.mkdir_p src
+
+total.times do |i|
+  File.open("#{src}/file#{i}.rb", "w") do |f|
+    f.puts "class BmCompileCache#{i}"
+    20.times do |j|
+      f.puts "  def method#{j}(a, b)"
+      f.puts "    [a, b].each { |x| x.to_s * #{j} }"
+      f.puts "  end"
+    end
+    f.puts "end"
+  end
+end
+
+Compile.cache = Compile::Cache.new "#{root}/cache"
+
+Benchmark.bm(6) do |x|
+  x.report("cold") do
+    total.times { |i| load "#{src}/file#{i}.rb" }
+  end
+
+  FileUtils.touch Dir["#{src}/*.rb"]
+
+  x.report("warm") do
+    total.times { |i| load "#{src}/file#{i}.rb" }
+  end
+end
+
+FileUtils.rm_rf root
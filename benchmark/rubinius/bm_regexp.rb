@@ -2,6 +2,9 @@ require "benchmark"
 
 MAX = (ENV['TOTAL'] || 1_000).to_i
 
+HEADERS = ("Host: example.com\r\nAccept: */*\r\n" * 2_000) +
+          "Content-Length: 42\r\n"
+
 STRING = "r(n]sp &xq\nhn^kj)rs\nb c6{lh|4c@jcb [v8\nPvu}s%wijh# lz! \\d\"y7hlKlR nzqxg"
 
 Benchmark.bmbm do |x|
@@ -12,4 +15,50 @@ Benchmark.bmbm do |x|
   x.report("Regexp.escape") do
     MAX.times { Regexp.escape STRING }
   end
+
+  x.report("Regexp#=~") do
+    MAX.times { /lz!/ =~ STRING }
+  end
+
+  x.report("Regexp#=~ miss") do
+    MAX.times { /xyzzy/ =~ STRING }
+  end
+
+  x.report("Regexp#match with captures") do
+    MAX.times { /(\w+)\s+(\w+)/.match STRING }
+  end
+
+  x.report("MatchData#[]") do
+    MAX.times { /(\w+)\s+(\w+)/.match(STRING)[2] }
+  end
+
+  x.report("case/when") do
+    MAX.times do
+      case STRING
+      when /\A\d/ then 1
+      when /xyzzy/ then 2
+      when /lz!/ then 3
+      end
+    end
+  end
+
+  x.report("large =~ literal near end") do
+    (MAX / 100).times { HEADERS =~ /Content-Length: (\d+)/ }
+  end
+
+  x.report("large =~ missing literal") do
+    (MAX / 100).times { HEADERS =~ /Transfer-Encoding: / }
+  end
+
+  x.report("large scan") do
+    (MAX / 100).times { HEADERS.scan(/Accept: /) }
+  end
+
+  x.report("large gsub") do
+    (MAX / 100).times { HEADERS.gsub(/Host: /, "X-Host: ") }
+  end
+
+  x.report("Integer()") do
+    MAX.times { Integer("0x1f_ff") }
+  end
 end
@@ -0,0 +1,31 @@
+require 'benchmark'
+
+total = (ENV['TOTAL'] || 10).to_i
+
+# About 10MB of log lines, long enough to be shared rather than copied.
+line = "127.0.0.1 - - [10/Oct/2008:13:55:36 -0700] \"GET /apache_pb.gif HTTP/1.0\" 200 2326\n"
+body = line * (10_000_000 / line.size)
+
+Benchmark.bmbm do |x|
+  x.report("each_line") do
+    total.times { body.each_line { |l| l } }
+  end
+
+  x.report("split lines") do
+    total.times { body.split("\n") }
+  end
+
+  x.report("split fields") do
+    total.times { line.split(" ") }
+  end
+
+  x.report("slice") do
+    total.times do
+      i = 0
+      while i < 100_000
+        body[i, 80]
+        i += 1
+      end
+    end
+  end
+end
@@ -0,0 +1,29 @@
+require 'benchmark'
+
+total = (ENV['TOTAL'] || 100_000).to_i
+
+short = %w[a foo bar baz each map inject const_missing]
+long = short.map { |s| s * 8 }
+fresh = (0...total).map { |i| "sym_#{i}" }
+
+Benchmark.bmbm do |x|
+  x.report("loop") do
+    total.times { |i| short.each {} }
+  end
+
+  x.report("String#to_sym short") do
+    total.times { |i| short.each { |s| s.to_sym } }
+  end
+
+  x.report("String#to_sym long") do
+    total.times { |i| long.each { |s| s.to_sym } }
+  end
+
+  x.report("String#to_sym new") do
+    fresh.each { |s| s.to_sym }
+  end
+
+  x.report("Symbol#to_s") do
+    total.times { |i| :const_missing.to_s }
+  end
+end
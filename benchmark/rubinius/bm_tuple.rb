@@ -11,6 +11,17 @@ unless defined?(Tuple)
       put(j, temp)
     end
 
+    def copy_from(other, start, length, dest)
+      self[dest, length] = other[start, length]
+      self
+    end
+
+    alias :array_fill :fill
+
+    def fill(start, length, obj)
+      array_fill(obj, start, length)
+    end
+
     alias :at :[]
     alias :put :[]=
   end
@@ -80,6 +91,24 @@ Benchmark.bmbm do |x|
     end
   end
 
+  x.report 'Tuple#copy_from' do
+    total.times do |i|
+      Tuple.new(total).copy_from(tuple, 0, total, 0)
+    end
+  end
+
+  x.report 'Tuple#copy_from overlapping' do
+    total.times do |i|
+      tuple.copy_from(tuple, 0, total - 1, 1)
+    end
+  end
+
+  x.report 'Tuple#fill' do
+    total.times do |i|
+      tuple.fill(0, total, i)
+    end
+  end
+
   x.report 'Tuple#swap' do
     total.times do 
       total.times do |i|
@@ -0,0 +1,74 @@
+// Compares the byte at a time String hash we used to have with
+// bytes::hash, and strncmp (what String equality used) with memcmp
+// (what bytes::equal uses), across key lengths. Build from the top of
+// the tree with:
+//
+//   g++ -O2 -I. benchmark/rubinius/bytes_hash.cpp vm/bytes.cpp -o bytes_hash
+
+#include "vm/bytes.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+using namespace rubinius;
+
+static unsigned int old_hash(const unsigned char* bp, unsigned int sz) {
+  const unsigned char* be = bp + sz;
+  unsigned int hv = 0;
+
+  while(bp < be) {
+    hv *= 16777619;
+    hv ^= *bp++;
+  }
+
+  return (hv >> 28) ^ (hv & ((1U << 28) - 1));
+}
+
+static double now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+// Keeps results live, and makes the compiler assume the keys change
+// every iteration, so the loops aren't optimized away.
+static volatile uint64_t sink;
+#define CLOBBER(p) __asm__ __volatile__("" : : "r"(p) : "memory")
+
+#define TIME(label, expr) do { \
+    double start = now(); \
+    uint64_t acc = 0; \
+    for(size_t i = 0; i < iterations; i++) { CLOBBER(a); acc += (expr); } \
+    sink = acc; \
+    double secs = now() - start; \
+    printf("  %-12s %8.1f MB/s\n", label, \
+           (double)iterations * len / secs / (1024 * 1024)); \
+  } while(0)
+
+int main(int argc, char* argv[]) {
+  size_t total = argc > 1 ? atol(argv[1]) : 256 * 1024 * 1024;
+  size_t lengths[] = { 4, 8, 16, 32, 64, 256, 4096 };
+
+  for(size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+    size_t len = lengths[l];
+    size_t iterations = total / len;
+
+    unsigned char* a = (unsigned char*)malloc(len + 1);
+    unsigned char* b = (unsigned char*)malloc(len + 1);
+    for(size_t i = 0; i < len; i++) a[i] = b[i] = 'a' + i % 26;
+    a[len] = b[len] = 0;
+
+    printf("%lu byte keys\n", (unsigned long)len);
+    TIME("old hash", old_hash(a, len));
+    TIME("bytes::hash", bytes::hash(a, len));
+    TIME("strncmp", strncmp((char*)a, (char*)b, len) == 0);
+    TIME("memcmp", memcmp(a, b, len) == 0);
+
+    free(a);
+    free(b);
+  }
+
+  return 0;
+}
@@ -0,0 +1,69 @@
+require 'benchmark'
+
+# Integers just past the Fixnum range: 64 bit ids, nanosecond timestamps
+# and money in micro-units.
+
+total = (ENV['TOTAL'] || 1_000).to_i
+
+srand(42)
+ids = Array.new(total) { 0x7fff_ffff_ffff_0000 + rand(100_000) }
+stamps = Array.new(total) { 1_225_000_000_000_000_000 + rand(1_000_000_000) }
+amounts = Array.new(total) { 0x4000_0000_0000_0000 + rand(1_000_000) }
+
+Benchmark.bmbm do |x|
+  x.report "loop" do
+    total.times do |i|
+      total.times do |j|
+        j
+      end
+    end
+  end
+
+  x.report "id + Fixnum" do
+    total.times do |i|
+      total.times do |j|
+        ids[i] + j
+      end
+    end
+  end
+
+  x.report "id <=> id" do
+    total.times do |i|
+      total.times do |j|
+        ids[i] <=> ids[j]
+      end
+    end
+  end
+
+  x.report "id == Fixnum" do
+    total.times do |i|
+      total.times do |j|
+        ids[i] == j
+      end
+    end
+  end
+
+  x.report "timestamp - timestamp" do
+    total.times do |i|
+      total.times do |j|
+        stamps[i] - stamps[j]
+      end
+    end
+  end
+
+  x.report "amount * Fixnum" do
+    total.times do |i|
+      total.times do |j|
+        amounts[i] * j
+      end
+    end
+  end
+
+  x.report "amount * amount" do
+    total.times do |i|
+      total.times do |j|
+        amounts[i] * amounts[j]
+      end
+    end
+  end
+end
@@ -96,3 +96,16 @@ Benchmark.bmbm {|bench|
   bench.report("strings ")        { i.times { strings2.sort } }
   bench.report("strings block")   { i.times { strings3.sort {|a, b| a <=> b} } }
 }
+
+puts
+puts "-- #sort_by --"
+
+Benchmark.bmbm {|bench|
+  bench.report("sorted")          { i.times { sorted.sort_by {|a| a } } }
+  bench.report("reversed")        { i.times { reversed.sort_by {|a| a } } }
+  bench.report("same")            { i.times { same.sort_by {|a| a } } }
+  bench.report("random")          { i.times { random.sort_by {|a| a } } }
+  bench.report("random negated")  { i.times { random.sort_by {|a| -a } } }
+  bench.report("strings ")        { i.times { strings.sort_by {|a| a } } }
+  bench.report("strings size")    { i.times { strings.sort_by {|a| a.size } } }
+}
@@ -1,134 +1,54 @@
-class Hash
-
-  # Bucket abstracts storage and search of entries in Hash.
-  # Each bin in a Hash is either +nil+, a single +Bucket+
-  # instance, or the head of a chain of +Bucket+ instances.
-  class Bucket
-    attr_accessor :key
-    attr_accessor :value
-    attr_accessor :key_hash
-    attr_accessor :next
-
-    def initialize(key=nil, value=nil, key_hash=nil, nxt=nil)
-      @key      = key
-      @value    = value
-      @key_hash = key_hash
-      @next     = nxt
-    end
+##
+# Hash is a builtin type; see vm/builtin/hash.hpp for the layout.
+#
+# @entries is a Tuple of (hash, key, value) triples in insertion order.
+# A deleted triple has a nil hash and stays until the next resize.
+# @used is the number of triples in use, deleted ones included.
+# @count is the number of live pairs, equivalent to <code>hsh.count</code>.
+# @index is an open addressed Tuple of entry numbers, nil where empty.
+#
+# The primitives handle Fixnum, Symbol, nil, true, false and String keys
+# without sending #hash or #eql?. Every other key goes through the Ruby
+# code here, which must probe @index exactly the way the VM does.
 
-    # Searches this chain of buckets for one matching both +key+
-    # and +key_hash+. Returns +nil+ if there is no match. Calls
-    # <code>#eql?</code> on +key+.
-    def find(key, key_hash)
-      return self if self.key_hash == key_hash and key.eql? self.key
-      return unless nxt = self.next
-      nxt.find key, key_hash
-    end
+class Hash
 
-    # Either updates an existing bucket matching +key+ and +key_hash+
-    # or appends a new bucket containing +key+, +value+, +key_hash+
-    # to the chain. Returns +true+ if a new bucket was added, otherwise
-    # returns +false+.
-    def set(key, value, key_hash)
-      if self.key_hash == key_hash and key.eql? self.key
-        self.value = value
-        return false
-      elsif nxt = self.next
-        return nxt.set(key, value, key_hash)
-      else
-        bucket = Bucket.new key, value, key_hash
-        self.next = bucket
-        return true
-      end
-    end
+  # Number of fields in @entries for each pair
+  ENTRY_FIELDS = 3
 
-    # Returns +false+ if the bucket was found and deleted and the head
-    # of the chain is unchanged. Returns +nil+ if the head of the
-    # chain should be replaced with <code>head.next</code>. Returns
-    # +true+ if the bucket was not found.
-    # FIX: cryptic. return a symbol for all 3 cases
-    def delete(k, k_hash, parent = nil)
-      # identity wins. see rb_any_cmp in hash.c in mri for clues.
-      if k.equal?(self.key) or (self.key_hash == k_hash and k.eql? self.key)
-        return nil unless parent
-        parent.next = self.next
-        return false
-      elsif nxt = self.next
-        return nxt.delete(k, k_hash, self)
-      else
-        return true
-      end
-    end
+  def self.allocate
+    Ruby.primitive :hash_allocate
+    raise PrimitiveFailure, "Hash.allocate primitive failed"
   end
 
-  # An external iterator that returns only bucket chains from the
-  # Hash storage, never nil bins. While somewhat following the API
-  # of Enumerator, it is named Iterator because it does not provide
-  # <code>#each</code> and should not conflict with +Enumerator+ in
-  # MRI 1.8.7+. Returned by <code>Hash#to_iter</code>.
-  class Iterator
-    def initialize(bins, records)
-      @bins = bins
-      @records = records
-      @index = -1
-    end
+  def [](key)
+    Ruby.primitive :hash_aref
 
-    # Returns the next object or +nil+.
-    def next
-      while (@index += 1) < @records
-        bucket = @bins[@index]
-        return bucket if bucket
-      end
+    if entry = find_entry(key)
+      return @entries[entry * ENTRY_FIELDS + 2]
     end
 
-    # Returns the index of the last object returned by <code>#next</code>.
-    def index
-      @index
-    end
-
-    # Resets the index of the next object to be returned by
-    # <code>#next</code> to the beginning of the storage vector.
-    def reset
-      @index = -1
-    end
+    default key
   end
 
-  # MUST be a power of 2
-  MIN_SIZE = 16
+  def []=(key, value)
+    Ruby.primitive :hash_store
 
-  # Allocate more storage when this full
-  MAX_DENSITY = 0.75
-
-  # Creates a fully-formed instance of Hash.
-  #--
-  # @count is the number of pairs, equivalent to <code>hsh.count</code>.
-  # @records is the number of entries in +@bins+.
-  # @bins is the vector of storage for the bucket chains.
-  #++
-  def self.allocate
-    h = super()
-
-    h.__initialize__
-    h
-  end
+    if entry = find_entry(key)
+      @entries[entry * ENTRY_FIELDS + 2] = value
+      return value
+    end
 
-  # Sets the underlying data structures.
-  def __initialize__
-    # We don't need the nanny checking our symbols
-    set_instance_variable :@records, MIN_SIZE
-    set_instance_variable :@bins, Tuple.new(MIN_SIZE)
-    set_instance_variable :@count, 0
-  end
+    if key.kind_of? String
+      key = key.dup.freeze unless key.frozen?
+    end
 
-  # Returns the storage vector for Hash. The object should provide
-  # an <code>#[]</code> for accessing and <code>#[]=</code> for setting.
-  def bins
-    @bins
+    insert key_hash(key), key, value
   end
 
-  # Returns the magnitude of the storage vector (+@bins+).
-  def records
-    @records
+  def clear
+    Ruby.primitive :hash_clear
+    raise PrimitiveFailure, "Hash#clear primitive failed"
   end
 
   # Retuns the number of items in the Hash.
@@ -136,68 +56,72 @@ class Hash
     @count
   end
 
-  # Increments the number of items in the Hash and requests
-  # that the Hash be redistributed. The request will be
-  # honored if the Hash's density exceeds a threshold.
-  def count=(count)
-    @count = count
-    redistribute false
+  # Returns the entry number for +key+ or +nil+. Identity wins over
+  # <code>#eql?</code>; see rb_any_cmp in hash.c in MRI.
+  def find_entry(key)
+    Ruby.primitive :hash_find_entry
+
+    hsh = key_hash key
+    mask = @index.size - 1
+    perturb = hsh
+    i = hsh & mask
+
+    while entry = @index[i]
+      e = entry * ENTRY_FIELDS
+      if @entries[e] == hsh
+        k = @entries[e + 1]
+        return entry if key.equal?(k) or key.eql?(k)
+      end
+
+      i = (i * 5 + perturb + 1) & mask
+      perturb >>= 5
+    end
+
+    nil
   end
 
-  # Returns an external iterator for the bins. See +Iterator+
-  def to_iter
-    Iterator.new @bins, @records
+  # Appends a pair whose key is known not to be present.
+  def insert(hsh, key, value)
+    Ruby.primitive :hash_insert
+    raise PrimitiveFailure, "Hash#insert primitive failed"
   end
 
-  # Returns a bucket for +key_hash+ from a bin. Creates a new
-  # bucket if there was no bucket at that bin. The bucket may be
-  # the head of a chain. Call <code>#find</code> to locate a value
-  # or <code>#set</code> to add or update a value. Those methods
-  # handle manipulating the bucket chain.
-  def entry(key, key_hash)
-    bin = entry_bin key_hash
-    entry = @bins[bin]
-    return entry if entry
+  # Removes the pair at entry number +entry+ and returns its value.
+  def delete_entry(entry)
+    Ruby.primitive :hash_delete_entry
+    raise PrimitiveFailure, "Hash#delete_entry primitive failed"
+  end
 
-    self.count += 1
+  # Returns the hash for +key+ as it is stored in @entries.
+  def key_hash(key)
+    hsh = key.hash
+    unless hsh.kind_of? Integer
+      raise TypeError, "#{key.class}#hash did not return an Integer"
+    end
 
-    # recalc the bin since #count may have invoked redistribute
-    @bins[entry_bin(key_hash)] = Bucket.new key, nil, key_hash
+    hsh & MAX_HASH
   end
 
-  # Returns the index into the storage for +key_hash+.
-  def entry_bin(key_hash)
-    key_hash & (@records - 1)
+  # Rebuilds @index from the hashes in @entries and squeezes out
+  # deleted pairs. Entry numbers are not stable across this.
+  def rebuild
+    Ruby.primitive :hash_rebuild
+    raise PrimitiveFailure, "Hash#rebuild primitive failed"
   end
 
-  # Grows the hash storage and redistributes the entries among
-  # the new bins if the entry density is above a threshold. Any
-  # Iterator instance will be invalid after a call to redistribute.
-  # If +rehash+ is true, recalculate the key_hash for each key.
-  def redistribute(rehash = true)
-    resize = @count >= MAX_DENSITY * @records
-    return unless rehash or resize
-
-    i = to_iter
-    @records *= 2 if resize
-    @bins = Tuple.new @records
-
-    while entry = i.next
-      while entry
-        nxt = entry.next
-
-        entry.key_hash = entry.key.hash if rehash
-
-        bin = entry_bin entry.key_hash
-        if head = @bins[bin]
-          entry.next = head
-        else
-          entry.next = nil
-        end
-        @bins[bin] = entry
-
-        entry = nxt
-      end
+  # Yields key, value for each item in the Hash, in insertion order. This
+  # method is necessary to protect the essential iterator from subclasses
+  # (e.g. REXML::Attribute) that replace #each with a version that is
+  # incompatible with the dependencies here (e.g. defining #each ->
+  # #each_attribute -> #each_value, where we had been defining
+  # #each_value in terms of #each).
+  def each_item
+    i = 0
+    while i < @used
+      e = i * ENTRY_FIELDS
+      entries = @entries
+      yield entries[e + 1], entries[e + 2] unless entries[e].nil?
+      i += 1
     end
 
     self
@@ -0,0 +1,6 @@
+class InstructionSequence
+  def self.allocate
+    Ruby.primitive :iseq_allocate
+    raise PrimitiveFailure, "InstructionSequence.allocate primitive failed"
+  end
+end
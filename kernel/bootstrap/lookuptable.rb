@@ -4,37 +4,15 @@
 # entry in LookupTable is determined by using the == comparison operator
 # in C code. In effect, two keys are equal if they are the same pointer.
 #
-# NOTE: the value used to determine the bin is the "pointer" value of
-# key >> 2. This makes it possible to calculate the bin from Ruby with
-# the same result as in C. For example:
-# 
-#   l = LookupTable.new
-#   loc = :a.hash & (l.bins - 1)  # => 12
-#   class LookupTable
-#     def show
-#       @values
-#     end
-#   end
-#
-#   l[:a] = 1
-#   l.show  # => #<Tuple: nil, ..., nil, #<Bucket: @key=>:a, @value=>1,
-#                         @next=>nil>, nil, nil, nil>
-#
-# where ... is ten "nil, " entries. This only works for Objects that
-# are tagged data (see e.g. shotgun/lib/oop.h). This will NOT work with
-# a String, for instance.
+# Keys and values live in the parallel Tuples @keys and @values. A bin
+# whose key is undefined is empty; use #each or #each_entry rather than
+# reading the Tuples directly.
 #
 # LookupTable is intended to be used with Symbol or Fixnum keys. Internally,
 # String keys are converted to Symbols. LookupTable is NOT intended to be
 # used generally like Hash.
 
 class LookupTable
-  class Bucket
-    attr_reader :key
-    attr_reader :value
-    attr_reader :next
-  end
-
   class Association
     attr_reader :key
     attr_writer :active
@@ -117,15 +95,18 @@ class LookupTable
     raise PrimitiveFailure, "LookupTable#entries primitive failed"
   end
 
+  # Returns the first bin at or after +start+ holding an entry, or nil.
+  def next_entry(start)
+    Ruby.primitive :lookuptable_next_entry
+    raise PrimitiveFailure, "LookupTable#next_entry primitive failed"
+  end
+
   def each
     raise LocalJumpError, "no block given" unless block_given? or @entries == 0
 
-    ents = entries
-    i = ents.start
-    total = ents.start + ents.total
-    while i < total
-      entry = ents[i]
-      yield [entry.key, entry.value]
+    i = 0
+    while i = next_entry(i)
+      yield [@keys[i], @values[i]]
       i += 1
     end
     self
@@ -134,12 +115,9 @@ class LookupTable
   def each_entry
     raise LocalJumpError, "no block given" unless block_given? or @entries == 0
 
-    ents = entries
-    i = ents.start
-    total = ents.start + ents.total
-    while i < total
-      entry = ents[i]
-      yield entry.key, entry.value
+    i = 0
+    while i = next_entry(i)
+      yield @keys[i], @values[i]
       i += 1
     end
     self
@@ -24,6 +24,14 @@ class Regexp
     raise PrimitiveFailure, "Regexp#match_start primitive failed"
   end
 
+  # Returns where the first match at or after +start+ begins, or nil.
+  # Unlike #match_from it builds no MatchData and leaves $~ alone, for
+  # callers that only want to know whether +str+ matches.
+  def search_from(str, start)
+    Ruby.primitive :regexp_search_from
+    raise PrimitiveFailure, "Regexp#search_from primitive failed"
+  end
+
   def options
     Ruby.primitive :regexp_options
     raise PrimitiveFailure, "Regexp#options primitive failed"
@@ -30,6 +30,8 @@ class String
   end
 
   def substring(start, count)
+    Ruby.primitive :string_substring
+
     return if count < 0 || start > @num_bytes || -start > @num_bytes
 
     start += @num_bytes if start < 0
@@ -40,6 +40,16 @@ class Tuple
     raise PrimitiveFailure, "Tuple#copy_from primitive failed"
   end
 
+  def fill(start, length, obj)
+    Ruby.primitive :tuple_fill
+    raise PrimitiveFailure, "Tuple#fill primitive failed"
+  end
+
+  def concat(other)
+    Ruby.primitive :tuple_concat
+    raise PrimitiveFailure, "Tuple#concat primitive failed"
+  end
+
   def delete(start,length,object)
     Ruby.primitive :tuple_delete_inplace
     raise PrimitiveFailure, "Tuple#delete primitive failed"
@@ -234,6 +234,8 @@ class Array
   # Appends the object to the end of the Array.
   # Returns self so several appends can be chained.
   def <<(obj)
+    Ruby.primitive :array_append
+
     self[@total] = obj
     self
   end
@@ -297,10 +299,14 @@ class Array
       out.total = new_size
       out.taint if self.tainted? && val > 0
 
-      i = 0
+      # Double up what has been copied so far rather than copying
+      # self val times.
+      nt.copy_from(@tuple, @start, @total, 0) if new_size > 0
+      i = sz
       while(i < new_size)
-        nt.copy_from(@tuple,@start,@total, i)
-        i += sz
+        n = i < new_size - i ? i : new_size - i
+        nt.copy_from(nt, 0, n, i)
+        i += n
       end
       out
     end
@@ -362,6 +368,8 @@ class Array
   # are equal according to first_e == second_e . Both
   # Array subclasses and to_ary objects are accepted.
   def ==(other)
+    Ruby.primitive :array_equal
+
     return true if equal?(other)
     unless other.kind_of? Array
       return false unless other.respond_to? :to_ary
@@ -423,6 +431,8 @@ class Array
 
   # Returns a copy of self with all nil elements removed
   def compact()
+    Ruby.primitive :array_compact
+
     out = dup
     out.compact! || out
   end
@@ -440,6 +450,8 @@ class Array
 
   # Appends the elements in the other Array to self
   def concat(other)
+    Ruby.primitive :array_concat
+
     ary = Type.coerce_to(other, Array, :to_ary)
     size = @total + ary.size
     tuple = Tuple.new size
@@ -518,6 +530,13 @@ class Array
     return self
   end
 
+  # Copies plain Arrays in one step; anything with its own
+  # class or instance variables goes through Kernel#dup.
+  def dup
+    Ruby.primitive :array_dup
+    super
+  end
+
   # Passes each index of the Array to the given block
   # and returns self.  We re-evaluate @total each time
   # through the loop in case the array has changed.
@@ -651,8 +670,8 @@ class Array
 
     if block_given?
       start.upto(finish) { |i|  @tuple.put @start + i, yield(i) }
-    else
-      start.upto(finish) { |i|  @tuple.put @start + i, obj }
+    elsif finish >= start
+      @tuple.fill @start + start, finish - start + 1, obj
     end
 
     self
@@ -673,6 +692,8 @@ class Array
 
   # Recursively flatten any contained Arrays into an one-dimensional result.
   def flatten()
+    Ruby.primitive :array_flatten
+
     dup.flatten! || self
   end
 
@@ -689,29 +710,33 @@ class Array
   # Computes a Fixnum hash code for this Array. Any two
   # Arrays with the same content will have the same hash
   # code (similar to #eql?)
+  #
+  # The primitive handles Arrays of Fixnums, Symbols, Strings, nil, true
+  # and false. This must compute the same value for those.
   def hash()
-    # IMPROVE: This is a really really poor implementation of hash for an array, but
-    # it does work. It should be replaced with something much better, but I'm not sure
-    # what level it belongs at.
-    str = ""
+    Ruby.primitive :array_hash
+
+    hsh = @total
     RecursionGuard.inspect(self) do
       i = 0
       while(i < @total)
         curr = at(i)
         if RecursionGuard.inspecting?(curr)
-          str.append curr.object_id.to_s
+          hsh = (hsh * 31 + curr.object_id) & Hash::MAX_HASH
         else
-          str.append curr.hash.to_s
+          hsh = (hsh * 31 + curr.hash) & Hash::MAX_HASH
         end
         i+=1
       end
     end
-    str.hash
+    hsh
   end
 
   # Returns true if the given obj is present in the Array.
   # Presence is determined by calling elem == obj until found.
   def include?(obj)
+    Ruby.primitive :array_include_p
+
     i = 0
     while i < @total do
       return true if at(i) == obj
@@ -723,6 +748,8 @@ class Array
   # Returns the index of the first element in the Array
   # for which elem == obj is true or nil.
   def index(obj)
+    Ruby.primitive :array_index
+
     i = 0
     while i < @total do
       return i if at(i) == obj
@@ -927,6 +954,8 @@ class Array
 
   # Removes and returns the last element from the Array.
   def pop()
+    Ruby.primitive :array_pop
+
     return nil if empty?
 
     elem = at(@total-1)
@@ -941,6 +970,10 @@ class Array
   # Appends the given object(s) to the Array and returns
   # the modified self.
   def push(*args)
+    # Subclasses may override #<<, so only Array itself takes the
+    # single concat instead of appending each element.
+    return concat(args) if instance_of? Array
+
     args.each { |ent| self << ent }
     self
   end
@@ -1036,6 +1069,8 @@ class Array
   # Array or nil if empty. All other elements are
   # moved down one index.
   def shift()
+    Ruby.primitive :array_shift
+
     return nil if @total == 0
 
     obj = @tuple.at(@start)
@@ -1082,6 +1117,7 @@ class Array
   # Sorts this Array in-place. See #sort.
   def sort!(&block)
     return self unless @total > 1
+    return self if !block and native_sort!
 
     if (@total - @start) < 6
       if block
@@ -1100,6 +1136,24 @@ class Array
     self
   end
 
+  # Returns a new Array sorted by the values the block returns for each
+  # element, which are computed once each. Elements with equal values
+  # keep their order when the values are all Fixnums, all Floats or all
+  # Strings, since those are sorted natively.
+  def sort_by
+    keys = collect { |x| yield x }
+    sorted = Array.new self
+    return sorted if sorted.sort_by_keys! keys
+
+    i = 0
+    while i < @total
+      sorted[i] = Enumerable::Sort::SortedElement.new sorted.at(i), keys.at(i)
+      i += 1
+    end
+
+    sorted.sort!.collect! { |e| e.value }
+  end
+
   # Returns self except on subclasses which are converted
   # or 'upcast' to Arrays.
   def to_a()
@@ -1146,6 +1200,8 @@ class Array
   # Returns a new Array by removing duplicate entries
   # from self. Equality is determined by using a Hash
   def uniq()
+    Ruby.primitive :array_uniq
+
     seen, out = {}, self.class.new
 
     i = 0
@@ -1644,6 +1700,20 @@ class Array
     end
   end
 
+  # Sorts in place without sending #<=> when every element is a Fixnum,
+  # every one is a Float or every one is a String. Returns nil otherwise.
+  def native_sort!
+    Ruby.primitive :array_sort
+    nil
+  end
+
+  # Sorts self and +keys+ in place by the elements of +keys+, under the
+  # same conditions as #native_sort!. Returns nil if it can't.
+  def sort_by_keys!(keys)
+    Ruby.primitive :array_sort_by_keys
+    nil
+  end
+
   def __rescue_match__(exception)
     i = 0
     while i < @total
@@ -1657,4 +1727,5 @@ class Array
   private :isort
   private :qsort_block
   private :isort_block
+  private :native_sort!
 end
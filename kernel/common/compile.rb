@@ -47,6 +47,22 @@ module Compile
     return self.compiler ? self.compiler.version_number : 0
   end
 
+  ##
+  # The Compile::Cache that .rb files are compiled through, or nil to
+  # write each .rbc next to its source. Set by RBX_COMPILE_CACHE or
+  # -Xrbx.compile.cache.
+
+  def self.cache
+    return @cache if defined? @cache
+
+    dir = ENV['RBX_COMPILE_CACHE'] || Rubinius::RUBY_CONFIG['rbx.compile.cache']
+    @cache = dir.kind_of?(String) ? Cache.new(dir) : nil
+  end
+
+  def self.cache=(cache)
+    @cache = cache
+  end
+
   def self.compile_file(path, flags=nil)
     compiler.compile_file(path, flags)
   end
@@ -187,6 +203,16 @@ module Compile
             raise LoadError, "Unable to find '#{rbc_path}' to load directly"
           end
 
+        elsif cache = Compile.cache
+          if $DEBUG_LOADING
+            STDERR.puts "[Loading #{rb_path} through #{cache.directory}]"
+          end
+
+          compile_feature(rb, requiring) do
+            cm = cache.load(rb_path, version_number, options[:recompile])
+            raise LoadError, "Unable to compile: #{rb_path}" unless cm
+          end
+
         # Prefer compiled whenever possible
         elsif !File.file?(rbc_path) or File.mtime(rb_path) > File.mtime(rbc_path) or options[:recompile]
           if $DEBUG_LOADING
@@ -0,0 +1,151 @@
+# depends on: compile.rb
+
+##
+# A cache of compiled files kept in one directory and shared between
+# processes. Entries are named by the SHA-1 of the source and by the
+# compiler version, not by where the source lives, so moving, checking
+# out again or deploying the same code never recompiles it, and read-only
+# source directories are fine.
+#
+# Turned on by setting RBX_COMPILE_CACHE or -Xrbx.compile.cache to the
+# directory; see Compile.cache.
+#
+# Entries are written to a temporary file and renamed into place, so
+# other processes see the whole file or none of it. The index file saves
+# reading and hashing sources which haven't changed: each line maps the
+# inode, mtime, size and path of a source to its digest. Lines are only
+# ever appended, one short write at a time, and the last one for a source
+# wins.
+
+class Compile::Cache
+
+  def initialize(directory)
+    @directory = directory
+    @index = nil
+  end
+
+  attr_reader :directory
+
+  ##
+  # The SHA-1 of the contents of the file at +path+ in hex, or nil if it
+  # can't be read.
+
+  def self.digest(path)
+    Ruby.primitive :compiledfile_digest
+    raise PrimitiveFailure, "Compile::Cache.digest primitive failed"
+  end
+
+  ##
+  # Returns the CompiledMethod for the source at +path+, from the cache
+  # if possible, otherwise by compiling it and adding it. With +recompile+
+  # the cache is only written to. Returns nil if +path+ can't be compiled.
+
+  def load(path, version, recompile=false)
+    stat = File.stat path
+    key = "#{stat.ino} #{stat.mtime.to_i} #{stat.size} #{path}"
+
+    unless digest = index[key]
+      digest = Compile::Cache.digest path
+      return nil unless digest
+
+      record key, digest
+    end
+
+    entry = entry_path digest, version
+
+    if !recompile and File.file? entry
+      cm = Compile.load_from_rbc entry, version
+      return cm if cm
+    end
+
+    if $DEBUG_LOADING
+      STDERR.puts "[Compiling #{path} into #{entry}]"
+    end
+
+    cm = Compile.compile_file path
+    store cm, entry if cm
+
+    return cm
+  end
+
+  def entry_path(digest, version)
+    "#{@directory}/#{digest[0, 2]}/#{digest[2..-1]}-" \
+      "#{Rubinius::CompiledMethodVersion}.#{version}.rbc"
+  end
+
+  def index_path
+    "#{@directory}/index"
+  end
+
+  ##
+  # Reads the index file the first time it's needed.
+
+  def index
+    return @index if @index
+
+    @index = {}
+    lines = 0
+
+    if File.file? index_path
+      File.open index_path do |f|
+        f.each_line do |line|
+          digest, key = line.chomp.split(" ", 2)
+          next unless key
+
+          @index[key] = digest
+          lines += 1
+        end
+      end
+    end
+
+    compact_index if lines > 2 * @index.size + 1000
+
+    @index
+  end
+
+  def record(key, digest)
+    @index[key] = digest
+
+    mkdir @directory
+    File.open index_path, "a" do |f|
+      f.write "#{digest} #{key}\n"
+    end
+  rescue SystemCallError
+    # Without an index the source is just hashed again next time.
+  end
+
+  ##
+  # Rewrites the index without the lines which later ones replaced.
+
+  def compact_index
+    tmp = "#{index_path}.#{Process.pid}.tmp"
+
+    File.open tmp, "w" do |f|
+      @index.each { |key, digest| f.write "#{digest} #{key}\n" }
+    end
+
+    File.rename tmp, index_path
+  rescue SystemCallError
+    File.unlink tmp rescue nil
+  end
+
+  def store(cm, entry)
+    mkdir @directory
+    mkdir File.dirname(entry)
+
+    tmp = "#{entry}.#{Process.pid}.tmp"
+    Rubinius::CompiledFile.dump cm, tmp
+    File.rename tmp, entry
+  rescue SystemCallError
+    File.unlink tmp rescue nil
+  end
+
+  def mkdir(dir)
+    Dir.mkdir dir unless File.directory? dir
+  rescue Errno::EEXIST
+    # Another process made it first.
+  end
+
+  private :entry_path, :index_path, :index, :record, :compact_index,
+          :store, :mkdir
+end
@@ -130,6 +130,16 @@ class Float < Numeric
     self
   end
 
+  # Most Floats are immediates on 64-bit, which can't be copied. Raise
+  # for all of them, as MRI does.
+  def dup
+    raise TypeError, "can't dup Float"
+  end
+
+  def clone
+    raise TypeError, "can't clone Float"
+  end
+
   def to_i
     Ruby.primitive :float_to_i
   end
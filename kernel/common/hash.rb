@@ -61,12 +61,8 @@ class Hash
   end
 
   def fetch(key, default = Undefined)
-    hsh = key.hash
-    bin = entry_bin hsh
-
-    if entry = bins[bin]
-      result = entry.find key, hsh
-      return result.value if result
+    if entry = find_entry(key)
+      return @entries[entry * ENTRY_FIELDS + 2]
     end
 
     return yield(key) if block_given?
@@ -74,37 +70,8 @@ class Hash
     raise IndexError, 'key not found'
   end
 
-  def [](key)
-    hsh = key.hash
-    bin = entry_bin hsh
-
-    if entry = bins[bin]
-      result = entry.find key, hsh
-      return result.value if result
-    end
-
-    default key
-  end
-
-  def []=(key, value)
-    if key.kind_of? String
-      key = key.dup.freeze unless key.frozen?
-    end
-
-    hsh = key.hash
-    entry = self.entry key, hsh
-    self.count += 1 if entry.set(key, value, hsh)
-
-    value
-  end
-
   alias_method :store, :[]=
 
-  def clear
-    __initialize__
-    self
-  end
-
   def default(key = Undefined)
     # current MRI documentation comment is wrong.  Actual behavior is:
     # Hash.new { 1 }.default # => nil
@@ -125,19 +92,12 @@ class Hash
   end
 
   def delete(key)
-    key = key.dup if key.kind_of? String # to bypass singleton hash method
-
-    hsh = key.hash
-    bin = entry_bin hsh
+    Ruby.primitive :hash_delete
 
-    if entry = bins[bin]
-      result = entry.delete key, hsh
+    key = key.dup if key.kind_of? String # to bypass singleton hash method
 
-      bins[bin] = entry.next if result.nil?
-      unless result
-        self.count -= 1
-        return entry.value
-      end
+    if entry = find_entry(key)
+      return delete_entry(entry)
     end
 
     return yield(key) if block_given?
@@ -168,23 +128,6 @@ class Hash
     self
   end
 
-  # Yields key, value for each item in the Hash. This method
-  # is necessary to protect the essential iterator from subclasses
-  # (e.g. REXML::Attribute) that replace #each with a version
-  # that is incompatible with the dependencies here (e.g. defining
-  # #each -> #each_attribute -> #each_value, where we had been
-  # defining #each_value in terms of #each).
-  def each_item
-    i = to_iter
-    while entry = i.next
-      begin
-        yield entry.key, entry.value
-      end while entry = entry.next
-    end
-
-    self
-  end
-
   alias_method :each_pair, :each_item
 
  def each_value
@@ -228,13 +171,7 @@ class Hash
   end
 
   def key?(key)
-    i = to_iter
-    while entry = i.next
-      begin
-        return true if entry.key_hash == key.hash and entry.key.eql? key
-      end while entry = entry.next
-    end
-    false
+    !find_entry(key).nil?
   end
 
   alias_method :has_key?, :key?
@@ -262,7 +199,18 @@ class Hash
   end
   alias_method :update, :merge!
 
-  alias_method :rehash, :redistribute
+  def rehash
+    Ruby.primitive :hash_rehash
+
+    i = 0
+    while i < @used
+      e = i * ENTRY_FIELDS
+      @entries[e] = key_hash(@entries[e + 1]) unless @entries[e].nil?
+      i += 1
+    end
+
+    rebuild
+  end
 
   def reject(&block)
     hsh = dup
@@ -282,8 +230,14 @@ class Hash
     other = Type.coerce_to other, Hash, :to_hash
     return self if self.equal? other
 
-    clear
-    other.each_item { |k, v| self[k] = v }
+    # The tables are copied as they are, since the hashes stored in
+    # them are still good; no key needs #hash sent to it again.
+    entries = other.instance_variable_get :@entries
+    index = other.instance_variable_get :@index
+    @entries = Tuple.new(entries.size).copy_from entries, 0, entries.size, 0
+    @index = Tuple.new(index.size).copy_from index, 0, index.size, 0
+    @count = other.instance_variable_get :@count
+    @used = other.instance_variable_get :@used
 
     if other.default_proc
       @default = other.default_proc
@@ -298,11 +252,8 @@ class Hash
 
   def select
     selected = []
-    i = to_iter
-    while e = i.next
-      begin
-        selected << [e.key, e.value] if yield(e.key, e.value)
-      end while e = e.next
+    each_item do |key, value|
+      selected << [key, value] if yield(key, value)
     end
 
     selected
@@ -311,12 +262,11 @@ class Hash
   def shift
     return default(nil) if empty?
 
-    i = to_iter
-    if entry = i.next
-      bins[i.index] = entry.next
-      self.count -= 1
-      return entry.key, entry.value
-    end
+    entry = 0
+    entry += 1 while @entries[entry * ENTRY_FIELDS].nil?
+
+    key = @entries[entry * ENTRY_FIELDS + 1]
+    return key, delete_entry(entry)
   end
 
   alias_method :length, :count
@@ -151,7 +151,7 @@ class Hash
   def to_marshal(ms)
     raise TypeError, "can't dump hash with default proc" if default_proc
 
-    excluded_ivars = %w[@bins @count @records]
+    excluded_ivars = %w[@entries @index @count @used]
 
     out = ms.serialize_instance_variables_prefix self, excluded_ivars
     out << ms.serialize_extended_object(self)
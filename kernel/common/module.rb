@@ -748,7 +748,7 @@ class Module
   #++
 
   def valid_const_name?(name)
-    name.to_s =~ /^((::)?[A-Z]\w*)+$/ ? true : false
+    /^((::)?[A-Z]\w*)+$/.search_from(name.to_s, 0) ? true : false
   end
 
   private :valid_const_name?
@@ -480,6 +480,12 @@ class Regexp
   end
 end
 
+##
+# @region is a Tuple of the begin and end offset of each group, the whole
+# match first; both are -1 for a group that didn't take part. See
+# vm/builtin/regexp.hpp. The Strings are only cut out of @source when
+# they are asked for.
+
 class MatchData
 
   def string
@@ -490,66 +496,47 @@ class MatchData
     @source
   end
 
-  def full
-    @full
-  end
-
   def begin(idx)
-    return @full.at(0) if idx == 0
-    return @region.at(idx - 1).at(0)
+    @region.at(idx * 2)
   end
 
   def end(idx)
-    return full.at(1) if idx == 0
-    @region.at(idx - 1).at(1)
+    @region.at(idx * 2 + 1)
   end
 
   def offset(idx)
-    out = []
-    out << self.begin(idx)
-    out << self.end(idx)
-    return out
+    [self.begin(idx), self.end(idx)]
   end
 
   def length
-    @region.fields + 1
+    @region.fields / 2
   end
 
   def captures
     out = []
-    @region.each do |tup|
-      x = tup.at(0)
-
-      if x == -1
-        out << nil
-      else
-        y = tup.at(1)
-        out << @source[x, y-x]
-      end
-    end
+    each_capture { |str| out << str }
     return out
   end
 
   def pre_match
-    return @source.substring(0, 0) if full.at(0) == 0
-    nd = full.at(0) - 1
-    @source[0, nd+1]
+    x = @region.at(0)
+    return @source.substring(0, 0) if x == 0
+    @source[0, x]
   end
 
   def pre_match_from(idx)
-    return @source.substring(0, 0) if full.at(0) == 0
-    nd = full.at(0) - 1
-    @source[idx, nd-idx+1]
+    x = @region.at(0)
+    return @source.substring(0, 0) if x == 0
+    @source[idx, x-idx]
   end
 
   def collapsing?
-    self.begin(0) == self.end(0)
+    @region.at(0) == @region.at(1)
   end
 
   def post_match
-    nd = @source.size - 1
-    st = full.at(1)
-    @source[st, nd-st+1]
+    st = @region.at(1)
+    @source[st, @source.size-st]
   end
 
   def [](idx, len = nil)
@@ -608,30 +595,34 @@ class MatchData
   end
 
   def matched_area
-    x = full[0]
-    y = full[1]
-    @source[x, y-x]
+    x = @region.at(0)
+    @source[x, @region.at(1)-x]
   end
 
   private :matched_area
 
   def get_capture(num)
-    x, y = @region[num]
-    return nil if !y or x == -1
+    i = num * 2 + 2
+    return nil if i >= @region.fields
 
-    return @source[x, y-x]
+    x = @region.at(i)
+    return nil if x == -1
+
+    return @source[x, @region.at(i + 1)-x]
   end
 
   private :get_capture
 
   def each_capture
-    @region.each do |tup|
-      x, y = *tup
-      yield @source[x, y-x]
+    i = 2
+    total = @region.fields
+    while i < total
+      x = @region.at(i)
+      yield(x == -1 ? nil : @source[x, @region.at(i + 1)-x])
+      i += 2
     end
   end
 
   private :each_capture
 
 end
-
@@ -1910,7 +1910,7 @@ class String
     detect_base = true if base == 0
 
     raise(ArgumentError,
-          "invalid value for Integer: #{inspect}") if check and self =~ /__/
+          "invalid value for Integer: #{inspect}") if check and /__/.search_from(self, 0)
 
     s = if check then
           self.strip
@@ -2192,21 +2192,21 @@ class String
 
   def full_to_i
     err = "invalid value for Integer: #{self.inspect}"
-    raise ArgumentError, err if self.match(/__/) || self.empty?
+    raise ArgumentError, err if /__/.search_from(self, 0) || self.empty?
     case self
     when /^[-+]?0(\d|_\d)/
-      raise ArgumentError, err if self =~ /[^0-7_]/
+      raise ArgumentError, err if /[^0-7_]/.search_from(self, 0)
       to_i(8)
     when /^[-+]?0x[a-f\d]/i
       after = self.match(/^[-+]?0x/i)
-      raise ArgumentError, err if /([^0-9a-f_])/i.match_from(self, after.end(0))
+      raise ArgumentError, err if /[^0-9a-f_]/i.search_from(self, after.end(0))
       to_i(16)
     when /^[-+]?0b[01]/i
       after = self.match(/^[-+]?0b/i)
-      raise ArgumentError, err if /[^01_]/.match_from(self, after.end(0))
+      raise ArgumentError, err if /[^01_]/.search_from(self, after.end(0))
       to_i(2)
     when /^[-+]?\d/
-      raise ArgumentError, err if self.match(/[^0-9_]/)
+      raise ArgumentError, err if /[^0-9_]/.search_from(self, 0)
       to_i(10)
     else
       raise ArgumentError, err
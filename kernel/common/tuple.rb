@@ -33,10 +33,7 @@ class Tuple
   end
 
   def + o
-    t = Tuple.new(size + o.size)
-    t.copy_from(self,0,size,0)
-    t.copy_from(o,0,o.size,size)
-    t
+    concat o
   end
 
   def inspect
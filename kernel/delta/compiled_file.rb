@@ -3,6 +3,17 @@ module Rubinius
   # A decode for the .rbc file format.
 
   class CompiledFile
+    ##
+    # Version of the text format, read by CompiledFile::Marshal.
+
+    TextVersion = 0
+
+    ##
+    # Version of the binary format. Only the VM reads it; see
+    # CompiledFile::BinaryMarshal.
+
+    BinaryVersion = 2
+
     ##
     # Create a CompiledFile with +magic+ magic bytes, of version +ver+,
     # data containing a SHA1 sum of +sum+. The optional +stream+ is used
@@ -32,10 +43,19 @@ module Rubinius
     end
 
     ##
-    # Writes the CompiledFile +cm+ to +file+.
-    def self.dump(cm, file)
+    # Unmarshals +str+, the whole of a binary .rbc, in the VM.
+
+    def self.load_binary(str)
+      Ruby.primitive :compiledfile_load_string
+      raise PrimitiveFailure, "CompiledFile.load_binary primitive failed"
+    end
+
+    ##
+    # Writes the CompiledFile +cm+ to +file+, in the binary format unless
+    # +version+ is TextVersion.
+    def self.dump(cm, file, version=BinaryVersion)
       File.open(file, "w") do |f|
-        new("!RBIX", 0, "x").encode_to(f, cm)
+        new("!RBIX", version, "x").encode_to(f, cm)
       end
     rescue Errno::EACCES
       # just skip writing the compiled file if we don't have permissions
@@ -46,12 +66,17 @@ module Rubinius
     # a body of +body+. Body use marshalled using CompiledFile::Marshal
 
     def encode_to(stream, body)
-      stream.puts @magic
-      stream.puts @version.to_s
-      stream.puts @sum.to_s
-
-      mar = CompiledFile::Marshal.new
-      stream << mar.marshal(body)
+      header = "#{@magic}\n#{@version}\n#{@sum}\n"
+      stream << header
+
+      if @version == BinaryVersion
+        # The VM maps the body straight in, so it must start on a word.
+        stream << BinaryMarshal.padding(header.size)
+        stream << BinaryMarshal.new.marshal(body)
+      else
+        mar = CompiledFile::Marshal.new
+        stream << mar.marshal(body)
+      end
     end
 
     ##
@@ -60,6 +85,11 @@ module Rubinius
     def body
       return @data if @data
 
+      if @version == BinaryVersion
+        data = stream.kind_of?(String) ? stream : stream.read
+        return @data = CompiledFile.load_binary("#{@magic}\n#{@version}\n#{@sum}\n#{data}")
+      end
+
       mar = CompiledFile::Marshal.new
       @data = mar.unmarshal(stream)
     end
@@ -339,6 +369,132 @@ module Rubinius
         return str
       end
     end
+
+    ##
+    # Converts a CompiledMethod to the binary body read by
+    # BinaryUnMarshaller in vm/marshal.cpp, which documents the layout.
+    # Every word is written little endian.
+
+    class BinaryMarshal
+      ByteOrderMark = 0x01020304
+
+      Strings = 1
+      Opcodes = 2
+      Objects = 3
+
+      ##
+      # The NUL bytes needed to pad +size+ bytes to a whole word.
+
+      def self.padding(size)
+        "\0" * ((4 - size % 4) % 4)
+      end
+
+      def initialize
+        @strings = []
+        @string_index = {}
+        @opcodes = []
+        @objects = []
+      end
+
+      ##
+      # For object +val+, return the String of the whole body.
+
+      def marshal(val)
+        add val
+
+        strings = [@strings.size].pack("V")
+        @strings.each do |s|
+          strings << [s.size].pack("V") << s << BinaryMarshal.padding(s.size)
+        end
+
+        str = [ByteOrderMark, 3].pack("VV")
+        str << section(Strings, strings)
+        str << section(Opcodes, @opcodes.pack("V*"))
+        str << section(Objects, @objects.pack("V*"))
+        str
+      end
+
+      def section(kind, payload)
+        [kind, payload.size].pack("VV") << payload << BinaryMarshal.padding(payload.size)
+      end
+
+      private :section
+
+      ##
+      # Returns the index of +str+ in the string table, adding it once.
+
+      def string(str)
+        index = @string_index[str]
+        return index if index
+
+        @strings << str
+        @string_index[str] = @strings.size - 1
+      end
+
+      private :string
+
+      def add(val)
+        case val
+        when TrueClass
+          @objects << ?t
+        when FalseClass
+          @objects << ?f
+        when NilClass
+          @objects << ?n
+        when Fixnum, Bignum
+          if val >= -0x80000000 and val <= 0x7fffffff
+            @objects << ?I << (val & 0xffffffff)
+          else
+            @objects << ?B << string(val.to_s)
+          end
+        when String
+          @objects << ?s << string(val)
+        when Symbol
+          @objects << ?x << string(val.to_s)
+        when SendSite
+          @objects << ?S << string(val.name.to_s)
+        when Tuple
+          @objects << ?p << val.size
+          val.each { |ele| add ele }
+        when Array
+          @objects << ?A << val.size
+          val.each { |ele| add ele }
+        when Float
+          # Same text as the text format, without the "d\n" and "\n".
+          @objects << ?d << string(Marshal.new.marshal(val)[2..-2])
+        when InstructionSequence
+          @objects << ?i << @opcodes.size << val.size
+          val.opcodes.each { |op| @opcodes << op }
+        when CompiledMethod
+          # Written so the VM can skip the body and load the method as a
+          # stub; the body is preceded by its size in words.
+          @objects << ?m << 1
+          add val.__ivars__
+          add val.primitive
+          add val.name
+          add val.stack_size
+          add val.local_count
+          add val.required_args
+          add val.total_args
+          add val.splat
+          add val.file
+
+          outer, @objects = @objects, []
+          add val.iseq
+          add val.literals
+          add val.exceptions
+          add val.lines
+          add val.local_names
+          body, @objects = @objects, outer
+
+          @objects << body.size
+          @objects.concat body
+        else
+          raise ArgumentError, "Unknown type #{val.class}: #{val.inspect}"
+        end
+      end
+
+      private :add
+    end
   end
 end
-
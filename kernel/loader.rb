@@ -368,6 +368,11 @@ if Rubinius::RUBY_CONFIG['rbx.jit_stats']
   stats = Rubinius::VM.jit_info
   puts "JIT time spent: #{stats[0] / 1000000}ms"
   puts " JITed methods: #{stats[1]}"
+  puts "  Still queued: #{stats[2]}"
+  puts "    Code bytes: #{stats[4]}"
+  if stats[1] > 0
+    puts "Queue latency: #{stats[3] / stats[1] / 1000}us per method"
+  end
 end
 
 if Rubinius::RUBY_CONFIG['rbx.gc_stats']
@@ -0,0 +1,31 @@
+# Packs the kernel into a single image that vm/vm loads at startup in
+# place of alpha.rbc and the directories listed in the runtime index.
+#
+#   vm/vm lib/bin/kernel_image.rb [runtime [output]]
+#
+# The image is a binary .rbc whose body is an Array of alternating file
+# names and script bodies, in the order they'd otherwise be run.
+
+root = ARGV.shift || "runtime"
+output = ARGV.shift || File.join(root, "kernel.rbi")
+
+files = [File.join(root, "alpha.rbc")]
+
+File.readlines(File.join(root, "index")).each do |dir|
+  dir = dir.strip
+  next if dir.empty?
+
+  File.readlines(File.join(root, dir, "load_order.txt")).each do |name|
+    name = name.strip
+    files << File.join(root, dir, name) unless name.empty?
+  end
+end
+
+scripts = []
+files.each do |path|
+  cm = File.open(path) { |io| Rubinius::CompiledFile.load(io).body }
+  scripts << path << cm
+end
+
+Rubinius::CompiledFile.dump scripts, output
+puts "Wrote #{files.size} files to #{output}"
@@ -181,6 +181,8 @@ def install_files(files, destination)
     dest_dir = File.dirname dest_file
     mkdir_p dest_dir unless File.directory? dest_dir
 
-    install path, dest_file, :mode => 0644, :verbose => true
+    # :preserve keeps runtime/kernel.rbi no older than what it was built
+    # from, or vm/vm would ignore it.
+    install path, dest_file, :mode => 0644, :preserve => true, :verbose => true
   end
 end
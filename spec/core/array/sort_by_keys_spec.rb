@@ -0,0 +1,53 @@
+require File.dirname(__FILE__) + '/../../spec_helper'
+
+describe "Array#sort_by_keys!" do
+  it "sorts self and the keys by the keys" do
+    a = [:a, :b, :c]
+    keys = [3, 1, 2]
+    a.sort_by_keys!(keys).should equal(a)
+    a.should == [:b, :c, :a]
+    keys.should == [1, 2, 3]
+  end
+
+  it "keeps elements with equal keys in order" do
+    a = [1, 2, 3, 4, 5]
+    a.sort_by_keys!(["b", "a", "b", "a", "ab"])
+    a.should == [2, 4, 5, 1, 3]
+  end
+
+  it "sorts by Float keys" do
+    a = [1, 2, 3]
+    a.sort_by_keys!([0.5, -1.5, 0.25])
+    a.should == [2, 3, 1]
+  end
+
+  it "returns nil for keys it can't compare natively" do
+    a = [1, 2]
+    a.sort_by_keys!([1, 2.0]).should == nil
+    a.sort_by_keys!([[1], [2]]).should == nil
+    a.sort_by_keys!([0.0 / 0.0, 1.0]).should == nil
+    a.should == [1, 2]
+  end
+
+  it "returns nil if the sizes differ" do
+    [1, 2].sort_by_keys!([1]).should == nil
+  end
+end
+
+describe "Array#native_sort!" do
+  it "sorts Fixnums, Floats and Strings in place" do
+    a = [3, -1, 2]
+    a.send(:native_sort!).should equal(a)
+    a.should == [-1, 2, 3]
+
+    a = ["b", "ab", "a"]
+    a.send(:native_sort!)
+    a.should == ["a", "ab", "b"]
+  end
+
+  it "returns nil for mixed elements" do
+    a = [3, "b"]
+    a.send(:native_sort!).should == nil
+    a.should == [3, "b"]
+  end
+end
@@ -6,7 +6,8 @@ describe "Hash.allocate" do
   it "initializes the Hash storage" do
     h = Hash.allocate
     h.instance_variable_get(:@count).should == 0
-    h.instance_variable_get(:@records).should == Hash::MIN_SIZE
-    h.instance_variable_get(:@bins).should be_kind_of(Tuple)
+    h.instance_variable_get(:@used).should == 0
+    h.instance_variable_get(:@index).should be_kind_of(Tuple)
+    h.instance_variable_get(:@entries).should be_kind_of(Tuple)
   end
 end
@@ -0,0 +1,11 @@
+require File.dirname(__FILE__) + '/../../spec_helper'
+
+describe "Hash#delete_entry" do
+  it "removes the pair at the entry number and returns its value" do
+    h = { :a => 1, :b => 2 }
+    h.delete_entry(0).should == 1
+    h.count.should == 1
+    h.key?(:a).should == false
+    h[:b].should == 2
+  end
+end
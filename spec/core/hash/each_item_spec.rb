@@ -11,6 +11,22 @@ describe "Hash#each_item" do
     a.sort.should == [[1, :a], [2, :b], [3, :c]]
   end
 
+  it "yields entries in insertion order" do
+    h = {}
+    keys = [5, :x, "y", 1, [2]]
+    keys.each { |k| h[k] = true }
+    a = []
+    h.each_item { |k, v| a << k }
+    a.should == keys
+  end
+
+  it "skips deleted entries" do
+    @hash.delete 2
+    a = []
+    @hash.each_item { |k, v| a << k }
+    a.should == [1, 3]
+  end
+
   it "raises LocalJumpError if not passed a block" do
     lambda { @hash.each_item }.should raise_error(LocalJumpError)
   end
@@ -0,0 +1,34 @@
+require File.dirname(__FILE__) + '/../../spec_helper'
+
+describe "Hash#find_entry" do
+  before :each do
+    @hash = Hash.allocate
+  end
+
+  it "returns the entry number for a key" do
+    @hash[:a] = 1
+    @hash["b"] = 2
+    @hash.find_entry(:a).should == 0
+    @hash.find_entry("b").should == 1
+  end
+
+  it "returns nil if the key is not present" do
+    @hash[:a] = 1
+    @hash.find_entry(:b).should be_nil
+  end
+
+  it "calls #hash and #eql? on keys the VM can't compare" do
+    key = mock("key")
+    key.should_receive(:hash).any_number_of_times.and_return(5)
+    key.should_receive(:eql?).any_number_of_times.and_return(true)
+
+    @hash.insert 5, "key", 1
+    @hash.find_entry(key).should == 0
+  end
+
+  it "probes past entries with the same index slot" do
+    keys = (0...8).map { |i| [i * 1024] }
+    keys.each { |k| @hash[k] = k }
+    keys.each { |k| @hash[k].should == k }
+  end
+end
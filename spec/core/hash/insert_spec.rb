@@ -0,0 +1,11 @@
+require File.dirname(__FILE__) + '/../../spec_helper'
+
+describe "Hash#insert" do
+  it "appends a pair with the given hash" do
+    h = Hash.allocate
+    h.insert 7, :key, :value
+    h.count.should == 1
+    h.instance_variable_get(:@entries)[0].should == 7
+    h.instance_variable_get(:@entries)[1].should == :key
+  end
+end
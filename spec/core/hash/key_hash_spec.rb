@@ -0,0 +1,16 @@
+require File.dirname(__FILE__) + '/../../spec_helper'
+
+describe "Hash#key_hash" do
+  it "returns key.hash masked to a positive Fixnum" do
+    h = Hash.allocate
+    h.key_hash(:a).should == :a.hash & Hash::MAX_HASH
+    h.key_hash(-1).should == Hash::MAX_HASH
+    h.key_hash(2 ** 100).should be_kind_of(Fixnum)
+  end
+
+  it "raises a TypeError if #hash does not return an Integer" do
+    key = mock("key")
+    key.should_receive(:hash).and_return("hash")
+    lambda { Hash.allocate.key_hash(key) }.should raise_error(TypeError)
+  end
+end
@@ -0,0 +1,12 @@
+require File.dirname(__FILE__) + '/../../spec_helper'
+
+describe "Hash#rebuild" do
+  it "squeezes out deleted entries" do
+    h = { :a => 1, :b => 2, :c => 3 }
+    h.delete :b
+    h.rebuild
+    h.instance_variable_get(:@used).should == 2
+    h.find_entry(:c).should == 1
+    h[:c].should == 3
+  end
+end
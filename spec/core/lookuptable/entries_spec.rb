@@ -5,9 +5,8 @@ describe "LookupTable#entries" do
     @lt = LookupTable.new(:a => 1, :b => 2, :c => 3)
   end
 
-  it "returns an Array of the entries in the LookupTable" do
-    entries = @lt.entries.sort { |a, b| a.key.to_s <=> b.key.to_s }
-    entries.collect { |e| e.key }.should == [:a, :b, :c]
-    entries.collect { |e| e.value }.should == [1, 2, 3]
+  it "returns an Array of the [key, value] pairs in the LookupTable" do
+    entries = @lt.entries.sort { |a, b| a.first.to_s <=> b.first.to_s }
+    entries.should == [[:a, 1], [:b, 2], [:c, 3]]
   end
 end
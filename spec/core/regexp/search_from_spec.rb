@@ -0,0 +1,20 @@
+require File.dirname(__FILE__) + '/../../spec_helper'
+
+describe "Regexp#search_from" do
+  it "returns the index the first match at or after start begins at" do
+    /c/.search_from("abcabc", 0).should == 2
+    /c/.search_from("abcabc", 3).should == 5
+    /\Ab/.search_from("abc", 1).should == nil
+  end
+
+  it "returns nil if there is no match" do
+    /d/.search_from("abc", 0).should == nil
+    /c/.search_from("abc", 3).should == nil
+  end
+
+  it "does not set $~" do
+    /b/ =~ "abc"
+    /(c)/.search_from("abc", 0)
+    $~[0].should == "b"
+  end
+end
@@ -0,0 +1,18 @@
+require File.dirname(__FILE__) + '/../../spec_helper'
+
+describe "Tuple#copy_from" do
+  it "copies a range of another Tuple" do
+    t = Tuple.new(3)
+    t.copy_from(Tuple[:a, :b, :c], 1, 2, 1).should equal(t)
+    t.to_a.should == [nil, :b, :c]
+  end
+
+  it "moves fields within the same Tuple when the ranges overlap" do
+    t = Tuple[1, 2, 3, 4]
+    t.copy_from(t, 0, 3, 1)
+    t.to_a.should == [1, 1, 2, 3]
+
+    t.copy_from(t, 1, 3, 0)
+    t.to_a.should == [1, 2, 3, 3]
+  end
+end
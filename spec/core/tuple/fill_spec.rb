@@ -0,0 +1,15 @@
+require File.dirname(__FILE__) + '/../../spec_helper'
+
+describe "Tuple#fill" do
+  it "sets a range of fields to object" do
+    t = Tuple[1, 2, 3, 4]
+    t.fill(1, 2, :a).should equal(t)
+    t.to_a.should == [1, :a, :a, 4]
+  end
+
+  it "raises an Rubinius::ObjectBoundsExceededError when the range is out of bounds" do
+    t = Tuple[1, 2]
+    lambda { t.fill(1, 2, :a) }.should raise_error(Rubinius::ObjectBoundsExceededError)
+    lambda { t.fill(-1, 1, :a) }.should raise_error(Rubinius::ObjectBoundsExceededError)
+  end
+end
@@ -11,9 +11,14 @@ static VALUE sf_new_point_five(VALUE self) {
   return rb_float_new(flt);
 }
 
+static VALUE sf_num2dbl(VALUE self, VALUE num) {
+  return rb_float_new(NUM2DBL(num) * 2);
+}
+
 void Init_subtend_float() {
   VALUE cls;
   cls = rb_define_class("SubtendFloat", rb_cObject);
   rb_define_method(cls, "sf_new_zero", sf_new_zero, 0);
   rb_define_method(cls, "sf_new_point_five", sf_new_point_five, 0);  
+  rb_define_method(cls, "sf_num2dbl", sf_num2dbl, 1);
 }
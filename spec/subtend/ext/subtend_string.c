@@ -94,6 +94,11 @@ VALUE ss_rstring_assign_foo_and_upcase(VALUE self, VALUE str) {
   return Qnil;
 }
 
+VALUE ss_rstring_ptr_write_x(VALUE self, VALUE str) {
+  RSTRING_PTR(str)[0] = 'x';
+  return str;
+}
+
 VALUE ss_str_to_str(VALUE self, VALUE arg) {
   return rb_str_to_str(arg);
 }
@@ -120,5 +125,6 @@ void Init_subtend_string() {
   rb_define_method(cls, "rb_rstring_assign_global_foobar", ss_rstring_assign_global_foobar, 0);
   rb_define_method(cls, "rb_rstring_set_len", ss_rstring_set_len, 2);
   rb_define_method(cls, "rb_rstring_assign_foo_and_upcase", ss_rstring_assign_foo_and_upcase, 1);
+  rb_define_method(cls, "rb_rstring_ptr_write_x", ss_rstring_ptr_write_x, 1);
   rb_define_method(cls, "rb_str_to_str", ss_str_to_str, 1);
 }
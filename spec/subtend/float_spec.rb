@@ -13,4 +13,14 @@ describe "SubtendFloat" do
     ((@f.sf_new_zero - 0).abs < 0.000001).should == true
     ((@f.sf_new_point_five - 0.555).abs < 0.000001).should == true
   end
+
+  it "NUM2DBL should convert a Float or an Integer to a double" do
+    @f.sf_num2dbl(1.25).should == 2.5
+    @f.sf_num2dbl(1.0e300).should == 2.0e300
+    @f.sf_num2dbl(3).should == 6.0
+  end
+
+  it "NUM2DBL should raise a TypeError for other objects" do
+    lambda { @f.sf_num2dbl("1.0") }.should raise_error(TypeError)
+  end
 end
@@ -115,6 +115,20 @@ describe "SubtendString" do
     t.should == "FOO"
   end
 
+  it "writing through RSTRING_PTR on a shared string leaves the strings sharing with it alone" do
+    a = "hello"
+    b = a.dup
+    @s.rb_rstring_ptr_write_x(b).should == "xello"
+    a.should == "hello"
+  end
+
+  it "writing through RSTRING_PTR on a substring leaves the original string alone" do
+    a = "hello world"
+    b = a[6, 5]
+    @s.rb_rstring_ptr_write_x(b).should == "xorld"
+    a.should == "hello world"
+  end
+
   it "rb_str_to_str should try to coerce to String, otherwise raise a TypeError" do
     @s.rb_str_to_str("foo").should == "foo"
     @s.rb_str_to_str(ValidTostrTest.new).should == "ruby"
@@ -0,0 +1,138 @@
+#include "assembler_x8664.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+
+// for abi::__cxa_demangle
+#include <cxxabi.h>
+
+namespace assembler_x8664 {
+  using namespace assembler;
+
+  Register rax = { 0 };
+  Register rcx = { 1 };
+  Register rdx = { 2 };
+  Register rbx = { 3 };
+  Register rsp = { 4 };
+  Register rbp = { 5 };
+  Register rsi = { 6 };
+  Register rdi = { 7 };
+  Register r8  = { 8 };
+  Register r9  = { 9 };
+  Register r10 = { 10 };
+  Register r11 = { 11 };
+  Register r12 = { 12 };
+  Register r13 = { 13 };
+  Register r14 = { 14 };
+  Register r15 = { 15 };
+  Register no_reg = { -1 };
+  Register no_base = rbp;
+
+  void AssemblerX8664::show() {
+    show_buffer(buffer_, pc_ - buffer_);
+  }
+
+  void AssemblerX8664::show_buffer(void* buffer, size_t size, bool show_hex,
+      rubinius::AddressComments* comments) {
+    ud_t ud;
+
+    ud_init(&ud);
+    ud_set_mode(&ud, 64);
+    ud_set_syntax(&ud, UD_SYN_ATT);
+    ud_set_input_buffer(&ud, reinterpret_cast<uint8_t*>(buffer), size);
+
+    while(ud_disassemble(&ud)) {
+      void* address = reinterpret_cast<void*>(
+          reinterpret_cast<uintptr_t>(buffer) + ud_insn_off(&ud));
+
+      if(comments) {
+        rubinius::AddressComments::iterator i = comments->find(address);
+        if(i != comments->end()) {
+          std::cout << "                 ;  " << i->second << "\n";
+        }
+      }
+
+      std::cout << std::setw(18) << std::right
+                << address
+                << "  ";
+
+      if(show_hex) {
+        if(ud_insn_len(&ud) <= 6) {
+          std::cout << std::setw(12);
+        } else {
+          std::cout << std::setw(24);
+        }
+        std::cout << std::left << ud_insn_hex(&ud) << "  ";
+      }
+      std::cout << std::setw(24) << std::left << ud_insn_asm(&ud);
+
+      // Calls are always 'mov $imm64, %r11; call *%r11', so show what
+      // the immediate refers to.
+      if(ud.mnemonic == UD_Imov && ud.operand[1].type == UD_OP_IMM &&
+          ud.operand[1].size == 64) {
+        const void* addr = (const void*)ud.operand[1].lval.uqword;
+        Dl_info info;
+        if(dladdr(addr, &info) && info.dli_sname && info.dli_saddr == addr) {
+          int status = 0;
+          char* cpp_name = abi::__cxa_demangle(info.dli_sname, 0, 0, &status);
+          if(status >= 0 && cpp_name) {
+            // Chop off the arg info from the signature output
+            char *paren = strstr(cpp_name, "(");
+            if(paren) *paren = 0;
+            std::cout << " ; " << cpp_name;
+            free(cpp_name);
+          } else {
+            std::cout << " ; " << info.dli_sname;
+          }
+        }
+      } else if(ud.operand[0].type == UD_OP_JIMM) {
+        const void* addr = (const void*)((uintptr_t)buffer + ud.pc + (int)ud.operand[0].lval.sdword);
+        std::cout << " ; " << addr;
+      }
+
+      std::cout << "\n";
+    }
+  }
+
+  ud_t* AssemblerX8664::disassemble() {
+    ud_t *ud = new ud_t();
+    ud_init(ud);
+    ud_set_mode(ud, 64);
+    ud_set_syntax(ud, UD_SYN_ATT);
+    ud_set_input_buffer(ud, (uint8_t*)buffer_, pc_ - buffer_);
+    ud_disassemble(ud);
+    return ud;
+  }
+
+  void AssemblerX8664::show_relocations() {
+    std::cout << "Relocations:\n";
+    for(Relocations::iterator i = relocations_.begin();
+        i != relocations_.end();
+        i++) {
+      std::cout << i->first << ": ";
+      std::cout << "address=" << i->second->address();
+      switch(i->second->kind()) {
+      case Relocation::Relative:
+        std::cout << " relative";
+        break;
+      case Relocation::LocalAbsolute:
+        std::cout << " local";
+        break;
+      case Relocation::ExternalAbsolute:
+        std::cout << " absolute";
+        break;
+      }
+
+      switch(i->second->target_kind()) {
+      case Relocation::Absolute:
+        break;
+      case Relocation::Symbol:
+        std::cout << " symbol='" << i->second->symbol() << "'";
+        break;
+      }
+
+      std::cout << "\n";
+    }
+  }
+}
@@ -1,5 +1,21 @@
-#include "assembler.hpp"
+#ifndef RBX_ASSEMBLER_X8664
+#define RBX_ASSEMBLER_X8664
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <string>
+#include <cstring>
+#include <iomanip>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <dlfcn.h>
+
+#include "assembler/assembler.hpp"
 #include "udis86.h"
+#include "assembler/relocation.hpp"
+#include "assembler/code_map.hpp"
 
 namespace assembler_x8664 {
   struct Register {
@@ -15,6 +31,8 @@ namespace assembler_x8664 {
       return code_;
     }
 
+    // The 3 bits that go into a ModRM or SIB byte. The 4th bit goes
+    // into the REX prefix.
     int base_code() {
       return code_ & 0x7;
     }
@@ -28,131 +46,330 @@ namespace assembler_x8664 {
     }
   };
 
-  Register rax = { 0 };
-  Register rcx = { 1 };
-  Register rdx = { 2 };
-  Register rbx = { 3 };
-  Register rsp = { 4 };
-  Register rbp = { 5 };
-  Register rsi = { 6 };
-  Register rdi = { 7 };
-  Register r8  = { 8 };
-  Register r9  = { 9 };
-  Register r10 = { 10 };
-  Register r11 = { 11 };
-  Register r12 = { 12 };
-  Register r13 = { 13 };
-  Register r14 = { 14 };
-  Register r15 = { 15 };
-  Register rip = { 16 };
-  Register no_reg = { -1 };
-  Register no_base = rbp;
+  // Set in assembler_x8664.cpp so they're not defined multiple times.
+  extern Register rax;
+  extern Register rcx;
+  extern Register rdx;
+  extern Register rbx;
+  extern Register rsp;
+  extern Register rbp;
+  extern Register rsi;
+  extern Register rdi;
+  extern Register r8;
+  extern Register r9;
+  extern Register r10;
+  extern Register r11;
+  extern Register r12;
+  extern Register r13;
+  extern Register r14;
+  extern Register r15;
+  extern Register no_reg;
+  extern Register no_base;
 
   class AssemblerX8664 : public assembler::Assembler {
-  public:
+  public: // Types
+    // See http://wiki.osdev.org/X86_Instruction_Encoding
+    // for info on how the mod bits are interpretted
     enum ModType {
+      ModNone = 0,
       ModAddr2Reg = 1,
       ModReg2Addr = 2,
-      ModReg2Reg = 3
+      ModReg2Reg = 3,
+
+      Mod8Displacement = 1,
+      Mod32Displacement = 2
     };
 
-  private:
-    void rex(Register &reg, bool imm64=false) {
-      if(reg.extended_p()) {
-        emit(0x49);
-      } else if(imm64) {
-        emit(0x48);
+    // [base + (index * scale) + offset]. index is no_reg when the
+    // address is just base + offset.
+    class Address {
+      Register& base_;
+      Register& index_;
+      int scale_;
+      int offset_;
+
+    public:
+
+      Address(Register& r, int o)
+        : base_(r), index_(no_reg), scale_(1), offset_(o) { }
+
+      Address(Register& r, Register& i, int s, int o)
+        : base_(r), index_(i), scale_(s), offset_(o) { }
+
+      Register& base() const {
+        return base_;
+      }
+
+      Register& index() const {
+        return index_;
+      }
+
+      int scale() const {
+        return scale_;
       }
-    }
 
-    void rex_r(Register &reg) {
-      if(reg.extended_p()) {
-        emit(0x4c);
+      int offset() const {
+        return offset_;
+      }
+
+      bool indexed_p() const {
+        return index_.code() >= 0;
       }
+    };
+
+  private:
+
+    assembler::Relocations relocations_;
+
+    const static int AddOperation = 0;
+    const static int OrOperation = 1;
+    const static int AndOperation = 4;
+    const static int SubOperation = 5;
+    const static int CompareOperation = 7;
+
+    const static int RexW = 0x8;
+    const static int RexR = 0x4;
+    const static int RexX = 0x2;
+    const static int RexB = 0x1;
+
+    static bool byte_p(int val) {
+      return val < 128 && val >= -128;
     }
 
-    void rex_rb(Register &reg, Register &modrm) {
-      int prefix = 0x40;
-      if(reg.extended_p())   prefix |= 0xc;
-      if(modrm.extended_p()) prefix |= 0x9;
+    // Emit a REX prefix if any of the bits are needed. +reg+ goes in the
+    // ModRM reg field, +rm+ in the ModRM r/m field (or opcode), +index+
+    // in the SIB index field.
+    void rex(bool wide, int reg, int rm, int index = 0) {
+      int bits = 0;
+      if(wide) bits |= RexW;
+      if(reg > 7) bits |= RexR;
+      if(index > 7) bits |= RexX;
+      if(rm > 7) bits |= RexB;
+
+      if(bits) emit(0x40 | bits);
+    }
 
-      if(prefix != 0x40) emit(prefix);
+    void rex(bool wide, int reg, const Address& addr) {
+      rex(wide, reg, addr.base().code(),
+          addr.indexed_p() ? addr.index().code() : 0);
     }
 
     void emit_modrm(ModType mod, int reg, int rm) {
       emit(((int)mod << 6) | (reg & 0x7) << 3 | (rm & 0x7));
     }
 
-  public:
-    AssemblerX8664() : Assembler() { }
+    static int scale_bits(int scale) {
+      switch(scale) {
+      case 2: return 1;
+      case 4: return 2;
+      case 8: return 3;
+      default: return 0;
+      }
+    }
 
-    class Address {
-      Register& base_;
-      int offset_;
+    // Emit the ModRM, SIB and displacement bytes for a memory operand.
+    //
+    // Two encodings are special:
+    //   rsp/r12 as base: the r/m value 4 means 'SIB follows', so those
+    //                    registers must always be addressed through SIB.
+    //   rbp/r13 as base: mod 0 with r/m 5 means rip relative, so those
+    //                    always carry at least an 8 bit displacement.
+    void emit_address(int reg, const Address& addr) {
+      Register& base = addr.base();
+      int disp = addr.offset();
+
+      ModType mod;
+      if(disp == 0 && base.base_code() != 5) {
+        mod = ModNone;
+      } else if(byte_p(disp)) {
+        mod = Mod8Displacement;
+      } else {
+        mod = Mod32Displacement;
+      }
 
-    public:
+      if(addr.indexed_p()) {
+        emit_modrm(mod, reg, 4);
+        emit(scale_bits(addr.scale()) << 6 |
+             addr.index().base_code() << 3 | base.base_code());
+      } else if(base.base_code() == 4) {
+        emit_modrm(mod, reg, 4);
+        // index of 4 (rsp) means no index.
+        emit(0 << 6 | 4 << 3 | base.base_code());
+      } else {
+        emit_modrm(mod, reg, base.base_code());
+      }
 
-      Address(Register& r, int o) : base_(r), offset_(o) { }
+      if(mod == Mod8Displacement) {
+        // Be sure to cast so that the sign is extended properly.
+        emit((int8_t)disp);
+      } else if(mod == Mod32Displacement) {
+        emit_w(disp);
+      }
+    }
 
-      Register& base() const {
-        return base_;
+    void emit_math(int operation, Register& reg, int val) {
+      rex(true, 0, reg.code());
+      if(byte_p(val)) {
+        emit(0x83);
+        emit_modrm(ModReg2Reg, operation, reg.base_code());
+        emit((int8_t)val);
+      } else {
+        emit(0x81);
+        emit_modrm(ModReg2Reg, operation, reg.base_code());
+        emit_w(val);
       }
+    }
 
-      int offset() const {
-        return offset_;
+    void emit_math(int operation, const Address& addr, int val, bool wide) {
+      rex(wide, 0, addr);
+      if(byte_p(val)) {
+        emit(0x83);
+        emit_address(operation, addr);
+        emit((int8_t)val);
+      } else {
+        emit(0x81);
+        emit_address(operation, addr);
+        emit_w(val);
       }
-    };
+    }
+
+    // Emit +opcode+ with a register destination and register source,
+    // in the 'op reg, r/m' form.
+    void emit_rr(uint8_t opcode, Register& dst, Register& src, bool wide = true) {
+      rex(wide, dst.code(), src.code());
+      emit(opcode);
+      emit_modrm(ModReg2Reg, dst.base_code(), src.base_code());
+    }
+
+    void emit_ra(uint8_t opcode, Register& reg, const Address& addr, bool wide = true) {
+      rex(wide, reg.code(), addr);
+      emit(opcode);
+      emit_address(reg.base_code(), addr);
+    }
+
+    void add_relocation(void* position, void* address, const char* name) {
+      assembler::Relocation* rel = new assembler::Relocation(
+          assembler::Relocation::ExternalAbsolute, position, address, 0);
+      if(name) rel->references_symbol(name);
+      relocations_[position] = rel;
+
+      rel->write();
+    }
+
+  public:
+    AssemblerX8664() : Assembler() { }
+
+    AssemblerX8664(uint8_t* buffer) : Assembler(buffer) { }
+
+    ~AssemblerX8664() {
+      for(assembler::Relocations::iterator i = relocations_.begin();
+          i != relocations_.end();
+          i++) {
+        delete i->second;
+      }
+    }
 
     Address address(Register &r, int o = 0) {
       return Address(r, o);
     }
 
+    Address address(Register &r, Register& index, int scale, int o = 0) {
+      return Address(r, index, scale, o);
+    }
+
+    // Relocation
+    assembler::Relocation* find_relocation(void* address) {
+      return relocations_[address];
+    }
+
+    void add_relocation(void* addr, assembler::Relocation* rel) {
+      relocations_[addr] = rel;
+    }
+
+    assembler::Relocations& relocations() {
+      return relocations_;
+    }
+
+    // Data movement
+    //
+    // Unless the name says otherwise (the *32 variants), operations are
+    // on full 64 bit registers and memory.
+
     void mov(Register &reg, uint64_t val) {
-      rex(reg, true);
+      rex(true, 0, reg.code());
       emit(0xb8 | reg.base_code());
       emit_dw(val);
     }
 
-    void mov(const Address addr, int val) {
-      rex(addr.base());
+    // Load a sign extended 32 bit immediate. Shorter than mov() when
+    // the value is known to fit.
+    void mov_imm32(Register &reg, int32_t val) {
+      rex(true, 0, reg.code());
       emit(0xc7);
+      emit_modrm(ModReg2Reg, 0, reg.base_code());
+      emit_w(val);
+    }
 
-      // the low bits of r12 are 4, which is the same as the flag to use
-      // SIB. Therefore to address via r12, we have to use SIB.
-      if(addr.base() == r12) {
-        // 4 means use SIB, so we have to use it.
-        emit_modrm(ModReg2Addr, 0, 4);
-        // rsp.code() means ignore the index.
-        emit(0 << 6 | rsp.code() << 3 | addr.base().base_code());
-      } else {
-        emit_modrm(ModReg2Addr, 0, addr.base().base_code());
-      }
-      emit_w(addr.offset());
+    // Stores a sign extended 32 bit immediate into a 64 bit slot.
+    void mov(const Address addr, int val) {
+      rex(true, 0, addr);
+      emit(0xc7);
+      emit_address(0, addr);
       emit_w(val);
     }
 
     void mov(Register &dst, Register &src) {
-      rex_rb(dst, src);
-      emit(0x8b);
-      emit_modrm(ModReg2Reg, dst.code(), src.code());
+      emit_rr(0x8b, dst, src);
     }
 
     void mov(Register &dst, const Address addr) {
-      rex_rb(dst, addr.base());
-      emit(0x8b);
-      emit_modrm(ModAddr2Reg, dst.base_code(), addr.base().base_code());
-      emit(addr.offset());
+      emit_ra(0x8b, dst, addr);
     }
 
     void mov(const Address addr, Register &src) {
-      rex_rb(src, addr.base());
-      emit(0x89);
-      emit_modrm(ModReg2Addr, src.base_code(), addr.base().base_code());
-      emit_w(addr.offset());
+      emit_ra(0x89, src, addr);
+    }
+
+    // 32 bit moves, for int sized fields like MethodContext::ip and
+    // the opcode stream. Loads zero extend into the full register.
+    void mov32(Register &dst, const Address addr) {
+      emit_ra(0x8b, dst, addr, false);
+    }
+
+    void mov32(const Address addr, Register &src) {
+      emit_ra(0x89, src, addr, false);
+    }
+
+    void mov32(const Address addr, int val) {
+      rex(false, 0, addr);
+      emit(0xc7);
+      emit_address(0, addr);
+      emit_w(val);
+    }
+
+    void mov32(Register &reg, uint32_t val) {
+      rex(false, 0, reg.code());
+      emit(0xb8 | reg.base_code());
+      emit_w(val);
+    }
+
+    // Sign extend the low 32 bits of +src+ into +dst+.
+    void movsxd(Register &dst, Register &src) {
+      emit_rr(0x63, dst, src);
+    }
+
+    // Sets up a mov instruction of an immediate value to register.
+    // The immediate value is initialized to 0, and it's location
+    // in memory is returned so it can be updated directly.
+    void mov_delayed(Register &reg, uintptr_t** loc) {
+      rex(true, 0, reg.code());
+      emit(0xb8 | reg.base_code());
+      *loc = (uintptr_t*)pc_;
+      emit_dw(0);
     }
 
     void push(Register &reg) {
-      rex(reg, true);
+      rex(false, 0, reg.code());
       emit(0x50 | reg.base_code());
     }
 
@@ -162,23 +379,22 @@ namespace assembler_x8664 {
     }
 
     void push(const Address addr) {
-      rex(addr.base());
+      rex(false, 0, addr);
       emit(0xff);
-
-      emit_modrm(ModReg2Addr, 6, addr.base().base_code());
-      emit_w(addr.offset());
+      emit_address(6, addr);
     }
 
     void pop(Register &reg) {
-      rex(reg);
+      rex(false, 0, reg.code());
       emit(0x58 | reg.base_code());
     }
 
     void lea(Register &dest, Register &base, int offset) {
-      rex_rb(dest, base);
-      emit(0x8d);
-      emit_modrm(ModReg2Addr, dest.base_code(), base.base_code());
-      emit_w(offset);
+      emit_ra(0x8d, dest, address(base, offset));
+    }
+
+    void nop() {
+      emit(0x90);
     }
 
     // Function setup/teardown
@@ -191,34 +407,327 @@ namespace assembler_x8664 {
       emit(0xc3);
     }
 
+    // Math
+
     void sub(Register &reg, int val) {
-      rex(reg);
-      emit(0x81);
-      emit_modrm(ModReg2Reg, 5, reg.base_code());
-      emit_w(val);
+      emit_math(SubOperation, reg, val);
     }
 
     void add(Register &reg, int val) {
-      rex(reg);
-      emit(0x81);
+      emit_math(AddOperation, reg, val);
+    }
+
+    void add(const Address addr, int val) {
+      emit_math(AddOperation, addr, val, true);
+    }
+
+    void add32(const Address addr, int val) {
+      emit_math(AddOperation, addr, val, false);
+    }
+
+    void add(Register &dst, Register &src) {
+      emit_rr(0x03, dst, src);
+    }
+
+    void sub(Register &dst, Register &src) {
+      emit_rr(0x2b, dst, src);
+    }
+
+    void dec(Register &reg) {
+      rex(true, 0, reg.code());
+      emit(0xff);
+      emit_modrm(ModReg2Reg, 1, reg.base_code());
+    }
+
+    void inc(Register &reg) {
+      rex(true, 0, reg.code());
+      emit(0xff);
+      emit_modrm(ModReg2Reg, 0, reg.base_code());
+    }
+
+    void cmp(Register &reg, int val) {
+      emit_math(CompareOperation, reg, val);
+    }
+
+    void cmp(Register &lhs, Register &rhs) {
+      emit_rr(0x3b, lhs, rhs);
+    }
+
+    void cmp(const Address addr, int val) {
+      emit_math(CompareOperation, addr, val, true);
+    }
+
+    // Compare only the low byte of +reg+. Used on the result of
+    // functions returning bool, where the rest of the register is
+    // undefined.
+    void cmp_byte(Register &reg, int8_t val) {
+      // Without a REX prefix, codes 4-7 mean ah/ch/dh/bh
+      if(reg.code() > 3) {
+        emit(0x40 | (reg.extended_p() ? RexB : 0));
+      }
+      emit(0x80);
+      emit_modrm(ModReg2Reg, CompareOperation, reg.base_code());
+      emit(val);
+    }
+
+    void shift_right(Register &reg, int count) {
+      rex(true, 0, reg.code());
+      emit(0xc1);
+      emit_modrm(ModReg2Reg, 7, reg.base_code());
+      emit(count);
+    }
+
+    void shift_left(Register &reg, int count) {
+      rex(true, 0, reg.code());
+      emit(0xc1);
+      emit_modrm(ModReg2Reg, 4, reg.base_code());
+      emit(count);
+    }
+
+    void bit_or(Register &reg, int val) {
+      emit_math(OrOperation, reg, val);
+    }
+
+    void bit_or(Register &dst, const Address addr) {
+      emit_ra(0x0b, dst, addr);
+    }
+
+    void bit_and(Register &reg, int val) {
+      emit_math(AndOperation, reg, val);
+    }
+
+    void bit_and(Register &dst, const Address addr) {
+      emit_ra(0x23, dst, addr);
+    }
+
+    void bit_and(Register &dst, Register &reg) {
+      emit_rr(0x23, dst, reg);
+    }
+
+    // Testing
+
+    void test(Register &lhs, Register &rhs) {
+      emit_rr(0x85, rhs, lhs);
+    }
+
+    void test(Register &reg, const int val) {
+      rex(true, 0, reg.code());
+      emit(0xf7);
       emit_modrm(ModReg2Reg, 0, reg.base_code());
       emit_w(val);
     }
 
-    void add(Register &dst, Register &src) {
-      rex_rb(dst, src);
-      emit(0x03);
-      emit_modrm(ModReg2Reg, dst.base_code(), src.base_code());
+    // Calling
+    //
+    // Targets outside the code buffer are usually further than 2GB away
+    // from it, out of reach of a rel32 call. So calls go through r11,
+    // which the System V ABI leaves as a scratch register that is never
+    // used to pass arguments.
+
+    void call(Register &reg) {
+      rex(false, 0, reg.code());
+      emit(0xff);
+      emit_modrm(ModReg2Reg, 2, reg.base_code());
+    }
+
+    void call(void* func) {
+      call(func, NULL);
+    }
+
+    // Used for calling to a symbol that may need to be fixed up
+    // via dlsym() later.
+    void call(void* func, const char* name) {
+      mov(r11, 0);
+      add_relocation(pc_ - 8, func, name);
+      call(r11);
+    }
+
+    // Jump
+
+    typedef std::vector<uint8_t*> Locations;
+
+    class NearJumpLocation {
+      Locations *fixups_;
+      uint8_t *destination_;
+      uint32_t flags_;
+
+    public:
+
+      NearJumpLocation() : fixups_(0), destination_(0), flags_(0) { }
+
+      Locations& fixups() {
+        return *fixups_;
+      }
+
+      uint32_t& flags() {
+        return flags_;
+      }
+
+      void set_destination(uint8_t *dest) {
+        destination_ = dest;
+
+        if(!fixups_) return;
+
+        for(Locations::iterator i = fixups_->begin();
+            i != fixups_->end();
+            i++) {
+          *reinterpret_cast<int32_t*>(*i) = dest - (*i + 4);
+        }
+
+        // We're done with the fixups, get rid of them.
+        delete fixups_;
+        fixups_ = 0;
+      }
+
+      uint8_t *destination() {
+        return destination_;
+      }
+
+      bool bound_p() {
+        return destination_ != 0;
+      }
+
+      int operand(uint8_t* location) {
+        if(!bound_p()) {
+          if(!fixups_) fixups_ = new Locations;
+          fixups_->push_back(location);
+          return 0;
+        }
+        // The 4 here is because thats the size of the operand
+        // is 4 bytes and rip points to the next instruction
+        // when jump runs
+        return destination_ - (location + 4);
+      }
+    };
+
+    void jump(NearJumpLocation& loc) {
+      emit(0xe9);
+      emit_w(loc.operand(pc_));
+    }
+
+    void jump(Register &reg) {
+      rex(false, 0, reg.code());
+      emit(0xff);
+      emit_modrm(ModReg2Reg, 4, reg.base_code());
+    }
+
+    void jump(const Address addr) {
+      rex(false, 0, addr);
+      emit(0xff);
+      emit_address(4, addr);
+    }
+
+    // Jump to table[index]. The table can live anywhere in the address
+    // space, so its address is loaded into r11 first.
+    void jump_via_table(void** table, Register& index) {
+      mov(r11, reinterpret_cast<uintptr_t>(table));
+      jump(address(r11, index, sizeof(void*)));
+    }
+
+    void jump(void* address) {
+      mov(r11, 0);
+      add_relocation(pc_ - 8, address, NULL);
+      jump(r11);
     }
 
-    ud_t* disassemble() {
-      ud_t *ud = new ud_t();
-      ud_init(ud);
-      ud_set_mode(ud, 64);
-      ud_set_syntax(ud, UD_SYN_ATT);
-      ud_set_input_buffer(ud, (uint8_t*)buffer_, pc_ - buffer_);
-      ud_disassemble(ud);
-      return ud;
+    void jump_if_equal(NearJumpLocation& loc) {
+      emit(0x0f);
+      emit(0x84);
+      emit_w(loc.operand(pc_));
     }
+
+    void jump_if_not_equal(NearJumpLocation& loc) {
+      emit(0x0f);
+      emit(0x85);
+      emit_w(loc.operand(pc_));
+    }
+
+    void jump_if_greater(NearJumpLocation& loc) {
+      emit(0x0f);
+      emit(0x8f);
+      emit_w(loc.operand(pc_));
+    }
+
+    void jump_if_less(NearJumpLocation& loc) {
+      emit(0x0f);
+      emit(0x8c);
+      emit_w(loc.operand(pc_));
+    }
+
+    void jump_if_overflow(NearJumpLocation& loc) {
+      emit(0x0f);
+      emit(0x80);
+      emit_w(loc.operand(pc_));
+    }
+
+    void set_label(NearJumpLocation& loc) {
+      loc.set_destination(pc_);
+    }
+
+    // Meta instructions
+
+    // Number of callee saved registers pushed by prologue(), besides rbp.
+    const static int SavedRegisters = 5;
+
+    // Sets up a System V frame and saves every callee saved register,
+    // so generated code is free to keep state in rbx and r12-r15.
+    // +stack+ bytes of scratch space are reserved below the saved
+    // registers, with rsp left 16 byte aligned for calls.
+    int prologue(int stack) {
+      push(rbp);
+      mov(rbp, rsp);
+
+      push(rbx);
+      push(r12);
+      push(r13);
+      push(r14);
+      push(r15);
+
+      // return address + rbp + saved registers are on the stack. Pad
+      // so that rsp ends up 16 byte aligned.
+      int used = 16 + (SavedRegisters * 8);
+      stack = ((used + stack + 15) & ~15) - used;
+
+      if(stack > 0) sub(rsp, stack);
+
+      return stack;
+    }
+
+    void epilogue() {
+      // Point rsp at the last saved register, skipping any scratch space.
+      lea(rsp, rbp, -(SavedRegisters * 8));
+
+      pop(r15);
+      pop(r14);
+      pop(r13);
+      pop(r12);
+      pop(rbx);
+
+      pop(rbp);
+      ret();
+    }
+
+    // Arguments arrive in registers under System V, in this order.
+    static Register& arg_register(int which) {
+      switch(which) {
+      case 0: return rdi;
+      case 1: return rsi;
+      case 2: return rdx;
+      case 3: return rcx;
+      case 4: return r8;
+      case 5: return r9;
+      }
+
+      return no_reg;
+    }
+
+    // Disassembling
+    void show();
+    static void show_buffer(void* buffer, size_t size, bool show_hex = false,
+        rubinius::AddressComments* comments = NULL);
+    ud_t* disassemble();
+    void show_relocations();
   };
 }
+
+#endif
@@ -30,7 +30,8 @@ namespace rubinius {
     , buffer_(new uint8_t[1024*1024])
     , a(buffer_)
     , s(a, ebx)
-    , ops(s) { }
+    , ops(s)
+    , speculate_(false) { }
 
   JITCompiler::JITCompiler(uint8_t* buf)
     : stack_cached_(false)
@@ -38,7 +39,8 @@ namespace rubinius {
     , buffer_(buf)
     , a(buffer_)
     , s(a, ebx)
-    , ops(s) { }
+    , ops(s)
+    , speculate_(false) { }
 
   JITCompiler::~JITCompiler() {
     if(own_buffer_) {
@@ -61,8 +63,15 @@ namespace rubinius {
 
   ExecuteStatus JITCompiler::check_interrupts(VMMethod* const vmm, Task* const task,
       MethodContext* const ctx) {
-    task->state->events->poll();
-    return task->state->interrupts.check_events ? cExecuteRestart : cExecuteContinue;
+    // Events are polled by VM::run_and_monitor once we return to it, and
+    // only if something raised check_events.
+    return task->state->interrupts.check ? cExecuteRestart : cExecuteContinue;
+  }
+
+  ExecuteStatus JITCompiler::deoptimize(VMMethod* const vmm, Task* const task,
+      MethodContext* const ctx, int ip) {
+    vmm->deoptimize(task->state, ctx, ip);
+    return cExecuteRestart;
   }
 
   ExecuteStatus JITCompiler::slow_plus_path(VMMethod* const vmm, Task* const task,
@@ -117,8 +126,10 @@ namespace rubinius {
     a.jump_if_equal(fin);
   }
 
-  void JITCompiler::emit_fast_math(AssemblerX86::NearJumpLocation& done, bool add) {
+  void JITCompiler::emit_fast_math(AssemblerX86::NearJumpLocation& done, bool add,
+      AssemblerX86::NearJumpLocation* failed) {
     AssemblerX86::NearJumpLocation slow_path;
+    AssemblerX86::NearJumpLocation& bail = failed ? *failed : slow_path;
 
     // This code is HIGHLY aware that the tag bit for fixnum
     // is a 1 in the low position only.
@@ -134,7 +145,7 @@ namespace rubinius {
 
     // This seems odd, like the condition is backwards, but thats
     // how test works.
-    a.jump_if_equal(slow_path);
+    a.jump_if_equal(bail);
 
     // Ok, they're are both fixnums...
     if(add) {
@@ -142,7 +153,7 @@ namespace rubinius {
       a.add(eax, ecx);
 
       // Check the x86 overflow bit, and if so, run the slow path
-      a.jump_if_overflow(slow_path);
+      a.jump_if_overflow(bail);
 
       // Everything was good, so subtract 1 because the tag adds an
       // extra 1 to the result
@@ -152,7 +163,7 @@ namespace rubinius {
       a.sub(eax, ecx);
 
       // Check the x86 overflow bit, and if so, run the slow path
-      a.jump_if_overflow(slow_path);
+      a.jump_if_overflow(bail);
 
       // Everything was good, so add 1 because the tag subtracts an
       // extra 1 to the result
@@ -167,6 +178,9 @@ namespace rubinius {
 
     a.jump(done);
 
+    // Failed guards are dealt with out of line by emit_guards()
+    if(failed) return;
+
     a.set_label(slow_path);
     uncache_stack();
     if(add) {
@@ -233,8 +247,10 @@ namespace rubinius {
     cache_stack();
   }
 
-  void JITCompiler::emit_fast_compare(AssemblerX86::NearJumpLocation& done, bool less) {
+  void JITCompiler::emit_fast_compare(AssemblerX86::NearJumpLocation& done, bool less,
+      AssemblerX86::NearJumpLocation* failed) {
     AssemblerX86::NearJumpLocation slow_path;
+    AssemblerX86::NearJumpLocation& bail = failed ? *failed : slow_path;
 
     s.load_nth(ecx, 0);
     s.load_nth(edx, 1);
@@ -244,7 +260,7 @@ namespace rubinius {
     a.bit_and(eax, TAG_FIXNUM_MASK);
 
     a.cmp(eax, TAG_FIXNUM);
-    a.jump_if_not_equal(slow_path);
+    a.jump_if_not_equal(bail);
 
     // Ok, both are fixnums
     // no need to strip the tags in this case
@@ -275,6 +291,9 @@ namespace rubinius {
       a.jump(done);
     }
 
+    // Failed guards are dealt with out of line by emit_guards()
+    if(failed) return;
+
     a.set_label(slow_path);
     uncache_stack();
 
@@ -287,7 +306,35 @@ namespace rubinius {
     cache_stack();
   }
 
+  AssemblerX86::NearJumpLocation& JITCompiler::guard(int ip) {
+    guards_.push_back(Guard(ip));
+    return guards_.back().label;
+  }
+
+  void JITCompiler::emit_guards(AssemblerX86::NearJumpLocation& exit) {
+    for(std::list<Guard>::iterator i = guards_.begin(); i != guards_.end(); i++) {
+      a.set_label(i->label);
+
+      deopt_points_[i->ip] = reinterpret_cast<void*>(a.pc());
+      comments_[a.pc()] = "deoptimize";
+
+      // Guards are only taken before the fast path changes the stack,
+      // and with the stack cached.
+      ops.reset_usage();
+      ops.save_stack_pointer();
+      ops.call_via_symbol((void*)JITCompiler::deoptimize, i->ip);
+      a.jump(exit);
+    }
+  }
+
   void JITCompiler::compile(STATE, VMMethod* vmm) {
+    compile(state, vmm, vmm->opcodes);
+  }
+
+  void JITCompiler::compile(STATE, VMMethod* vmm, opcode* opcodes) {
+    // Once a guard has failed in this method, assume the rest could too.
+    speculate_ = vmm->deoptimizations == 0;
+
     // Used for fixups
     uintptr_t* last_imm = NULL;
 
@@ -325,8 +372,27 @@ namespace rubinius {
 
     a.set_label(normal_start);
 
+    // Find the targets of backward jumps. They get entries in
+    // virtual2native so that an interpreted context can switch over to
+    // this code in the middle of a loop (see VMMethod::backedge).
+    for(size_t i = 0; i < vmm->total;) {
+      opcode op = opcodes[i];
+
+      switch(op) {
+      case InstructionSequence::insn_goto:
+      case InstructionSequence::insn_goto_if_false:
+      case InstructionSequence::insn_goto_if_true:
+        if(opcodes[i + 1] <= i) {
+          labels[opcodes[i + 1]].flags() |= cFlagLoopHeader;
+        }
+        break;
+      }
+
+      i += InstructionSequence::instruction_width(op);
+    }
+
     for(size_t i = 0; i < vmm->total;) {
-      opcode op = vmm->opcodes[i];
+      opcode op = opcodes[i];
       size_t width = InstructionSequence::instruction_width(op);
 
       // Set the label location
@@ -358,30 +424,37 @@ namespace rubinius {
         ops.reset_usage();
       }
 
+      if(labels[i].flags() & cFlagLoopHeader) {
+        // Entered directly by on-stack replacement, with only the
+        // prologue run beforehand, so assume nothing about registers.
+        virtual2native[i] = reinterpret_cast<void*>(a.pc());
+        ops.reset_usage();
+      }
+
       switch(op) {
       case InstructionSequence::insn_noop:
         break;
       case InstructionSequence::insn_goto:
-        a.jump(labels[vmm->opcodes[i + 1]]);
+        a.jump(labels[opcodes[i + 1]]);
         break;
       case InstructionSequence::insn_goto_if_false:
         s.load_nth(eax, 0);
         s.pop();
-        ops.jump_if_false(eax, labels[vmm->opcodes[i + 1]]);
+        ops.jump_if_false(eax, labels[opcodes[i + 1]]);
         break;
       case InstructionSequence::insn_goto_if_true:
         s.load_nth(eax, 0);
         s.pop();
-        ops.jump_if_true(eax, labels[vmm->opcodes[i + 1]]);
+        ops.jump_if_true(eax, labels[opcodes[i + 1]]);
         break;
       case InstructionSequence::insn_goto_if_defined:
         s.load_nth(eax, 0);
         s.pop();
         a.cmp(eax, (uintptr_t)Qundef);
-        a.jump_if_not_equal(labels[vmm->opcodes[i + 1]]);
+        a.jump_if_not_equal(labels[opcodes[i + 1]]);
         break;
       case InstructionSequence::insn_setup_unwind:
-        labels[vmm->opcodes[i + 1]].flags() |= cFlagUnwoundTo;
+        labels[opcodes[i + 1]].flags() |= cFlagUnwoundTo;
         goto call_op;
       case InstructionSequence::insn_pop:
         s.pop();
@@ -391,7 +464,7 @@ namespace rubinius {
         s.push(eax);
         break;
       case InstructionSequence::insn_rotate:
-        if(vmm->opcodes[i + 1] != 2) goto call_op;
+        if(opcodes[i + 1] != 2) goto call_op;
         // Fall through and use swap if it's just 2
       case InstructionSequence::insn_swap_stack:
         s.load_nth(eax, 0);
@@ -426,7 +499,7 @@ namespace rubinius {
         s.push((uintptr_t)Fixnum::from(-1));
         break;
       case InstructionSequence::insn_push_int:
-        s.push((uintptr_t)Fixnum::from(vmm->opcodes[i + 1]));
+        s.push((uintptr_t)Fixnum::from(opcodes[i + 1]));
         break;
       case InstructionSequence::insn_push_self:
         ops.load_self(eax);
@@ -436,25 +509,32 @@ namespace rubinius {
       // Now, for a bit more complicated ones...
       //
       case InstructionSequence::insn_push_local:
-        ops.get_local(eax, vmm->opcodes[i + 1]);
+        ops.get_local(eax, opcodes[i + 1]);
         s.push(eax);
         break;
 
       case InstructionSequence::insn_set_local:
         s.load_nth(edx, 0);
-        ops.set_local(edx, vmm->opcodes[i + 1]);
+        ops.set_local(edx, opcodes[i + 1]);
         break;
 
       case InstructionSequence::insn_push_literal:
-        ops.get_literal(eax, vmm->opcodes[i + 1]);
+        ops.get_literal(eax, opcodes[i + 1]);
         s.push(eax);
         break;
 
       case InstructionSequence::insn_meta_send_op_minus:
       case InstructionSequence::insn_meta_send_op_plus: {
         AssemblerX86::NearJumpLocation done;
-        emit_fast_math(done, op == InstructionSequence::insn_meta_send_op_plus);
-        maybe_return(i, &last_imm, fin);
+        if(speculate_) {
+          // Nothing has been popped when the guard fails, so the
+          // interpreter picks up at this instruction.
+          emit_fast_math(done, op == InstructionSequence::insn_meta_send_op_plus,
+              &guard(i));
+        } else {
+          emit_fast_math(done, op == InstructionSequence::insn_meta_send_op_plus);
+          maybe_return(i, &last_imm, fin);
+        }
 
         // This is a phi point, where the fast path and slow path merge.
         // We have to be sure that the stack cache settings are in sync
@@ -477,8 +557,13 @@ namespace rubinius {
       case InstructionSequence::insn_meta_send_op_lt:
       case InstructionSequence::insn_meta_send_op_gt: {
         AssemblerX86::NearJumpLocation done;
-        emit_fast_compare(done, op == InstructionSequence::insn_meta_send_op_lt);
-        maybe_return(i, &last_imm, fin);
+        if(speculate_) {
+          emit_fast_compare(done, op == InstructionSequence::insn_meta_send_op_lt,
+              &guard(i));
+        } else {
+          emit_fast_compare(done, op == InstructionSequence::insn_meta_send_op_lt);
+          maybe_return(i, &last_imm, fin);
+        }
 
         a.set_label(done);
         break;
@@ -488,7 +573,7 @@ namespace rubinius {
         AssemblerX86::NearJumpLocation slow_path;
         AssemblerX86::NearJumpLocation done;
 
-        ops.get_literal(eax, vmm->opcodes[i + 2]);
+        ops.get_literal(eax, opcodes[i + 2]);
         a.cmp(eax, reinterpret_cast<uintptr_t>(Qnil));
         a.jump_if_equal(slow_path);
         a.mov(eax, a.address(eax, FIELD_OFFSET(rubinius::LookupTableAssociation, value_)));
@@ -501,8 +586,8 @@ namespace rubinius {
         uncache_stack();
         const instructions::Implementation* impl = instructions::implementation(op);
         ops.call_operation(impl->address, impl->name,
-            vmm->opcodes[i + 1],
-            vmm->opcodes[i + 2]);
+            opcodes[i + 1],
+            opcodes[i + 2]);
         maybe_return(i, &last_imm, fin);
 
         a.set_label(done);
@@ -510,7 +595,7 @@ namespace rubinius {
       }
 
       case InstructionSequence::insn_set_call_flags:
-        ops.store_call_flags(vmm->opcodes[i + 1]);
+        ops.store_call_flags(opcodes[i + 1]);
         break;
 
         // for any instruction we don't handle with a special code sequence,
@@ -525,12 +610,12 @@ call_op:
           break;
         case 2:
           ops.call_operation(impl->address, impl->name,
-              vmm->opcodes[i + 1]);
+              opcodes[i + 1]);
           break;
         case 3:
           ops.call_operation(impl->address, impl->name,
-              vmm->opcodes[i + 1],
-              vmm->opcodes[i + 2]);
+              opcodes[i + 1],
+              opcodes[i + 2]);
           break;
         default:
           std::cout << "Invalid width '" << width << "' for instruction '" <<
@@ -565,6 +650,8 @@ call_op:
 
     a.set_label(real_fin);
     ops.epilogue();
+
+    emit_guards(real_fin);
   }
 
   /*
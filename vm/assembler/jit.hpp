@@ -1,12 +1,37 @@
+#ifndef RBX_ASSEMBLER_JIT
+#define RBX_ASSEMBLER_JIT
+
+#include "detection.hpp"
+
+#ifdef IS_X8664
+#include "assembler/assembler_x8664.hpp"
+#include "assembler/operations_x8664.hpp"
+#else
 #include "assembler/assembler_x86.hpp"
 #include "assembler/operations.hpp"
+#endif
+
 #include "assembler/code_map.hpp"
 
+#include <list>
+
 namespace rubinius {
   class VMMethod;
   class MachineMethod;
   class VM;
 
+  // The JIT is implemented once per backend (jit.cpp and jit_x8664.cpp),
+  // but they share this interface.
+#ifdef IS_X8664
+  typedef assembler_x8664::AssemblerX8664 JITAssembler;
+  typedef operations_x8664::StackOperations JITStackOperations;
+  typedef operations_x8664::ObjectOperations JITObjectOperations;
+#else
+  typedef assembler_x86::AssemblerX86 JITAssembler;
+  typedef operations::StackOperations JITStackOperations;
+  typedef operations::ObjectOperations JITObjectOperations;
+#endif
+
   class JITCompiler {
   private: // data
     // indicates if ebx contains the current stack top
@@ -15,9 +40,9 @@ namespace rubinius {
     bool own_buffer_;
     uint8_t* buffer_;
 
-    assembler_x86::AssemblerX86 a;
-    operations::StackOperations s;
-    operations::ObjectOperations ops;
+    JITAssembler a;
+    JITStackOperations s;
+    JITObjectOperations ops;
 
     // Contains the mapping between virtual ip and native ip
     CodeMap virtual2native;
@@ -25,15 +50,36 @@ namespace rubinius {
     // Contains comments about addresses
     AddressComments comments_;
 
+    // A check that the fast path assumed would pass. If it fails, the
+    // code at +label+ hands the context back to the interpreter at +ip+.
+    struct Guard {
+      int ip;
+      JITAssembler::NearJumpLocation label;
+
+      Guard(int ip) : ip(ip) { }
+    };
+
+    // A list, since the labels are referenced while more are added
+    std::list<Guard> guards_;
+
+    // Whether fixnum fast paths should guard rather than fall back to a
+    // send. Off for methods that have been deoptimized before.
+    bool speculate_;
+
+    // Contains the mapping between virtual ip and the native code which
+    // deoptimizes there
+    CodeMap deopt_points_;
+
   public:
     const static int cFlagUnwoundTo = (1 << 0);
     const static int cRecordV2N     = (1 << 1);
+    const static int cFlagLoopHeader = (1 << 2);
 
     JITCompiler();
     JITCompiler(uint8_t* buffer);
     ~JITCompiler();
 
-    assembler_x86::AssemblerX86& assembler() {
+    JITAssembler& assembler() {
       return a;
     }
 
@@ -45,15 +91,28 @@ namespace rubinius {
       return comments_;
     }
 
+    CodeMap& deopt_points() {
+      return deopt_points_;
+    }
+
     void compile(VM*, VMMethod*);
+
+    // Compile from +opcodes+ rather than vmm->opcodes. The background
+    // compiler passes a private copy, since specialization and
+    // breakpoints rewrite vmm->opcodes while it works.
+    void compile(VM*, VMMethod*, opcode* opcodes);
     void show();
 
     void** create_interpreter(VM*);
 
-    void emit_fast_math(assembler_x86::AssemblerX86::NearJumpLocation& done, bool add);
-    void emit_fast_equal(assembler_x86::AssemblerX86::NearJumpLocation& done, bool equal);
-    void emit_fast_compare(assembler_x86::AssemblerX86::NearJumpLocation& done, bool less);
-    void emit_opcode(opcode op, assembler_x86::AssemblerX86::NearJumpLocation& fin);
+    // If +failed+ is given, non-fixnum operands or an overflow jump
+    // there rather than to a send of the operator.
+    void emit_fast_math(JITAssembler::NearJumpLocation& done, bool add,
+        JITAssembler::NearJumpLocation* failed = NULL);
+    void emit_fast_equal(JITAssembler::NearJumpLocation& done, bool equal);
+    void emit_fast_compare(JITAssembler::NearJumpLocation& done, bool less,
+        JITAssembler::NearJumpLocation* failed = NULL);
+    void emit_opcode(opcode op, JITAssembler::NearJumpLocation& fin);
 
     static ExecuteStatus slow_plus_path(VMMethod* const vmm, Task* const task,
         MethodContext* const ctx);
@@ -76,17 +135,29 @@ namespace rubinius {
     static ExecuteStatus check_interrupts(VMMethod* const vmm, Task* const task,
       MethodContext* const ctx);
 
+    static ExecuteStatus deoptimize(VMMethod* const vmm, Task* const task,
+      MethodContext* const ctx, int ip);
+
   private:
 
-    // Emit code to check %eax and determine if a new context was
-    // installed.
-    void maybe_return(int i, uintptr_t **last_imm, assembler_x86::AssemblerX86::NearJumpLocation& fin);
+    // Emit code to check the operation's return value and determine if
+    // a new context was installed.
+    void maybe_return(int i, uintptr_t **last_imm, JITAssembler::NearJumpLocation& fin);
 
-    // Pull the stack pointer into ebx if it's not there already
+    // Pull the stack pointer into ebx/rbx if it's not there already
     void cache_stack(bool force = false);
 
-    // Save ebx back into the MethodContext if it's currently cached
+    // Save ebx/rbx back into the MethodContext if it's currently cached
     void uncache_stack(bool force = false);
+
+    // Returns a new guard label for the instruction at +ip+
+    JITAssembler::NearJumpLocation& guard(int ip);
+
+    // Emit the code for each guard, which deoptimizes and then jumps
+    // to +exit+.
+    void emit_guards(JITAssembler::NearJumpLocation& exit);
   };
 
 }
+
+#endif
@@ -0,0 +1,948 @@
+#include "assembler/assembler_x8664.hpp"
+#include "oop.hpp"
+#include "jit_state.h"
+#include "operations_x8664.hpp"
+#include "instructions.hpp"
+#include "vmmethod.hpp"
+
+#include "builtin/iseq.hpp"
+#include "builtin/contexts.hpp"
+#include "builtin/fixnum.hpp"
+#include "builtin/lookuptable.hpp"
+
+#include "instructions.hpp"
+#include "assembler/jit.hpp"
+#include "event.hpp"
+
+using namespace assembler;
+using namespace assembler_x8664;
+using namespace operations_x8664;
+using namespace rubinius;
+
+extern "C" {
+  ExecuteStatus send_slowly(VMMethod* vmm, Task* task, MethodContext* const ctx, Symbol* name, size_t args);
+}
+
+namespace rubinius {
+  JITCompiler::JITCompiler()
+    : stack_cached_(false)
+    , own_buffer_(true)
+    , buffer_(new uint8_t[1024*1024])
+    , a(buffer_)
+    , s(a, rbx)
+    , ops(s)
+    , speculate_(false) { }
+
+  JITCompiler::JITCompiler(uint8_t* buf)
+    : stack_cached_(false)
+    , own_buffer_(false)
+    , buffer_(buf)
+    , a(buffer_)
+    , s(a, rbx)
+    , ops(s)
+    , speculate_(false) { }
+
+  JITCompiler::~JITCompiler() {
+    if(own_buffer_) {
+      memset(buffer_, 0, 1024*1024);
+      delete[] buffer_;
+    }
+  }
+
+  void JITCompiler::cache_stack(bool force) {
+    if(!force && stack_cached_) return;
+    stack_cached_ = true;
+    ops.load_stack_pointer();
+  }
+
+  void JITCompiler::uncache_stack(bool force) {
+    if(!force && !stack_cached_) return;
+    stack_cached_ = false;
+    ops.save_stack_pointer();
+  }
+
+  ExecuteStatus JITCompiler::check_interrupts(VMMethod* const vmm, Task* const task,
+      MethodContext* const ctx) {
+    // Events are polled by VM::run_and_monitor once we return to it, and
+    // only if something raised check_events.
+    return task->state->interrupts.check ? cExecuteRestart : cExecuteContinue;
+  }
+
+  ExecuteStatus JITCompiler::deoptimize(VMMethod* const vmm, Task* const task,
+      MethodContext* const ctx, int ip) {
+    vmm->deoptimize(task->state, ctx, ip);
+    return cExecuteRestart;
+  }
+
+  ExecuteStatus JITCompiler::slow_plus_path(VMMethod* const vmm, Task* const task,
+      MethodContext* const ctx) {
+    return send_slowly(vmm, task, ctx, task->state->globals.sym_plus.get(), 1);
+  }
+
+  ExecuteStatus JITCompiler::slow_minus_path(VMMethod* const vmm, Task* const task,
+      MethodContext* const ctx) {
+    return send_slowly(vmm, task, ctx, task->state->globals.sym_minus.get(), 1);
+  }
+
+  ExecuteStatus JITCompiler::slow_equal_path(VMMethod* const vmm, Task* const task,
+      MethodContext* const ctx) {
+    return send_slowly(vmm, task, ctx, task->state->globals.sym_equal.get(), 1);
+  }
+
+  ExecuteStatus JITCompiler::slow_nequal_path(VMMethod* const vmm, Task* const task,
+      MethodContext* const ctx) {
+    return send_slowly(vmm, task, ctx, task->state->globals.sym_nequal.get(), 1);
+  }
+
+  ExecuteStatus JITCompiler::slow_lt_path(VMMethod* const vmm, Task* const task,
+      MethodContext* const ctx) {
+    return send_slowly(vmm, task, ctx, task->state->globals.sym_lt.get(), 1);
+  }
+
+  ExecuteStatus JITCompiler::slow_gt_path(VMMethod* const vmm, Task* const task,
+      MethodContext* const ctx) {
+    return send_slowly(vmm, task, ctx, task->state->globals.sym_gt.get(), 1);
+  }
+
+  void JITCompiler::maybe_return(int i, uintptr_t **last_imm, AssemblerX8664::NearJumpLocation &fin) {
+
+    // after every call instruction that's passed the ctx
+    cache_stack();
+
+    // RDX will contain the native ip, to be stored
+    // back into the MethodContext in the epilogue.
+    a.mov_delayed(rdx, last_imm);
+
+    // ECX will contain the virtual ip, which is stored
+    // back into the MethodContext in the epilogue
+    // The + 1 is to match the interpreter, where the ip points
+    // to the next instruction rather than the current one
+    a.mov32(rcx, i + 1);
+
+    // If the return value of the operation (located in eax),
+    // is cExecuteRestart, then jump to the epilogue, which
+    // stores ecx as the virtual ip and returns.
+    ops.check_restart(fin);
+  }
+
+  void JITCompiler::emit_fast_math(AssemblerX8664::NearJumpLocation& done, bool add,
+      AssemblerX8664::NearJumpLocation* failed) {
+    AssemblerX8664::NearJumpLocation slow_path;
+    AssemblerX8664::NearJumpLocation& bail = failed ? *failed : slow_path;
+
+    // This code is HIGHLY aware that the tag bit for fixnum
+    // is a 1 in the low position only.
+
+    // Pull in the top 2 entries on the stack into registers
+    s.load_nth(rcx, 0);
+    s.load_nth(rax, 1);
+
+    // Perform the bit and to find out if they're both fixnums
+    a.mov(rdx, rax);
+    a.bit_and(rdx, rcx);
+    a.test(rdx, TAG_FIXNUM);
+
+    // This seems odd, like the condition is backwards, but thats
+    // how test works.
+    a.jump_if_equal(bail);
+
+    // Ok, they're are both fixnums...
+    if(add) {
+      // And add them together directly
+      a.add(rax, rcx);
+
+      // Check the x86 overflow bit, and if so, run the slow path
+      a.jump_if_overflow(bail);
+
+      // Everything was good, so subtract 1 because the tag adds an
+      // extra 1 to the result
+      a.sub(rax, 1);
+    } else {
+      // And subtract them together directly
+      a.sub(rax, rcx);
+
+      // Check the x86 overflow bit, and if so, run the slow path
+      a.jump_if_overflow(bail);
+
+      // Everything was good, so add 1 because the tag subtracts an
+      // extra 1 to the result
+      a.add(rax, 1);
+    }
+
+    // Remove one from the stack
+    s.pop();
+
+    // Put the result on the stack
+    s.set_top(rax);
+
+    a.jump(done);
+
+    // Failed guards are dealt with out of line by emit_guards()
+    if(failed) return;
+
+    a.set_label(slow_path);
+    uncache_stack();
+    if(add) {
+      ops.call_via_symbol((void*)JITCompiler::slow_plus_path);
+    } else {
+      ops.call_via_symbol((void*)JITCompiler::slow_minus_path);
+    }
+    cache_stack();
+  }
+
+  void JITCompiler::emit_fast_equal(AssemblerX8664::NearJumpLocation& done, bool equal) {
+    AssemblerX8664::NearJumpLocation equal_path;
+    AssemblerX8664::NearJumpLocation slow_path;
+
+    s.load_nth(rcx, 0);
+    s.load_nth(rdx, 1);
+
+    a.mov(rax, rcx);
+    a.bit_and(rax, TAG_REF_MASK);
+
+    a.cmp(rax, TAG_REF);
+    a.jump_if_equal(slow_path);
+
+    a.mov(rax, rdx);
+    a.bit_and(rax, TAG_REF_MASK);
+
+    a.cmp(rax, TAG_REF);
+    a.jump_if_equal(slow_path);
+
+    // An immediate Float can be == to a Fixnum, so let Float#== decide
+    a.mov(rax, rcx);
+    a.bit_and(rax, TAG_FLONUM_MASK);
+
+    a.cmp(rax, TAG_FLONUM);
+    a.jump_if_equal(slow_path);
+
+    a.mov(rax, rdx);
+    a.bit_and(rax, TAG_FLONUM_MASK);
+
+    a.cmp(rax, TAG_FLONUM);
+    a.jump_if_equal(slow_path);
+
+    // Ok, both are not references
+
+    s.pop();
+
+    a.cmp(rcx, rdx);
+    a.jump_if_equal(equal_path);
+
+    if(equal) {
+      s.set_top(cFalse);
+      a.jump(done);
+
+      a.set_label(equal_path);
+
+      s.set_top(cTrue);
+      a.jump(done);
+    } else {
+      s.set_top(cTrue);
+      a.jump(done);
+
+      a.set_label(equal_path);
+
+      s.set_top(cFalse);
+      a.jump(done);
+    }
+
+    a.set_label(slow_path);
+    uncache_stack();
+
+    if(equal) {
+      ops.call_via_symbol((void*)JITCompiler::slow_equal_path);
+    } else {
+      ops.call_via_symbol((void*)JITCompiler::slow_nequal_path);
+    }
+
+    cache_stack();
+  }
+
+  void JITCompiler::emit_fast_compare(AssemblerX8664::NearJumpLocation& done, bool less,
+      AssemblerX8664::NearJumpLocation* failed) {
+    AssemblerX8664::NearJumpLocation slow_path;
+    AssemblerX8664::NearJumpLocation& bail = failed ? *failed : slow_path;
+
+    s.load_nth(rcx, 0);
+    s.load_nth(rdx, 1);
+
+    a.mov(rax, rcx);
+    a.bit_and(rax, rdx);
+    a.bit_and(rax, TAG_FIXNUM_MASK);
+
+    a.cmp(rax, TAG_FIXNUM);
+    a.jump_if_not_equal(bail);
+
+    // Ok, both are fixnums
+    // no need to strip the tags in this case
+    // stack top is rhs operand
+
+    s.pop();
+    a.cmp(rdx, rcx);
+
+    if(less) {
+      AssemblerX8664::NearJumpLocation less_path;
+
+      a.jump_if_less(less_path);
+      s.set_top(cFalse);
+      a.jump(done);
+
+      a.set_label(less_path);
+      s.set_top(cTrue);
+      a.jump(done);
+    } else {
+      AssemblerX8664::NearJumpLocation greater_path;
+
+      a.jump_if_greater(greater_path);
+      s.set_top(cFalse);
+      a.jump(done);
+
+      a.set_label(greater_path);
+      s.set_top(cTrue);
+      a.jump(done);
+    }
+
+    // Failed guards are dealt with out of line by emit_guards()
+    if(failed) return;
+
+    a.set_label(slow_path);
+    uncache_stack();
+
+    if(less) {
+      ops.call_via_symbol((void*)JITCompiler::slow_lt_path);
+    } else {
+      ops.call_via_symbol((void*)JITCompiler::slow_gt_path);
+    }
+
+    cache_stack();
+  }
+
+  AssemblerX8664::NearJumpLocation& JITCompiler::guard(int ip) {
+    guards_.push_back(Guard(ip));
+    return guards_.back().label;
+  }
+
+  void JITCompiler::emit_guards(AssemblerX8664::NearJumpLocation& exit) {
+    for(std::list<Guard>::iterator i = guards_.begin(); i != guards_.end(); i++) {
+      a.set_label(i->label);
+
+      deopt_points_[i->ip] = reinterpret_cast<void*>(a.pc());
+      comments_[a.pc()] = "deoptimize";
+
+      // Guards are only taken before the fast path changes the stack,
+      // and with the stack cached.
+      ops.reset_usage();
+      ops.save_stack_pointer();
+      ops.call_via_symbol((void*)JITCompiler::deoptimize, i->ip);
+      a.jump(exit);
+    }
+  }
+
+  void JITCompiler::compile(STATE, VMMethod* vmm) {
+    compile(state, vmm, vmm->opcodes);
+  }
+
+  void JITCompiler::compile(STATE, VMMethod* vmm, opcode* opcodes) {
+    // Once a guard has failed in this method, assume the rest could too.
+    speculate_ = vmm->deoptimizations == 0;
+
+    // Used for fixups
+    uintptr_t* last_imm = NULL;
+
+    // A label pointing to the code for each virtual ip
+    std::vector<AssemblerX8664::NearJumpLocation> labels(vmm->total);
+
+    // The location of the instructions that save ip into the current
+    // MethodContext then clear the stack and return
+    AssemblerX8664::NearJumpLocation fin;
+
+    // The location of just the instructions that clear the stack and return
+    AssemblerX8664::NearJumpLocation real_fin;
+
+    comments_[a.pc()] = "prologue";
+
+    ops.prologue();
+    cache_stack();
+
+    // Pull native_ip out of the method_context and jump to it if
+    // it's not 0.
+    //
+    // NOTE we don't pull the stack pointer out into rbx by default,
+    // which means that any code that is jumped to has to assume it
+    // needs to pull it out manually. This is currently not a problem
+    // because our jump destinations are always right after calls
+    // out to implementions and thus have uncached rbx.
+    AssemblerX8664::NearJumpLocation normal_start;
+
+    comments_[a.pc()] = "method reentry";
+
+    ops.load_native_ip(rax);
+    a.cmp(rax, 0);
+    a.jump_if_equal(normal_start);
+    a.jump(rax);
+
+    a.set_label(normal_start);
+
+    // Find the targets of backward jumps. They get entries in
+    // virtual2native so that an interpreted context can switch over to
+    // this code in the middle of a loop (see VMMethod::backedge).
+    for(size_t i = 0; i < vmm->total;) {
+      opcode op = opcodes[i];
+
+      switch(op) {
+      case InstructionSequence::insn_goto:
+      case InstructionSequence::insn_goto_if_false:
+      case InstructionSequence::insn_goto_if_true:
+        if(opcodes[i + 1] <= i) {
+          labels[opcodes[i + 1]].flags() |= cFlagLoopHeader;
+        }
+        break;
+      }
+
+      i += InstructionSequence::instruction_width(op);
+    }
+
+    for(size_t i = 0; i < vmm->total;) {
+      opcode op = opcodes[i];
+      size_t width = InstructionSequence::instruction_width(op);
+
+      // Set the label location
+      a.set_label(labels[i]);
+
+      comments_[a.pc()] = InstructionSequence::get_instruction_name(op);
+
+      // If we registers an immediate to be update, do it now.
+      // mov_delayed always leaves room for a full 64 bit address.
+      if(last_imm) {
+
+        *last_imm = (uintptr_t)a.pc();
+        Relocation* rel = new Relocation(Relocation::LocalAbsolute,
+            last_imm, a.pc(), 0);
+        a.add_relocation(last_imm, rel);
+
+        last_imm = NULL;
+        // Because this is now a jump destination, reset the register
+        // usage since we don't know the state off things when we're
+        // jumped here.
+        ops.reset_usage();
+      } else if(labels[i].flags() & cFlagUnwoundTo) {
+        // Update our table of virtual ip to native ip
+        virtual2native[i] = reinterpret_cast<void*>(a.pc());
+
+        labels[i].flags() |= cRecordV2N;
+        // This is a jump destination for exceptions, reset
+        // things and register it.
+        ops.reset_usage();
+      }
+
+      if(labels[i].flags() & cFlagLoopHeader) {
+        // Entered directly by on-stack replacement, with only the
+        // prologue run beforehand, so assume nothing about registers.
+        virtual2native[i] = reinterpret_cast<void*>(a.pc());
+        ops.reset_usage();
+      }
+
+      switch(op) {
+      case InstructionSequence::insn_noop:
+        break;
+      case InstructionSequence::insn_goto:
+        a.jump(labels[opcodes[i + 1]]);
+        break;
+      case InstructionSequence::insn_goto_if_false:
+        s.load_nth(rax, 0);
+        s.pop();
+        ops.jump_if_false(rax, labels[opcodes[i + 1]]);
+        break;
+      case InstructionSequence::insn_goto_if_true:
+        s.load_nth(rax, 0);
+        s.pop();
+        ops.jump_if_true(rax, labels[opcodes[i + 1]]);
+        break;
+      case InstructionSequence::insn_goto_if_defined:
+        s.load_nth(rax, 0);
+        s.pop();
+        a.cmp(rax, (uintptr_t)Qundef);
+        a.jump_if_not_equal(labels[opcodes[i + 1]]);
+        break;
+      case InstructionSequence::insn_setup_unwind:
+        labels[opcodes[i + 1]].flags() |= cFlagUnwoundTo;
+        goto call_op;
+      case InstructionSequence::insn_pop:
+        s.pop();
+        break;
+      case InstructionSequence::insn_dup_top:
+        s.load_nth(rax, 0);
+        s.push(rax);
+        break;
+      case InstructionSequence::insn_rotate:
+        if(opcodes[i + 1] != 2) goto call_op;
+        // Fall through and use swap if it's just 2
+      case InstructionSequence::insn_swap_stack:
+        s.load_nth(rax, 0);
+        s.load_nth(rcx, 1);
+        a.mov(s.position(1), rax);
+        s.set_top(rcx);
+        break;
+      case InstructionSequence::insn_halt:
+        a.mov_imm32(rdx, -1);
+        a.mov32(rcx, static_cast<uint32_t>(-1));
+        a.jump(fin);
+        break;
+      case InstructionSequence::insn_push_true:
+        s.push((uintptr_t)Qtrue);
+        break;
+      case InstructionSequence::insn_push_false:
+        s.push((uintptr_t)Qfalse);
+        break;
+      case InstructionSequence::insn_push_nil:
+        s.push((uintptr_t)Qnil);
+        break;
+      case InstructionSequence::insn_meta_push_0:
+        s.push((uintptr_t)Fixnum::from(0));
+        break;
+      case InstructionSequence::insn_meta_push_1:
+        s.push((uintptr_t)Fixnum::from(1));
+        break;
+      case InstructionSequence::insn_meta_push_2:
+        s.push((uintptr_t)Fixnum::from(2));
+        break;
+      case InstructionSequence::insn_meta_push_neg_1:
+        s.push((uintptr_t)Fixnum::from(-1));
+        break;
+      case InstructionSequence::insn_push_int:
+        s.push((uintptr_t)Fixnum::from(static_cast<int>(opcodes[i + 1])));
+        break;
+      case InstructionSequence::insn_push_self:
+        ops.load_self(rax);
+        s.push(rax);
+        break;
+
+      // Now, for a bit more complicated ones...
+      //
+      case InstructionSequence::insn_push_local:
+        ops.get_local(rax, opcodes[i + 1]);
+        s.push(rax);
+        break;
+
+      case InstructionSequence::insn_set_local:
+        s.load_nth(rdx, 0);
+        ops.set_local(rdx, opcodes[i + 1]);
+        break;
+
+      case InstructionSequence::insn_push_literal:
+        ops.get_literal(rax, opcodes[i + 1]);
+        s.push(rax);
+        break;
+
+      case InstructionSequence::insn_meta_send_op_minus:
+      case InstructionSequence::insn_meta_send_op_plus: {
+        AssemblerX8664::NearJumpLocation done;
+        if(speculate_) {
+          // Nothing has been popped when the guard fails, so the
+          // interpreter picks up at this instruction.
+          emit_fast_math(done, op == InstructionSequence::insn_meta_send_op_plus,
+              &guard(i));
+        } else {
+          emit_fast_math(done, op == InstructionSequence::insn_meta_send_op_plus);
+          maybe_return(i, &last_imm, fin);
+        }
+
+        // This is a phi point, where the fast path and slow path merge.
+        // We have to be sure that the stack cache settings are in sync
+        // for both paths taken at this point. To be sure of that, we
+        // always run cache_stack() after calling slow_path_plus.
+        a.set_label(done);
+        break;
+      }
+
+      case InstructionSequence::insn_meta_send_op_equal:
+      case InstructionSequence::insn_meta_send_op_nequal: {
+        AssemblerX8664::NearJumpLocation done;
+        emit_fast_equal(done, op == InstructionSequence::insn_meta_send_op_equal);
+        maybe_return(i, &last_imm, fin);
+
+        a.set_label(done);
+        break;
+      }
+
+      case InstructionSequence::insn_meta_send_op_lt:
+      case InstructionSequence::insn_meta_send_op_gt: {
+        AssemblerX8664::NearJumpLocation done;
+        if(speculate_) {
+          emit_fast_compare(done, op == InstructionSequence::insn_meta_send_op_lt,
+              &guard(i));
+        } else {
+          emit_fast_compare(done, op == InstructionSequence::insn_meta_send_op_lt);
+          maybe_return(i, &last_imm, fin);
+        }
+
+        a.set_label(done);
+        break;
+      }
+
+      case InstructionSequence::insn_push_const_fast: {
+        AssemblerX8664::NearJumpLocation slow_path;
+        AssemblerX8664::NearJumpLocation done;
+
+        ops.get_literal(rax, opcodes[i + 2]);
+        a.cmp(rax, reinterpret_cast<uintptr_t>(Qnil));
+        a.jump_if_equal(slow_path);
+        a.mov(rax, a.address(rax, FIELD_OFFSET(rubinius::LookupTableAssociation, value_)));
+        // TODO this doesn't support autoload!
+        s.push(rax);
+
+        a.jump(done);
+
+        a.set_label(slow_path);
+        uncache_stack();
+        const instructions::Implementation* impl = instructions::implementation(op);
+        ops.call_operation(impl->address, impl->name,
+            opcodes[i + 1],
+            opcodes[i + 2]);
+        maybe_return(i, &last_imm, fin);
+
+        a.set_label(done);
+        break;
+      }
+
+      case InstructionSequence::insn_set_call_flags:
+        ops.store_call_flags(opcodes[i + 1]);
+        break;
+
+        // for any instruction we don't handle with a special code sequence,
+        // just call the regular function for it.
+      default: {
+call_op:
+        uncache_stack();
+        const instructions::Implementation* impl = instructions::implementation(op);
+        switch(width) {
+        case 1:
+          ops.call_operation(impl->address, impl->name);
+          break;
+        case 2:
+          ops.call_operation(impl->address, impl->name,
+              opcodes[i + 1]);
+          break;
+        case 3:
+          ops.call_operation(impl->address, impl->name,
+              opcodes[i + 1],
+              opcodes[i + 2]);
+          break;
+        default:
+          std::cout << "Invalid width '" << width << "' for instruction '" <<
+            op << "'\n";
+          abort();
+        }
+
+        instructions::Status status = instructions::check_status(op);
+        if(status == instructions::MightReturn) {
+          maybe_return(i, &last_imm, fin);
+        } else if(status == instructions::Terminate) {
+          a.jump(real_fin);
+          cache_stack();
+        } else {
+          cache_stack();
+        }
+        break;
+      }
+      }
+
+      i += width;
+    }
+
+    comments_[a.pc()] = "epilogue";
+
+    a.set_label(fin);
+
+    // We could be jumping here from anywhere, assume nothing.
+    ops.reset_usage();
+    ops.store_ip(rcx, rdx);
+    uncache_stack();
+
+    a.set_label(real_fin);
+    ops.epilogue();
+
+    emit_guards(real_fin);
+  }
+
+  /*
+  static void show_info(VMMethod* const vmm, Task* const task,
+                        MethodContext* const ctx, void* rbx) {
+    std::cout << (void*)ctx << " " <<
+      InstructionSequence::get_instruction_name(vmm->opcodes[ctx->ip - 1]) <<
+      " @ " << ctx->ip - 1 <<
+      " stack=" << rbx << "/" << ctx->js.stack << "/" << ctx->stk <<
+      "\n";
+  }
+
+  static void show_info2(VMMethod* const vmm, Task* const task,
+                        MethodContext* const ctx, void* rbx) {
+    std::cout << "     " <<
+      InstructionSequence::get_instruction_name(vmm->opcodes[ctx->ip - 1]) <<
+      " @ " << ctx->ip - 1 <<
+      " stack=" << rbx <<
+      "\n";
+  }
+  */
+
+  void JITCompiler::emit_opcode(opcode op, AssemblerX8664::NearJumpLocation& fin) {
+    switch(op) {
+    case InstructionSequence::insn_noop:
+      break;
+    case InstructionSequence::insn_goto:
+      ops.load_next_opcode(rax);
+      ops.store_virtual_ip(rax);
+      break;
+    case InstructionSequence::insn_goto_if_false: {
+      ops.load_and_increment_ip(rdx);
+      s.load_nth(rax, 0);
+      s.pop();
+
+      AssemblerX8664::NearJumpLocation set, done;
+
+      ops.jump_if_false(rax, set);
+      a.jump(done);
+
+      a.set_label(set);
+      ops.load_opcode(rax, r15, rdx);
+      ops.store_virtual_ip(rax);
+
+      a.set_label(done);
+      break;
+    }
+    case InstructionSequence::insn_goto_if_true: {
+      ops.load_and_increment_ip(rdx);
+      s.load_nth(rax, 0);
+      s.pop();
+
+      AssemblerX8664::NearJumpLocation set, done;
+
+      ops.jump_if_true(rax, set);
+      a.jump(done);
+
+      a.set_label(set);
+      ops.load_opcode(rax, r15, rdx);
+      ops.store_virtual_ip(rax);
+
+      a.set_label(done);
+      break;
+    }
+    case InstructionSequence::insn_goto_if_defined: {
+      ops.load_and_increment_ip(rdx);
+      s.load_nth(rax, 0);
+      s.pop();
+
+      AssemblerX8664::NearJumpLocation set, done;
+
+      a.cmp(rax, (uintptr_t)Qundef);
+      a.jump_if_not_equal(set);
+      a.jump(done);
+
+      a.set_label(set);
+      ops.load_opcode(rax, r15, rdx);
+      ops.store_virtual_ip(rax);
+
+      a.set_label(done);
+      break;
+    }
+    case InstructionSequence::insn_pop:
+      s.pop();
+      break;
+    case InstructionSequence::insn_dup_top:
+      s.load_nth(rax, 0);
+      s.push(rax);
+      break;
+    case InstructionSequence::insn_swap_stack:
+      s.load_nth(rax, 0);
+      s.load_nth(rcx, 1);
+      a.mov(s.position(1), rax);
+      s.set_top(rcx);
+      break;
+    case InstructionSequence::insn_halt:
+      a.mov32(rcx, static_cast<uint32_t>(-1));
+      ops.store_virtual_ip(rcx);
+      a.jump(fin);
+      break;
+    case InstructionSequence::insn_push_true:
+      s.push((uintptr_t)Qtrue);
+      break;
+    case InstructionSequence::insn_push_false:
+      s.push((uintptr_t)Qfalse);
+      break;
+    case InstructionSequence::insn_push_nil:
+      s.push((uintptr_t)Qnil);
+      break;
+    case InstructionSequence::insn_meta_push_0:
+      s.push((uintptr_t)Fixnum::from(0));
+      break;
+    case InstructionSequence::insn_meta_push_1:
+      s.push((uintptr_t)Fixnum::from(1));
+      break;
+    case InstructionSequence::insn_meta_push_2:
+      s.push((uintptr_t)Fixnum::from(2));
+      break;
+    case InstructionSequence::insn_meta_push_neg_1:
+      s.push((uintptr_t)Fixnum::from(-1));
+      break;
+    case InstructionSequence::insn_push_int:
+      ops.load_next_opcode(rax);
+      // The operand is an int, like in the interpreter
+      a.movsxd(rax, rax);
+      ops.tag_fixnum(rax);
+      s.push(rax);
+      break;
+    case InstructionSequence::insn_push_self:
+      ops.load_self(rax);
+      s.push(rax);
+      break;
+    case InstructionSequence::insn_push_local:
+      ops.load_next_opcode(rcx);
+      ops.get_local(rax, rcx);        // rax == local
+      s.push(rax);
+      break;
+    case InstructionSequence::insn_set_local:
+      ops.load_next_opcode(rcx);
+      s.load_nth(rdx, 0);
+      ops.set_local(rdx, rcx);
+      break;
+    case InstructionSequence::insn_push_literal:
+      ops.load_next_opcode(rcx);
+      ops.get_literal(rax, rcx);
+      s.push(rax);
+      break;
+    case InstructionSequence::insn_meta_send_op_minus:
+    case InstructionSequence::insn_meta_send_op_plus: {
+      AssemblerX8664::NearJumpLocation done;
+      emit_fast_math(done, op == InstructionSequence::insn_meta_send_op_plus);
+
+      // If the return value of the operation (located in eax),
+      // is cExecuteRestart, then jump to the epilogue, which
+      // stores ecx as the virtual ip and returns.
+      ops.check_restart(fin);
+
+      // This is a phi point, where the fast path and slow path merge.
+      // We have to be sure that the stack cache settings are in sync
+      // for both paths taken at this point. To be sure of that, we
+      // always run cache_stack() after calling slow_path_plus.
+      a.set_label(done);
+      break;
+    }
+
+    case InstructionSequence::insn_meta_send_op_equal:
+    case InstructionSequence::insn_meta_send_op_nequal: {
+      AssemblerX8664::NearJumpLocation done;
+      emit_fast_equal(done, op == InstructionSequence::insn_meta_send_op_equal);
+
+      // If the return value of the operation (located in eax),
+      // is cExecuteRestart, then jump to the epilogue, which
+      // stores ecx as the virtual ip and returns.
+      ops.check_restart(fin);
+
+      a.set_label(done);
+      break;
+    }
+
+
+    case InstructionSequence::insn_meta_send_op_lt:
+    case InstructionSequence::insn_meta_send_op_gt: {
+      AssemblerX8664::NearJumpLocation done;
+      emit_fast_compare(done, op == InstructionSequence::insn_meta_send_op_lt);
+      ops.check_restart(fin);
+
+      a.set_label(done);
+      break;
+    }
+
+    case InstructionSequence::insn_set_call_flags:
+      ops.load_next_opcode(rcx);
+      ops.store_call_flags(rcx);
+      break;
+
+    default: {
+      uncache_stack();
+      // ops.call_operation(reinterpret_cast<void*>(show_info), "show_info", rbx);
+
+      size_t width = InstructionSequence::instruction_width(op);
+      const instructions::Implementation* impl = instructions::implementation(op);
+      switch(width) {
+      case 1:
+        ops.call_operation(impl->address, impl->name);
+        break;
+      case 2:
+        ops.load_next_opcode(rax);
+        ops.call_operation(impl->address, impl->name, rax);
+        break;
+      case 3:
+        ops.load_next_opcode(rax);
+        ops.load_next_opcode(rcx);
+        ops.call_operation(impl->address, impl->name, rax, rcx);
+        break;
+      default:
+        std::cout << "Invalid width '" << width << "' for instruction '" <<
+          op << "'\n";
+        abort();
+      }
+
+      cache_stack();
+
+      instructions::Status status = instructions::check_status(op);
+      if(status == instructions::MightReturn) {
+        ops.check_restart(fin);
+      } else if(status == instructions::Terminate) {
+        a.jump(fin);
+      }
+      break;
+    }
+    }
+  }
+
+  // Generate a function to interprete the bytecode of a method.
+  // Fixed registers:
+  //   rbx: the stack top. Sync'd with the context when needed
+  //   r15: the opcodes array. Pulled out at the top only.
+  //   r12, r13, r14: the VMMethod, Task and MethodContext arguments.
+  //
+  // Scratch registers:
+  //   rax, rcx, rdx, r10, plus the argument registers
+  //
+  void** JITCompiler::create_interpreter(STATE) {
+    // A label for each operation
+    std::vector<AssemblerX8664::NearJumpLocation> labels(InstructionSequence::cTotal);
+
+    // The lookup table to use
+    void** table = new void*[InstructionSequence::cTotal];
+
+    AssemblerX8664::NearJumpLocation fin;
+
+    ops.prologue();
+    cache_stack();
+    ops.load_opcodes(r15);
+    ops.load_and_increment_ip(rax);
+    ops.load_opcode(rax, r15, rax);
+    a.jump_via_table(table, rax);
+
+    for(opcode i = 0; i < InstructionSequence::cTotal; i++) {
+      a.set_label(labels[i]);
+
+      // ops.call_operation(reinterpret_cast<void*>(show_info2), "show_info2", rbx);
+
+      emit_opcode(i, fin);
+      ops.load_and_increment_ip(rax);
+      ops.load_opcode(rax, r15, rax);
+      a.jump_via_table(table, rax);
+    }
+
+    ops.reset_usage();
+    a.set_label(fin);
+    uncache_stack();
+    ops.epilogue();
+
+    // Fill out table now
+    for(opcode i = 0; i < InstructionSequence::cTotal; i++) {
+      table[i] = labels[i].destination();
+    }
+
+    return table;
+  }
+}
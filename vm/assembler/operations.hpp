@@ -151,8 +151,8 @@ namespace operations {
       s.assembler().epilogue();
     }
 
-    // Attempts to call +func+ as a symbol.
-    void call_via_symbol(void* func) {
+    // Returns the name +func+ is exported as, so it can be relocated.
+    const char* symbol_name(void* func) {
       Dl_info info;
       if(!dladdr(func, &info)) {
         throw std::runtime_error("Unable to find symbol");
@@ -162,7 +162,16 @@ namespace operations {
         throw std::runtime_error("Unable to resolve symbol properly");
       }
 
-      s.assembler().call(func, info.dli_sname);
+      return info.dli_sname;
+    }
+
+    // Attempts to call +func+ as a symbol.
+    void call_via_symbol(void* func) {
+      s.assembler().call(func, symbol_name(func));
+    }
+
+    void call_via_symbol(void* func, int arg) {
+      call_operation(func, symbol_name(func), arg);
     }
 
     void call_operation(void* func, const char* name) {
@@ -0,0 +1,381 @@
+#ifndef RBX_ASM_OPERATIONS_X8664
+#define RBX_ASM_OPERATIONS_X8664
+
+#include "assembler_x8664.hpp"
+#include "oop.hpp"
+#include "jit_state.h"
+#include "builtin/contexts.hpp"
+#include "builtin/task.hpp"
+#include "builtin/tuple.hpp"
+
+#include <stdexcept>
+
+// The x86-64 flavor of operations.hpp. Rather than reloading the
+// arguments from the stack like the 32 bit version, the incoming
+// arguments are parked in callee saved registers for the life of
+// the function:
+//
+//   r12: the VMMethod
+//   r13: the Task
+//   r14: the MethodContext
+//
+namespace operations_x8664 {
+
+  using namespace assembler_x8664;
+
+  class StackOperations {
+    AssemblerX8664 &a;
+    Register &sp;
+
+  public:
+    const static int EntryWidth = 8;
+
+    StackOperations(AssemblerX8664 &a,
+                    Register &reg)
+      : a(a)
+      , sp(reg) { }
+
+    AssemblerX8664& assembler() {
+      return a;
+    }
+
+    Register& stack_pointer() {
+      return sp;
+    }
+
+    AssemblerX8664::Address position(int which) {
+      return a.address(sp, -(which * EntryWidth));
+    }
+
+    // All the immediates we push (true, false, nil, small fixnums) fit
+    // in a sign extended 32 bit value. Anything else goes through r10.
+    void set_top(uintptr_t val) {
+      intptr_t sval = static_cast<intptr_t>(val);
+      if(sval == static_cast<int32_t>(sval)) {
+        a.mov(a.address(sp, 0), static_cast<int>(sval));
+      } else {
+        a.mov(r10, static_cast<uint64_t>(val));
+        a.mov(a.address(sp, 0), r10);
+      }
+    }
+
+    void set_top(Register &dst) {
+      a.mov(a.address(sp, 0), dst);
+    }
+
+    void push(uintptr_t val) {
+      a.add(sp, EntryWidth);
+      set_top(val);
+    }
+
+    void push(Register &dst) {
+      a.add(sp, EntryWidth);
+      set_top(dst);
+    }
+
+    void load_nth(Register &dst, int which) {
+      a.mov(dst, a.address(sp, -(which * EntryWidth)));
+    }
+
+    void clear(int count) {
+      a.sub(sp, count * EntryWidth);
+    }
+
+    void pop() {
+      clear(1);
+    }
+  };
+
+  class ObjectOperations {
+    StackOperations &s;
+
+  public:
+    ObjectOperations(StackOperations &s)
+      : s(s)
+    { }
+
+    Register& vmm() {
+      return r12;
+    }
+
+    Register& task() {
+      return r13;
+    }
+
+    Register& ctx() {
+      return r14;
+    }
+
+    // Nothing is loaded lazily here, so there is no usage to reset.
+    void reset_usage() { }
+
+    void check_both_fixnum(AssemblerX8664::NearJumpLocation &are_not) {
+      Register& scratch = rcx;
+
+      s.load_nth(scratch, 0);
+      s.assembler().bit_and(scratch, s.position(1));
+      s.assembler().test(scratch, TAG_FIXNUM);
+      s.assembler().jump_if_not_equal(are_not);
+    }
+
+    void load_stack_pointer() {
+      // Pull jit_state.stack into the stack pointer
+      s.assembler().mov(s.stack_pointer(), s.assembler().address(ctx(),
+        FIELD_OFFSET(rubinius::MethodContext, js.stack)));
+    }
+
+    void save_stack_pointer() {
+      // Mov the stack pointer into  jit_state.stack
+      s.assembler().mov(
+          s.assembler().address(ctx(),
+            FIELD_OFFSET(rubinius::MethodContext, js.stack)),
+          s.stack_pointer());
+    }
+
+    void prologue() {
+      AssemblerX8664& a = s.assembler();
+
+      // Saves rbx and r12-r15 and leaves rsp aligned for calls.
+      a.prologue(0);
+
+      a.mov(vmm(),  AssemblerX8664::arg_register(0));
+      a.mov(task(), AssemblerX8664::arg_register(1));
+      a.mov(ctx(),  AssemblerX8664::arg_register(2));
+    }
+
+    void epilogue() {
+      s.assembler().epilogue();
+    }
+
+    // Returns the name +func+ is exported as, so it can be relocated.
+    const char* symbol_name(void* func) {
+      Dl_info info;
+      if(!dladdr(func, &info)) {
+        throw std::runtime_error("Unable to find symbol");
+      }
+
+      if(!info.dli_sname || info.dli_saddr != func) {
+        throw std::runtime_error("Unable to resolve symbol properly");
+      }
+
+      return info.dli_sname;
+    }
+
+    // Attempts to call +func+ as a symbol.
+    void call_via_symbol(void* func) {
+      call_operation(func, symbol_name(func));
+    }
+
+    void call_via_symbol(void* func, int arg) {
+      call_operation(func, symbol_name(func), arg);
+    }
+
+    void load_operation_args() {
+      AssemblerX8664 &a = s.assembler();
+      a.mov(AssemblerX8664::arg_register(0), vmm());
+      a.mov(AssemblerX8664::arg_register(1), task());
+      a.mov(AssemblerX8664::arg_register(2), ctx());
+    }
+
+    void call_operation(void* func, const char* name) {
+      load_operation_args();
+      s.assembler().call(func, name);
+    }
+
+    void call_operation(void* func, const char* name, int arg) {
+      AssemblerX8664 &a = s.assembler();
+      load_operation_args();
+      a.mov32(AssemblerX8664::arg_register(3), static_cast<uint32_t>(arg));
+      a.call(func, name);
+    }
+
+    void call_operation(void* func, const char* name, Register& arg) {
+      AssemblerX8664 &a = s.assembler();
+      load_operation_args();
+      a.mov(AssemblerX8664::arg_register(3), arg);
+      a.call(func, name);
+    }
+
+    void call_operation(void* func, const char* name, int arg, int arg2) {
+      AssemblerX8664 &a = s.assembler();
+      load_operation_args();
+      a.mov32(AssemblerX8664::arg_register(3), static_cast<uint32_t>(arg));
+      a.mov32(AssemblerX8664::arg_register(4), static_cast<uint32_t>(arg2));
+      a.call(func, name);
+    }
+
+    // NOTE arg2 is moved first, so arg2 may be rcx (arg_register(3)).
+    void call_operation(void* func, const char* name, Register& arg, Register& arg2) {
+      AssemblerX8664 &a = s.assembler();
+      load_operation_args();
+      a.mov(AssemblerX8664::arg_register(4), arg2);
+      a.mov(AssemblerX8664::arg_register(3), arg);
+      a.call(func, name);
+    }
+
+    // Operations return an ExecuteStatus, of which only the low 32 bits
+    // of rax are defined. The values are all tiny, so just check al.
+    void check_restart(AssemblerX8664::NearJumpLocation& lbl) {
+      AssemblerX8664 &a = s.assembler();
+      a.cmp_byte(rax, rubinius::cExecuteRestart);
+      a.jump_if_equal(lbl);
+    }
+
+    void store_mc_field(Register& reg, int pos) {
+      AssemblerX8664 &a = s.assembler();
+      a.mov(a.address(ctx(), pos), reg);
+    }
+
+    void load_mc_field(Register& reg, int pos) {
+      AssemblerX8664 &a = s.assembler();
+      a.mov(reg, a.address(ctx(), pos));
+    }
+
+    // MethodContext::ip is an int, so it's always accessed 32 bits wide.
+    void store_virtual_ip(Register& reg) {
+      AssemblerX8664 &a = s.assembler();
+      a.mov32(a.address(ctx(), FIELD_OFFSET(rubinius::MethodContext, ip)), reg);
+    }
+
+    void store_native_ip(Register& reg) {
+      store_mc_field(reg, FIELD_OFFSET(rubinius::MethodContext, native_ip));
+    }
+
+    void load_native_ip(Register& reg) {
+      load_mc_field(reg, FIELD_OFFSET(rubinius::MethodContext, native_ip));
+    }
+
+    void store_ip(Register& virtual_ip, Register& native_ip) {
+      store_virtual_ip(virtual_ip);
+      store_native_ip(native_ip);
+    }
+
+    void load_and_increment_ip(Register& reg) {
+      AssemblerX8664 &a = s.assembler();
+      a.mov32(reg, a.address(ctx(), FIELD_OFFSET(rubinius::MethodContext, ip)));
+      a.add32(a.address(ctx(), FIELD_OFFSET(rubinius::MethodContext, ip)), 1);
+    }
+
+    void load_opcodes(Register& reg) {
+      AssemblerX8664 &a = s.assembler();
+      a.mov(reg, a.address(vmm(), FIELD_OFFSET(rubinius::VMMethod, opcodes)));
+    }
+
+    // +index+ must hold a zero extended 32 bit value, which is what
+    // load_and_increment_ip leaves behind.
+    void load_opcode(Register& dest, Register& table, Register& index) {
+      AssemblerX8664 &a = s.assembler();
+      a.mov32(dest, a.address(table, index, sizeof(rubinius::opcode)));
+    }
+
+    void load_next_opcode(Register& dest) {
+      load_and_increment_ip(dest);
+      load_opcode(dest, r15, dest);
+    }
+
+    void load_self(Register& reg) {
+      load_home(reg);
+      AssemblerX8664 &a = s.assembler();
+      a.mov(reg, a.address(reg, FIELD_OFFSET(rubinius::MethodContext, self_)));
+    }
+
+    void load_home(Register& reg) {
+      load_mc_field(reg, FIELD_OFFSET(rubinius::MethodContext, home_));
+    }
+
+    void load_literals(Register& reg) {
+      load_mc_field(reg, FIELD_OFFSET(rubinius::MethodContext, cm_));
+      AssemblerX8664 &a = s.assembler();
+      a.mov(reg, a.address(reg, FIELD_OFFSET(rubinius::CompiledMethod, literals_)));
+    }
+
+    void set_local(Register& val, int which) {
+      load_home(rax);
+      AssemblerX8664 &a = s.assembler();
+      int base =   FIELD_OFFSET(rubinius::MethodContext, stk);
+      int offset = which * sizeof(void*);
+      a.mov(a.address(rax, base + offset), val);
+    }
+
+    void set_local(Register& val, Register& which) {
+      load_home(rax);
+      AssemblerX8664 &a = s.assembler();
+      int base =   FIELD_OFFSET(rubinius::MethodContext, stk);
+      a.mov(a.address(rax, which, sizeof(void*), base), val);
+    }
+
+    void get_local(Register& val, int which) {
+      load_home(rax);
+      AssemblerX8664 &a = s.assembler();
+      int base =   FIELD_OFFSET(rubinius::MethodContext, stk);
+      int offset = which * sizeof(void*);
+      a.mov(val, a.address(rax, base + offset));
+    }
+
+    void get_local(Register& val, Register& which) {
+      load_home(rax);
+      AssemblerX8664 &a = s.assembler();
+      int base =   FIELD_OFFSET(rubinius::MethodContext, stk);
+      a.mov(val, a.address(rax, which, sizeof(void*), base));
+    }
+
+    void get_literal(Register& dst, int which) {
+      load_literals(dst);
+
+      int base =   FIELD_OFFSET(rubinius::Tuple, field);
+      int offset = which * sizeof(void*);
+      AssemblerX8664 &a = s.assembler();
+      a.mov(dst, a.address(dst, base + offset));
+    }
+
+    void get_literal(Register& dst, Register& which) {
+      load_literals(dst);
+
+      int base =   FIELD_OFFSET(rubinius::Tuple, field);
+      AssemblerX8664 &a = s.assembler();
+      a.mov(dst, a.address(dst, which, sizeof(void*), base));
+    }
+
+    void tag_fixnum(Register& val) {
+      AssemblerX8664 &a = s.assembler();
+      a.shift_left(val, 1);
+      a.bit_or(val, 1);
+    }
+
+    void untag_fixnum(Register& val) {
+      s.assembler().shift_right(val, 1);
+    }
+
+    // Task::call_flags is an int.
+    void store_call_flags(int val) {
+      AssemblerX8664 &a = s.assembler();
+      a.mov32(a.address(task(), FIELD_OFFSET(rubinius::Task, call_flags)), val);
+    }
+
+    void store_call_flags(Register& val) {
+      AssemblerX8664 &a = s.assembler();
+      a.mov32(a.address(task(), FIELD_OFFSET(rubinius::Task, call_flags)), val);
+    }
+
+    // If the value in +reg+ is what ruby calls true (not false or nil),
+    // jump to +lbl+
+    void jump_if_true(Register& reg, AssemblerX8664::NearJumpLocation& lbl) {
+      AssemblerX8664 &a = s.assembler();
+      a.bit_and(reg, FALSE_MASK); // the common mask for both nil and false
+      a.cmp(reg, rubinius::cFalse);     // both nil and false have Qfalse in the low 3 bits
+      a.jump_if_not_equal(lbl);
+    }
+
+    // If the value in +reg+ is what ruby calls false (false or nil),
+    // jump to +lbl+
+    void jump_if_false(Register& reg, AssemblerX8664::NearJumpLocation& lbl) {
+      AssemblerX8664 &a = s.assembler();
+      a.bit_and(reg, FALSE_MASK); // common mask for both nil and false
+      a.cmp(reg, rubinius::cFalse);    // both nil and false have Qfalse in the low 3 bits
+      a.jump_if_equal(lbl);
+    }
+
+  };
+}
+
+#endif
@@ -11,7 +11,10 @@ namespace assembler {
   public: // Types
     enum Kind {
       Relative,
-      LocalAbsolute
+      LocalAbsolute,
+      // An absolute address outside the code buffer, written as a full
+      // pointer. Used on x86-64, where a rel32 can't reach everything.
+      ExternalAbsolute
     };
 
     enum TargetKind {
@@ -64,10 +67,16 @@ namespace assembler {
       return val;
     }
 
-    // Write the relocation out to memory
+    // Write the relocation out to memory. Relative displacements are
+    // always 32 bits, even on 64 bit platforms.
     void write() {
-      intptr_t* write_to = reinterpret_cast<intptr_t*>(instruction_location_);
-      *write_to = value();
+      if(kind_ == Relative) {
+        int32_t* write_to = reinterpret_cast<int32_t*>(instruction_location_);
+        *write_to = static_cast<int32_t>(value());
+      } else {
+        intptr_t* write_to = reinterpret_cast<intptr_t*>(instruction_location_);
+        *write_to = value();
+      }
     }
 
     void references_symbol(const char* name) {
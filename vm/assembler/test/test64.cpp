@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <cassert>
+#include <sys/mman.h>
 
 #include "assembler_x8664.hpp"
 
@@ -163,11 +164,11 @@ void test_mov9() {
 
   assert_kind(UD_Imov);
   assert_op(0, type, UD_OP_REG);
-  assert_op(0, base, UD_R_ESI);
+  assert_op(0, base, UD_R_RSI);
   assert_op(0, index, UD_NONE);
 
   assert_op(1, type, UD_OP_REG);
-  assert_op(1, base, UD_R_EAX);
+  assert_op(1, base, UD_R_RAX);
   assert_op(1, index, UD_NONE);
   delete ud;
   cout << "test_mov: reg to reg ok!\n";
@@ -317,7 +318,7 @@ void test_lea2() {
 
   assert_kind(UD_Ilea);
   assert_op(0, type, UD_OP_REG);
-  assert_op(0, base, UD_R_EAX);
+  assert_op(0, base, UD_R_RAX);
 
   assert_op(1, type, UD_OP_MEM);
   assert_op(1, base, UD_R_RSI);
@@ -350,7 +351,7 @@ void test_sub2() {
 
   assert_kind(UD_Isub);
   assert_op(0, type, UD_OP_REG);
-  assert_op(0, base, UD_R_EAX);
+  assert_op(0, base, UD_R_RAX);
 
   assert_op(1, type, UD_OP_IMM);
   assert_op(1, lval.udword, 4);
@@ -382,7 +383,7 @@ void test_add2() {
 
   assert_kind(UD_Iadd);
   assert_op(0, type, UD_OP_REG);
-  assert_op(0, base, UD_R_ECX);
+  assert_op(0, base, UD_R_RCX);
 
   assert_op(1, type, UD_OP_IMM);
   assert_op(1, lval.udword, 4);
@@ -430,15 +431,285 @@ void test_add5() {
 
   assert_kind(UD_Iadd);
   assert_op(0, type, UD_OP_REG);
-  assert_op(0, base, UD_R_ECX);
+  assert_op(0, base, UD_R_RCX);
 
   assert_op(1, type, UD_OP_REG);
-  assert_op(1, base, UD_R_EAX);
+  assert_op(1, base, UD_R_RAX);
 
   delete ud;
   cout << "test_add: reg and reg ok!\n";
 }
 
+void test_mov12() {
+  AssemblerX8664 a;
+  a.mov(rax, a.address(rsp, 8));
+  ud_t *ud = a.disassemble();
+
+  assert_kind(UD_Imov);
+  assert_op(0, type, UD_OP_REG);
+  assert_op(0, base, UD_R_RAX);
+
+  assert_op(1, type, UD_OP_MEM);
+  assert_op(1, base, UD_R_RSP);
+  assert_op(1, index, UD_NONE);
+  assert_op(1, lval.sbyte, 8);
+
+  delete ud;
+  cout << "test_mov: rsp based address to reg ok!\n";
+}
+
+void test_mov13() {
+  AssemblerX8664 a;
+  a.mov(rcx, a.address(r13, 0));
+  ud_t *ud = a.disassemble();
+
+  assert_kind(UD_Imov);
+  assert_op(0, type, UD_OP_REG);
+  assert_op(0, base, UD_R_RCX);
+
+  assert_op(1, type, UD_OP_MEM);
+  assert_op(1, base, UD_R_R13);
+  assert_op(1, lval.sbyte, 0);
+
+  delete ud;
+  cout << "test_mov: r13 based address with no offset ok!\n";
+}
+
+void test_mov14() {
+  AssemblerX8664 a;
+  a.mov(a.address(r14, 1024), rbx);
+  ud_t *ud = a.disassemble();
+
+  assert_kind(UD_Imov);
+  assert_op(0, type, UD_OP_MEM);
+  assert_op(0, base, UD_R_R14);
+  assert_op(0, size, 64);
+  assert_op(0, lval.sdword, 1024);
+
+  assert_op(1, type, UD_OP_REG);
+  assert_op(1, base, UD_R_RBX);
+
+  delete ud;
+  cout << "test_mov: reg to address with 32 bit offset ok!\n";
+}
+
+void test_mov15() {
+  AssemblerX8664 a;
+  a.mov(rdx, a.address(r15, rax, 8, 16));
+  ud_t *ud = a.disassemble();
+
+  assert_kind(UD_Imov);
+  assert_op(0, type, UD_OP_REG);
+  assert_op(0, base, UD_R_RDX);
+
+  assert_op(1, type, UD_OP_MEM);
+  assert_op(1, base, UD_R_R15);
+  assert_op(1, index, UD_R_RAX);
+  assert_op(1, scale, 8);
+  assert_op(1, lval.sbyte, 16);
+
+  delete ud;
+  cout << "test_mov: indexed address to reg ok!\n";
+}
+
+void test_mov32_1() {
+  AssemblerX8664 a;
+  a.mov32(rax, a.address(r15, r9, 4));
+  ud_t *ud = a.disassemble();
+
+  assert_kind(UD_Imov);
+  assert_op(0, type, UD_OP_REG);
+  assert_op(0, base, UD_R_EAX);
+
+  assert_op(1, type, UD_OP_MEM);
+  assert_op(1, size, 32);
+  assert_op(1, base, UD_R_R15);
+  assert_op(1, index, UD_R_R9);
+  assert_op(1, scale, 4);
+
+  delete ud;
+  cout << "test_mov32: indexed address to reg ok!\n";
+}
+
+void test_mov32_2() {
+  AssemblerX8664 a;
+  a.mov32(a.address(r14, 16), rcx);
+  ud_t *ud = a.disassemble();
+
+  assert_kind(UD_Imov);
+  assert_op(0, type, UD_OP_MEM);
+  assert_op(0, size, 32);
+  assert_op(0, base, UD_R_R14);
+
+  assert_op(1, type, UD_OP_REG);
+  assert_op(1, base, UD_R_ECX);
+
+  delete ud;
+  cout << "test_mov32: reg to address ok!\n";
+}
+
+void test_movsxd() {
+  AssemblerX8664 a;
+  a.movsxd(rax, rax);
+  ud_t *ud = a.disassemble();
+
+  assert_kind(UD_Imovsxd);
+  assert_op(0, type, UD_OP_REG);
+  assert_op(0, base, UD_R_RAX);
+  assert_op(1, type, UD_OP_REG);
+  assert_op(1, base, UD_R_EAX);
+
+  delete ud;
+  cout << "test_movsxd: ok!\n";
+}
+
+void test_cmp_byte() {
+  AssemblerX8664 a;
+  a.cmp_byte(rax, 1);
+  ud_t *ud = a.disassemble();
+
+  assert_kind(UD_Icmp);
+  assert_op(0, type, UD_OP_REG);
+  assert_op(0, base, UD_R_AL);
+  assert_op(1, type, UD_OP_IMM);
+  assert_op(1, lval.sbyte, 1);
+
+  delete ud;
+  cout << "test_cmp_byte: ok!\n";
+}
+
+void test_cmp_byte2() {
+  AssemblerX8664 a;
+  a.cmp_byte(rsi, 1);
+  ud_t *ud = a.disassemble();
+
+  assert_kind(UD_Icmp);
+  assert_op(0, type, UD_OP_REG);
+  assert_op(0, base, UD_R_SIL);
+
+  delete ud;
+  cout << "test_cmp_byte: sil ok!\n";
+}
+
+void test_add6() {
+  AssemblerX8664 a;
+  a.add32(a.address(r14, 8), 1);
+  ud_t *ud = a.disassemble();
+
+  assert_kind(UD_Iadd);
+  assert_op(0, type, UD_OP_MEM);
+  assert_op(0, size, 32);
+  assert_op(0, base, UD_R_R14);
+
+  assert_op(1, type, UD_OP_IMM);
+  assert_op(1, lval.sbyte, 1);
+
+  delete ud;
+  cout << "test_add32: imm to address ok!\n";
+}
+
+void test_call1() {
+  AssemblerX8664 a;
+  a.call((void*)puts);
+  ud_t *ud = a.disassemble();
+
+  assert_kind(UD_Imov);
+  assert_op(0, type, UD_OP_REG);
+  assert_op(0, base, UD_R_R11);
+  assert_op(1, type, UD_OP_IMM);
+  assert_op(1, size, 64);
+  assert_op(1, lval.uqword, (uint64_t)puts);
+
+  ud_disassemble(ud);
+
+  assert_kind(UD_Icall);
+  assert_op(0, type, UD_OP_REG);
+  assert_op(0, base, UD_R_R11);
+
+  delete ud;
+  cout << "test_call: far function ok!\n";
+}
+
+void test_jump_via_table() {
+  void* table[2];
+  AssemblerX8664 a;
+  a.jump_via_table(table, rax);
+  ud_t *ud = a.disassemble();
+
+  assert_kind(UD_Imov);
+  assert_op(1, lval.uqword, (uint64_t)table);
+
+  ud_disassemble(ud);
+
+  assert_kind(UD_Ijmp);
+  assert_op(0, type, UD_OP_MEM);
+  assert_op(0, base, UD_R_R11);
+  assert_op(0, index, UD_R_RAX);
+  assert_op(0, scale, 8);
+
+  delete ud;
+  cout << "test_jump_via_table: ok!\n";
+}
+
+static void* executable(AssemblerX8664& a) {
+  void* code = mmap(NULL, a.used_bytes(), PROT_READ | PROT_WRITE | PROT_EXEC,
+                    MAP_PRIVATE | MAP_ANON, -1, 0);
+  assert(code != MAP_FAILED);
+  memcpy(code, a.buffer(), a.used_bytes());
+  return code;
+}
+
+static long add3(long a, long b, long c) {
+  return a + b + c;
+}
+
+// Runs generated code: a function that keeps its 3 arguments in callee
+// saved registers, calls out to a C function and returns its result.
+void test_prologue_and_call() {
+  AssemblerX8664 a;
+  a.prologue(0);
+  a.mov(r12, rdi);
+  a.mov(r13, rsi);
+  a.mov(r14, rdx);
+  a.mov(rdi, r14);
+  a.mov(rsi, r13);
+  a.mov(rdx, r12);
+  a.call((void*)add3);
+  a.add(rax, r12);
+  a.epilogue();
+
+  void* code = executable(a);
+  long (*func)(long, long, long) = (long (*)(long, long, long))code;
+  assert(func(1, 2, 3) == 7);
+  munmap(code, a.used_bytes());
+
+  cout << "test_prologue: call through generated code ok!\n";
+}
+
+void test_labels() {
+  AssemblerX8664 a;
+  AssemblerX8664::NearJumpLocation less, done;
+
+  a.prologue(0);
+  a.cmp(rdi, rsi);
+  a.jump_if_less(less);
+  a.mov(rax, rdi);
+  a.jump(done);
+  a.set_label(less);
+  a.mov(rax, rsi);
+  a.set_label(done);
+  a.epilogue();
+
+  void* code = executable(a);
+  long (*max)(long, long) = (long (*)(long, long))code;
+  assert(max(3, 9) == 9);
+  assert(max(9, 3) == 9);
+  assert(max(-5, -7) == -5);
+  munmap(code, a.used_bytes());
+
+  cout << "test_labels: forward jumps ok!\n";
+}
+
 int main(int argc, char** argv) {
   test_mov1();
   test_mov2();
@@ -468,4 +739,21 @@ int main(int argc, char** argv) {
   test_add3();
   test_add4();
   test_add5();
+  test_add6();
+
+  test_mov12();
+  test_mov13();
+  test_mov14();
+  test_mov15();
+  test_mov32_1();
+  test_mov32_2();
+  test_movsxd();
+  test_cmp_byte();
+  test_cmp_byte2();
+
+  test_call1();
+  test_jump_via_table();
+
+  test_prologue_and_call();
+  test_labels();
 }
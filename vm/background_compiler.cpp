@@ -0,0 +1,214 @@
+#include "vm/background_compiler.hpp"
+
+#include "vm.hpp"
+#include "vmmethod.hpp"
+#include "timing.hpp"
+
+#include "assembler/jit.hpp"
+#include "builtin/machine_method.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <signal.h>
+
+namespace rubinius {
+
+  BackgroundCompiler::Request::Request(VMMethod* vmm)
+    : vmm(vmm)
+    , opcodes(new opcode[vmm->total])
+    , jit(NULL)
+    , enqueued_at(get_current_time())
+    , compile_time(0)
+  {
+    std::memcpy(opcodes, vmm->opcodes, sizeof(opcode) * vmm->total);
+  }
+
+  BackgroundCompiler::Request::~Request() {
+    delete[] opcodes;
+    delete jit;
+  }
+
+  BackgroundCompiler::BackgroundCompiler(VM* state)
+    : state_(state)
+    , started_(false)
+    , busy_(false)
+    , stop_(false)
+  {
+    pthread_mutex_init(&lock_, NULL);
+    pthread_cond_init(&work_ready_, NULL);
+    pthread_cond_init(&work_done_, NULL);
+  }
+
+  BackgroundCompiler::~BackgroundCompiler() {
+    if(started_) {
+      pthread_mutex_lock(&lock_);
+      stop_ = true;
+      pthread_cond_signal(&work_ready_);
+      pthread_mutex_unlock(&lock_);
+
+      pthread_join(thread_, NULL);
+    }
+
+    for(Requests::iterator i = pending_.begin(); i != pending_.end(); i++) {
+      delete *i;
+    }
+
+    for(Requests::iterator i = finished_.begin(); i != finished_.end(); i++) {
+      delete *i;
+    }
+
+    pthread_cond_destroy(&work_done_);
+    pthread_cond_destroy(&work_ready_);
+    pthread_mutex_destroy(&lock_);
+  }
+
+  // Trampoline to call perform() in the compiler thread
+  static void* __compiler_tramp__(void* arg) {
+    BackgroundCompiler* compiler = static_cast<BackgroundCompiler*>(arg);
+    compiler->perform();
+    return NULL;
+  }
+
+  void BackgroundCompiler::start() {
+    if(pthread_create(&thread_, NULL, __compiler_tramp__, this) != 0) {
+      std::cout << "Unable to create background compiler thread!\n";
+      return;
+    }
+
+    started_ = true;
+  }
+
+  void BackgroundCompiler::enqueue(VMMethod* vmm) {
+    if(!started_) start();
+
+    Request* req = new Request(vmm);
+
+    // Without a thread, compile right here and install at the next
+    // safe point like normal.
+    if(!started_) {
+      compile(req);
+      finished_.push_back(req);
+      state_->interrupts.set_install_code();
+      return;
+    }
+
+    pthread_mutex_lock(&lock_);
+    pending_.push_back(req);
+    pthread_cond_signal(&work_ready_);
+    pthread_mutex_unlock(&lock_);
+  }
+
+  void BackgroundCompiler::compile(Request* req) {
+    uint64_t start = get_current_time();
+
+    JITCompiler* jit = new JITCompiler();
+    try {
+      jit->compile(state_, req->vmm, req->opcodes);
+      req->jit = jit;
+    } catch(const std::exception& e) {
+      std::cout << "Unable to JIT method: " << e.what() << "\n";
+      delete jit;
+    }
+
+    req->compile_time = get_current_time() - start;
+  }
+
+  void BackgroundCompiler::perform() {
+    // Signals are for the VM thread only.
+    sigset_t mask;
+    sigfillset(&mask);
+    if(pthread_sigmask(SIG_BLOCK, &mask, NULL) != 0) {
+      abort();
+    }
+
+    for(;;) {
+      pthread_mutex_lock(&lock_);
+      while(pending_.empty() && !stop_) {
+        pthread_cond_wait(&work_ready_, &lock_);
+      }
+
+      if(stop_) {
+        pthread_mutex_unlock(&lock_);
+        return;
+      }
+
+      Request* req = pending_.front();
+      pending_.pop_front();
+      busy_ = true;
+      pthread_mutex_unlock(&lock_);
+
+      compile(req);
+
+      // The flag is raised before the broadcast, so anyone woken by
+      // wait_until_idle() sees it along with the finished request.
+      pthread_mutex_lock(&lock_);
+      finished_.push_back(req);
+      busy_ = false;
+      state_->interrupts.set_install_code();
+      pthread_cond_broadcast(&work_done_);
+      pthread_mutex_unlock(&lock_);
+    }
+  }
+
+  size_t BackgroundCompiler::install_finished(STATE) {
+    Requests done;
+
+    pthread_mutex_lock(&lock_);
+    done.swap(finished_);
+    pthread_mutex_unlock(&lock_);
+
+    size_t installed = 0;
+
+    for(Requests::iterator i = done.begin(); i != done.end(); i++) {
+      Request* req = *i;
+      VMMethod* vmm = req->vmm;
+
+      state->stats.jit_timing += req->compile_time;
+
+      // A failed compile leaves call_count at -1, so the method isn't
+      // queued again.
+      if(req->jit) {
+        if(std::memcmp(req->opcodes, vmm->opcodes,
+                       sizeof(opcode) * vmm->total) == 0) {
+          if(MachineMethod* mm = MachineMethod::create(state, vmm, *req->jit)) {
+            mm->activate();
+
+            state->stats.jitted_methods++;
+            state->stats.jit_install_latency += get_current_time() - req->enqueued_at;
+            installed++;
+          } else {
+            // The code cache is full. Cold code is being evicted, so
+            // try again once the method is hot again.
+            vmm->call_count = 0;
+            vmm->backedge_count = 0;
+          }
+        } else {
+          // The method was specialized or had a breakpoint set while we
+          // were compiling. Start counting again so it's compiled from
+          // the new opcodes.
+          vmm->call_count = 0;
+        }
+      }
+
+      delete req;
+    }
+
+    return installed;
+  }
+
+  void BackgroundCompiler::wait_until_idle() {
+    pthread_mutex_lock(&lock_);
+    while(!pending_.empty() || busy_) {
+      pthread_cond_wait(&work_done_, &lock_);
+    }
+    pthread_mutex_unlock(&lock_);
+  }
+
+  size_t BackgroundCompiler::queue_length() {
+    pthread_mutex_lock(&lock_);
+    size_t length = pending_.size() + finished_.size() + (busy_ ? 1 : 0);
+    pthread_mutex_unlock(&lock_);
+
+    return length;
+  }
+}
@@ -0,0 +1,88 @@
+#ifndef RBX_VM_BACKGROUND_COMPILER_HPP
+#define RBX_VM_BACKGROUND_COMPILER_HPP
+
+#include "vmmethod.hpp"
+
+#include <list>
+#include <pthread.h>
+#include <stdint.h>
+
+namespace rubinius {
+  class VM;
+  class JITCompiler;
+
+  /**
+   *  Runs the JIT on a native thread of its own, so that compiling a hot
+   *  method doesn't stall the interpreter.
+   *
+   *  The VM thread enqueues a VMMethod along with a copy of its opcodes.
+   *  The compiler thread turns that into machine code and moves it to the
+   *  finished list, then raises interrupts.install_code. The VM thread
+   *  picks it up at its next safe point (VM::run_and_monitor) and calls
+   *  install_finished(), which allocates the MachineMethod and swaps it
+   *  into VMMethod::run. Until then the method keeps being interpreted.
+   *
+   *  Only the VM thread touches the object heap; the compiler thread only
+   *  reads the opcode copy and the static instruction tables.
+   */
+  class BackgroundCompiler {
+  public:
+    struct Request {
+      VMMethod* vmm;
+      opcode* opcodes;
+      JITCompiler* jit;
+
+      // When the request was queued, and how long compiling took.
+      uint64_t enqueued_at;
+      uint64_t compile_time;
+
+      Request(VMMethod* vmm);
+      ~Request();
+    };
+
+    typedef std::list<Request*> Requests;
+
+  private:
+    VM* state_;
+
+    pthread_t thread_;
+    pthread_mutex_t lock_;
+    pthread_cond_t work_ready_;
+    pthread_cond_t work_done_;
+
+    Requests pending_;
+    Requests finished_;
+
+    bool started_;
+    bool busy_;
+    bool stop_;
+
+  public:
+    BackgroundCompiler(VM* state);
+
+    // Stops the compiler thread. Anything not yet installed is dropped.
+    ~BackgroundCompiler();
+
+    // Queues +vmm+ to be compiled. Only call from the VM thread.
+    void enqueue(VMMethod* vmm);
+
+    // Activates every method which has finished compiling. Only call from
+    // the VM thread, at a point where swapping VMMethod::run is safe.
+    // Returns how many methods were installed.
+    size_t install_finished(STATE);
+
+    // Blocks until nothing is pending or being compiled.
+    void wait_until_idle();
+
+    // The number of methods queued but not yet installed.
+    size_t queue_length();
+
+    void perform();
+
+  private:
+    void start();
+    void compile(Request* req);
+  };
+}
+
+#endif
@@ -3,13 +3,19 @@
 
 #include "builtin/array.hpp"
 #include "builtin/fixnum.hpp"
+#include "builtin/float.hpp"
+#include "builtin/hash.hpp"
+#include "builtin/string.hpp"
 #include "builtin/tuple.hpp"
 #include "builtin/class.hpp"
 #include "objectmemory.hpp"
 #include "primitives.hpp"
+#include "vm/bytes.hpp"
 
 #include <iostream>
 #include <cmath>
+#include <algorithm>
+#include <vector>
 
 /* Implementation certain Array methods. These methods are just
  * the ones the VM requires, not the entire set of all Array methods.
@@ -46,9 +52,7 @@ namespace rubinius {
   Array* Array::from_tuple(STATE, Tuple* tup) {
     size_t length = tup->num_fields();
     Array* ary = Array::create(state, length);
-    ary->tuple_->copy_from(state, tup,
-			   Fixnum::from(0), Fixnum::from(length),
-			   Fixnum::from(0));
+    ary->tuple_->copy_fields(state, 0, tup, 0, length);
     ary->total(state, Fixnum::from(length));
     return ary;
   }
@@ -114,7 +118,7 @@ namespace rubinius {
       }
 
       Tuple* nt = Tuple::create(state, new_size+idx);
-      nt->copy_from(state, tuple_, start_, total_, Fixnum::from(0));
+      nt->copy_fields(state, 0, tuple_, start_->to_native(), total_->to_native());
       tuple(state, nt);
       start(state, Fixnum::from(0));
       idx = oidx;
@@ -137,8 +141,7 @@ namespace rubinius {
       total(state, Fixnum::from(new_size));
     } else {
       Tuple* nt = Tuple::create(state, new_size);
-      nt->copy_from(state, tuple_, start_, total_,
-		    Fixnum::from(1));
+      nt->copy_fields(state, 1, tuple_, start_->to_native(), total_->to_native());
       nt->put(state, 0, val);
 
       total(state, Fixnum::from(new_size));
@@ -155,6 +158,7 @@ namespace rubinius {
     set(state, 0, Qnil);
     start(state, Fixnum::from(start_->to_native() + 1));
     total(state, Fixnum::from(cnt - 1));
+    shrink(state);
     return obj;
   }
 
@@ -180,9 +184,413 @@ namespace rubinius {
     Object *obj = get(state, cnt - 1);
     set(state, cnt-1, Qnil);
     total(state, Fixnum::from(cnt - 1));
+    shrink(state);
     return obj;
   }
 
+  /* Same as Array#reallocate_shrink, except that small tuples are left
+   * alone so that a short queue doesn't reallocate on every push/shift. */
+  void Array::shrink(STATE) {
+    size_t new_size = tuple_->num_fields();
+    size_t cnt = total_->to_native();
+
+    if(new_size <= 16 || cnt > new_size / 3) return;
+
+    do {
+      new_size /= 2;
+    } while(cnt < new_size / 6);
+
+    Tuple* nt = Tuple::create(state, new_size);
+    size_t new_start = (new_size - cnt) / 2;
+    nt->copy_fields(state, new_start, tuple_, start_->to_native(), cnt);
+
+    tuple(state, nt);
+    start(state, Fixnum::from(new_start));
+  }
+
+  static bool immediate_p(Object* obj) {
+    return obj->fixnum_p() || obj->symbol_p() ||
+      obj->nil_p() || obj->true_p() || obj->false_p();
+  }
+
+  static bool plain_string_p(STATE, Object* obj) {
+    return obj->reference_p() && obj->klass() == G(string);
+  }
+
+  /* Immediate Floats can't have a singleton class, boxed ones can. */
+  static bool plain_float_p(STATE, Object* obj) {
+    if(FLONUM_P(obj)) return true;
+    return obj->reference_p() && obj->klass() == G(floatpoint);
+  }
+
+  /* What a == b would return, if that can be worked out without sending
+   * anything: 1 or 0, or -1 when == has to be sent. Identity counts as
+   * equal, as it does for rb_equal in MRI. */
+  static int native_equal(STATE, Object* a, Object* b) {
+    if(a == b) return 1;
+
+    if(immediate_p(a)) {
+      // Only Fixnum#== looks at anything besides identity
+      if(!a->fixnum_p()) return 0;
+      if(immediate_p(b) || plain_string_p(state, b)) return 0;
+      return -1;
+    }
+
+    if(plain_string_p(state, a)) {
+      if(kind_of<String>(b)) return String::string_equal_p(state, a, b) ? 1 : 0;
+      if(immediate_p(b)) return 0;
+    }
+
+    return -1;
+  }
+
+  Array* Array::push(STATE, Object* val) {
+    set(state, (size_t)total_->to_native(), val);
+    return this;
+  }
+
+  Array* Array::concat(STATE, Array* other) {
+    size_t cnt = total_->to_native();
+    size_t ocnt = other->size();
+    size_t lend = start_->to_native();
+
+    if(ocnt == 0) return this;
+
+    if(lend + cnt + ocnt > tuple_->num_fields()) {
+      size_t new_size = tuple_->num_fields() * 2;
+      if(new_size < cnt + ocnt) new_size = cnt + ocnt;
+
+      Tuple* nt = Tuple::create(state, new_size);
+      nt->copy_fields(state, 0, tuple_, lend, cnt);
+      tuple(state, nt);
+      start(state, Fixnum::from(0));
+      lend = 0;
+    }
+
+    // Read other's fields after the resize above, in case other is this.
+    tuple_->copy_fields(state, lend + cnt, other->tuple(),
+                        other->start()->to_native(), ocnt);
+    total(state, Fixnum::from(cnt + ocnt));
+
+    return this;
+  }
+
+  Array* Array::dup_prim(STATE) {
+    if(klass() != G(array) || !ivars()->nil_p()) {
+      return (Array*)Primitives::failure();
+    }
+
+    size_t cnt = total_->to_native();
+    Array* ary = Array::create(state, cnt);
+    ary->tuple()->copy_fields(state, 0, tuple_, start_->to_native(), cnt);
+    ary->total(state, total_);
+    ary->IsTainted = IsTainted;
+
+    return ary;
+  }
+
+  Object* Array::include_p(STATE, Object* val) {
+    Object* idx = index(state, val);
+    if(idx == Primitives::failure()) return idx;
+    return idx->nil_p() ? Qfalse : Qtrue;
+  }
+
+  Object* Array::index(STATE, Object* val) {
+    size_t cnt = total_->to_native();
+    size_t lend = start_->to_native();
+
+    for(size_t i = 0; i < cnt; i++) {
+      switch(native_equal(state, tuple_->field[lend + i], val)) {
+      case 1:
+        return Fixnum::from(i);
+      case -1:
+        return Primitives::failure();
+      }
+    }
+
+    return Qnil;
+  }
+
+  Object* Array::elements_equal(STATE, Array* other) {
+    size_t cnt = total_->to_native();
+
+    if(other == this) return Qtrue;
+    if(cnt != other->size()) return Qfalse;
+
+    size_t lend = start_->to_native();
+    size_t olend = other->start()->to_native();
+    Tuple* otup = other->tuple();
+
+    // Check everything before answering false, so that the Ruby code
+    // gets to send == to the elements we couldn't compare here.
+    bool equal = true;
+    for(size_t i = 0; i < cnt; i++) {
+      switch(native_equal(state, tuple_->field[lend + i], otup->field[olend + i])) {
+      case 0:
+        equal = false;
+        break;
+      case -1:
+        return Primitives::failure();
+      }
+    }
+
+    return equal ? Qtrue : Qfalse;
+  }
+
+  /* Must give the same answer as the Ruby Array#hash, which works on the
+   * Integers returned by #hash. The arithmetic wraps here, but the bits
+   * kept by the final mask are the same. */
+  Object* Array::hash_elements(STATE) {
+    size_t cnt = total_->to_native();
+    size_t lend = start_->to_native();
+    uintptr_t hsh = cnt;
+
+    for(size_t i = 0; i < cnt; i++) {
+      Object* obj = tuple_->field[lend + i];
+      if(!Hash::simple_key_p(state, obj)) return Primitives::failure();
+
+      hsh = hsh * 31 + (uintptr_t)obj->hash(state);
+    }
+
+    return Fixnum::from(hsh & FIXNUM_MAX);
+  }
+
+  /* Appends the elements of +ary+ to +out+, flattening nested Arrays.
+   * Returns false if an element might respond to #to_ary, or if +ary+
+   * contains itself, so that the Ruby code can handle it. */
+  static bool flatten_into(STATE, Array* ary, Array* out, std::vector<Array*>& seen) {
+    size_t cnt = ary->size();
+
+    for(size_t i = 0; i < seen.size(); i++) {
+      if(seen[i] == ary) return false;
+    }
+    seen.push_back(ary);
+
+    for(size_t i = 0; i < cnt; i++) {
+      Object* obj = ary->get(state, i);
+
+      if(immediate_p(obj) || plain_string_p(state, obj)) {
+        out->append(state, obj);
+      } else if(obj->reference_p() && obj->klass() == G(array)) {
+        if(!flatten_into(state, as<Array>(obj), out, seen)) return false;
+      } else {
+        return false;
+      }
+    }
+
+    seen.pop_back();
+    return true;
+  }
+
+  Array* Array::flatten(STATE) {
+    if(klass() != G(array)) return (Array*)Primitives::failure();
+
+    Array* out = Array::create(state, total_->to_native());
+    std::vector<Array*> seen;
+
+    if(!flatten_into(state, this, out, seen)) {
+      return (Array*)Primitives::failure();
+    }
+
+    out->IsTainted = IsTainted;
+    return out;
+  }
+
+  Array* Array::compact(STATE) {
+    if(klass() != G(array)) return (Array*)Primitives::failure();
+
+    size_t cnt = total_->to_native();
+    size_t lend = start_->to_native();
+    Array* out = Array::create(state, cnt);
+    Tuple* tup = out->tuple();
+    size_t j = 0;
+
+    for(size_t i = 0; i < cnt; i++) {
+      Object* obj = tuple_->field[lend + i];
+      if(!obj->nil_p()) tup->put(state, j++, obj);
+    }
+
+    out->total(state, Fixnum::from(j));
+    out->IsTainted = IsTainted;
+    return out;
+  }
+
+  Array* Array::uniq(STATE) {
+    if(klass() != G(array)) return (Array*)Primitives::failure();
+
+    size_t cnt = total_->to_native();
+    size_t lend = start_->to_native();
+
+    for(size_t i = 0; i < cnt; i++) {
+      if(!Hash::simple_key_p(state, tuple_->field[lend + i])) {
+        return (Array*)Primitives::failure();
+      }
+    }
+
+    Array* out = Array::create(state, cnt);
+    Hash* seen = Hash::create(state);
+
+    for(size_t i = 0; i < cnt; i++) {
+      Object* obj = tuple_->field[lend + i];
+      if(!seen->find_entry(state, obj)->nil_p()) continue;
+
+      seen->insert(state, Fixnum::from(Hash::key_hash(state, obj)), obj, Qtrue);
+      out->append(state, obj);
+    }
+
+    return out;
+  }
+
+  /* The elements #sort and #sort_by_keys know how to compare without
+   * sending #<=>. NaN is left out, since Float#<=> returns nil for it and
+   * sort has to raise. */
+  enum SortKind {
+    cSortNone,
+    cSortFixnum,
+    cSortFloat,
+    cSortString
+  };
+
+  static SortKind sort_kind(STATE, Object** elems, size_t cnt) {
+    if(cnt == 0) return cSortNone;
+
+    Object* first = elems[0];
+    if(first->fixnum_p()) {
+      for(size_t i = 1; i < cnt; i++) {
+        if(!elems[i]->fixnum_p()) return cSortNone;
+      }
+      return cSortFixnum;
+    }
+
+    if(plain_float_p(state, first)) {
+      for(size_t i = 0; i < cnt; i++) {
+        Object* obj = elems[i];
+        if(!plain_float_p(state, obj)) return cSortNone;
+        if(std::isnan(((Float*)obj)->val())) return cSortNone;
+      }
+      return cSortFloat;
+    }
+
+    if(!first->reference_p()) return cSortNone;
+
+    if(first->klass() == G(string)) {
+      for(size_t i = 1; i < cnt; i++) {
+        if(!plain_string_p(state, elems[i])) return cSortNone;
+      }
+      return cSortString;
+    }
+
+    return cSortNone;
+  }
+
+  /* sort_kind has checked every element already, so the comparisons
+   * below just cast. */
+  struct FixnumLess {
+    bool operator()(Object* a, Object* b) const {
+      return ((Fixnum*)a)->to_native() < ((Fixnum*)b)->to_native();
+    }
+  };
+
+  struct FloatLess {
+    bool operator()(Object* a, Object* b) const {
+      return ((Float*)a)->val() < ((Float*)b)->val();
+    }
+  };
+
+  /* Same order as String#<=>: bytewise, then shorter first. */
+  struct StringLess {
+    bool operator()(Object* a, Object* b) const {
+      String* sa = (String*)a;
+      String* sb = (String*)b;
+      size_t na = sa->size();
+      size_t nb = sb->size();
+
+      int cmp = bytes::compare(sa->byte_address(), sb->byte_address(),
+                               na < nb ? na : nb);
+      return cmp < 0 || (cmp == 0 && na < nb);
+    }
+  };
+
+  /* Orders positions in a parallel keys array by the key there; used
+   * with stable_sort so that equal keys keep their order. */
+  template <typename Less>
+    struct KeyIndexLess {
+      Object** keys;
+      Less less;
+
+      KeyIndexLess(Object** keys) : keys(keys) { }
+
+      bool operator()(size_t a, size_t b) const {
+        return less(keys[a], keys[b]);
+      }
+    };
+
+  /* The tuple keeps exactly the same set of references when its fields are
+   * only reordered, so no write barrier is needed below. */
+  Array* Array::sort(STATE) {
+    size_t cnt = total_->to_native();
+    Object** elems = tuple_->field + start_->to_native();
+
+    switch(sort_kind(state, elems, cnt)) {
+    case cSortFixnum:
+      std::sort(elems, elems + cnt, FixnumLess());
+      break;
+    case cSortFloat:
+      std::sort(elems, elems + cnt, FloatLess());
+      break;
+    case cSortString:
+      std::sort(elems, elems + cnt, StringLess());
+      break;
+    default:
+      if(cnt > 1) return (Array*)Primitives::failure();
+    }
+
+    return this;
+  }
+
+  template <typename Less>
+    static void sort_indexes(std::vector<size_t>& order, Object** keys) {
+      std::stable_sort(order.begin(), order.end(), KeyIndexLess<Less>(keys));
+    }
+
+  Array* Array::sort_by_keys(STATE, Array* keys) {
+    size_t cnt = total_->to_native();
+    if(keys->size() != cnt || keys == this) return (Array*)Primitives::failure();
+    if(cnt < 2) return this;
+
+    Object** elems = tuple_->field + start_->to_native();
+    Object** kelems = keys->tuple()->field + keys->start()->to_native();
+
+    std::vector<size_t> order(cnt);
+    for(size_t i = 0; i < cnt; i++) order[i] = i;
+
+    switch(sort_kind(state, kelems, cnt)) {
+    case cSortFixnum:
+      sort_indexes<FixnumLess>(order, kelems);
+      break;
+    case cSortFloat:
+      sort_indexes<FloatLess>(order, kelems);
+      break;
+    case cSortString:
+      sort_indexes<StringLess>(order, kelems);
+      break;
+    default:
+      return (Array*)Primitives::failure();
+    }
+
+    std::vector<Object*> sorted(cnt);
+    std::vector<Object*> sorted_keys(cnt);
+    for(size_t i = 0; i < cnt; i++) {
+      sorted[i] = elems[order[i]];
+      sorted_keys[i] = kelems[order[i]];
+    }
+
+    std::copy(sorted.begin(), sorted.end(), elems);
+    std::copy(sorted_keys.begin(), sorted_keys.end(), kelems);
+
+    return this;
+  }
+
   void Array::Info::show(STATE, Object* self, int level) {
     Array* ary = as<Array>(self);
     size_t size = ary->size();
@@ -46,11 +46,64 @@ namespace rubinius {
     Object* get(STATE, size_t idx);
     Object* set(STATE, size_t idx, Object* val);
     void   unshift(STATE, Object* val);
+    // Ruby.primitive :array_shift
     Object* shift(STATE);
     Object* append(STATE, Object* val);
+    // Ruby.primitive :array_pop
     Object* pop(STATE);
     bool   includes_p(STATE, Object* val);
 
+    /* The primitives below only do what they can without sending a
+     * method. The ones that compare or hash elements fail as soon as they
+     * find one that isn't a Fixnum, Symbol, nil, true, false or plain
+     * String, and the ones that return a new Array fail for subclasses.
+     * The Ruby code in kernel/common/array.rb then does the work. */
+
+    // Ruby.primitive :array_append
+    Array* push(STATE, Object* val);
+
+    // Ruby.primitive :array_concat
+    Array* concat(STATE, Array* other);
+
+    // Ruby.primitive :array_dup
+    Array* dup_prim(STATE);
+
+    // Ruby.primitive :array_include_p
+    Object* include_p(STATE, Object* val);
+
+    // Ruby.primitive :array_index
+    Object* index(STATE, Object* val);
+
+    // Ruby.primitive :array_equal
+    Object* elements_equal(STATE, Array* other);
+
+    // Ruby.primitive :array_hash
+    Object* hash_elements(STATE);
+
+    // Ruby.primitive :array_flatten
+    Array* flatten(STATE);
+
+    // Ruby.primitive :array_compact
+    Array* compact(STATE);
+
+    // Ruby.primitive :array_uniq
+    Array* uniq(STATE);
+
+    /** Sorts in place when the elements are all Fixnums, all Floats or
+     *  all plain Strings, comparing them the way their #<=> would. */
+    // Ruby.primitive :array_sort
+    Array* sort(STATE);
+
+    /** Stable sort of self, in place, by the parallel Array +keys+, which
+     *  is sorted along with it. Same restrictions on the keys as #sort. */
+    // Ruby.primitive :array_sort_by_keys
+    Array* sort_by_keys(STATE, Array* keys);
+
+  private:
+    void shrink(STATE);
+
+  public:
+
     class Info : public TypeInfo {
     public:
       BASIC_TYPEINFO(TypeInfo)
@@ -41,6 +41,8 @@ namespace rubinius {
    * of the mp_set_long, mp_init_set_long and mp_get_long
    * functions here.
    */
+#ifndef MP_64BIT
+  /* 64 bit builds set values with mp_set_small below instead. */
   static int mp_set_long (mp_int * a, unsigned long b)
   {
     int     err;
@@ -70,6 +72,7 @@ namespace rubinius {
     mp_clamp (a);
     return MP_OKAY;
   }
+#endif
 
   static unsigned long mp_get_long (mp_int * a)
   {
@@ -94,6 +97,71 @@ namespace rubinius {
       return res;
   }
 
+#ifdef MP_64BIT
+  /*
+   * With 60 bit digits, a Bignum of at most two digits fits in 120 bits,
+   * which covers everything just past the Fixnum range (64 bit ids,
+   * nanosecond timestamps, ...). Arithmetic on two of those is done on
+   * 128 bit words and the result written straight into the digits, so
+   * libtommath is only used once a value outgrows that.
+   */
+  typedef long          int128 __attribute__ ((mode(TI)));
+  typedef unsigned long uint128 __attribute__ ((mode(TI)));
+
+#define SMALL_DIGITS 2
+
+  static inline bool small_p(mp_int* a) {
+    return a->used <= SMALL_DIGITS;
+  }
+
+  static inline int128 small_value(mp_int* a) {
+    uint128 mag = 0;
+
+    switch(a->used) {
+    case 2:
+      mag = (uint128)DIGIT(a, 1) << DIGIT_BIT;
+      /* fall through */
+    case 1:
+      mag |= DIGIT(a, 0);
+    }
+
+    return a->sign == MP_NEG ? -(int128)mag : (int128)mag;
+  }
+
+  /* Number of significant bits in |v|. */
+  static inline int small_bits(int128 v) {
+    uint128 mag = v < 0 ? -(uint128)v : (uint128)v;
+    uint64_t high = (uint64_t)(mag >> 64);
+
+    if(high) return 128 - __builtin_clzll(high);
+    if(mag) return 64 - __builtin_clzll((uint64_t)mag);
+    return 0;
+  }
+
+  /* Sets +a+, which must already be initialized, to +v+. */
+  static void mp_set_small(mp_int* a, int128 v) {
+    uint128 mag = v < 0 ? -(uint128)v : (uint128)v;
+
+    mp_grow(a, 3);
+    DIGIT(a, 0) = (mp_digit)(mag & MP_MASK);
+    DIGIT(a, 1) = (mp_digit)((mag >> DIGIT_BIT) & MP_MASK);
+    DIGIT(a, 2) = (mp_digit)(mag >> (2 * DIGIT_BIT));
+    a->used = 3;
+    a->sign = v < 0 ? MP_NEG : MP_ZPOS;
+    mp_clamp(a);
+  }
+
+  static Integer* small_result(STATE, int128 v) {
+    if(v >= FIXNUM_MIN && v <= FIXNUM_MAX) {
+      return Fixnum::from((native_int)v);
+    }
+
+    Bignum* big = Bignum::create(state);
+    mp_set_small(big->mp_val(), v);
+    return big;
+  }
+#endif
+
   static void twos_complement(mp_int *a)
   {
     long i = a->used;
@@ -199,7 +267,7 @@ namespace rubinius {
 
   void Bignum::Info::show(STATE, Object* self, int level) {
     Bignum* b = as<Bignum>(self);
-    std::cout << b->to_s(state, Fixnum::from(10))->c_str() << std::endl;
+    std::cout << b->to_s(state, Fixnum::from(10))->c_str(state) << std::endl;
   }
 
   void Bignum::Info::show_simple(STATE, Object* self, int level) {
@@ -251,23 +319,34 @@ namespace rubinius {
     o = Bignum::create(state);
     a = o->mp_val();
 
+#ifdef MP_64BIT
+    mp_set_small(a, num);
+#else
     if(num < 0) {
       mp_set_long(a, (unsigned long)-num);
       a->sign = MP_NEG;
     } else {
       mp_set_long(a, (unsigned long)num);
     }
+#endif
     return o;
   }
 
   Bignum* Bignum::from(STATE, unsigned long num) {
     Bignum* o;
     o = Bignum::create(state);
+#ifdef MP_64BIT
+    mp_set_small(o->mp_val(), num);
+#else
     mp_set_long(o->mp_val(), num);
+#endif
     return o;
   }
 
   Bignum* Bignum::from(STATE, unsigned long long val) {
+#ifdef MP_64BIT
+    return Bignum::from(state, (unsigned long)val);
+#else
     mp_int low, high;
     mp_int* ans;
     mp_init_set_int(&low, val & 0xffffffff);
@@ -282,9 +361,13 @@ namespace rubinius {
     mp_clear(&high);
 
     return ret;
+#endif
   }
 
   Bignum* Bignum::from(STATE, long long val) {
+#ifdef MP_64BIT
+    return Bignum::from(state, (long)val);
+#else
     Bignum* ret;
 
     if(val < 0) {
@@ -295,6 +378,7 @@ namespace rubinius {
     }
 
     return ret;
+#endif
   }
 
   Bignum* Bignum::create(STATE, Fixnum* val) {
@@ -356,6 +440,12 @@ namespace rubinius {
   }
 
   Integer* Bignum::add(STATE, Fixnum* b) {
+#ifdef MP_64BIT
+    if(small_p(mp_val())) {
+      return small_result(state, small_value(mp_val()) + b->to_native());
+    }
+#endif
+
     NMP;
     native_int bi = b->to_native();
     if(bi > 0) {
@@ -367,6 +457,12 @@ namespace rubinius {
   }
 
   Integer* Bignum::add(STATE, Bignum* b) {
+#ifdef MP_64BIT
+    if(small_p(mp_val()) && small_p(b->mp_val())) {
+      return small_result(state, small_value(mp_val()) + small_value(b->mp_val()));
+    }
+#endif
+
     NMP;
     mp_add(mp_val(), b->mp_val(), n);
     return Bignum::normalize(state, n_obj);
@@ -377,6 +473,12 @@ namespace rubinius {
   }
 
   Integer* Bignum::sub(STATE, Fixnum* b) {
+#ifdef MP_64BIT
+    if(small_p(mp_val())) {
+      return small_result(state, small_value(mp_val()) - b->to_native());
+    }
+#endif
+
     NMP;
     native_int bi = b->to_native();
     if(bi > 0) {
@@ -388,6 +490,12 @@ namespace rubinius {
   }
 
   Integer* Bignum::sub(STATE, Bignum* b) {
+#ifdef MP_64BIT
+    if(small_p(mp_val()) && small_p(b->mp_val())) {
+      return small_result(state, small_value(mp_val()) - small_value(b->mp_val()));
+    }
+#endif
+
     NMP;
     mp_sub(mp_val(), b->mp_val(), n);
     return Bignum::normalize(state, n_obj);
@@ -398,6 +506,16 @@ namespace rubinius {
   }
 
   Integer* Bignum::mul(STATE, Fixnum* b) {
+#ifdef MP_64BIT
+    if(small_p(mp_val())) {
+      int128 a = small_value(mp_val());
+      int128 bi = b->to_native();
+      if(small_bits(a) + small_bits(bi) < 127) {
+        return small_result(state, a * bi);
+      }
+    }
+#endif
+
     NMP;
 
     native_int bi = b->to_native();
@@ -415,6 +533,16 @@ namespace rubinius {
   }
 
   Integer* Bignum::mul(STATE, Bignum* b) {
+#ifdef MP_64BIT
+    if(small_p(mp_val()) && small_p(b->mp_val())) {
+      int128 a = small_value(mp_val());
+      int128 bi = small_value(b->mp_val());
+      if(small_bits(a) + small_bits(bi) < 127) {
+        return small_result(state, a * bi);
+      }
+    }
+#endif
+
     NMP;
     mp_mul(mp_val(), b->mp_val(), n);
     return Bignum::normalize(state, n_obj);
@@ -541,7 +669,7 @@ namespace rubinius {
   }
 
   Integer* Bignum::bit_and(STATE, Float* b) {
-    return bit_and(state, Bignum::from_double(state, b->val));
+    return bit_and(state, Bignum::from_double(state, b->val()));
   }
 
   Integer* Bignum::bit_or(STATE, Integer* b) {
@@ -556,7 +684,7 @@ namespace rubinius {
   }
 
   Integer* Bignum::bit_or(STATE, Float* b) {
-    return bit_or(state, Bignum::from_double(state, b->val));
+    return bit_or(state, Bignum::from_double(state, b->val()));
   }
 
   Integer* Bignum::bit_xor(STATE, Integer* b) {
@@ -571,7 +699,7 @@ namespace rubinius {
   }
 
   Integer* Bignum::bit_xor(STATE, Float* b) {
-    return bit_xor(state, Bignum::from_double(state, b->val));
+    return bit_xor(state, Bignum::from_double(state, b->val()));
   }
 
   Integer* Bignum::invert(STATE) {
@@ -657,15 +785,23 @@ namespace rubinius {
   }
 
   Object* Bignum::equal(STATE, Fixnum* b) {
+#ifdef MP_64BIT
+    if(small_p(mp_val())) {
+      return small_value(mp_val()) == b->to_native() ? Qtrue : Qfalse;
+    }
+#endif
+
     native_int bi = b->to_native();
     mp_int* a = mp_val();
     if(bi < 0) {
-      bi = -bi;
       mp_int n;
       mp_init(&n);
       mp_copy(a, &n);
       mp_neg(&n, &n);
-      a = &n;
+
+      int cmp = mp_cmp_d(&n, -bi);
+      mp_clear(&n);
+      return cmp == MP_EQ ? Qtrue : Qfalse;
     }
     if(mp_cmp_d(a, bi) == MP_EQ) {
       return Qtrue;
@@ -685,6 +821,14 @@ namespace rubinius {
   }
 
   Fixnum* Bignum::compare(STATE, Fixnum* b) {
+#ifdef MP_64BIT
+    if(small_p(mp_val())) {
+      int128 a = small_value(mp_val());
+      native_int bi = b->to_native();
+      return Fixnum::from(a < bi ? -1 : (a > bi ? 1 : 0));
+    }
+#endif
+
     native_int bi = b->to_native();
     mp_int* a = mp_val();
     if(bi < 0) {
@@ -693,7 +837,10 @@ namespace rubinius {
       mp_copy(a, &n);
       mp_neg(&n, &n);
 
-      switch(mp_cmp_d(&n, -bi)) {
+      int cmp = mp_cmp_d(&n, -bi);
+      mp_clear(&n);
+
+      switch(cmp) {
         case MP_LT:
           return Fixnum::from(1);
         case MP_GT:
@@ -712,6 +859,14 @@ namespace rubinius {
   }
 
   Fixnum* Bignum::compare(STATE, Bignum* b) {
+#ifdef MP_64BIT
+    if(small_p(mp_val()) && small_p(b->mp_val())) {
+      int128 a = small_value(mp_val());
+      int128 bi = small_value(b->mp_val());
+      return Fixnum::from(a < bi ? -1 : (a > bi ? 1 : 0));
+    }
+#endif
+
     switch(mp_cmp(mp_val(), b->mp_val())) {
       case MP_LT:
         return Fixnum::from(-1);
@@ -961,7 +1116,7 @@ namespace rubinius {
   }
 
   Integer* Bignum::from_float(STATE, Float* f) {
-    return Bignum::from_double(state, f->val);
+    return Bignum::from_double(state, f->val());
   }
 
   Integer* Bignum::from_double(STATE, double d) {
@@ -96,6 +96,10 @@ namespace rubinius {
     ctx->home(state, home_);
 
     ctx->vmm = vmm ? vmm : method_->backend_method_;
+
+    // Blocks are compiled on their own, just like methods, so the block
+    // body of an each or times loop gets to run as machine code.
+    ctx->vmm->called(state);
     ctx->run = ctx->vmm->run;
 
     ctx->ip = 0;
@@ -4,6 +4,7 @@
 #include "vm.hpp"
 #include "objectmemory.hpp"
 #include "primitives.hpp"
+#include "bytes.hpp"
 #include "builtin/class.hpp"
 #include "builtin/exception.hpp"
 #include "builtin/fixnum.hpp"
@@ -129,7 +130,7 @@ namespace rubinius {
     // only compare the shortest string
     native_int len = m < n ? m : n;
 
-    native_int cmp = std::memcmp(this->bytes, other->bytes, len);
+    native_int cmp = bytes::compare(this->bytes, other->bytes, len);
 
     // even if substrings are equal, check actual requested limits
     // of comparison e.g. "xyz", "xyzZ"
@@ -33,6 +33,9 @@ namespace rubinius {
     cm->local_count(state, Fixnum::from(0));
     cm->set_executor(CompiledMethod::default_executor);
     cm->backend_method_ = NULL;
+    cm->body_source_ = NULL;
+    cm->body_offset_ = 0;
+    cm->pending_type_ = NULL;
 
     return cm;
   }
@@ -58,6 +61,7 @@ namespace rubinius {
   }
 
   int CompiledMethod::start_line(STATE) {
+    materialize(state);
     if(lines_->nil_p()) return -1;
     if(lines_->num_fields() < 1) return -1;
     Tuple* top = as<Tuple>(lines_->at(state, 0));
@@ -66,6 +70,8 @@ namespace rubinius {
 
   VMMethod* CompiledMethod::formalize(STATE, bool ondemand) {
     if(!backend_method_) {
+      materialize(state);
+
       VMMethod* vmm = NULL;
 #ifdef ENABLE_LLVM
       /* Controls whether we use LLVM out of the gate or not. */
@@ -85,6 +91,11 @@ namespace rubinius {
 #endif
       backend_method_ = vmm;
 
+      if(vmm && pending_type_) {
+        vmm->specialize(state, pending_type_);
+        pending_type_ = NULL;
+      }
+
       if(!primitive()->nil_p()) {
         if(Symbol* name = try_as<Symbol>(primitive())) {
           set_executor(Primitives::resolve_primitive(state, name));
@@ -97,11 +108,25 @@ namespace rubinius {
   }
 
   void CompiledMethod::specialize(STATE, TypeInfo* ti) {
+    // A stub isn't formalized until it's first run.
+    if(!backend_method_) {
+      pending_type_ = ti;
+      return;
+    }
+
     backend_method_->specialize(state, ti);
   }
 
   Object* CompiledMethod::compile(STATE) {
+    materialize(state);
+
     if(backend_method_ == NULL || backend_method_->run != VMMethod::debugger_interpreter) {
+      // The iseq may have been changed since it was loaded, so build
+      // the new VMMethod from the Tuple.
+      if(InstructionSequence* is = try_as<InstructionSequence>(iseq())) {
+        is->set_mapped_opcodes(NULL);
+      }
+
       backend_method_ = NULL;
       formalize(state);
     }
@@ -116,6 +141,18 @@ namespace rubinius {
 
   void CompiledMethod::post_marshal(STATE) {
     formalize(state); // side-effect, populates backend_method_
+    attach_sendsites(state);
+  }
+
+  void CompiledMethod::materialize_body(STATE) {
+    BinaryUnMarshaller* source = body_source_;
+    body_source_ = NULL;
+
+    source->materialize(this, body_offset_);
+    attach_sendsites(state);
+  }
+
+  void CompiledMethod::attach_sendsites(STATE) {
     // Set the sender attribute of all SendSites in this method to this CM
     Tuple *lit = literals();
     for(std::size_t i = 0; i < lit->num_fields(); i++) {
@@ -157,7 +194,13 @@ namespace rubinius {
 
     JITCompiler jit;
     jit.compile(state, backend_method_);
-    return MachineMethod::create(state, backend_method_, jit);
+
+    MachineMethod* mm = MachineMethod::create(state, backend_method_, jit);
+    if(!mm) {
+      Exception::assertion_error(state, "JIT code cache is full");
+    }
+
+    return mm;
   }
 
   bool CompiledMethod::is_rescue_target(STATE, int ip) {
@@ -203,6 +246,7 @@ namespace rubinius {
 
   void CompiledMethod::Info::show(STATE, Object* self, int level) {
     CompiledMethod* cm = as<CompiledMethod>(self);
+    cm->materialize(state);
 
     class_header(state, self);
     indent_attribute(++level, "exceptions"); cm->exceptions()->show_simple(state, level);
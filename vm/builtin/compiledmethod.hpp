@@ -11,6 +11,7 @@ namespace rubinius {
   class VMMethod;
   class StaticScope;
   class MachineMethod;
+  class BinaryUnMarshaller;
 
   class CompiledMethod : public Executable {
   public:
@@ -18,26 +19,36 @@ namespace rubinius {
 
   private:
     Symbol* name_;               // slot
-    InstructionSequence* iseq_; // slot
+    InstructionSequence* iseq_; // slot lazy
     Fixnum* stack_size_;         // slot
     Fixnum* local_count_;        // slot
     Fixnum* required_args_;      // slot
     Fixnum* total_args_;         // slot
     Object* splat_;              // slot
-    Tuple* exceptions_;         // slot
-    Tuple* lines_;              // slot
-    Tuple* local_names_;        // slot
+    Tuple* exceptions_;         // slot lazy
+    Tuple* lines_;              // slot lazy
+    Tuple* local_names_;        // slot lazy
     Symbol* file_;               // slot
     StaticScope* scope_;        // slot
 
   public:
     // Access directly from assembly, so has to be public.
-    Tuple* literals_;           // slot
+    Tuple* literals_;           // slot lazy
 
     /* accessors */
 
     VMMethod* backend_method_;
 
+  private:
+    // Set while this is a stub loaded from a binary .rbc. The slots
+    // marked lazy are still nil; materialize() reads them from here.
+    BinaryUnMarshaller* body_source_;
+    size_t body_offset_;
+
+    // What specialize() was asked for before there was a VMMethod.
+    TypeInfo* pending_type_;
+
+  public:
 
     attr_accessor(name, Symbol);
     attr_accessor(iseq, InstructionSequence);
@@ -68,6 +79,24 @@ namespace rubinius {
     static CompiledMethod* generate_tramp(STATE, size_t stack_size = tramp_stack_size);
 
     void post_marshal(STATE);
+
+    bool lazy_p() {
+      return body_source_ != NULL;
+    }
+
+    // Makes this a stub whose lazy slots are unmarshalled by +source+
+    // from +offset+ the first time they're needed.
+    void set_lazy_body(BinaryUnMarshaller* source, size_t offset) {
+      body_source_ = source;
+      body_offset_ = offset;
+    }
+
+    // Fills in the lazy slots of a stub. Must be called before reading
+    // them from C++; the generated field accessors used by Ruby do it.
+    void materialize(STATE) {
+      if(unlikely(body_source_ != NULL)) materialize_body(state);
+    }
+
     size_t number_of_locals();
     VMMethod* formalize(STATE, bool ondemand=true);
     void specialize(STATE, TypeInfo* ti);
@@ -94,6 +123,11 @@ namespace rubinius {
     // Ruby.primitive :compiledmethod_is_breakpoint
     Object* is_breakpoint(STATE, Fixnum* ip);
 
+  private:
+    void materialize_body(STATE);
+    void attach_sendsites(STATE);
+
+  public:
     class Info : public TypeInfo {
     public:
       BASIC_TYPEINFO(TypeInfo)
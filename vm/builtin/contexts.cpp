@@ -5,6 +5,7 @@
 #include "builtin/lookuptable.hpp"
 #include "builtin/tuple.hpp"
 
+#include "code_cache.hpp"
 #include "gc_object_mark.hpp"
 #include "objectmemory.hpp"
 
@@ -381,6 +382,9 @@ namespace rubinius {
       mark.gc->object_memory->remember_object(ctx);
     }
 
+    // Keep the machine code the context is running from being freed.
+    state()->code_cache->mark_running(reinterpret_cast<void*>(ctx->run));
+
     auto_mark(obj, mark);
 
     /* Now also mark the stack */
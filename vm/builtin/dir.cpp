@@ -32,7 +32,7 @@ namespace rubinius {
   }
 
   Object* Dir::open(STATE, String* path) {
-    DIR* d = opendir(path->c_str());
+    DIR* d = opendir(path->c_str(state));
 
     if(!d) Exception::errno_error(state, "Unable to open directory");
     data(state, MemoryPointer::create(state, d));
@@ -182,7 +182,7 @@ namespace rubinius {
   }
 
   Object* Fixnum::equal(STATE, Float* other) {
-    return (double)to_native() == other->val ? Qtrue : Qfalse;
+    return (double)to_native() == other->val() ? Qtrue : Qfalse;
   }
 
   Fixnum* Fixnum::compare(STATE, Fixnum* other) {
@@ -210,7 +210,7 @@ namespace rubinius {
 
   Fixnum* Fixnum::compare(STATE, Float* other) {
     double left  = (double)to_native();
-    double right = other->val;
+    double right = other->val();
     if(left == right) {
       return Fixnum::from(0);
     } else if(left < right) {
@@ -225,7 +225,7 @@ namespace rubinius {
   }
 
   Object* Fixnum::gt(STATE, Float* other) {
-    return (double) to_native() > other->val ? Qtrue : Qfalse;
+    return (double) to_native() > other->val() ? Qtrue : Qfalse;
   }
 
   Object* Fixnum::ge(STATE, Fixnum* other) {
@@ -237,7 +237,7 @@ namespace rubinius {
   }
 
   Object* Fixnum::ge(STATE, Float* other) {
-    return (double) to_native() >= other->val ? Qtrue : Qfalse;
+    return (double) to_native() >= other->val() ? Qtrue : Qfalse;
   }
 
   Object* Fixnum::lt(STATE, Bignum* other) {
@@ -245,7 +245,7 @@ namespace rubinius {
   }
 
   Object* Fixnum::lt(STATE, Float* other) {
-    return (double) to_native() < other->val ? Qtrue : Qfalse;
+    return (double) to_native() < other->val() ? Qtrue : Qfalse;
   }
 
   Object* Fixnum::le(STATE, Fixnum* other) {
@@ -257,7 +257,7 @@ namespace rubinius {
   }
 
   Object* Fixnum::le(STATE, Float* other) {
-    return (double) to_native() <= other->val ? Qtrue : Qfalse;
+    return (double) to_native() <= other->val() ? Qtrue : Qfalse;
   }
 
   Integer* Fixnum::left_shift(STATE, Fixnum* bits) {
@@ -298,7 +298,7 @@ namespace rubinius {
   }
 
   Integer* Fixnum::bit_and(STATE, Float* other) {
-    return Fixnum::from(to_native() & (native_int)other->val);
+    return Fixnum::from(to_native() & (native_int)other->val());
   }
 
   Integer* Fixnum::bit_or(STATE, Fixnum* other) {
@@ -310,7 +310,7 @@ namespace rubinius {
   }
 
   Integer* Fixnum::bit_or(STATE, Float* other) {
-    return Fixnum::from(to_native() | (native_int)other->val);
+    return Fixnum::from(to_native() | (native_int)other->val());
   }
 
   Integer* Fixnum::bit_xor(STATE, Fixnum* other) {
@@ -322,7 +322,7 @@ namespace rubinius {
   }
 
   Integer* Fixnum::bit_xor(STATE, Float* other) {
-    return Fixnum::from(to_native() ^ (native_int)other->val);
+    return Fixnum::from(to_native() ^ (native_int)other->val());
   }
 
   Integer* Fixnum::invert(STATE) {
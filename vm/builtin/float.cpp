@@ -19,6 +19,12 @@ namespace rubinius {
     GO(floatpoint).set(state->new_class("Float", G(numeric)));
     G(floatpoint)->set_object_type(state, FloatType);
 
+#ifdef IS_X8664
+    for(size_t i = 0; i < SPECIAL_CLASS_SIZE; i++) {
+      if(FLONUM_P(i)) state->globals.special_classes[i] = GO(floatpoint);
+    }
+#endif
+
     G(floatpoint)->set_const(state, "RADIX",      Fixnum::from(FLT_RADIX));
     G(floatpoint)->set_const(state, "ROUNDS",     Fixnum::from(FLT_ROUNDS));
     G(floatpoint)->set_const(state, "MIN",        Float::create(state, DBL_MIN));
@@ -34,8 +40,12 @@ namespace rubinius {
   }
 
   Float* Float::create(STATE, double val) {
+#ifdef IS_X8664
+    if(Float* flt = to_flonum(val)) return flt;
+#endif
+
     Float* flt = state->new_struct<Float>(G(floatpoint));
-    flt->val = val;
+    flt->value_ = val;
     return flt;
   }
 
@@ -52,50 +62,50 @@ namespace rubinius {
   }
 
   Float* Float::add(STATE, Float* other) {
-    return Float::create(state, this->val + other->val);
+    return Float::create(state, val() + other->val());
   }
 
   Float* Float::add(STATE, Integer* other) {
-    return Float::create(state, this->val + Float::coerce(state, other)->val);
+    return Float::create(state, val() + Float::coerce(state, other)->val());
   }
 
   Float* Float::sub(STATE, Float* other) {
-    return Float::create(state, this->val - other->val);
+    return Float::create(state, val() - other->val());
   }
 
   Float* Float::sub(STATE, Integer* other) {
-    return Float::create(state, this->val - Float::coerce(state, other)->val);
+    return Float::create(state, val() - Float::coerce(state, other)->val());
   }
 
   Float* Float::mul(STATE, Float* other) {
-    return Float::create(state, this->val * other->val);
+    return Float::create(state, val() * other->val());
   }
 
   Float* Float::mul(STATE, Integer* other) {
-    return Float::create(state, this->val * Float::coerce(state, other)->val);
+    return Float::create(state, val() * Float::coerce(state, other)->val());
   }
 
   Float* Float::fpow(STATE, Float* other) {
-    return Float::create(state, pow(this->val, other->val));
+    return Float::create(state, pow(val(), other->val()));
   }
 
   Float* Float::fpow(STATE, Integer* other) {
-    return Float::create(state, pow(this->val, Float::coerce(state, other)->val));
+    return Float::create(state, pow(val(), Float::coerce(state, other)->val()));
   }
 
   Float* Float::div(STATE, Float* other) {
-    return Float::create(state, this->val / other->val);
+    return Float::create(state, val() / other->val());
   }
 
   Float* Float::div(STATE, Integer* other) {
-    return Float::create(state, this->val / Float::coerce(state, other)->val);
+    return Float::create(state, val() / Float::coerce(state, other)->val());
   }
 
   Float* Float::mod(STATE, Float* other) {
-    double res = fmod(this->val, other->val);
-    if((other->val < 0.0 && this->val > 0.0) ||
-       (other->val > 0.0 && this->val < 0.0)) {
-      res += other->val;
+    double res = fmod(val(), other->val());
+    if((other->val() < 0.0 && val() > 0.0) ||
+       (other->val() > 0.0 && val() < 0.0)) {
+      res += other->val();
     }
     return Float::create(state, res);
   }
@@ -106,7 +116,7 @@ namespace rubinius {
 
   Array* Float::divmod(STATE, Float* other) {
     Array* ary = Array::create(state, 2);
-    ary->set(state, 0, Bignum::from_double(state, floor(this->val / other->val) ));
+    ary->set(state, 0, Bignum::from_double(state, floor(val() / other->val()) ));
     ary->set(state, 1, mod(state, other));
     return ary;
   }
@@ -116,11 +126,11 @@ namespace rubinius {
   }
 
   Float* Float::neg(STATE) {
-    return Float::create(state, -this->val);
+    return Float::create(state, -val());
   }
 
   Object* Float::equal(STATE, Float* other) {
-    if(this->val == other->val) {
+    if(val() == other->val()) {
       return Qtrue;
     }
     return Qfalse;
@@ -128,14 +138,14 @@ namespace rubinius {
 
   Object* Float::equal(STATE, Integer* other) {
     Float* o = Float::coerce(state, other);
-    if(this->val == o->val) {
+    if(val() == o->val()) {
       return Qtrue;
     }
     return Qfalse;
   }
 
   Object* Float::eql(STATE, Float* other) {
-    if(this->val == other->val) {
+    if(val() == other->val()) {
       return Qtrue;
     }
     return Qfalse;
@@ -146,9 +156,9 @@ namespace rubinius {
   }
 
   Fixnum* Float::compare(STATE, Float* other) {
-    if(this->val == other->val) {
+    if(val() == other->val()) {
       return Fixnum::from(0);
-    } else if(this->val > other->val) {
+    } else if(val() > other->val()) {
       return Fixnum::from(1);
     } else {
       return Fixnum::from(-1);
@@ -157,9 +167,9 @@ namespace rubinius {
 
   Fixnum* Float::compare(STATE, Integer* other) {
     Float* o = Float::coerce(state, other);
-    if(this->val == o->val) {
+    if(val() == o->val()) {
       return Fixnum::from(0);
-    } else if(this->val > o->val) {
+    } else if(val() > o->val()) {
       return Fixnum::from(1);
     } else {
       return Fixnum::from(-1);
@@ -167,63 +177,63 @@ namespace rubinius {
   }
 
   Object* Float::gt(STATE, Float* other) {
-    return this->val > other->val ? Qtrue : Qfalse;
+    return val() > other->val() ? Qtrue : Qfalse;
   }
 
   Object* Float::gt(STATE, Integer* other) {
-    return this->val > Float::coerce(state, other)->val ? Qtrue : Qfalse;
+    return val() > Float::coerce(state, other)->val() ? Qtrue : Qfalse;
   }
 
   Object* Float::ge(STATE, Float* other) {
-    return this->val >= other->val ? Qtrue : Qfalse;
+    return val() >= other->val() ? Qtrue : Qfalse;
   }
 
   Object* Float::ge(STATE, Integer* other) {
-    return this->val >= Float::coerce(state, other)->val ? Qtrue : Qfalse;
+    return val() >= Float::coerce(state, other)->val() ? Qtrue : Qfalse;
   }
 
   Object* Float::lt(STATE, Float* other) {
-    return this->val < other->val ? Qtrue : Qfalse;
+    return val() < other->val() ? Qtrue : Qfalse;
   }
 
   Object* Float::lt(STATE, Integer* other) {
-    return this->val < Float::coerce(state, other)->val ? Qtrue : Qfalse;
+    return val() < Float::coerce(state, other)->val() ? Qtrue : Qfalse;
   }
 
   Object* Float::le(STATE, Float* other) {
-    return this->val <= other->val ? Qtrue : Qfalse;
+    return val() <= other->val() ? Qtrue : Qfalse;
   }
 
   Object* Float::le(STATE, Integer* other) {
-    return this->val <= Float::coerce(state, other)->val ? Qtrue : Qfalse;
+    return val() <= Float::coerce(state, other)->val() ? Qtrue : Qfalse;
   }
 
   Object* Float::fisinf(STATE) {
-    if(std::isinf(this->val) != 0) {
-      return this->val < 0 ? Fixnum::from(-1) : Fixnum::from(1);
+    if(std::isinf(val()) != 0) {
+      return val() < 0 ? Fixnum::from(-1) : Fixnum::from(1);
     } else {
       return Qnil;
     }
   }
 
   Object* Float::fisnan(STATE) {
-    return std::isnan(this->val) == 1 ? Qtrue : Qfalse;
+    return std::isnan(val()) == 1 ? Qtrue : Qfalse;
   }
 
   Integer* Float::fround(STATE) {
-    double value = this->val;
+    double value = val();
     if (value > 0.0) value = floor(value+0.5);
     if (value < 0.0) value = ceil(value-0.5);
     return Bignum::from_double(state, value);
   }
 
   Integer* Float::to_i(STATE) {
-    if(this->val > 0.0) {
-      return Bignum::from_double(state, floor(this->val));
-    } else if(this->val < 0.0) {
-      return Bignum::from_double(state, ceil(this->val));
+    if(val() > 0.0) {
+      return Bignum::from_double(state, floor(val()));
+    } else if(val() < 0.0) {
+      return Bignum::from_double(state, ceil(val()));
     }
-    return Bignum::from_double(state, this->val);
+    return Bignum::from_double(state, val());
   }
 
 /* It requires "%.1022f" to print all digits of Float::MIN.
@@ -234,7 +244,7 @@ namespace rubinius {
   String* Float::to_s_formatted(STATE, String* format) {
     char str[FLOAT_TO_S_STRLEN];
 
-    size_t size = snprintf(str, FLOAT_TO_S_STRLEN, format->c_str(), val);
+    size_t size = snprintf(str, FLOAT_TO_S_STRLEN, format->c_str(state), val());
 
     if(size >= FLOAT_TO_S_STRLEN) {
       std::ostringstream msg;
@@ -246,14 +256,14 @@ namespace rubinius {
   }
 
   void Float::into_string(STATE, char* buf, size_t sz) {
-    snprintf(buf, sz, "%+.17e", val);
+    snprintf(buf, sz, "%+.17e", val());
   }
 
   void Float::Info::mark(Object* t, ObjectMark& mark) { }
 
   void Float::Info::show(STATE, Object* self, int level) {
     Float* f = as<Float>(self);
-    std::cout << f->val << std::endl;
+    std::cout << f->val() << std::endl;
   }
 
   void Float::Info::show_simple(STATE, Object* self, int level) {
@@ -17,20 +17,65 @@ namespace rubinius {
   class Array;
   class String;
 
+  /**
+   *  Ruby's Float.
+   *
+   *  On 64-bit most Floats are immediates tagged with TAG_FLONUM, so +this+
+   *  may not point at anything. Always read the value through val() and
+   *  make new ones with create(); see oop.hpp for the encoding.
+   */
   class Float : public Numeric {
   public:
     const static object_type type = FloatType;
 
     static bool is_a(Object* obj) {
-      return obj->obj_type == FloatType;
+      return FLONUM_P(obj) || obj->obj_type == FloatType;
     }
 
-    double val;
+  private:
+    double value_;
 
+  public:
     static void init(STATE);
     static Float* create(STATE, double val);
     static Float* coerce(STATE, Object* value);
-    double to_double(STATE) { return val; }
+
+    double val() const {
+#ifdef IS_X8664
+      if(FLONUM_P(this)) return from_flonum((uintptr_t)this);
+#endif
+      return value_;
+    }
+
+    double to_double(STATE) { return val(); }
+
+#ifdef IS_X8664
+    /** The immediate for +val+, or NULL if it has to be boxed. */
+    static Float* to_flonum(double val) {
+      union { double d; uint64_t i; } bits;
+      bits.d = val;
+
+      uint64_t top = bits.i >> 59;
+      if((top == 7 && bits.i != 0x3800000000000000UL) || top == 8 || top == 0x17 || top == 0x18) {
+        uint64_t v = (bits.i << 4) | (bits.i >> 60);
+        return (Float*)((v & ~(uint64_t)TAG_FLONUM_MASK) | TAG_FLONUM);
+      } else if(bits.i == 0) {
+        return (Float*)FLONUM_ZERO;
+      }
+
+      return NULL;
+    }
+
+    static double from_flonum(uintptr_t v) {
+      union { double d; uint64_t i; } bits;
+
+      if(v == FLONUM_ZERO) return 0.0;
+
+      v = (v & ~(uint64_t)TAG_FLONUM_MASK) | ((v >> 63) ? 3 : 4);
+      bits.i = (v >> 4) | (v << 60);
+      return bits.d;
+    }
+#endif
     void into_string(STATE, char* buf, size_t sz);
 
     // Ruby.primitive! :float_add
@@ -0,0 +1,278 @@
+#include "vm.hpp"
+#include "vm/object_utils.hpp"
+#include "objectmemory.hpp"
+#include "primitives.hpp"
+
+#include "builtin/hash.hpp"
+#include "builtin/class.hpp"
+#include "builtin/fixnum.hpp"
+#include "builtin/string.hpp"
+#include "builtin/symbol.hpp"
+#include "builtin/tuple.hpp"
+
+#include <iostream>
+
+#define entry_hash(e) ((e) * cEntryFields)
+#define entry_key(e) ((e) * cEntryFields + 1)
+#define entry_value(e) ((e) * cEntryFields + 2)
+
+namespace rubinius {
+  void Hash::init(STATE) {
+    GO(hash).set(state->new_class("Hash", G(object)));
+    G(hash)->set_object_type(state, HashType);
+    G(hash)->set_const(state, "MAX_HASH", Fixnum::from(FIXNUM_MAX));
+  }
+
+  Hash* Hash::create(STATE, size_t size) {
+    Hash* hash = state->new_object<Hash>(G(hash));
+    hash->setup(state, size);
+
+    return hash;
+  }
+
+  void Hash::setup(STATE, size_t size) {
+    entries(state, Tuple::create(state, capacity(size) * cEntryFields));
+    index(state, Tuple::create(state, size));
+    count(state, Fixnum::from(0));
+    used(state, Fixnum::from(0));
+  }
+
+  /* The Hash.allocate primitive. */
+  Hash* Hash::allocate(STATE, Object* self) {
+    Hash* hash = create(state);
+    hash->klass(state, as<Class>(self));
+    return hash;
+  }
+
+  bool Hash::simple_key_p(STATE, Object* key) {
+    if(key->fixnum_p() || key->symbol_p()) return true;
+    if(key->nil_p() || key->true_p() || key->false_p()) return true;
+
+    return key->reference_p() && key->klass() == G(string);
+  }
+
+  native_int Hash::key_hash(STATE, Object* key) {
+    return key->hash(state) & FIXNUM_MAX;
+  }
+
+  /* Returns the entry number holding +key+, or -1. +key+ must be a simple
+   * key, so it is never sent #eql?. */
+  native_int Hash::lookup(STATE, Object* key, native_int hash) {
+    size_t mask = index_->num_fields() - 1;
+    size_t perturb = hash;
+    size_t i = hash & mask;
+    Object* tagged = Fixnum::from(hash);
+    String* str = try_as<String>(key);
+
+    for(;;) {
+      Object* slot = index_->field[i];
+      if(slot->nil_p()) return -1;
+
+      native_int entry = as<Fixnum>(slot)->to_native();
+      if(entries_->field[entry_hash(entry)] == tagged) {
+        Object* other = entries_->field[entry_key(entry)];
+        if(other == key) return entry;
+        if(str && kind_of<String>(other) &&
+            String::string_equal_p(state, str, other)) return entry;
+      }
+
+      i = (i * 5 + perturb + 1) & mask;
+      perturb >>= 5;
+    }
+  }
+
+  void Hash::index_entry(STATE, Tuple* index, native_int hash, size_t entry) {
+    size_t mask = index->num_fields() - 1;
+    size_t perturb = hash;
+    size_t i = hash & mask;
+
+    while(!index->field[i]->nil_p()) {
+      i = (i * 5 + perturb + 1) & mask;
+      perturb >>= 5;
+    }
+
+    index->put(state, i, Fixnum::from(entry));
+  }
+
+  /* Copies the live entries, in order, into tables for an index of +size+
+   * slots. Entry numbers change, so this is the only place they do. */
+  void Hash::resize(STATE, size_t size) {
+    Tuple* new_entries = Tuple::create(state, capacity(size) * cEntryFields);
+    Tuple* new_index = Tuple::create(state, size);
+    size_t num = used_->to_native();
+    size_t live = 0;
+    size_t i = 0;
+
+    // Live entries are copied a run at a time.
+    while(i < num) {
+      if(entries_->field[entry_hash(i)]->nil_p()) {
+        i++;
+        continue;
+      }
+
+      size_t first = i;
+      for(; i < num; i++) {
+        Object* hash = entries_->field[entry_hash(i)];
+        if(hash->nil_p()) break;
+
+        index_entry(state, new_index, as<Fixnum>(hash)->to_native(), live + i - first);
+      }
+
+      new_entries->copy_fields(state, entry_hash(live), entries_,
+                               entry_hash(first), (i - first) * cEntryFields);
+      live += i - first;
+    }
+
+    entries(state, new_entries);
+    index(state, new_index);
+    count(state, Fixnum::from(live));
+    used(state, Fixnum::from(live));
+  }
+
+  void Hash::add(STATE, native_int hash, Object* key, Object* value) {
+    size_t size = index_->num_fields();
+    size_t entry = used_->to_native();
+
+    if(entry >= capacity(size)) {
+      // Only grow if deleted entries wouldn't free up much room.
+      if((size_t)count_->to_native() * 2 >= capacity(size)) size <<= 1;
+      resize(state, size);
+      entry = used_->to_native();
+    }
+
+    entries_->put(state, entry_hash(entry), Fixnum::from(hash));
+    entries_->put(state, entry_key(entry), key);
+    entries_->put(state, entry_value(entry), value);
+    index_entry(state, index_, hash, entry);
+
+    used(state, Fixnum::from(entry + 1));
+    count(state, Fixnum::from(count_->to_native() + 1));
+  }
+
+  Object* Hash::aref(STATE, Object* key) {
+    if(!simple_key_p(state, key)) return Primitives::failure();
+
+    native_int entry = lookup(state, key, key_hash(state, key));
+    if(entry < 0) return Primitives::failure();
+
+    return entries_->field[entry_value(entry)];
+  }
+
+  Object* Hash::store(STATE, Object* key, Object* value) {
+    if(!simple_key_p(state, key)) return Primitives::failure();
+
+    native_int hash = key_hash(state, key);
+    native_int entry = lookup(state, key, hash);
+
+    if(entry >= 0) {
+      entries_->put(state, entry_value(entry), value);
+      return value;
+    }
+
+    if(String* str = try_as<String>(key)) {
+      if(!str->IsFrozen) {
+        key = str->string_dup(state);
+        key->freeze();
+      }
+    }
+
+    add(state, hash, key, value);
+    return value;
+  }
+
+  Object* Hash::remove(STATE, Object* key) {
+    if(!simple_key_p(state, key)) return Primitives::failure();
+
+    native_int entry = lookup(state, key, key_hash(state, key));
+    if(entry < 0) return Primitives::failure();
+
+    return delete_entry(state, Fixnum::from(entry));
+  }
+
+  Object* Hash::find_entry(STATE, Object* key) {
+    if(!simple_key_p(state, key)) return Primitives::failure();
+
+    native_int entry = lookup(state, key, key_hash(state, key));
+    if(entry < 0) return Qnil;
+
+    return Fixnum::from(entry);
+  }
+
+  Object* Hash::insert(STATE, Fixnum* hash, Object* key, Object* value) {
+    native_int hsh = hash->to_native();
+    if(hsh < 0) {
+      Exception::argument_error(state, "hash must not be negative");
+    }
+
+    add(state, hsh, key, value);
+    return value;
+  }
+
+  Object* Hash::delete_entry(STATE, Fixnum* entry) {
+    native_int e = entry->to_native();
+    if(e < 0 || e >= used_->to_native()) {
+      Exception::object_bounds_exceeded_error(state, this, e);
+    }
+
+    Object* value = entries_->field[entry_value(e)];
+    if(entries_->field[entry_hash(e)]->nil_p()) return Qnil;
+
+    // The index slot still points here; the nil hash makes probes skip it.
+    entries_->put(state, entry_hash(e), Qnil);
+    entries_->put(state, entry_key(e), Qnil);
+    entries_->put(state, entry_value(e), Qnil);
+    count(state, Fixnum::from(count_->to_native() - 1));
+
+    return value;
+  }
+
+  Hash* Hash::rebuild(STATE) {
+    resize(state, index_->num_fields());
+    return this;
+  }
+
+  Hash* Hash::rehash(STATE) {
+    size_t num = used_->to_native();
+
+    for(size_t i = 0; i < num; i++) {
+      if(entries_->field[entry_hash(i)]->nil_p()) continue;
+
+      Object* key = entries_->field[entry_key(i)];
+      if(!simple_key_p(state, key)) return (Hash*)Primitives::failure();
+
+      entries_->put(state, entry_hash(i), Fixnum::from(key_hash(state, key)));
+    }
+
+    return rebuild(state);
+  }
+
+  Hash* Hash::clear(STATE) {
+    setup(state, cMinSize);
+    return this;
+  }
+
+  void Hash::Info::show(STATE, Object* self, int level) {
+    Hash* hash = as<Hash>(self);
+    size_t count = hash->count()->to_native();
+    size_t used = hash->used()->to_native();
+    Tuple* entries = hash->entries();
+
+    if(count == 0) {
+      class_info(state, self, true);
+      return;
+    }
+
+    class_info(state, self);
+    std::cout << ": " << count << std::endl;
+    ++level;
+    for(size_t i = 0; i < used; i++) {
+      if(entries->at(state, entry_hash(i))->nil_p()) continue;
+
+      indent(level);
+      entries->at(state, entry_key(i))->show_simple(state, level);
+      indent(level + 1);
+      entries->at(state, entry_value(i))->show_simple(state, level + 1);
+    }
+    close_body(level);
+  }
+}
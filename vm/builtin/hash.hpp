@@ -0,0 +1,121 @@
+#ifndef RBX_BUILTIN_HASH_HPP
+#define RBX_BUILTIN_HASH_HPP
+
+#include "builtin/object.hpp"
+#include "type_info.hpp"
+
+namespace rubinius {
+
+  class Tuple;
+
+  /**
+   *  Ruby's Hash, stored the way CPython stores dicts.
+   *
+   *  entries holds (hash, key, value) triples in insertion order, so
+   *  iterating is a walk over one Tuple. A deleted entry keeps its place
+   *  with a nil hash until the next resize squeezes it out.
+   *
+   *  index is an open addressed table of entry numbers, nil where empty.
+   *  It is probed with the perturbed sequence
+   *
+   *    i = (i * 5 + perturb + 1) & mask; perturb >>= 5
+   *
+   *  starting at hash & mask, which copes with keys whose hashes only
+   *  differ in the high bits without having to mix the hash first. The
+   *  Ruby side walks the same sequence for keys that need #hash and #eql?
+   *  sent to them, so both sides have to agree on it.
+   *
+   *  The hash stored is key.hash & MAX_HASH, which is always a Fixnum.
+   *
+   *  Fixnum, Symbol, nil, true, false and plain String keys are hashed and
+   *  compared here without any sends; the primitives fail for any other
+   *  key and the Ruby code takes over.
+   */
+  class Hash : public Object {
+  public:
+    const static object_type type = HashType;
+
+    const static size_t cMinSize = 16;
+    const static size_t cEntryFields = 3;
+
+  private:
+    Tuple* entries_;  // slot
+    Tuple* index_;    // slot
+    Fixnum* count_;   // slot
+    Fixnum* used_;    // slot
+
+  public:
+    /* accessors */
+
+    attr_accessor(entries, Tuple);
+    attr_accessor(index, Tuple);
+    attr_accessor(count, Fixnum);
+    attr_accessor(used, Fixnum);
+
+    /* interface */
+
+    static void init(STATE);
+    static Hash* create(STATE, size_t size = cMinSize);
+    void setup(STATE, size_t size);
+
+    // Ruby.primitive :hash_allocate
+    static Hash* allocate(STATE, Object* self);
+
+    // Ruby.primitive :hash_aref
+    Object* aref(STATE, Object* key);
+
+    // Ruby.primitive :hash_store
+    Object* store(STATE, Object* key, Object* value);
+
+    // Ruby.primitive :hash_delete
+    Object* remove(STATE, Object* key);
+
+    /** Entry number for +key+, or nil. */
+    // Ruby.primitive :hash_find_entry
+    Object* find_entry(STATE, Object* key);
+
+    /** Appends a new entry with a hash computed by the caller. */
+    // Ruby.primitive :hash_insert
+    Object* insert(STATE, Fixnum* hash, Object* key, Object* value);
+
+    /** Deletes entry number +entry+ and returns its value. */
+    // Ruby.primitive :hash_delete_entry
+    Object* delete_entry(STATE, Fixnum* entry);
+
+    /** Rebuilds index from the hashes in entries, dropping deleted ones. */
+    // Ruby.primitive :hash_rebuild
+    Hash* rebuild(STATE);
+
+    /** Rehashes every key; fails if a key needs #hash sent to it. */
+    // Ruby.primitive :hash_rehash
+    Hash* rehash(STATE);
+
+    // Ruby.primitive :hash_clear
+    Hash* clear(STATE);
+
+    /** True if +key+ can be hashed and compared without sending to it. */
+    static bool simple_key_p(STATE, Object* key);
+
+    /** The hash stored for a simple key. */
+    static native_int key_hash(STATE, Object* key);
+
+    static size_t capacity(size_t size) {
+      return size - (size >> 2);
+    }
+
+  private:
+    native_int lookup(STATE, Object* key, native_int hash);
+    void add(STATE, native_int hash, Object* key, Object* value);
+    void index_entry(STATE, Tuple* index, native_int hash, size_t entry);
+    void resize(STATE, size_t size);
+
+  public:
+    class Info : public TypeInfo {
+    public:
+      BASIC_TYPEINFO(TypeInfo)
+      virtual void show(STATE, Object* self, int level);
+    };
+  };
+};
+
+#endif
@@ -55,7 +55,7 @@ namespace rubinius {
   }
 
   Fixnum* IO::open(STATE, String* path, Fixnum* mode, Fixnum* perm) {
-    int fd = ::open(path->c_str(), mode->to_native(), perm->to_native());
+    int fd = ::open(path->c_str(state), mode->to_native(), perm->to_native());
     return Fixnum::from(fd);
   }
 
@@ -213,7 +213,7 @@ namespace rubinius {
   }
 
   Object* IO::write(STATE, String* buf) {
-    ssize_t cnt = ::write(this->to_fd(), buf->data()->bytes, buf->size());
+    ssize_t cnt = ::write(this->to_fd(), buf->byte_address(), buf->size());
 
     if(cnt == -1) {
       Exception::errno_error(state);
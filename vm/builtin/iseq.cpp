@@ -10,8 +10,14 @@ namespace rubinius {
     G(iseq)->set_object_type(state, InstructionSequenceType);
   }
 
-  InstructionSequence* InstructionSequence::create(STATE, size_t instructions) {
+  InstructionSequence* InstructionSequence::allocate(STATE) {
     InstructionSequence* is = state->new_object<InstructionSequence>(G(iseq));
+    is->mapped_opcodes_ = NULL;
+    return is;
+  }
+
+  InstructionSequence* InstructionSequence::create(STATE, size_t instructions) {
+    InstructionSequence* is = allocate(state);
     is->opcodes(state, Tuple::create(state, instructions));
     return is;
   }
@@ -15,15 +15,33 @@ namespace rubinius {
     Tuple* opcodes_;     // slot
     Fixnum* stack_depth_; // slot
 
+    // The same opcodes as a raw array, when loaded from a binary .rbc.
+    uint32_t* mapped_opcodes_;
+
   public:
     /* accessors */
 
     attr_accessor(opcodes, Tuple);
     attr_accessor(stack_depth, Fixnum);
 
+    uint32_t* mapped_opcodes() {
+      return mapped_opcodes_;
+    }
+
+    // +ops+ must hold what opcodes() does, and stay valid for as long as
+    // the VM runs. Cleared when the method is recompiled, since opcodes()
+    // could have been changed by then.
+    void set_mapped_opcodes(uint32_t* ops) {
+      mapped_opcodes_ = ops;
+    }
+
     /* interface */
 
     static void init(STATE);
+
+    // Ruby.primitive :iseq_allocate
+    static InstructionSequence* allocate(STATE);
+
     static InstructionSequence* create(STATE, size_t instructions);
 
     static size_t instruction_width(size_t op);
@@ -15,10 +15,9 @@
 #define LOOKUPTABLE_MAX_DENSITY 0.75
 #define LOOKUPTABLE_MIN_DENSITY 0.3
 
-#define key_hash(obj) (((unsigned int)(uintptr_t)obj))
-#define find_bin(hash, bins) (hash & ((bins) - 1))
 #define max_density_p(ents,bins) (ents >= LOOKUPTABLE_MAX_DENSITY * bins)
 #define min_density_p(ents,bins) (ents < LOOKUPTABLE_MIN_DENSITY * bins)
+#define empty_p(key) ((key) == Qundef)
 #define key_to_sym(key) \
   if(String* _str = try_as<String>(key)) { \
     key = _str->to_sym(state); \
@@ -26,6 +25,20 @@
 
 
 namespace rubinius {
+  /* Keys are almost always Symbols or Fixnums, whose pointer values are
+   * small consecutive integers shifted over the tag bits, so using them
+   * directly would leave most bins unused and make long probe runs. This
+   * is the MurmurHash3 finalizer cut down to a single multiply. */
+  static inline size_t key_hash(Object* key) {
+    uint64_t h = (uintptr_t)key;
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+
+    return (size_t)h;
+  }
+
   LookupTable* LookupTable::create(STATE, size_t size) {
     LookupTable *tbl;
 
@@ -37,6 +50,7 @@ namespace rubinius {
 
   void LookupTable::setup(STATE, size_t sz = 0) {
     if(!sz) sz = LOOKUPTABLE_MIN_SIZE;
+    keys(state, Tuple::pattern(state, Fixnum::from(sz), Qundef));
     values(state, Tuple::create(state, sz));
     bins(state, Fixnum::from(sz));
     entries(state, Fixnum::from(0));
@@ -49,55 +63,51 @@ namespace rubinius {
     return tbl;
   }
 
+  /* The keys hash the same in a table of the same size, so the bins can
+   * be copied as they are. */
   LookupTable* LookupTable::dup(STATE) {
-    size_t size, i;
     LookupTable *dup;
 
-    size = bins_->to_native();
-    dup = LookupTable::create(state, size);
-    state->om->set_class(dup, class_object(state));
-    size_t num = entries_->to_native();
+    dup = state->new_object<LookupTable>(class_object(state));
+    dup->keys(state, as<Tuple>(keys_->dup(state)));
+    dup->values(state, as<Tuple>(values_->dup(state)));
+    dup->bins(state, bins_);
+    dup->entries(state, entries_);
 
-    Array* entries = all_entries(state);
-    for(i = 0; i < num; i++) {
-      LookupTableBucket* entry = as<LookupTableBucket>(entries->get(state, i));
-      dup->store(state, entry->key(), entry->value());
-    }
     return dup;
   }
 
-  void LookupTable::redistribute(STATE, size_t size) {
-    size_t num = bins_->to_native();
-    Tuple* new_values = Tuple::create(state, size);
+  /* Puts +key+ in the first empty bin of its probe run. The caller has
+   * made sure +key+ isn't already in the table and that there is room. */
+  void LookupTable::insert(STATE, Object* key, Object* val) {
+    size_t mask = bins_->to_native() - 1;
+    size_t bin = key_hash(key) & mask;
 
-    for(size_t i = 0; i < num; i++) {
-      LookupTableBucket* entry = try_as<LookupTableBucket>(values_->at(state, i));
+    while(!empty_p(keys_->field[bin])) {
+      bin = (bin + 1) & mask;
+    }
 
-      while(entry) {
-        LookupTableBucket* link = try_as<LookupTableBucket>(entry->next());
-        entry->next(state, reinterpret_cast<LookupTableBucket *>(Qnil));
+    keys_->put(state, bin, key);
+    values_->put(state, bin, val);
+  }
 
-        size_t bin = find_bin(key_hash(entry->key()), size);
-        LookupTableBucket* slot = try_as<LookupTableBucket>(new_values->at(state, bin));
+  void LookupTable::redistribute(STATE, size_t size) {
+    size_t num = bins_->to_native();
+    Tuple* old_keys = keys_;
+    Tuple* old_values = values_;
 
-        if(slot) {
-          slot->append(state, entry);
-        } else {
-          new_values->put(state, bin, entry);
-        }
+    keys(state, Tuple::pattern(state, Fixnum::from(size), Qundef));
+    values(state, Tuple::create(state, size));
+    bins(state, Fixnum::from(size));
 
-        entry = link;
-      }
+    for(size_t i = 0; i < num; i++) {
+      Object* key = old_keys->field[i];
+      if(!empty_p(key)) insert(state, key, old_values->field[i]);
     }
-
-    values(state, new_values);
-    bins(state, Fixnum::from(size));
   }
 
   Object* LookupTable::store(STATE, Object* key, Object* val) {
-    unsigned int num_entries, num_bins, bin;
-    LookupTableBucket* entry;
-    LookupTableBucket* last = NULL;
+    unsigned int num_entries, num_bins;
 
     num_entries = entries_->to_native();
     num_bins = bins_->to_native();
@@ -107,77 +117,65 @@ namespace rubinius {
     }
 
     key_to_sym(key);
-    bin = find_bin(key_hash(key), num_bins);
-    entry = try_as<LookupTableBucket>(values_->at(state, bin));
-
-    while(entry) {
-      if(entry->key() == key) {
-        entry->value(state, val);
-        return val;
-      }
-      last = entry;
-      entry = try_as<LookupTableBucket>(entry->next());
-    }
+    native_int bin = find_bin(state, key);
 
-    if(last) {
-      last->next(state, LookupTableBucket::create(state, key, val));
-    } else {
-      values_->put(state, bin, LookupTableBucket::create(state, key, val));
+    if(bin >= 0) {
+      values_->put(state, bin, val);
+      return val;
     }
 
+    insert(state, key, val);
     entries(state, Fixnum::from(num_entries + 1));
     return val;
   }
 
-  LookupTableBucket* LookupTable::find_entry(STATE, Object* key) {
-    unsigned int bin;
-
+  native_int LookupTable::find_bin(STATE, Object* key) {
     key_to_sym(key);
-    bin = find_bin(key_hash(key), bins_->to_native());
-    LookupTableBucket *entry = try_as<LookupTableBucket>(values_->at(state, bin));
 
-    while(entry) {
-      if(entry->key() == key) {
-        return entry;
-      }
-      entry = try_as<LookupTableBucket>(entry->next());
+    size_t mask = bins_->to_native() - 1;
+    size_t bin = key_hash(key) & mask;
+
+    for(;;) {
+      Object* tmp = keys_->field[bin];
+      if(tmp == key) return bin;
+      if(empty_p(tmp)) return -1;
+      bin = (bin + 1) & mask;
     }
-    return reinterpret_cast<LookupTableBucket *>(Qnil);
   }
 
   /** Same as fetch(state, key). */
   Object* LookupTable::aref(STATE, Object* key) {
-    LookupTableBucket* entry = find_entry(state, key);
-    if(entry == Qnil) return Qnil;
-    return entry->value();
+    native_int bin = find_bin(state, key);
+    if(bin < 0) return Qnil;
+    return values_->field[bin];
   }
 
   /** Same as aref(state, key). */
   Object* LookupTable::fetch(STATE, Object* key) {
-    LookupTableBucket* entry = find_entry(state, key);
-    if(entry == Qnil) return Qnil;
-    return entry->value();
+    native_int bin = find_bin(state, key);
+    if(bin < 0) return Qnil;
+    return values_->field[bin];
   }
 
   Object* LookupTable::fetch(STATE, Object* key, Object* return_on_failure) {
-    LookupTableBucket* entry = find_entry(state, key);
+    native_int bin = find_bin(state, key);
 
-    if(entry == Qnil) {
+    if(bin < 0) {
       return return_on_failure;
     }
 
-    return entry->value();
+    return values_->field[bin];
   }
 
   Object* LookupTable::fetch(STATE, Object* key, bool* found) {
-    LookupTableBucket* entry = find_entry(state, key);
-    if(entry == Qnil) {
+    native_int bin = find_bin(state, key);
+    if(bin < 0) {
       *found = false;
       return Qnil;
     }
 
     *found = true;
-    return entry->value();
+    return values_->field[bin];
   }
 
   /* lookuptable_find returns Qundef if there is not entry
@@ -186,18 +184,14 @@ namespace rubinius {
    * in cpu.c in e.g. cpu_const_get_in_context.
    */
   Object* LookupTable::find(STATE, Object* key) {
-    LookupTableBucket* entry = find_entry(state, key);
-    if(entry == Qnil) {
+    native_int bin = find_bin(state, key);
+    if(bin < 0) {
       return Qundef;
     }
-    return entry->value();
+    return values_->field[bin];
   }
 
   Object* LookupTable::remove(STATE, Object* key) {
-    hashval bin;
-    LookupTableBucket* entry;
-    LookupTableBucket* last = NULL;
-
     size_t num_entries = entries_->to_native();
     size_t num_bins = bins_->to_native();
 
@@ -205,74 +199,93 @@ namespace rubinius {
       redistribute(state, num_bins >>= 1);
     }
 
-    key_to_sym(key);
-    bin = find_bin(key_hash(key), num_bins);
-    entry = try_as<LookupTableBucket>(values_->at(state, bin));
-
-    while(entry) {
-      if(entry->key() == key) {
-        Object *val = entry->value();
-        if(last) {
-          last->next(state, entry->next());
-        } else {
-          values_->put(state, bin, entry->next());
-        }
-        entries(state, Fixnum::from(entries_->to_native() - 1));
-        return val;
-      }
+    native_int bin = find_bin(state, key);
+    if(bin < 0) return Qnil;
+
+    Object* val = values_->field[bin];
+
+    /* Walk the rest of the probe run, moving back any entry that the
+     * hole would otherwise cut off from its home bin. */
+    size_t mask = num_bins - 1;
+    size_t hole = bin;
+    size_t i = bin;
+
+    for(;;) {
+      i = (i + 1) & mask;
 
-      last = entry;
-      entry = try_as<LookupTableBucket>(entry->next());
+      Object* tmp = keys_->field[i];
+      if(empty_p(tmp)) break;
+
+      size_t home = key_hash(tmp) & mask;
+      bool movable = hole <= i ? (home <= hole || home > i)
+                               : (home <= hole && home > i);
+
+      if(movable) {
+        keys_->put(state, hole, tmp);
+        values_->put(state, hole, values_->field[i]);
+        hole = i;
+      }
     }
 
-    return Qnil;
+    keys_->put(state, hole, Qundef);
+    values_->put(state, hole, Qnil);
+    entries(state, Fixnum::from(num_entries - 1));
+
+    return val;
   }
 
   Object* LookupTable::has_key(STATE, Object* key) {
-    LookupTableBucket* entry = find_entry(state, key);
-
-    if(entry == Qnil) return Qfalse;
+    if(find_bin(state, key) < 0) return Qfalse;
     return Qtrue;
   }
 
-  Array* LookupTable::collect(STATE, LookupTable* tbl, Object* (*action)(STATE, LookupTableBucket*)) {
+  Object* LookupTable::next_entry(STATE, Fixnum* start) {
+    native_int num = bins_->to_native();
+
+    for(native_int i = start->to_native(); i < num; i++) {
+      if(!empty_p(keys_->field[i])) return Fixnum::from(i);
+    }
+
+    return Qnil;
+  }
+
+  Array* LookupTable::collect(STATE, LookupTable* tbl, Object* (*action)(STATE, LookupTable*, size_t)) {
     size_t i, j;
-    Tuple* values;
-    LookupTableBucket* entry;
+    Tuple* keys;
 
     Array* ary = Array::create(state, tbl->entries()->to_native());
     size_t num_bins = tbl->bins()->to_native();
-    values = tbl->values();
+    keys = tbl->keys();
 
     for(i = j = 0; i < num_bins; i++) {
-      entry = try_as<LookupTableBucket>(values->at(state, i));
-
-      while(entry) {
-        ary->set(state, j++, action(state, entry));
-        entry = try_as<LookupTableBucket>(entry->next());
+      if(!empty_p(keys->field[i])) {
+        ary->set(state, j++, action(state, tbl, i));
       }
     }
     return ary;
   }
 
-  Object* LookupTable::get_key(STATE, LookupTableBucket* entry) {
-    return entry->key();
+  Object* LookupTable::get_key(STATE, LookupTable* tbl, size_t bin) {
+    return tbl->keys()->field[bin];
   }
 
   Array* LookupTable::all_keys(STATE) {
     return collect(state, this, get_key);
   }
 
-  Object* LookupTable::get_value(STATE, LookupTableBucket* entry) {
-    return entry->value();
+  Object* LookupTable::get_value(STATE, LookupTable* tbl, size_t bin) {
+    return tbl->values()->field[bin];
   }
 
   Array* LookupTable::all_values(STATE) {
     return collect(state, this, get_value);
   }
 
-  Object* LookupTable::get_entry(STATE, LookupTableBucket* entry) {
-    return entry;
+  Object* LookupTable::get_entry(STATE, LookupTable* tbl, size_t bin) {
+    Array* pair = Array::create(state, 2);
+    pair->set(state, 0, tbl->keys()->field[bin]);
+    pair->set(state, 1, tbl->values()->field[bin]);
+    return pair;
   }
 
   Array* LookupTable::all_entries(STATE) {
@@ -300,29 +313,6 @@ namespace rubinius {
     close_body(level);
   }
 
-
-  LookupTableBucket* LookupTableBucket::create(STATE, Object *key, Object *value) {
-    LookupTableBucket *entry =
-      state->new_object<LookupTableBucket>(G(lookuptablebucket));
-
-    entry->key(state, key);
-    entry->value(state, value);
-    return entry;
-  }
-
-  Object* LookupTableBucket::append(STATE, LookupTableBucket* nxt) {
-    LookupTableBucket* cur = try_as<LookupTableBucket>(this->next());
-    LookupTableBucket* last = this;
-
-    while(cur) {
-      last = cur;
-      cur = try_as<LookupTableBucket>(cur->next());
-    }
-
-    last->next(state, nxt);
-    return nxt;
-  }
-
   LookupTableAssociation* LookupTableAssociation::create(STATE, Object *key, Object *value) {
     LookupTableAssociation *entry =
       state->new_object<LookupTableAssociation>(G(lookuptableassociation));
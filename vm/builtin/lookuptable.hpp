@@ -9,30 +9,6 @@ namespace rubinius {
   class Tuple;
   class Array;
 
-  class LookupTableBucket : public Object {
-  public:
-    const static object_type type = LookupTableBucketType;
-
-  private:
-    Object *key_;   // slot
-    Object *value_; // slot
-    LookupTableBucket *next_;  // slot
-
-  public:
-    attr_accessor(key, Object);
-    attr_accessor(value, Object);
-    attr_accessor(next, LookupTableBucket);
-
-    static LookupTableBucket* create(STATE, Object* key, Object* value);
-
-    Object* append(STATE, LookupTableBucket *nxt);
-
-    class Info : public TypeInfo {
-    public:
-      BASIC_TYPEINFO(TypeInfo)
-    };
-  };
-
   class LookupTableAssociation : public Object {
   public:
     const static object_type type = LookupTableAssociationType;
@@ -59,18 +35,30 @@ namespace rubinius {
   };
 
   #define LOOKUPTABLE_MIN_SIZE 16
+
+  /**
+   *  An identity keyed table, open addressed with linear probing.
+   *
+   *  keys and values are parallel Tuples of bins entries. A bin is empty
+   *  when its key is Qundef, which no Ruby object can be, so nil is a
+   *  valid key. Entries are removed by shifting the rest of their probe
+   *  run back, so there are no tombstones and a lookup stops at the first
+   *  empty bin.
+   */
   class LookupTable : public Object {
   public:
     const static object_type type = LookupTableType;
 
   private:
-    Tuple* values_;   // slot
+    Tuple* keys_;      // slot
+    Tuple* values_;    // slot
     Integer* bins_;    // slot
     Integer* entries_; // slot
 
   public:
     /* accessors */
 
+    attr_accessor(keys, Tuple);
     attr_accessor(values, Tuple);
     attr_accessor(bins, Integer);
     attr_accessor(entries, Integer);
@@ -99,23 +87,31 @@ namespace rubinius {
     // Ruby.primitive :lookuptable_dup
     LookupTable* dup(STATE);
     void   redistribute(STATE, size_t size);
-    LookupTableBucket* find_entry(STATE, Object* key);
+    /** The bin holding +key+, or -1. */
+    native_int find_bin(STATE, Object* key);
     Object* find(STATE, Object* key);
     // Ruby.primitive :lookuptable_delete
     Object* remove(STATE, Object* key);
     // Ruby.primitive :lookuptable_has_key
     Object* has_key(STATE, Object* key);
-    static Array* collect(STATE, LookupTable* tbl, Object* (*action)(STATE, LookupTableBucket*));
-    static Object* get_key(STATE, LookupTableBucket* entry);
+    /** The first bin at or after +start+ holding an entry, or nil. */
+    // Ruby.primitive :lookuptable_next_entry
+    Object* next_entry(STATE, Fixnum* start);
+    static Array* collect(STATE, LookupTable* tbl, Object* (*action)(STATE, LookupTable*, size_t));
+    static Object* get_key(STATE, LookupTable* tbl, size_t bin);
     // Ruby.primitive :lookuptable_keys
     Array* all_keys(STATE);
-    static Object* get_value(STATE, LookupTableBucket* entry);
+    static Object* get_value(STATE, LookupTable* tbl, size_t bin);
     // Ruby.primitive :lookuptable_values
     Array* all_values(STATE);
-    static Object* get_entry(STATE, LookupTableBucket* entry);
+    static Object* get_entry(STATE, LookupTable* tbl, size_t bin);
     // Ruby.primitive :lookuptable_entries
     Array* all_entries(STATE);
 
+  private:
+    void insert(STATE, Object* key, Object* val);
+
+  public:
     class Info : public TypeInfo {
     public:
       BASIC_TYPEINFO(TypeInfo)
@@ -1,7 +1,11 @@
 #include "prelude.hpp"
 #include "builtin/class.hpp"
+#include "builtin/contexts.hpp"
 #include "builtin/machine_method.hpp"
 #include "vm/exception.hpp"
+#include "vm/object_utils.hpp"
+#include "vm/code_cache.hpp"
+#include "vm/perf_map.hpp"
 
 #include "detection.hpp"
 
@@ -23,16 +27,27 @@ namespace rubinius {
 
   MachineMethod* MachineMethod::create(STATE, VMMethod* vmm, JITCompiler& jit) {
     size_t code_size = jit.assembler().used_bytes();
+
+    void* code = state->code_cache->allocate(vmm, code_size);
+    if(!code) {
+      // Evicted methods only give back their memory once their
+      // MachineMethods are collected, so ask for a GC too.
+      state->code_cache->evict_cold();
+      state->run_gc_soon();
+      return NULL;
+    }
+
     MachineMethod* mm = state->new_struct<MachineMethod>(G(machine_method));
 
     mm->vmmethod_ = vmm;
     mm->code_size_ = code_size;
 
-    mm->set_function(reinterpret_cast<void*>(malloc(code_size)));
+    mm->set_function(code);
     std::memcpy(mm->function(), jit.assembler().buffer(), code_size);
 
     assembler::Relocations& current = jit.assembler().relocations();
     mm->relocations_ = new assembler::Relocation*[current.size()];
+    mm->num_relocations_ = current.size();
 
     int j = 0;
     for(assembler::Relocations::iterator i = current.begin();
@@ -45,6 +60,11 @@ namespace rubinius {
       rel->resolve_and_write();
     }
 
+    // Done writing to the code
+    state->code_cache->commit(code);
+
+    if(state->perf_map) state->perf_map->record(state, vmm, code, code_size);
+
     mm->virtual2native_ = new CodeMap();
     CodeMap& v2n = *mm->virtual2native_;
 
@@ -54,6 +74,15 @@ namespace rubinius {
       v2n[i->first] = adjust(jit.assembler().buffer(), mm->function(), i->second);
     }
 
+    mm->deopt_points_ = new CodeMap();
+    CodeMap& deopt = *mm->deopt_points_;
+
+    for(CodeMap::iterator i = jit.deopt_points().begin();
+        i != jit.deopt_points().end();
+        i++) {
+      deopt[i->first] = adjust(jit.assembler().buffer(), mm->function(), i->second);
+    }
+
     mm->comments_ = new AddressComments();
     AddressComments& comments = *mm->comments_;
 
@@ -67,12 +96,46 @@ namespace rubinius {
     return mm;
   }
 
+  void MachineMethod::Info::cleanup(Object* obj) {
+    MachineMethod* mm = as<MachineMethod>(obj);
+
+    // Contexts may still be running the code, so the cache decides
+    // when to free it.
+    state()->code_cache->retire(mm->function());
+
+    for(size_t i = 0; i < mm->num_relocations_; i++) {
+      delete mm->relocations_[i];
+    }
+
+    delete[] mm->relocations_;
+    delete mm->virtual2native_;
+    delete mm->deopt_points_;
+    delete mm->comments_;
+  }
+
   void* MachineMethod::resolve_virtual_ip(opcode ip) {
     CodeMap::iterator i = virtual2native_->find(ip);
     if(i == virtual2native_->end()) return NULL;
     return i->second;
   }
 
+  void* MachineMethod::deopt_point(opcode ip) {
+    CodeMap::iterator i = deopt_points_->find(ip);
+    if(i == deopt_points_->end()) return NULL;
+    return i->second;
+  }
+
+  bool MachineMethod::replace_on_stack(MethodContext* ctx) {
+    void* native_ip = resolve_virtual_ip(ctx->ip);
+    if(!native_ip) return false;
+
+    // The machine code reads the stack and locals straight out of ctx,
+    // so there is nothing to copy. It jumps to native_ip on entry.
+    ctx->native_ip = native_ip;
+    ctx->run = reinterpret_cast<Runner>(function());
+    return true;
+  }
+
   Object* MachineMethod::show() {
     std::cout << "== stats ==\n";
     std::cout << "number of bytecodes: " << vmmethod_->total << "\n";
@@ -82,23 +145,23 @@ namespace rubinius {
     ratio = (double)code_size_ / ((double)vmmethod_->total * sizeof(rubinius::opcode));
     std::cout << "       memory ratio: " << ratio << "\n";
     std::cout << "\n== x86 assembly ==\n";
-    assembler_x86::AssemblerX86::show_buffer(function(), code_size_, false, comments_);
+    JITAssembler::show_buffer(function(), code_size_, false, comments_);
     return Qnil;
   }
 
   void MachineMethod::run_code(VMMethod* const vmm, Task* const task,
       MethodContext* const ctx) {
-#ifdef IS_X86
+#if defined(IS_X86) || defined(IS_X8664)
     MachineMethod* mm = vmm->machine_method();
     void* func = mm->function();
     ((Runner)func)(vmm, task, ctx);
 #else
-    Assertion::raise("Only supported on x86");
+    Assertion::raise("Only supported on x86 and x86-64");
 #endif
   }
 
   Object* MachineMethod::activate() {
-#ifdef IS_X86
+#if defined(IS_X86) || defined(IS_X8664)
 #ifdef MM_DEBUG
     vmmethod_->run = MachineMethod::run_code;
 #else
@@ -107,7 +170,7 @@ namespace rubinius {
     vmmethod_->set_machine_method(this);
     return Qtrue;
 #else
-    Assertion::raise("Only supported on x86");
+    Assertion::raise("Only supported on x86 and x86-64");
     return Qfalse;
 #endif
   }
@@ -14,13 +14,17 @@ namespace rubinius {
     VMMethod* vmmethod_;
     size_t code_size_;
     CodeMap* virtual2native_;
+    CodeMap* deopt_points_;
     AddressComments* comments_;
     assembler::Relocation** relocations_;
+    size_t num_relocations_;
 
     void* function_;
 
   public:
     static void init(STATE);
+    // Copies the code from +jit+ into the VM's CodeCache. Returns NULL
+    // if the cache is full.
     static MachineMethod* create(STATE, VMMethod* vmm, JITCompiler& jit);
 
     void* function() {
@@ -41,6 +45,21 @@ namespace rubinius {
     Object* activate();
 
     void* resolve_virtual_ip(opcode ip);
+
+    // The code which deoptimizes if the guard for the instruction at +ip+
+    // fails, or NULL if that instruction isn't guarded.
+    void* deopt_point(opcode ip);
+
+    // Switch +ctx+, which is being interpreted, over to this machine code
+    // at ctx->ip. Only loop headers and unwind targets can be entered
+    // like this. Returns false if ctx->ip isn't one of them.
+    bool replace_on_stack(MethodContext* ctx);
+
+    class Info : public TypeInfo {
+    public:
+      Info(object_type type, bool cleanup = true) : TypeInfo(type, true) { }
+      virtual void cleanup(Object* obj);
+    };
   };
 }
 
@@ -97,7 +97,7 @@ namespace rubinius {
   }
 
   Float* MemoryPointer::write_float(STATE, Float* flt) {
-    *(double*)pointer = flt->val;
+    *(double*)pointer = flt->val();
     return flt;
   }
 
@@ -319,7 +319,7 @@ namespace rubinius {
          * internal pointer to the string means that when the string
          * moves, the data will point at the wrong place. Probably need to
          * copy the string data instead */
-        result = str->c_str();
+        result = str->c_str(state);
       }
       WRITE(const char*, result);
       break;
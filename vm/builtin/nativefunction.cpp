@@ -449,7 +449,7 @@ namespace rubinius {
           *tmp = NULL;
         } else {
           String* so = as<String>(obj);
-          *tmp = const_cast<char*>(so->c_str());
+          *tmp = const_cast<char*>(so->c_str(state));
         }
         values[i] = tmp;
         break;
@@ -197,6 +197,7 @@ namespace rubinius {
     if(reference_p()) return obj_type;
     if(fixnum_p()) return FixnumType;
     if(symbol_p()) return SymbolType;
+    if(FLONUM_P(this)) return FloatType;
     if(nil_p()) return NilType;
     if(true_p()) return TrueType;
     if(false_p()) return FalseType;
@@ -209,6 +210,9 @@ namespace rubinius {
         return fix->to_native();
       } else if(Symbol* sym = try_as<Symbol>(this)) {
         return sym->index();
+      } else if(Float* flt = try_as<Float>(this)) {
+        double val = flt->val();
+        return String::hash_str((unsigned char *)&val, sizeof(double));
       } else {
         return (native_int)this;
       }
@@ -218,7 +222,8 @@ namespace rubinius {
       } else if(Bignum* bignum = try_as<Bignum>(this)) {
         return bignum->hash_bignum(state);
       } else if(Float* flt = try_as<Float>(this)) {
-        return String::hash_str((unsigned char *)(&(flt->val)), sizeof(double));
+        double val = flt->val();
+        return String::hash_str((unsigned char *)&val, sizeof(double));
       } else {
         return id(state)->to_native();
       }
@@ -242,6 +247,13 @@ namespace rubinius {
       }
 
       return as<Integer>(id);
+    } else if(FLONUM_P(this)) {
+      /* The same odd id as below, but it can take 65 bits */
+      uintptr_t val = (uintptr_t)this;
+      if(val <= (uintptr_t)FIXNUM_MAX >> 1) return Fixnum::from((val << 1) | 1);
+
+      Integer* id = Bignum::from(state, (unsigned long)val)->left_shift(state, Fixnum::from(1));
+      return as<Bignum>(id)->add(state, Fixnum::from(1));
     } else {
       /* All non-references have an odd object_id */
       return Fixnum::from(((uintptr_t)this << 1) | 1);
@@ -1,7 +1,10 @@
 #include "oniguruma.h" // Must be first.
 
+#include <string.h>
+
 #include "builtin/regexp.hpp"
 #include "builtin/class.hpp"
+#include "builtin/fixnum.hpp"
 #include "builtin/integer.hpp"
 #include "builtin/lookuptable.hpp"
 #include "builtin/string.hpp"
@@ -11,6 +14,7 @@
 #include "vm.hpp"
 #include "vm/object_utils.hpp"
 #include "objectmemory.hpp"
+#include "region_pool.hpp"
 
 #define OPTION_IGNORECASE ONIG_OPTION_IGNORECASE
 #define OPTION_EXTENDED   ONIG_OPTION_EXTEND
@@ -24,6 +28,12 @@
 #define KCODE_UTF8        64
 #define KCODE_MASK        (KCODE_EUC|KCODE_SJIS|KCODE_UTF8)
 
+// From Oniguruma's regint.h, which isn't meant to be used outside of it
+#define OPTIMIZE_EXACT            1
+#define OPTIMIZE_EXACT_BM         2
+#define OPTIMIZE_EXACT_BM_NOT_REV 3
+#define ANCHOR_BEGIN_POSITION     (1<<2)
+
 namespace rubinius {
 
   void Regexp::Info::cleanup(Object* regexp) {
@@ -103,6 +113,7 @@ namespace rubinius {
     Regexp* o_reg = state->new_object<Regexp>(G(regexp));
 
     o_reg->onig_data = NULL;
+    o_reg->literal_ = NULL;
 
     return o_reg;
   }
@@ -119,7 +130,7 @@ namespace rubinius {
     OnigEncoding enc;
     int err, num_names, kcode;
 
-    pat = (UChar*)pattern->c_str();
+    pat = (UChar*)pattern->byte_address();
     end = pat + pattern->size();
 
     opts  = options->to_native();
@@ -138,6 +149,8 @@ namespace rubinius {
       Exception::regexp_error(state, err_buf);
     }
 
+    find_literal();
+
     this->source(state, pattern);
 
     num_names = onig_number_of_names(this->onig_data);
@@ -156,6 +169,61 @@ namespace rubinius {
     return this;
   }
 
+  /*
+   * While compiling a pattern, Oniguruma works out a literal that every
+   * match has to contain, if there is one, and how far into the match it
+   * can be. It only uses this inside onig_search, with a byte at a time
+   * or Boyer-Moore loop. prefilter() looks for the same literal with
+   * memchr/memmem, which libc vectorises, so a string without it never
+   * gets as far as onig_search, and one with it starts at the first
+   * place a match could be. Case insensitive literals are left alone.
+   */
+  void Regexp::find_literal() {
+    literal_ = NULL;
+    literal_size_ = 0;
+    literal_offset_ = -1;
+
+    switch(onig_data->optimize) {
+    case OPTIMIZE_EXACT:
+    case OPTIMIZE_EXACT_BM:
+    case OPTIMIZE_EXACT_BM_NOT_REV:
+      break;
+    default:
+      return;
+    }
+
+    literal_ = onig_data->exact;
+    literal_size_ = onig_data->exact_end - onig_data->exact;
+
+    // \G matches where the search starts, so the start can't be moved.
+    if(onig_data->anchor & ANCHOR_BEGIN_POSITION) return;
+
+    if(onig_data->dmax != ONIG_INFINITE_DISTANCE) {
+      literal_offset_ = onig_data->dmax;
+    }
+  }
+
+  /*
+   * Returns where a forward search from +start+ may as well begin, or NULL
+   * if the literal isn't between +start+ and +end+ and nothing can match.
+   */
+  const UChar* Regexp::prefilter(const UChar* str, const UChar* start, const UChar* end) {
+    if(!literal_) return start;
+    if(start < str || start > end) return start;
+
+    const UChar* p;
+    if(literal_size_ == 1) {
+      p = (const UChar*)memchr(start, *literal_, end - start);
+    } else {
+      p = (const UChar*)memmem(start, end - start, literal_, literal_size_);
+    }
+
+    if(!p) return NULL;
+    if(literal_offset_ < 0 || p - start <= literal_offset_) return start;
+
+    return onigenc_get_right_adjust_char_head(onig_data->enc, str, p - literal_offset_);
+  }
+
   // 'self' is passed in automatically by the primitive glue
   Regexp* Regexp::allocate(STATE, Object* self) {
     Regexp* re = Regexp::create(state);
@@ -175,28 +243,20 @@ namespace rubinius {
     return Integer::from(state, ((int)(option & OPTION_MASK) | get_kcode_from_enc(enc)));
   }
 
-  static Object* _md_region_to_tuple(STATE, OnigRegion *region, int max) {
-    int i;
-    Tuple* sub;
-    Tuple* tup = Tuple::create(state, region->num_regs - 1);
-    for(i = 1; i < region->num_regs; i++) {
-      sub = Tuple::from(state, 2,
-			Integer::from(state, region->beg[i]),
-			Integer::from(state, region->end[i]));
-      tup->put(state, i - 1, sub);
+  static Tuple* region_to_tuple(STATE, OnigRegion *region) {
+    Tuple* tup = Tuple::create(state, region->num_regs * 2);
+    for(int i = 0; i < region->num_regs; i++) {
+      tup->put(state, i * 2, Fixnum::from(region->beg[i]));
+      tup->put(state, i * 2 + 1, Fixnum::from(region->end[i]));
     }
     return tup;
   }
 
-  static Object* get_match_data(STATE, OnigRegion *region, String* string, Regexp* regexp, int max) {
+  static Object* get_match_data(STATE, OnigRegion *region, String* string, Regexp* regexp) {
     MatchData* md = state->new_object<MatchData>(G(matchdata));
     md->source(state, string->string_dup(state));
     md->regexp(state, regexp);
-    Tuple* tup = Tuple::from(state, 2,
-			     Integer::from(state, region->beg[0]),
-			     Integer::from(state, region->end[0]));
-    md->full(state, tup);
-    md->region(state, (Tuple*)_md_region_to_tuple(state, region, max));
+    md->region(state, region_to_tuple(state, region));
     return md;
   }
 
@@ -204,26 +264,34 @@ namespace rubinius {
     int beg, max;
     const UChar *str;
     OnigRegion *region;
-    Object* md;
-
-    region = onig_region_new();
+    const UChar *from;
+    Object* md = Qnil;
 
+    // Oniguruma is given the end, so a substring is matched in place
+    // rather than copied out by c_str().
     max = string->size();
-    str = (UChar*)string->c_str();
+    str = (UChar*)string->byte_address();
+
+    // onig_search goes backwards unless start is before end.
+    from = str + start->to_native();
+    if(RTEST(forward) && start->to_native() < end->to_native()) {
+      from = prefilter(str, from, str + max);
+      if(!from || from >= str + end->to_native()) return Qnil;
+    }
+
+    region = state->regions->acquire();
 
     if(!RTEST(forward)) {
       beg = onig_search(onig_data, str, str + max, str + end->to_native(), str + start->to_native(), region, ONIG_OPTION_NONE);
     } else {
-      beg = onig_search(onig_data, str, str + max, str + start->to_native(), str + end->to_native(), region, ONIG_OPTION_NONE);
+      beg = onig_search(onig_data, str, str + max, from, str + end->to_native(), region, ONIG_OPTION_NONE);
     }
 
-    if(beg == ONIG_MISMATCH) {
-      onig_region_free(region, 1);
-      return Qnil;
+    if(beg != ONIG_MISMATCH) {
+      md = get_match_data(state, region, string, this);
     }
 
-    md = get_match_data(state, region, string, this, max);
-    onig_region_free(region, 1);
+    state->regions->release(region);
     return md;
   }
 
@@ -233,19 +301,40 @@ namespace rubinius {
     OnigRegion *region;
     Object* md = Qnil;
 
-    region = onig_region_new();
+    region = state->regions->acquire();
 
     max = string->size();
-    str = (UChar*)string->c_str();
+    str = (UChar*)string->byte_address();
 
     beg = onig_match(onig_data, str, str + max, str + start->to_native(), region,
                      ONIG_OPTION_NONE);
 
     if(beg != ONIG_MISMATCH) {
-      md = get_match_data(state, region, string, this, max);
+      md = get_match_data(state, region, string, this);
     }
 
-    onig_region_free(region, 1);
+    state->regions->release(region);
     return md;
   }
+
+  /*
+   * Oniguruma doesn't record the groups when it isn't given a region,
+   * and the string is searched in place, so this allocates nothing at all.
+   */
+  Object* Regexp::search_from(STATE, String* string, Integer* start) {
+    int beg, max;
+    const UChar *str, *from;
+
+    max = string->size();
+    str = (UChar*)string->byte_address();
+
+    from = prefilter(str, str + start->to_native(), str + max);
+    if(!from) return Qnil;
+
+    beg = onig_search(onig_data, str, str + max, from, str + max,
+                      NULL, ONIG_OPTION_NONE);
+
+    if(beg == ONIG_MISMATCH) return Qnil;
+    return Fixnum::from(beg);
+  }
 }
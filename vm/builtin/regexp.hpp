@@ -27,6 +27,16 @@ namespace rubinius {
     LookupTable* names_; // slot
     regex_t* onig_data;
 
+    // A literal that every match contains, taken from Oniguruma's analysis
+    // of the pattern; NULL if there isn't one. Points into onig_data.
+    const unsigned char* literal_;
+    size_t literal_size_;
+
+    // How far past the start of a match the literal can begin, or -1 if
+    // there's no bound (or the pattern uses \G) and all the literal can do
+    // is rule a string out.
+    native_int literal_offset_;
+
   public:
     /* accessors */
 
@@ -51,9 +61,20 @@ namespace rubinius {
     // Ruby.primitive :regexp_match_start
     Object* match_start(STATE, String* string, Integer* start);
 
+    /** Where the first match at or after +start+ begins, or nil. Builds no MatchData. */
+    // Ruby.primitive :regexp_search_from
+    Object* search_from(STATE, String* string, Integer* start);
+
     // Ruby.primitive :regexp_allocate
     static Regexp* allocate(STATE, Object* self);
 
+  private:
+    void find_literal();
+    const unsigned char* prefilter(const unsigned char* str,
+        const unsigned char* start, const unsigned char* end);
+
+  public:
+
     class Info : public TypeInfo {
     public:
       BASIC_TYPEINFO_WITH_CLEANUP(TypeInfo)
@@ -61,15 +82,22 @@ namespace rubinius {
 
   };
 
+  /**
+   *  The result of a successful match.
+   *
+   *  region holds the begin and end offset of each group, the whole match
+   *  first, as one flat Tuple of Fixnums; both are -1 for a group that
+   *  didn't take part. The Strings for the groups are only cut out of
+   *  source when Ruby code asks for them.
+   */
   class MatchData : public Object {
   public:
-    const static size_t fields = 4;
+    const static size_t fields = 3;
     const static object_type type = MatchDataType;
 
   private:
     String* source_; // slot
     Regexp* regexp_; // slot
-    Tuple* full_;    // slot
     Tuple* region_;  // slot
 
   public:
@@ -77,7 +105,6 @@ namespace rubinius {
 
     attr_accessor(source, String);
     attr_accessor(regexp, Regexp);
-    attr_accessor(full, Tuple);
     attr_accessor(region, Tuple);
 
     /* interface */
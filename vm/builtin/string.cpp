@@ -10,6 +10,7 @@
 #include "parser/grammar.hpp"
 
 #include "vm.hpp"
+#include "bytes.hpp"
 #include "object_utils.hpp"
 #include "objectmemory.hpp"
 #include "primitives.hpp"
@@ -20,9 +21,6 @@
 #include <unistd.h>
 #include <iostream>
 
-#define HashPrime 16777619
-#define MASK_28 (((unsigned int)1<<28)-1)
-
 namespace rubinius {
 
   void String::init(STATE) {
@@ -52,6 +50,7 @@ namespace rubinius {
     so->encoding(state, Qnil);
     so->hash_value(state, (Integer*)Qnil);
     so->shared(state, Qfalse);
+    so->offset(state, (Fixnum*)Qnil);
 
     size_t bytes = size->to_native() + 1;
     ByteArray* ba = ByteArray::create(state, bytes);
@@ -83,6 +82,7 @@ namespace rubinius {
     s->encoding(state, Qnil);
     s->hash_value(state, (Integer*)Qnil);
     s->shared(state, Qfalse);
+    s->offset(state, (Fixnum*)Qnil);
 
     // fetch_bytes NULL terminates
     s->data(state, ba->fetch_bytes(state, start, count));
@@ -91,35 +91,21 @@ namespace rubinius {
   }
 
   hashval String::hash_string(STATE) {
-    unsigned char *bp;
-
-    if(!hash_value_->nil_p()) {
-      return (hashval)as<Integer>(hash_value_)->to_native();
+    if(Fixnum* hash = try_as<Fixnum>(hash_value_)) {
+      return hash->to_native();
     }
-    bp = (unsigned char*)(data_->bytes);
-    size_t sz = size();
 
-    hashval h = hash_str(bp, sz);
-    hash_value(state, Integer::from(state, h));
+    hashval h = hash_str((unsigned char*)byte_address(), size());
+    hash_value(state, Fixnum::from(h));
 
     return h;
   }
 
+  // Folded into the Fixnum range, so caching it in hash_value_ (or
+  // handing it to Ruby as #hash) never allocates a Bignum.
   hashval String::hash_str(const unsigned char *bp, unsigned int sz) {
-    unsigned char *be;
-    unsigned int hv;
-
-    be = (unsigned char*)bp + sz;
-
-    hv = 0;
-
-    while(bp < be) {
-      hv *= HashPrime;
-      hv ^= *bp++;
-    }
-    hv = (hv>>28) ^ (hv & MASK_28);
-
-    return hv;
+    uint64_t h = bytes::hash(bp, sz);
+    return (hashval)((h ^ (h >> 32)) & FIXNUM_MAX);
   }
 
   Symbol* String::to_sym(STATE) {
@@ -127,17 +113,22 @@ namespace rubinius {
   }
 
   char* String::byte_address() {
-    return (char*)data_->bytes;
+    return (char*)data_->bytes + byte_offset();
   }
 
-  const char* String::c_str() {
-    sassert(size() < data_->size());
-
-    char* c_string = (char*)data_->bytes;
+  const char* String::c_str(STATE) {
+    char* c_string = byte_address();
     if(c_string[size()] != 0) {
+      if(shared_ == Qtrue || window_p()) {
+        unshare(state);
+        c_string = byte_address();
+      }
+
       c_string[size()] = 0;
     }
 
+    sassert(byte_offset() + size() < data_->size());
+
     return c_string;
   }
 
@@ -146,11 +137,9 @@ namespace rubinius {
     String* other = as<String>(b);
 
     if(self->num_bytes() != other->num_bytes()) return false;
-    if(strncmp(self->byte_address(), other->byte_address(), self->num_bytes()->to_native())) {
-      return false;
-    }
 
-    return true;
+    return bytes::equal(self->byte_address(), other->byte_address(),
+                        self->num_bytes()->to_native());
   }
 
   Object* String::equal(STATE, String* other) {
@@ -171,10 +160,58 @@ namespace rubinius {
   }
 
   void String::unshare(STATE) {
-    data(state, as<ByteArray>(data_->dup(state)));
+    if(window_p()) {
+      size_t sz = size();
+      ByteArray* ba = ByteArray::create(state, sz + 1);
+
+      std::memcpy(ba->bytes, byte_address(), sz);
+      ba->bytes[sz] = 0;
+
+      data(state, ba);
+      offset(state, (Fixnum*)Qnil);
+    } else {
+      data(state, as<ByteArray>(data_->dup(state)));
+    }
+
     shared(state, Qfalse);
   }
 
+  String* String::substring(STATE, Fixnum* start, Fixnum* count) {
+    native_int sz = (native_int)size();
+    native_int src = start->to_native();
+    native_int cnt = count->to_native();
+
+    if(cnt < 0 || src > sz || -src > sz) return (String*)Qnil;
+
+    if(src < 0) src += sz;
+    if(src + cnt > sz) cnt = sz - src;
+
+    String* s;
+
+    if(cnt < cMinSharedBytes) {
+      s = String::create(state, Fixnum::from(cnt));
+      std::memcpy(s->byte_address(), byte_address() + src, cnt);
+    } else {
+      s = state->new_object<String>(G(string));
+
+      s->num_bytes(state, Fixnum::from(cnt));
+      s->characters(state, Fixnum::from(cnt));
+      s->encoding(state, Qnil);
+      s->hash_value(state, (Integer*)Qnil);
+      s->data(state, data_);
+      s->offset(state, Fixnum::from(byte_offset() + src));
+
+      // Writes to either one now have to unshare first.
+      s->shared(state, Qtrue);
+      shared(state, Qtrue);
+    }
+
+    s->klass(state, class_object(state));
+    s->IsTainted = IsTainted;
+
+    return s;
+  }
+
   String* String::append(STATE, String* other) {
     return append(state, other->byte_address(), other->size());
   }
@@ -184,6 +221,8 @@ namespace rubinius {
   }
 
   String* String::append(STATE, const char* other, std::size_t length) {
+    materialize(state);
+
     size_t new_size = size() + length;
     size_t capacity = data_->size();
 
@@ -230,6 +269,8 @@ namespace rubinius {
 
   double String::to_double(STATE) {
     double value;
+
+    materialize(state);
     char *ba = data_->to_chars(state);
     char *p, *n, *rest;
     int e_seen = 0;
@@ -308,7 +349,7 @@ namespace rubinius {
       tr_data.limit = -1;
     }
 
-    unsigned char* str = data_->bytes;
+    unsigned char* str = (unsigned char*)byte_address();
     native_int bytes = (native_int)this->size();
     native_int start = bytes > 1 && str[0] == '^' ? 1 : 0;
     std::memset(tr_data.set, -1, sizeof(native_int) * 256);
@@ -340,11 +381,12 @@ namespace rubinius {
   }
 
   Fixnum* String::tr_replace(STATE, struct tr_data* tr_data) {
-    if(tr_data->last > (native_int)size() || shared_->true_p()) {
+    if(tr_data->last > (native_int)size() || shared_->true_p() || window_p()) {
       ByteArray* ba = ByteArray::create(state, tr_data->last + 1);
 
       data(state, ba);
       shared(state, Qfalse);
+      offset(state, (Fixnum*)Qnil);
     }
 
     std::memcpy(data_->bytes, tr_data->tr, tr_data->last);
@@ -371,7 +413,7 @@ namespace rubinius {
     if(dst < 0) dst = 0;
     if(cnt > sz - dst) cnt = sz - dst;
 
-    std::memcpy(data_->bytes + dst, other->data()->bytes + src, cnt);
+    std::memcpy(byte_address() + dst, other->byte_address() + src, cnt);
 
     return this;
   }
@@ -392,7 +434,7 @@ namespace rubinius {
 
     if(cnt > sz) cnt = sz;
 
-    native_int cmp = std::memcmp(data_->bytes, other->data()->bytes + src, cnt);
+    native_int cmp = std::memcmp(byte_address(), other->byte_address() + src, cnt);
 
     if(cmp < 0) {
       return Fixnum::from(-1);
@@ -417,18 +459,18 @@ namespace rubinius {
 
       native_int psz = pat->size();
       if(psz == 1) {
-        std::memset(s->data()->bytes, pat->data()->bytes[0], cnt);
+        std::memset(s->data()->bytes, pat->byte_address()[0], cnt);
       } else if(psz > 1) {
         native_int i, j, n;
 
         native_int sz = cnt / psz;
         for(n = i = 0; i < sz; i++) {
           for(j = 0; j < psz; j++, n++) {
-            s->data()->bytes[n] = pat->data()->bytes[j];
+            s->data()->bytes[n] = pat->byte_address()[j];
           }
         }
         for(i = n, j = 0; i < cnt; i++, j++) {
-          s->data()->bytes[i] = pat->data()->bytes[j];
+          s->data()->bytes[i] = pat->byte_address()[j];
         }
       }
     } else {
@@ -439,12 +481,12 @@ namespace rubinius {
   }
 
   String* String::crypt(STATE, String* salt) {
-    const char* s = ::crypt(this->c_str(), salt->c_str());
+    const char* s = ::crypt(this->c_str(state), salt->c_str(state));
     return String::create(state, s);
   }
 
   Integer* String::to_i(STATE, Fixnum* fix_base, Object* strict) {
-    const char* str = c_str();
+    const char* str = c_str(state);
     int base = fix_base->to_native();
     bool negative = false;
     Integer* value = Fixnum::from(0);
@@ -623,12 +665,12 @@ return_value:
 
   Object* String::parse(STATE, String* name, Fixnum* line) {
     bstring str = blk2bstr(byte_address(), size());
-    return parser::syd_compile_string(state, name->c_str(), str, line->to_native());
+    return parser::syd_compile_string(state, name->c_str(state), str, line->to_native());
   }
 
   void String::Info::show(STATE, Object* self, int level) {
     String* str = as<String>(self);
-    std::cout << "\"" << str->c_str() << "\"" << std::endl;
+    std::cout << "\"" << std::string(str->byte_address(), str->size()) << "\"" << std::endl;
   }
 
   void String::Info::show_simple(STATE, Object* self, int level) {
@@ -35,9 +35,10 @@ namespace rubinius {
     Integer* num_bytes_;  // slot
     Integer* characters_; // slot
     Object* encoding_;    // slot
-    ByteArray* data_;    // slot
+    ByteArray* data_;    // slot lazy
     Integer* hash_value_; // slot
     Object* shared_;      // slot
+    Fixnum* offset_;      // slot
 
   public:
     /* accessors */
@@ -48,9 +49,15 @@ namespace rubinius {
     attr_accessor(data, ByteArray);
     attr_accessor(hash_value, Integer);
     attr_accessor(shared, Object);
+    attr_accessor(offset, Fixnum);
 
     /* interface */
 
+    // Substrings at least this long share their parent's ByteArray
+    // rather than copying out of it. Shorter ones are cheaper to copy
+    // than to keep the parent alive for.
+    const static native_int cMinSharedBytes = 64;
+
     static void init(STATE);
 
     static String* create(STATE, Fixnum* size);
@@ -66,6 +73,17 @@ namespace rubinius {
     // Returns the number of bytes this String contains
     size_t size();
 
+    // Where this String's bytes start in data_. A substring made by
+    // String#substring may be a window onto its parent's ByteArray, in
+    // which case offset_ is a Fixnum; for every other String it's nil.
+    native_int byte_offset() {
+      return offset_->fixnum_p() ? offset_->to_native() : 0;
+    }
+
+    bool window_p() {
+      return offset_->fixnum_p();
+    }
+
     // Access the String as a char* directly. WARNING: doesn't necessarily
     // return a null terminated char*, so be sure to use size() with it.
     //
@@ -75,10 +93,19 @@ namespace rubinius {
     // Use this version if you want to use this String as a null
     // terminated char*.
     // It doesn't return a copy, it just makes sure that the String
-    // object's data is null clamped properly.
+    // object's data is null clamped properly. A String sharing its
+    // ByteArray is unshared first, since clamping would write into the
+    // other String's bytes.
     //
     // NOTE: do not free() or realloc() this buffer.
-    const char* c_str();
+    const char* c_str(STATE);
+
+    // Copies a window out of its parent's ByteArray, so that data_
+    // starts at this String's first byte. Ruby code indexes @data
+    // directly, so reading or writing @data calls this first.
+    void materialize(STATE) {
+      if(unlikely(window_p())) unshare(state);
+    }
 
     void unshare(STATE);
     hashval hash_string(STATE);
@@ -127,6 +154,9 @@ namespace rubinius {
     Fixnum* tr_expand(STATE, Object* limit);
     Fixnum* tr_replace(STATE, struct tr_data* data);
 
+    // Ruby.primitive :string_substring
+    String* substring(STATE, Fixnum* start, Fixnum* count);
+
     // Ruby.primitive :string_copy_from
     String* copy_from(STATE, String* other, Fixnum* start, Fixnum* size, Fixnum* dest);
 
@@ -13,8 +13,11 @@
 #include "vm/vm.hpp"
 
 #include "compiled_file.hpp"
+#include "sha1.hpp"
 #include "objectmemory.hpp"
 #include "global_cache.hpp"
+#include "background_compiler.hpp"
+#include "code_cache.hpp"
 #include "config_parser.hpp"
 
 #include "builtin/array.hpp"
@@ -44,20 +47,20 @@ namespace rubinius {
   // unmarshal_data method works.
   Object* System::compiledfile_load(STATE, String* path, Object* version) {
     if(!state->probe->nil_p()) {
-      state->probe->load_runtime(state, std::string(path->c_str()));
+      state->probe->load_runtime(state, std::string(path->c_str(state)));
     }
 
-    std::ifstream stream(path->c_str());
+    std::ifstream stream(path->c_str(state));
     if(!stream) {
       std::ostringstream msg;
-      msg << "unable to open file to run: " << path->c_str();
+      msg << "unable to open file to run: " << path->c_str(state);
       Exception::io_error(state, msg.str().c_str());
     }
 
-    CompiledFile* cf = CompiledFile::load(stream);
+    CompiledFile* cf = CompiledFile::load(stream, path->c_str(state));
     if(cf->magic != "!RBIX") {
       std::ostringstream msg;
-      msg << "Invalid file: " << path->c_str();
+      msg << "Invalid file: " << path->c_str(state);
       Exception::io_error(state, msg.str().c_str());
     }
 
@@ -67,6 +70,28 @@ namespace rubinius {
     return body;
   }
 
+  Object* System::compiledfile_load_string(STATE, String* data) {
+    std::istringstream stream(std::string(data->byte_address(), data->size()));
+
+    CompiledFile* cf = CompiledFile::load(stream);
+    if(cf->magic != "!RBIX") {
+      delete cf;
+      Exception::io_error(state, "Invalid compiled file data");
+    }
+
+    Object *body = cf->body(state);
+
+    delete cf;
+    return body;
+  }
+
+  Object* System::compiledfile_digest(STATE, String* path) {
+    std::string digest = SHA1::file_hexdigest(path->c_str(state));
+    if(digest.empty()) return Qnil;
+
+    return String::create(state, digest.c_str());
+  }
+
   Object* System::yield_gdb(STATE, Object* obj) {
     obj->show(state);
     Exception::assertion_error(state, "yield_gdb called and not caught");
@@ -83,10 +108,10 @@ namespace rubinius {
 
     for (std::size_t i = 0; i < argc; ++i) {
       /* strdup should be OK. Trying to exec with strings containing NUL == bad. --rue */
-      argv[i] = ::strdup(as<String>(args->get(state, i))->c_str());
+      argv[i] = ::strdup(as<String>(args->get(state, i))->c_str(state));
     }
 
-    (void) ::execvp(path->c_str(), &argv[0]); /* std::vector is contiguous. --rue */
+    (void) ::execvp(path->c_str(state), &argv[0]); /* std::vector is contiguous. --rue */
 
     /* execvp() returning means it failed. */
     Exception::errno_error(state, "execvp() failed!");
@@ -122,7 +147,7 @@ namespace rubinius {
   }
 
   Object* System::vm_get_config_item(STATE, String* var) {
-    ConfigParser::Entry* ent = state->user_config->find(var->c_str());
+    ConfigParser::Entry* ent = state->user_config->find(var->c_str(state));
     if(!ent) return Qnil;
 
     if(ent->is_number()) {
@@ -178,7 +203,7 @@ namespace rubinius {
   }
 
   Object* System::vm_write_error(STATE, String* str) {
-    std::cerr << str->c_str() << std::endl;
+    std::cerr << str->c_str(state) << std::endl;
     return Qnil;
   }
 
@@ -187,9 +212,17 @@ namespace rubinius {
       return Qnil;
     }
 
-    Array* ary = Array::create(state, 2);
+    size_t queued = 0;
+    if(state->background_compiler) {
+      queued = state->background_compiler->queue_length();
+    }
+
+    Array* ary = Array::create(state, 5);
     ary->set(state, 0, Integer::from(state, state->stats.jit_timing));
     ary->set(state, 1, Integer::from(state, state->stats.jitted_methods));
+    ary->set(state, 2, Integer::from(state, queued));
+    ary->set(state, 3, Integer::from(state, state->stats.jit_install_latency));
+    ary->set(state, 4, Integer::from(state, state->code_cache->used_bytes()));
 
     return ary;
   }
@@ -31,6 +31,14 @@ namespace rubinius {
     // Ruby.primitive :compiledfile_load
     static Object*  compiledfile_load(STATE, String* path, Object* version);
 
+    /** Load a binary compiled file, header and all, held in +data+. */
+    // Ruby.primitive :compiledfile_load_string
+    static Object*  compiledfile_load_string(STATE, String* data);
+
+    /** SHA-1 of the contents of the file at +path+, in hex, or nil. */
+    // Ruby.primitive :compiledfile_digest
+    static Object*  compiledfile_digest(STATE, String* path);
+
     /**
      *  When running under GDB, stop here.
      *
@@ -132,7 +140,11 @@ namespace rubinius {
     static Object*  vm_write_error(STATE, String* str);
 
     /**
-     *  Returns information about how the JIT is working.
+     *  Returns information about how the JIT is working:
+     *  [time spent compiling (ns), methods installed,
+     *   methods queued but not yet installed,
+     *   total time from queueing to installing (ns),
+     *   bytes of machine code in the code cache]
      */
     // Ruby.primitive :vm_jit_info
     static Object*  vm_jit_info(STATE);
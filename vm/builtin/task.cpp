@@ -290,7 +290,9 @@ namespace rubinius {
     if(instance_of<Class>(mod)) {
       Class* cls = as<Class>(mod);
 
-      method->formalize(state, false);
+      // A stub from a binary .rbc is left alone until it's first run;
+      // specialize() holds on to the type until then.
+      if(!method->lazy_p()) method->formalize(state, false);
 
       object_type type = (object_type)cls->instance_type()->to_native();
       TypeInfo* ti = state->om->type_info[type];
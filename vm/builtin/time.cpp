@@ -191,11 +191,11 @@ namespace rubinius {
      *        if (and only if) struct tm does not have a const tm_zone,
      *        but for now, just reference the original. It *should* be
      *        safe. --rue */
-    tm.tm_zone = const_cast<char*>(as<String>(ary->get(state, 10))->c_str());
+    tm.tm_zone = const_cast<char*>(as<String>(ary->get(state, 10))->c_str(state));
 #endif
 
     size_t chars = ::strftime(str, MAX_STRFTIME_OUTPUT,
-                              format->c_str(), &tm);
+                              format->c_str(state), &tm);
     str[MAX_STRFTIME_OUTPUT-1] = 0;
 
     return String::create(state, str, chars);
@@ -6,6 +6,7 @@
 #include "builtin/compactlookuptable.hpp"
 
 #include <cstdarg>
+#include <cstring>
 #include <iostream>
 
 namespace rubinius {
@@ -90,19 +91,71 @@ namespace rubinius {
           "length should not exceed space in destination");
     }
 
-    for(size_t src = olend, dst = lend;
-        src < (size_t)(olend + olength);
-        ++src, ++dst) {
-      // Since we have carefully checked the bounds we don't need to do it in at/put
-      Object *obj = other->field[src];
-      this->field[dst] = obj;
-      // but this is necessary to keep the GC happy
-      if(obj->reference_p()) write_barrier(state, obj);
+    copy_fields(state, lend, other, olend, olength);
+
+    return this;
+  }
+
+  Tuple* Tuple::fill(STATE, Fixnum* start, Fixnum* length, Object* val) {
+    native_int size = num_fields();
+    native_int lend = start->to_native();
+    native_int cnt = length->to_native();
+
+    if(lend < 0 || lend > size) {
+      Exception::object_bounds_exceeded_error(state, this, lend);
     }
 
+    if(cnt < 0 || cnt > size - lend) {
+      Exception::object_bounds_exceeded_error(state,
+          "length should not exceed size of tuple");
+    }
+
+    fill_fields(state, lend, cnt, val);
     return this;
   }
 
+  Tuple* Tuple::concat(STATE, Tuple* other) {
+    size_t size = num_fields();
+    size_t osize = other->num_fields();
+    Tuple* tup = Tuple::create(state, size + osize);
+
+    tup->copy_fields(state, 0, this, 0, size);
+    tup->copy_fields(state, size, other, 0, osize);
+
+    return tup;
+  }
+
+  void Tuple::copy_fields(STATE, size_t dest, Tuple* other, size_t start, size_t length) {
+    if(length == 0) return;
+
+    std::memmove(field + dest, other->field + start, length * sizeof(Object*));
+
+    // Moving fields around within one tuple adds no new references.
+    if(other != this) write_barrier_fields(state, dest, length);
+  }
+
+  void Tuple::fill_fields(STATE, size_t start, size_t length, Object* val) {
+    Object** fld = field + start;
+    for(size_t i = 0; i < length; i++) {
+      fld[i] = val;
+    }
+
+    if(length > 0 && val->reference_p()) write_barrier(state, val);
+  }
+
+  void Tuple::write_barrier_fields(STATE, size_t start, size_t length) {
+    // Young tuples are scanned anyway, and a remembered one already is.
+    if(Remember || !mature_object_p()) return;
+
+    for(size_t i = start; i < start + length; i++) {
+      Object* obj = field[i];
+      if(obj->reference_p() && obj->young_object_p()) {
+        write_barrier(state, obj);
+        return;
+      }
+    }
+  }
+
   Fixnum* Tuple::delete_inplace(STATE, Fixnum *start, Fixnum *length, Object *obj) {
     int size = this->num_fields();
     int lend = start->to_native();
@@ -149,15 +202,7 @@ namespace rubinius {
   Tuple* Tuple::pattern(STATE, Fixnum* size, Object* val) {
     native_int cnt = size->to_native();
     Tuple* tuple = Tuple::create(state, cnt);
-
-    // val is referend size times, we only need to hit the write
-    // barrier once
-    if(val->reference_p()) tuple->write_barrier(state, val);
-    for(native_int i = 0; i < cnt; i++) {
-      // bounds checking is covered because we instantiated the tuple
-      // in this method
-      tuple->field[i] = val;
-    }
+    tuple->fill_fields(state, 0, cnt, val);
 
     return tuple;
   }
@@ -33,15 +33,36 @@ namespace rubinius {
     // Ruby.primitive :tuple_pattern
     static Tuple* pattern(STATE, Fixnum* size, Object* val);
 
+    /** Copies a range of +other+, which may be this tuple with the
+     *  ranges overlapping, into this one at +dest+. */
     // Ruby.primitive :tuple_copy_from
     Tuple* copy_from(STATE, Tuple* other, Fixnum *start, Fixnum *length, Fixnum *dest);
 
+    // Ruby.primitive :tuple_fill
+    Tuple* fill(STATE, Fixnum* start, Fixnum* length, Object* val);
+
+    /** A new tuple holding the fields of this one then those of +other+. */
+    // Ruby.primitive :tuple_concat
+    Tuple* concat(STATE, Tuple* other);
+
     // Ruby.primitive :tuple_delete_inplace
     Fixnum* delete_inplace(STATE, Fixnum *start, Fixnum *length, Object *obj);
 
     // Ruby.primitive :tuple_create_weakref
     static Tuple* create_weakref(STATE, Object* obj);
 
+    /* The bulk operations below don't check bounds; the callers above
+     * and in Array and Hash have already done that. They move fields
+     * with memmove and run the write barrier once per call rather than
+     * once per field. */
+
+    void copy_fields(STATE, size_t dest, Tuple* other, size_t start, size_t length);
+    void fill_fields(STATE, size_t start, size_t length, Object* val);
+
+    /** Runs the write barrier for fields just stored in bulk. A tuple
+     *  is remembered as a whole, so one young reference is enough. */
+    void write_barrier_fields(STATE, size_t start, size_t length);
+
   public: // Inline Functions
     Object* at(STATE, size_t index) {
       if(num_fields() <= index) {
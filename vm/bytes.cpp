@@ -0,0 +1,71 @@
+#include "vm/bytes.hpp"
+
+#include <cstring>
+
+namespace rubinius {
+namespace bytes {
+
+  const static uint64_t cMul = 0xc6a4a7935bd1e995ULL;
+  const static int cShift = 47;
+
+  // Unaligned loads. memcpy of a constant size compiles to a single mov.
+  static inline uint64_t load64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  static inline uint64_t mix(uint64_t h, uint64_t k) {
+    k *= cMul;
+    k ^= k >> cShift;
+    k *= cMul;
+
+    h ^= k;
+    h *= cMul;
+    return h;
+  }
+
+  uint64_t hash(const void* data, size_t size) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint64_t h = 0x8445d61a4e774912ULL ^ (size * cMul);
+
+    // Long keys run two independent lanes, 16 bytes a step, so the
+    // multiplies of one lane overlap with the other's.
+    if(size >= 32) {
+      uint64_t h2 = h ^ 0x9e3779b97f4a7c15ULL;
+      const uint8_t* end = p + (size & ~(size_t)15);
+
+      while(p < end) {
+        h = mix(h, load64(p));
+        h2 = mix(h2, load64(p + 8));
+        p += 16;
+      }
+
+      h = mix(h, h2);
+    }
+
+    const uint8_t* end = p + ((size - (p - static_cast<const uint8_t*>(data))) & ~(size_t)7);
+    while(p < end) {
+      h = mix(h, load64(p));
+      p += 8;
+    }
+
+    switch(size & 7) {
+    case 7: h ^= (uint64_t)p[6] << 48;  // fall through
+    case 6: h ^= (uint64_t)p[5] << 40;  // fall through
+    case 5: h ^= (uint64_t)p[4] << 32;  // fall through
+    case 4: h ^= (uint64_t)p[3] << 24;  // fall through
+    case 3: h ^= (uint64_t)p[2] << 16;  // fall through
+    case 2: h ^= (uint64_t)p[1] << 8;   // fall through
+    case 1: h ^= (uint64_t)p[0];
+            h *= cMul;
+    }
+
+    h ^= h >> cShift;
+    h *= cMul;
+    h ^= h >> cShift;
+
+    return h;
+  }
+}
+}
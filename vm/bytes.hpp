@@ -0,0 +1,42 @@
+#ifndef RBX_VM_BYTES_HPP
+#define RBX_VM_BYTES_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <cstring>
+
+namespace rubinius {
+
+  /**
+   *  Hashing and comparison over raw byte ranges, used by String,
+   *  ByteArray and SymbolTable.
+   *
+   *  The hash works 8 bytes a step, and 16 (in two lanes) once a key is
+   *  32 bytes or longer, rather than a byte at a time. Comparison is
+   *  left to memcmp, which libc already vectorizes and picks the SSE or
+   *  AVX2 version of for the CPU it runs on; benchmark/rubinius/
+   *  bytes_hash.cpp shows it beating hand written SSE2 loops at every
+   *  length. Unlike strncmp it doesn't stop at a NUL byte.
+   */
+  namespace bytes {
+
+    // A 64 bit hash of +size+ bytes at +data+, built on the
+    // MurmurHash64A mix. Not stable across byte orders, so never
+    // persist it.
+    uint64_t hash(const void* data, size_t size);
+
+    // True if the +size+ bytes at +a+ and +b+ are the same.
+    inline bool equal(const void* a, const void* b, size_t size) {
+      return std::memcmp(a, b, size) == 0;
+    }
+
+    // <0, 0 or >0 as the first differing byte of +a+ is less than,
+    // absent from or greater than the one in +b+, with the bytes
+    // compared as unsigned.
+    inline int compare(const void* a, const void* b, size_t size) {
+      return std::memcmp(a, b, size);
+    }
+  }
+}
+
+#endif
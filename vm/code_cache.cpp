@@ -0,0 +1,193 @@
+#include "vm/code_cache.hpp"
+
+#include "vmmethod.hpp"
+#include "builtin/machine_method.hpp"
+
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+namespace rubinius {
+
+  CodeCache::CodeCache(size_t limit)
+    : limit_(limit)
+    , mapped_(0)
+    , used_(0)
+    , epoch_(0)
+  { }
+
+  CodeCache::~CodeCache() {
+    for(Segments::iterator i = segments_.begin(); i != segments_.end(); i++) {
+      unmap((*i)->base, (*i)->size);
+      delete *i;
+    }
+  }
+
+  size_t CodeCache::page_size() {
+    static size_t size = 0;
+    if(size == 0) size = sysconf(_SC_PAGESIZE);
+    return size;
+  }
+
+  static size_t round_to_pages(size_t bytes) {
+    size_t page = CodeCache::page_size();
+    return (bytes + page - 1) & ~(page - 1);
+  }
+
+  uint8_t* CodeCache::map(size_t bytes) {
+    void* mem = mmap(NULL, round_to_pages(bytes), PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(mem == MAP_FAILED) return NULL;
+    return static_cast<uint8_t*>(mem);
+  }
+
+  void CodeCache::unmap(void* address, size_t bytes) {
+    munmap(address, round_to_pages(bytes));
+  }
+
+  void CodeCache::protect(void* address, size_t bytes, bool executable) {
+    int prot = executable ? PROT_READ | PROT_EXEC : PROT_READ | PROT_WRITE;
+    if(mprotect(address, round_to_pages(bytes), prot) != 0) {
+      throw std::runtime_error("Unable to change protection of machine code");
+    }
+  }
+
+  CodeCache::Segment* CodeCache::add_segment(size_t bytes) {
+    size_t size = bytes > cSegmentSize ? round_to_pages(bytes) : cSegmentSize;
+    if(mapped_ + size > limit_) return NULL;
+
+    uint8_t* base = map(size);
+    if(!base) return NULL;
+
+    Segment* seg = new Segment;
+    seg->base = base;
+    seg->size = size;
+    seg->used = 0;
+    seg->live = 0;
+
+    segments_.push_back(seg);
+    mapped_ += size;
+
+    return seg;
+  }
+
+  void* CodeCache::allocate(VMMethod* vmm, size_t bytes) {
+    bytes = round_to_pages(bytes);
+
+    Segment* seg = NULL;
+    for(Segments::iterator i = segments_.begin(); i != segments_.end(); i++) {
+      if((*i)->size - (*i)->used >= bytes) {
+        seg = *i;
+        break;
+      }
+    }
+
+    if(!seg && !(seg = add_segment(bytes))) return NULL;
+
+    uint8_t* code = seg->base + seg->used;
+    seg->used += bytes;
+    seg->live += bytes;
+    used_ += bytes;
+
+    Entry& entry = entries_[code];
+    entry.vmm = vmm;
+    entry.segment = seg;
+    entry.size = bytes;
+    entry.epoch = epoch_;
+    entry.retired = false;
+    entry.running = false;
+
+    // Freed pages may still be executable from their last use.
+    protect(code, bytes, false);
+
+    return code;
+  }
+
+  void CodeCache::commit(void* code) {
+    Entry* entry = find(code);
+    if(!entry) return;
+
+    protect(code, entry->size, true);
+  }
+
+  CodeCache::Entry* CodeCache::find(void* address) {
+    uint8_t* addr = static_cast<uint8_t*>(address);
+
+    Entries::iterator i = entries_.upper_bound(addr);
+    if(i == entries_.begin()) return NULL;
+    i--;
+
+    if(addr >= i->first + i->second.size) return NULL;
+    return &i->second;
+  }
+
+  void CodeCache::retire(void* code) {
+    if(Entry* entry = find(code)) entry->retired = true;
+  }
+
+  void CodeCache::mark_running(void* address) {
+    if(Entry* entry = find(address)) entry->running = true;
+  }
+
+  void CodeCache::free(Entries::iterator i) {
+    Segment* seg = i->second.segment;
+
+    seg->live -= i->second.size;
+    used_ -= i->second.size;
+
+    // Hand the pages back to the OS, but keep them reserved.
+    madvise(i->first, i->second.size, MADV_DONTNEED);
+
+    // Once everything in a segment is gone, start it over.
+    if(seg->live == 0) seg->used = 0;
+
+    entries_.erase(i);
+  }
+
+  size_t CodeCache::sweep() {
+    size_t freed = 0;
+
+    for(Entries::iterator i = entries_.begin(); i != entries_.end();) {
+      Entries::iterator cur = i++;
+
+      if(cur->second.retired && !cur->second.running) {
+        freed += cur->second.size;
+        free(cur);
+      } else {
+        cur->second.running = false;
+      }
+    }
+
+    return freed;
+  }
+
+  size_t CodeCache::evict_cold() {
+    size_t evicted = 0;
+
+    for(Entries::iterator i = entries_.begin(); i != entries_.end(); i++) {
+      Entry& entry = i->second;
+      VMMethod* vmm = entry.vmm;
+
+      if(entry.retired || !vmm) continue;
+
+      // Only look at the code the method is currently using.
+      MachineMethod* mm = vmm->machine_method();
+      if(!mm || mm->function() != i->first) continue;
+
+      if(entry.epoch < epoch_ && vmm->epoch_calls < cColdCalls) {
+        vmm->discard_machine_method();
+        evicted++;
+      }
+
+      vmm->epoch_calls = 0;
+    }
+
+    epoch_++;
+
+    return evicted;
+  }
+}
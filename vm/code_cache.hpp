@@ -0,0 +1,152 @@
+#ifndef RBX_VM_CODE_CACHE_HPP
+#define RBX_VM_CODE_CACHE_HPP
+
+#include <list>
+#include <map>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace rubinius {
+  class VMMethod;
+
+  /**
+   *  Executable memory for the machine code of MachineMethods.
+   *
+   *  Memory is mapped from the OS in segments, and each segment is handed
+   *  out by bumping a pointer, a whole number of pages at a time. Pages
+   *  are never writable and executable at once: allocate() returns
+   *  writable pages, and commit() flips them to executable once the code
+   *  has been copied in and relocated.
+   *
+   *  Code goes away in two steps. A MachineMethod which is collected, or
+   *  whose method was evicted for being cold, has its code retired. The
+   *  code is only freed by sweep() once no context was seen running it
+   *  during a mature GC, since a context keeps running the code it started in.
+   *  A segment whose code has all been freed starts over from its base.
+   */
+  class CodeCache {
+  public:
+    struct Segment {
+      uint8_t* base;
+      size_t size;
+
+      // Bump pointer, as an offset from base
+      size_t used;
+
+      // Bytes allocated and not yet freed
+      size_t live;
+    };
+
+    struct Entry {
+      // NULL for code which doesn't belong to a method
+      VMMethod* vmm;
+      Segment* segment;
+      size_t size;
+
+      // The epoch the code was installed in. Code is only cold once
+      // it's lived through an epoch.
+      size_t epoch;
+
+      // The MachineMethod is gone, so the code can be freed once no
+      // context is running it.
+      bool retired;
+
+      // A context was running this code at the last GC
+      bool running;
+    };
+
+    typedef std::list<Segment*> Segments;
+    typedef std::map<uint8_t*, Entry> Entries;
+
+    const static size_t cDefaultLimit = 64 * 1024 * 1024;
+    const static size_t cSegmentSize = 1024 * 1024;
+
+    // Methods called fewer times than this during an epoch are cold.
+    const static long cColdCalls = 10;
+
+  private:
+    size_t limit_;
+    size_t mapped_;
+    size_t used_;
+    size_t epoch_;
+
+    Segments segments_;
+    Entries entries_;
+
+  public:
+    CodeCache(size_t limit = cDefaultLimit);
+
+    // Unmaps every segment, so only delete it once nothing can be running
+    // the code.
+    ~CodeCache();
+
+    // The OS page size, which everything is rounded to.
+    static size_t page_size();
+
+    // Map +bytes+ of writable memory, outside of any cache.
+    static uint8_t* map(size_t bytes);
+
+    static void unmap(void* address, size_t bytes);
+
+    // Flip the pages covering +bytes+ at +address+ between writable and
+    // executable.
+    static void protect(void* address, size_t bytes, bool executable);
+
+    // Returns +bytes+ of writable memory for the code of +vmm+, or NULL
+    // if the limit has been reached.
+    void* allocate(VMMethod* vmm, size_t bytes);
+
+    // Makes the code at +code+, from allocate(), executable.
+    void commit(void* code);
+
+    // Called when the MachineMethod which owns +code+ is collected.
+    void retire(void* code);
+
+    // Called by the GC with the runner of each live context.
+    void mark_running(void* address);
+
+    // Frees the retired code which no context was running. Call after
+    // a mature GC, so that mark_running() has seen every context.
+    // Returns the number of bytes freed.
+    size_t sweep();
+
+    // Stops new calls using the code of methods which were called less
+    // than cColdCalls times since the last time this ran, then starts a
+    // new epoch. The code itself is retired when its MachineMethod is
+    // collected. Returns the number of methods evicted.
+    size_t evict_cold();
+
+    // Bytes of code allocated and not yet freed
+    size_t used_bytes() {
+      return used_;
+    }
+
+    // Bytes mapped from the OS
+    size_t mapped_bytes() {
+      return mapped_;
+    }
+
+    size_t limit() {
+      return limit_;
+    }
+
+    // Only stops new segments being mapped; nothing is unmapped to get
+    // under a lower limit.
+    void set_limit(size_t limit) {
+      limit_ = limit;
+    }
+
+    size_t epoch() {
+      return epoch_;
+    }
+
+    // The entry for the code containing +address+, or NULL.
+    Entry* find(void* address);
+
+  private:
+    Segment* add_segment(size_t bytes);
+    void free(Entries::iterator i);
+  };
+}
+
+#endif
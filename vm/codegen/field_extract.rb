@@ -205,11 +205,9 @@ class CPPClass
 
     offset = ary.size
     @fields.each do |n,t,i|
-      if readonly?(n)
-        flags = {:readonly => true}
-      else
-        flags = {}
-      end
+      flags = {}
+      flags[:readonly] = true if readonly?(n)
+      flags[:lazy] = true if lazy?(n)
       ary << [n, t, i + offset, flags]
     end
 
@@ -220,6 +218,12 @@ class CPPClass
     @flags[name] == "readonly"
   end
 
+  # A lazy field may not be filled in yet; the class's materialize(state)
+  # is called before Ruby reads or writes it.
+  def lazy?(name)
+    @flags[name] == "lazy"
+  end
+
   def add_primitive(name, cpp_name, ret, args, overload=false)
     prim = CPPPrimitive.new(name, @name)
     prim.cpp_name = cpp_name
@@ -270,6 +274,7 @@ class CPPClass
     str = ""
     all_fields.each do |name, type, idx, flags|
       str << "  case #{idx}:\n"
+      str << "    target->materialize(state);\n" if flags[:lazy]
       if type == :MethodContext or type == :BlockContext
         str << "    if(MethodContext* sub = try_as<MethodContext>(target->#{name}())) {\n"
         str << "      sub->reference(state);\n"
@@ -288,6 +293,7 @@ class CPPClass
       if flags[:readonly]
         str << "    Exception::assertion_error(state, \"#{name} is readonly\");\n"
       else
+        str << "    target->materialize(state);\n" if flags[:lazy]
         str << "    target->#{name}(state, val->nil_p() ? (#{type}*)Qnil : as<#{type}>(val));\n"
       end
       str << "    return;\n"
@@ -368,6 +374,8 @@ void #{@name}::Info::auto_mark(Object* _t, ObjectMark& mark) {
       return "FIXNUM_P(#{what})"
     when "Symbol"
       return "SYMBOL_P(#{what})"
+    when "Float"
+      return "(FLONUM_P(#{what}) || (REFERENCE_P(#{what}) && #{what}->obj_type == FloatType))"
     when "TrueClass"
       return "#{what} == Qtrue"
     when "FalseClass"
@@ -488,7 +496,7 @@ class CPPParser
           name = m[2]
 
           # Optional 'flag' argument after '// slot'
-          # Currently 'readonly' is the only supported flag
+          # Currently 'readonly' and 'lazy' are supported
           if m[3]
             flag = m[3].strip
           else
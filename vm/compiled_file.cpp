@@ -18,8 +18,74 @@
 #include "builtin/class.hpp"
 #include "builtin/thread.hpp"
 
+#include <cstring>
+#include <istream>
+#include <iterator>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 
 namespace rubinius {
+  MappedFile::MappedFile(const char* path, size_t offset)
+    : data(NULL)
+    , size(0)
+    , unmarshaller(NULL)
+    , base_(NULL)
+    , mapped_(0)
+  {
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) return;
+
+    struct stat st;
+    if(fstat(fd, &st) == 0 && (size_t)st.st_size > offset) {
+      void* base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE, fd, 0);
+      if(base != MAP_FAILED) {
+        base_ = base;
+        mapped_ = st.st_size;
+        data = static_cast<uint8_t*>(base) + offset;
+        size = st.st_size - offset;
+      }
+    }
+
+    close(fd);
+  }
+
+  MappedFile::MappedFile(std::istream& stream)
+    : data(NULL)
+    , size(0)
+    , unmarshaller(NULL)
+    , base_(NULL)
+    , mapped_(0)
+  {
+    std::string body((std::istreambuf_iterator<char>(stream)),
+                     std::istreambuf_iterator<char>());
+
+    // new[] of uint32_t so the words are aligned
+    size = body.size();
+    data = reinterpret_cast<uint8_t*>(new uint32_t[size / sizeof(uint32_t) + 1]);
+    std::memcpy(data, body.data(), size);
+  }
+
+  MappedFile::~MappedFile() {
+    delete unmarshaller;
+
+    if(base_) {
+      munmap(base_, mapped_);
+    } else {
+      delete[] reinterpret_cast<uint32_t*>(data);
+    }
+  }
+
+  CompiledFile* CompiledFile::load(std::istream& stream, const std::string& path) {
+    CompiledFile* cf = load(stream);
+    cf->path = path;
+    return cf;
+  }
+
   CompiledFile* CompiledFile::load(std::istream& stream) {
     std::string magic, sum;
     long ver;
@@ -33,13 +99,44 @@ namespace rubinius {
   }
 
   Object* CompiledFile::body(STATE) {
-    UnMarshaller mar(state, *stream);
-    return mar.unmarshal();
+    if(version != cBinaryVersion) {
+      UnMarshaller mar(state, *stream);
+      return mar.unmarshal();
+    }
+
+    // The header is text, so the body is padded out to a word boundary.
+    size_t offset = stream->tellg();
+    size_t skip = (sizeof(uint32_t) - offset % sizeof(uint32_t)) % sizeof(uint32_t);
+
+    MappedFile* file = NULL;
+    if(!path.empty()) {
+      file = new MappedFile(path.c_str(), offset + skip);
+      if(!file->open_p()) {
+        delete file;
+        file = NULL;
+      }
+    }
+
+    if(!file) {
+      stream->ignore(skip);
+      file = new MappedFile(*stream);
+    }
+
+    state->mapped_files.push_back(file);
+
+    // Methods are left as stubs until they're run, so the unmarshaller
+    // stays with the data it reads them from.
+    file->unmarshaller = new BinaryUnMarshaller(state, file->data, file->size, true);
+    return file->unmarshaller->unmarshal();
   }
 
   bool CompiledFile::execute(STATE) {
+    return execute(state, as<CompiledMethod>(body(state)));
+  }
+
+  bool CompiledFile::execute(STATE, CompiledMethod* meth) {
+    TypedRoot<CompiledMethod*> cm(state, meth);
     Task* task = state->new_task();
-    TypedRoot<CompiledMethod*> cm(state, as<CompiledMethod>(body(state)));
 
     Message msg(state);
     msg.setup(NULL, G(main), task->active(), 0, 0);
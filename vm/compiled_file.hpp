@@ -2,6 +2,8 @@
 #define RBX_COMPILED_FILE_HPP
 
 #include <string>
+#include <stddef.h>
+#include <stdint.h>
 
 #include "prelude.hpp"
 
@@ -9,13 +11,57 @@ namespace rubinius {
 
   class Object;
   class VM;
+  class CompiledMethod;
+  class BinaryUnMarshaller;
+
+  /**
+   *  The body of a binary .rbc, either mmap'd from the file or read into
+   *  the heap. VMMethods run opcodes straight out of it, and methods not
+   *  yet run are unmarshalled from it, so the VM keeps every one until
+   *  it's deleted.
+   */
+  class MappedFile {
+  public:
+    uint8_t* data;
+    size_t size;
+
+    // Reads the stub methods in +data+ as they're needed; owned.
+    BinaryUnMarshaller* unmarshaller;
+
+  private:
+    void* base_;
+    size_t mapped_;
+
+  public:
+    // Maps the part of the file at +path+ from +offset+ on. Pages are
+    // private, so the opcodes can be patched in place. open_p() is false
+    // if it couldn't be mapped.
+    MappedFile(const char* path, size_t offset);
+
+    // Copies the rest of +stream+.
+    MappedFile(std::istream& stream);
+
+    ~MappedFile();
+
+    bool open_p() {
+      return data != NULL;
+    }
+  };
 
   class CompiledFile {
   public:
+    // The version of .rbc whose body is in the binary format read by
+    // BinaryUnMarshaller. Other versions are text.
+    const static long cBinaryVersion = 2;
+
     std::string magic;
     long version;
     std::string sum;
 
+    // If set, the binary body is mapped from here rather than read from
+    // the stream.
+    std::string path;
+
   private:
     std::istream* stream;
 
@@ -27,8 +73,15 @@ namespace rubinius {
 
 
     static CompiledFile* load(std::istream& stream);
+
+    // As above, for the .rbc at +path+ which +stream+ is reading.
+    static CompiledFile* load(std::istream& stream, const std::string& path);
+
     Object* body(STATE);
     bool execute(STATE);
+
+    // Runs +cm+ as a script body, the same way execute runs ours.
+    static bool execute(STATE, CompiledMethod* cm);
   };
 
 }
@@ -3,9 +3,9 @@
 
 #include "detection.hpp"
 
-// Currently, these are only support on x86-32
+// Currently, these are only support on x86-32 and x86-64
 
-#ifdef IS_X8632
+#if defined(IS_X8632) || defined(IS_X8664)
 
 // Add support for the new dynamic interpreter
 #define USE_DYNAMIC_INTERPRETER
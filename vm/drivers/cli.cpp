@@ -1,9 +1,11 @@
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 #include <sys/stat.h>
 
 #include "vm/environment.hpp"
+#include "vm/config_parser.hpp"
 #include "vm/oop.hpp"
 #include "vm/type_info.hpp"
 #include "vm/exception.hpp"
@@ -13,6 +15,41 @@
 using namespace std;
 using namespace rubinius;
 
+/* The kernel image packs alpha.rbc and every file named by the
+ * load_order.txt files into one binary .rbc (see lib/bin/kernel_image.rb).
+ * It is only used if it's at least as new as everything it was built
+ * from; rake build rewrites the load_order.txt files each time, so an
+ * image left over from an older kernel is ignored rather than loaded.
+ * -Xrbx.kernel.image=false turns it off.
+ */
+static bool kernel_image_current_p(Environment& env, std::string root,
+                                   std::string image) {
+  if(ConfigParser::Entry* ent = env.state->user_config->find("rbx.kernel.image")) {
+    if(!ent->is_true()) return false;
+  }
+
+  struct stat st;
+  if(stat(image.c_str(), &st) == -1) return false;
+  time_t built = st.st_mtime;
+
+  std::vector<std::string> sources;
+  sources.push_back(root + "/index");
+  sources.push_back(root + "/alpha.rbc");
+
+  std::ifstream stream((root + "/index").c_str());
+  while(stream) {
+    std::string line;
+    stream >> line;
+    if(line.size() > 0) sources.push_back(root + "/" + line + "/load_order.txt");
+  }
+
+  for(std::vector<std::string>::iterator i = sources.begin(); i != sources.end(); i++) {
+    if(stat(i->c_str(), &st) == -1 || st.st_mtime > built) return false;
+  }
+
+  return true;
+}
+
 /* Loads the runtime kernel files. They're stored in /kernel.
  * These files consist of classes needed to bootstrap the kernel
  * and just get things started in general.
@@ -29,6 +66,12 @@ static void load_runtime_kernel(Environment& env, std::string root) {
     std::cout << "It appears that " << root << "/index is missing.\n";
     exit(1);
   }
+
+  std::string image = root + "/kernel.rbi";
+  if(kernel_image_current_p(env, root, image)) {
+    env.load_kernel_image(image);
+    return;
+  }
   
   // Load the ruby file to prepare for bootstrapping Ruby!
   // The bootstrapping for the VM is already done by the time we're here.
@@ -1,6 +1,7 @@
 #include "prelude.hpp"
 #include "object_utils.hpp"
-#include "jit.hpp"
+#include "assembler/jit.hpp"
+#include "builtin/machine_method.hpp"
 #include "environment.hpp"
 
 #include "builtin/compiledmethod.hpp"
@@ -31,7 +32,8 @@ int main(int argc, char **argv) {
 
   delete cf;
 
-  MachineMethod* mm = compiler.compile(vmm);
+  compiler.compile(&state, vmm);
+  MachineMethod* mm = MachineMethod::create(&state, vmm, compiler);
   mm->show();
   return 0;
 }
@@ -6,9 +6,11 @@
 #include "compiled_file.hpp"
 
 #include "vm/exception.hpp"
+#include "vm/object_utils.hpp"
 
 #include "builtin/array.hpp"
 #include "builtin/class.hpp"
+#include "builtin/compiledmethod.hpp"
 #include "builtin/exception.hpp"
 #include "builtin/string.hpp"
 #include "builtin/symbol.hpp"
@@ -110,12 +112,43 @@ namespace rubinius {
     std::ifstream stream(file.c_str());
     if(!stream) throw std::runtime_error("Unable to open file to run");
 
-    CompiledFile* cf = CompiledFile::load(stream);
+    CompiledFile* cf = CompiledFile::load(stream, file);
     if(cf->magic != "!RBIX") throw std::runtime_error("Invalid file");
 
     // TODO check version number
     cf->execute(state);
+    check_toplevel_exception();
 
+    delete cf;
+  }
+
+  /* Runs every script packed into the kernel image at +path+, in order.
+   * The image is a binary .rbc whose body is an Array of alternating
+   * file names and script bodies, written by lib/bin/kernel_image.rb. */
+  void Environment::load_kernel_image(std::string path) {
+    std::ifstream stream(path.c_str());
+    if(!stream) throw std::runtime_error("Unable to open kernel image");
+
+    CompiledFile* cf = CompiledFile::load(stream, path);
+    if(cf->magic != "!RBIX" || cf->version != CompiledFile::cBinaryVersion) {
+      throw std::runtime_error("Invalid kernel image");
+    }
+
+    TypedRoot<Array*> scripts(state, as<Array>(cf->body(state)));
+    delete cf;
+
+    for(size_t i = 0; i + 1 < scripts->size(); i += 2) {
+      if(!state->probe->nil_p()) {
+        String* file = as<String>(scripts->get(state, i));
+        state->probe->load_runtime(state, std::string(file->c_str(state)));
+      }
+
+      CompiledFile::execute(state, as<CompiledMethod>(scripts->get(state, i + 1)));
+      check_toplevel_exception();
+    }
+  }
+
+  void Environment::check_toplevel_exception() {
     if(!G(current_task)->exception()->nil_p()) {
       // Reset the context so we can show the backtrace
       // HACK need to use write barrier aware stuff?
@@ -126,13 +159,11 @@ namespace rubinius {
 
       msg << "exception detected at toplevel: ";
       if(!exc->message()->nil_p()) {
-        msg << exc->message()->c_str();
+        msg << exc->message()->c_str(state);
       }
       msg << " (" << exc->klass()->name()->c_str(state) << ")";
       Assertion::raise(msg.str().c_str());
     }
-
-    delete cf;
   }
 
 }
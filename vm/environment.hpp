@@ -20,8 +20,12 @@ namespace rubinius {
     void load_directory(std::string dir);
     void load_platform_conf(std::string dir);
     void run_file(std::string path);
+    void load_kernel_image(std::string path);
     void enable_preemption();
     void boot_vm();
+
+  private:
+    void check_toplevel_exception();
   };
 
 }
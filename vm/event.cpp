@@ -14,6 +14,8 @@
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <poll.h>
+#include <signal.h>
 #include <ev.h>
 
 #include "vm.hpp"
@@ -58,11 +60,13 @@ namespace rubinius {
       buffer(state), loop(NULL) { }
 
     void IO::stop() {
+      if(ev_is_active(&ev)) loop->unwatch_fd(fd, poll_events);
       ev_io_stop(loop->base, &ev);
     }
 
     void IO::start() {
       ev_io_start(loop->base, &ev);
+      loop->watch_fd(fd, poll_events);
     }
 
     bool IO::for_fd_p(int in) {
@@ -72,6 +76,7 @@ namespace rubinius {
 
     Write::Write(STATE, ObjectCallback* chan, int ifd) : IO(state, chan) {
       fd = ifd;
+      poll_events = POLLOUT;
       ev_io_init(&ev, event::tramp<struct ev_io>, fd, EV_WRITE);
       ev.data = this;
     }
@@ -84,6 +89,7 @@ namespace rubinius {
     Read::Read(STATE, ObjectCallback* chan, int ifd) :
         IO(state, chan), count(0) {
       fd = ifd;
+      poll_events = POLLIN;
       ev_io_init(&ev, event::tramp<struct ev_io>, fd, EV_READ);
       ev.data = this;
     }
@@ -144,10 +150,27 @@ namespace rubinius {
       ev.data = this;
     }
 
+    /* The handler libev installed for each signal, which notify() calls. */
+    static void (*libev_handlers[NSIG])(int);
+
+    void Signal::notify(int sig) {
+      libev_handlers[sig](sig);
+      if(VM* vm = VM::current_state()) vm->wakeup();
+    }
+
     void Signal::start() {
       /* Only one event of a given signal type per loop. */
       loop->remove_signal(signal);
       ev_signal_start(loop->base, &ev);
+
+      struct sigaction sa;
+      sigaction(signal, NULL, &sa);
+      if(sa.sa_handler != Signal::notify && sa.sa_handler != SIG_DFL &&
+         sa.sa_handler != SIG_IGN) {
+        libev_handlers[signal] = sa.sa_handler;
+        sa.sa_handler = Signal::notify;
+        sigaction(signal, &sa, NULL);
+      }
     }
 
     void Signal::stop() {
@@ -160,7 +183,7 @@ namespace rubinius {
     }
 
     Timer::Timer(STATE, ObjectCallback* chan, double seconds, Object* obj):
-      Event(state, chan), tag(obj), timer_(NULL)
+      Event(state, chan), tag(obj), timer_(NULL), seconds(seconds), deadline(0)
     {
       timer_ = new struct ev_timer;
       ev_timer_init(timer_, event::tramp<ev_timer>, (ev_tstamp)seconds, 0.);
@@ -168,6 +191,7 @@ namespace rubinius {
     }
 
     void Timer::start() {
+      deadline = ev_now(loop->base) + seconds;
       ev_timer_start(loop->base, timer_);
     }
 
@@ -270,12 +294,37 @@ namespace rubinius {
 
     /** @todo Fix the options. --rue */
     Loop::Loop(struct ev_loop *loop) :
-      base(loop), event_ids(0), options_(0), owner(false) { }
+      base(loop), event_ids(0), options_(0), owner(false), woken_(false),
+      next_timer_(-1) {
+      pthread_mutex_init(&fds_lock_, NULL);
+      init_wakeup();
+    }
 
-    Loop::Loop(int opts) : event_ids(0), options_(opts), owner(false) {
+    Loop::Loop(int opts) : event_ids(0), options_(opts), owner(false),
+      woken_(false), next_timer_(-1) {
       base = ev_default_loop(options_);
 
       /* @todo Should fail here if default returns NULL */
+      pthread_mutex_init(&fds_lock_, NULL);
+      init_wakeup();
+    }
+
+    /* The async watcher must not keep run_and_wait() blocking when it is
+     * the only thing registered, so it is unref'd once started. */
+    void Loop::init_wakeup() {
+      ev_async_init(&wakeup_, Loop::wakeup_cb);
+      wakeup_.data = this;
+      ev_async_start(base, &wakeup_);
+      ev_unref(base);
+    }
+
+    void Loop::wakeup_cb(EV_P_ struct ev_async* ev, int revents) {
+      /* Nothing to do, getting ev_loop to return is the point. */
+    }
+
+    void Loop::wakeup() {
+      woken_ = true;
+      ev_async_send(base, &wakeup_);
     }
 
     /* Gives this loop ownership of +ev+, letting it delete +ev+
@@ -290,10 +339,69 @@ namespace rubinius {
       // to remove itself, so we do this after the event has actually
       // started.
       events.push_back(ev);
+
+      if(Timer* timer = dynamic_cast<Timer*>(ev)) {
+        if(next_timer_ < 0 || timer->deadline < next_timer_) {
+          next_timer_ = timer->deadline;
+        }
+      }
+    }
+
+    /* Timers that fired or were cleared leave next_timer_ early, which
+     * only costs an extra poll, so it is recomputed after each run. */
+    void Loop::update_timers() {
+      ev_tstamp next = -1;
+
+      for(std::vector<Event*>::iterator it = events.begin();
+          it != events.end(); it++) {
+        if(Timer* timer = dynamic_cast<Timer*>(*it)) {
+          if(next < 0 || timer->deadline < next) next = timer->deadline;
+        }
+      }
+
+      next_timer_ = next;
+    }
+
+    bool Loop::ready_p() {
+      ev_tstamp next = next_timer_;
+      if(next >= 0 && ev_time() >= next) return true;
+
+      pthread_mutex_lock(&fds_lock_);
+      bool ready = !fds_.empty() && ::poll(&fds_[0], fds_.size(), 0) > 0;
+      pthread_mutex_unlock(&fds_lock_);
+
+      return ready;
+    }
+
+    void Loop::watch_fd(int fd, short poll_events) {
+      struct pollfd pfd;
+      pfd.fd = fd;
+      pfd.events = poll_events;
+      pfd.revents = 0;
+
+      pthread_mutex_lock(&fds_lock_);
+      fds_.push_back(pfd);
+      pthread_mutex_unlock(&fds_lock_);
+    }
+
+    void Loop::unwatch_fd(int fd, short poll_events) {
+      pthread_mutex_lock(&fds_lock_);
+      for(std::vector<struct pollfd>::iterator it = fds_.begin();
+          it != fds_.end(); it++) {
+        if(it->fd == fd && it->events == poll_events) {
+          fds_.erase(it);
+          break;
+        }
+      }
+      pthread_mutex_unlock(&fds_lock_);
     }
 
     /** @todo Figure out what to do with default vs. regular loops. --rue */
     Loop::~Loop() {
+      ev_ref(base);
+      ev_async_stop(base, &wakeup_);
+      pthread_mutex_destroy(&fds_lock_);
+
       if(owner) {
         std::vector<Event*>::iterator it;
         for(it = events.begin(); it != events.end(); it = events.erase(it)) {
@@ -315,11 +423,15 @@ namespace rubinius {
     }
 
     void Loop::poll() {
+      woken_ = false;
       ev_loop(base, EVLOOP_NONBLOCK);
+      update_timers();
     }
 
     void Loop::run_and_wait() {
+      woken_ = false;
       ev_loop(base, EVLOOP_ONESHOT);
+      update_timers();
     }
 
     void Loop::clear_by_fd(int fd) {
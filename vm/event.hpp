@@ -5,6 +5,8 @@
 
 #include <sys/wait.h>
 #include <sys/signal.h>
+#include <poll.h>
+#include <pthread.h>
 #include <ev.h>
 
 #include "prelude.hpp"
@@ -44,6 +46,9 @@ namespace rubinius {
 
       int fd;
 
+      /** POLLIN or POLLOUT, for Loop::ready_p(). */
+      short poll_events;
+
       IO(STATE, ObjectCallback* chan) : Event(state, chan) { }
       virtual ~IO() { stop(); }
       virtual bool for_fd_p(int fd);
@@ -79,6 +84,13 @@ namespace rubinius {
       virtual void start();
       virtual void stop();
       virtual bool activated();
+
+    private:
+      /**
+       *  Installed over libev's handler so that a signal also raises
+       *  VM::wakeup(); libev's handler is still called first.
+       */
+      static void notify(int sig);
     };
 
     /**
@@ -94,6 +106,9 @@ namespace rubinius {
     public:
       Object* tag;
       struct ev_timer* timer_;
+      double seconds;
+      /** When the timer fires, in ev_time(); set by start(). */
+      ev_tstamp deadline;
 
       Timer(STATE, ObjectCallback* chan, double seconds, Object* obj = Qnil);
       virtual ~Timer() { stop(); }
@@ -224,6 +239,35 @@ namespace rubinius {
       void remove_event(Event* ev);
       void remove_signal(int sig);
 
+      /**
+       *  Wake the loop if it is blocked in run_and_wait(). Uses libev's
+       *  async watcher, so it is safe to call from another native thread
+       *  or from a signal handler.
+       */
+      void wakeup();
+
+      /** Whether wakeup() has been called since the last poll. */
+      bool woken() { return woken_; }
+
+      /**
+       *  Whether a timer is due or a watched fd is ready, without
+       *  running any callbacks. Called from the preemption thread to
+       *  decide whether the interpreter needs to poll at all.
+       */
+      bool ready_p();
+
+      /** Record an fd that an IO event is waiting on, for ready_p(). */
+      void watch_fd(int fd, short poll_events);
+      void unwatch_fd(int fd, short poll_events);
+
+
+    private:  /* Helpers */
+
+      void init_wakeup();
+      void update_timers();
+
+      static void wakeup_cb(EV_P_ struct ev_async* ev, int revents);
+
 
     public:   /* Instance vars */
 
@@ -234,6 +278,15 @@ namespace rubinius {
       int                 options_;
       /** Whether this Loop controls the event loop it uses. */
       bool                owner;
+      /** Watcher used by wakeup(). Not counted in +events+. */
+      struct ev_async     wakeup_;
+      /** Set by wakeup(), cleared when the loop runs. */
+      volatile bool       woken_;
+      /** Earliest Timer deadline, or negative if there are no Timers. */
+      volatile ev_tstamp  next_timer_;
+      /** The fds IO events are waiting on, shared with ready_p(). */
+      std::vector<struct pollfd> fds_;
+      pthread_mutex_t     fds_lock_;
     };
 
   }     /* event */
@@ -27,8 +27,13 @@ namespace rubinius {
     // object.
     if(roots == r) {
 
-      // We don't add the root until it's got an object.
-      if(!object) roots->add(this);
+      // We don't add the root until it's got an object, and take it
+      // back out once the object is cleared.
+      if(!object) {
+        if(obj) roots->add(this);
+      } else if(!obj) {
+        roots->remove(this);
+      }
       object = obj;
 
     // Moving to a new set. Remove ourselves from
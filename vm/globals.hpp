@@ -57,6 +57,7 @@ namespace rubinius {
     TypedRoot<Class*> nil_class, true_class, false_class, fixnum_class, undef_class;
     TypedRoot<Class*> floatpoint, fastctx, nmc, task, list, list_node;
     TypedRoot<Class*> channel, thread, staticscope, send_site, selector, lookuptable;
+    TypedRoot<Class*> hash;
     TypedRoot<Class*> iseq, executable, native_function, iobuffer;
     TypedRoot<Class*> cmethod_vis, included_module;
 
@@ -89,7 +90,6 @@ namespace rubinius {
     TypedRoot<Object*> main;
     TypedRoot<Class*> dir;
     TypedRoot<Class*> compactlookuptable;
-    TypedRoot<Class*> lookuptablebucket;
     TypedRoot<Class*> lookuptableassociation;
     TypedRoot<Class*> access_variable;
     TypedRoot<Module*> rubinius;
@@ -150,6 +150,7 @@ namespace rubinius {
       send_site(&roots),
       selector(&roots),
       lookuptable(&roots),
+      hash(&roots),
       iseq(&roots),
       executable(&roots),
       native_function(&roots),
@@ -199,7 +200,6 @@ namespace rubinius {
       main(&roots),
       dir(&roots),
       compactlookuptable(&roots),
-      lookuptablebucket(&roots),
       lookuptableassociation(&roots),
       access_variable(&roots),
       rubinius(&roots),
@@ -728,6 +728,9 @@ class Instructions
   # [Description]
   #   Moves the instruction pointer to the instruction following the specified
   #   label without disturbing the stack.
+  #
+  #   Jumping backwards is a loop, which counts toward JIT compiling the
+  #   method, and may switch the context over to machine code.
   # [See Also]
   #   * goto_if_true
   #   * goto_if_false
@@ -735,8 +738,13 @@ class Instructions
 
   def goto(location)
     <<-CODE
+    bool backwards = location < ctx->ip;
     task->set_ip(location);
     cache_ip();
+    if(unlikely(backwards) && vmm->backedge(state, ctx)) {
+      RETURN(cExecuteRestart);
+    }
+    RETURN(cExecuteContinue);
     CODE
   end
 
@@ -813,9 +821,14 @@ class Instructions
     <<-CODE
     Object* t1 = stack_pop();
     if(!RTEST(t1)) {
+      bool backwards = location < ctx->ip;
       task->set_ip(location);
       cache_ip();
+      if(unlikely(backwards) && vmm->backedge(state, ctx)) {
+        RETURN(cExecuteRestart);
+      }
     }
+    RETURN(cExecuteContinue);
     CODE
   end
 
@@ -856,9 +869,14 @@ class Instructions
     <<-CODE
     Object* t1 = stack_pop();
     if(RTEST(t1)) {
+      bool backwards = location < ctx->ip;
       task->set_ip(location);
       cache_ip();
+      if(unlikely(backwards) && vmm->backedge(state, ctx)) {
+        RETURN(cExecuteRestart);
+      }
     }
+    RETURN(cExecuteContinue);
     CODE
   end
 
@@ -1429,8 +1447,9 @@ class Instructions
     <<-CODE
     Object* t1 = stack_back(1);
     Object* t2 = stack_back(0);
-    /* If both are not references, compare them directly. */
-    if(!t1->reference_p() && !t2->reference_p()) {
+    /* If both are not references, compare them directly. An immediate
+     * Float and a Fixnum have to go through Float#== though. */
+    if(!t1->reference_p() && !t2->reference_p() && !flonum_fixnum_p(t1, t2)) {
       stack_pop();
       stack_set_top((t1 == t2) ? Qtrue : Qfalse);
       RETURN(false);
@@ -1456,7 +1475,7 @@ class Instructions
   end
 
   # [Operation]
-  #   Implementation of > optimised for fixnums
+  #   Implementation of > optimised for fixnums and immediate floats
   # [Format]
   #   \meta_send_op_gt
   # [Stack Before]
@@ -1468,9 +1487,9 @@ class Instructions
   #   * ...
   # [Description]
   #   Pops +value1+ and +value2+ off the stack, and pushes the logical result
-  #   of (+value1+ > +value2+). If +value1+ and +value2+ are both fixnums, the
-  #   comparison is done directly; otherwise, the > method is called on
-  #   +value1+, passing +value2+ as the argument.
+  #   of (+value1+ > +value2+). If +value1+ and +value2+ are both fixnums or
+  #   both immediate floats, the comparison is done directly; otherwise, the
+  #   > method is called on +value1+, passing +value2+ as the argument.
 
   def meta_send_op_gt
     <<-CODE
@@ -1484,6 +1503,14 @@ class Instructions
       RETURN(false);
     }
 
+    if(both_flonum_p(t1, t2)) {
+      double j = ((Float*)t1)->val();
+      double k = ((Float*)t2)->val();
+      stack_pop();
+      stack_set_top((j > k) ? Qtrue : Qfalse);
+      RETURN(false);
+    }
+
     RETURN(send_slowly(vmm, task, ctx, G(sym_gt), 1));
     CODE
   end
@@ -1504,7 +1531,7 @@ class Instructions
   end
 
   # [Operation]
-  #   Implementation of < optimised for fixnums
+  #   Implementation of < optimised for fixnums and immediate floats
   # [Format]
   #   \meta_send_op_lt
   # [Stack Before]
@@ -1516,9 +1543,9 @@ class Instructions
   #   * ...
   # [Description]
   #   Pops +value1+ and +value2+ off the stack, and pushes the logical result
-  #   of (+value1+ < +value2+). If +value1+ and +value2+ are both fixnums, the
-  #   comparison is done directly; otherwise, the < method is called on
-  #   +value1+, passing +value2+ as the argument.
+  #   of (+value1+ < +value2+). If +value1+ and +value2+ are both fixnums or
+  #   both immediate floats, the comparison is done directly; otherwise, the
+  #   < method is called on +value1+, passing +value2+ as the argument.
 
   def meta_send_op_lt
     <<-CODE
@@ -1532,6 +1559,14 @@ class Instructions
       RETURN(false);
     }
 
+    if(both_flonum_p(t1, t2)) {
+      double j = ((Float*)t1)->val();
+      double k = ((Float*)t2)->val();
+      stack_pop();
+      stack_set_top((j < k) ? Qtrue : Qfalse);
+      RETURN(false);
+    }
+
     RETURN(send_slowly(vmm, task, ctx, G(sym_lt), 1));
     CODE
   end
@@ -1552,7 +1587,7 @@ class Instructions
   end
 
   # [Operation]
-  #   Implementation of - optimised for fixnums
+  #   Implementation of - optimised for fixnums and immediate floats
   # [Format]
   #   \meta_send_op_minus
   # [Stack Before]
@@ -1565,8 +1600,9 @@ class Instructions
   # [Description]
   #   Pops +value1+ and +value2+ off the stack, and pushes the logical result
   #   of (+value1+ - +value2+). If +value1+ and +value2+ are both fixnums, the
-  #   subtraction is done directly via the fixnum_sub primitive; otherwise,
-  #   the - method is called on +value1+, passing +value2+ as the argument.
+  #   subtraction is done directly via the fixnum_sub primitive, and if both
+  #   are immediate floats it is done inline; otherwise, the - method is
+  #   called on +value1+, passing +value2+ as the argument.
 
   def meta_send_op_minus
     <<-CODE
@@ -1581,6 +1617,13 @@ class Instructions
       RETURN(false);
     }
 
+    if(both_flonum_p(left, right)) {
+      stack_pop();
+      stack_pop();
+      stack_push(Float::create(state, ((Float*)left)->val() - ((Float*)right)->val()));
+      RETURN(false);
+    }
+
     RETURN(send_slowly(vmm, task, ctx, G(sym_minus), 1));
     CODE
   end
@@ -1624,8 +1667,9 @@ class Instructions
     <<-CODE
     Object* t1 = stack_back(1);
     Object* t2 = stack_back(0);
-    /* If both are not references, compare them directly. */
-    if(!t1->reference_p() && !t2->reference_p()) {
+    /* If both are not references, compare them directly. An immediate
+     * Float and a Fixnum have to go through Float#== though. */
+    if(!t1->reference_p() && !t2->reference_p() && !flonum_fixnum_p(t1, t2)) {
       stack_pop();
       stack_set_top((t1 == t2) ? Qfalse : Qtrue);
       RETURN(false);
@@ -1651,7 +1695,7 @@ class Instructions
   end
 
   # [Operation]
-  #   Implementation of + optimised for fixnums
+  #   Implementation of + optimised for fixnums and immediate floats
   # [Format]
   #   \meta_send_op_plus
   # [Stack Before]
@@ -1664,8 +1708,9 @@ class Instructions
   # [Description]
   #   Pops +value1+ and +value2+ off the stack, and pushes the logical result
   #   of (+value1+ + +value2+). If +value1+ and +value2+ are both fixnums, the
-  #   addition is done directly via the fixnum_add primitive; otherwise, the +
-  #   method is called on +value1+, passing +value2+ as the argument.
+  #   addition is done directly via the fixnum_add primitive, and if both are
+  #   immediate floats it is done inline; otherwise, the + method is called on
+  #   +value1+, passing +value2+ as the argument.
 
   def meta_send_op_plus
     <<-CODE
@@ -1680,6 +1725,13 @@ class Instructions
       RETURN(false);
     }
 
+    if(both_flonum_p(left, right)) {
+      stack_pop();
+      stack_pop();
+      stack_push(Float::create(state, ((Float*)left)->val() + ((Float*)right)->val()));
+      RETURN(false);
+    }
+
     RETURN(send_slowly(vmm, task, ctx, G(sym_plus), 1));
     CODE
   end
@@ -8,6 +8,7 @@
 
 #include "builtin/compiledmethod.hpp"
 #include "builtin/contexts.hpp"
+#include "builtin/fixnum.hpp"
 #include "builtin/iseq.hpp"
 #include "builtin/task.hpp"
 #include "builtin/tuple.hpp"
@@ -48,6 +49,7 @@
 #include <llvm/Analysis/Verifier.h>
 
 #include <algorithm>
+#include <map>
 #include <iostream>
 #include <sstream>
 #include <fstream>
@@ -131,6 +133,132 @@ namespace rubinius {
     return CallInst::Create(func, args.begin(), args.end(), "", block);
   }
 
+  static CallInst* call_function(std::string name, Value* task, Value* js,
+                                 std::vector<Value*>& extra, BasicBlock* block) {
+    Function* func = operations->getFunction(name);
+    if(!func) {
+      std::string str = std::string("Unable to find: ");
+      str += name;
+
+      throw std::runtime_error(str);
+    }
+
+    std::vector<Value*> args(0);
+    args.push_back(task);
+    args.push_back(js);
+    args.insert(args.end(), extra.begin(), extra.end());
+
+    return CallInst::Create(func, args.begin(), args.end(), "", block);
+  }
+
+  /* The operand stack of the block being translated.
+   *
+   * Values pushed by the simple instructions (constants, locals, stack
+   * shuffling and the fixnum fast paths) are kept here as SSA values
+   * rather than being stored to the context's stack. Anything below them
+   * lives in memory, and is popped into an SSA value when an instruction
+   * needs it. Before an instruction which might send, allocate or look at
+   * the stack itself, flush() spills the values back to memory, so the
+   * context is always complete at those points. Every block starts with
+   * nothing here, since it can be entered by the switch on resume.
+   *
+   * Locals read or written in the block are cached as well, until the
+   * next instruction that could change them behind our back. */
+  class JITStack {
+    Value* task_;
+    Value* js_;
+    std::vector<CallInst*>& calls_;
+    const Type* obj_type_;
+    const Type* int_type_;
+
+    std::vector<Value*> values_;
+    std::map<int, Value*> locals_;
+
+  public:
+    JITStack(Value* task, Value* js, const Type* obj_type,
+             std::vector<CallInst*>& calls)
+      : task_(task)
+      , js_(js)
+      , calls_(calls)
+      , obj_type_(obj_type)
+      , int_type_(IntegerType::get(sizeof(intptr_t) * 8))
+    { }
+
+    const Type* int_type() {
+      return int_type_;
+    }
+
+    Value* object(Object* obj) {
+      return ConstantExpr::getIntToPtr(
+          ConstantInt::get(int_type_, (uint64_t)(uintptr_t)obj), obj_type_);
+    }
+
+    void push(Value* val) {
+      values_.push_back(val);
+    }
+
+    Value* pop(BasicBlock* block) {
+      if(values_.empty()) {
+        CallInst* val = call_function("jit_pop", task_, js_, block);
+        val->setName("pop");
+        calls_.push_back(val);
+        return val;
+      }
+
+      Value* val = values_.back();
+      values_.pop_back();
+      return val;
+    }
+
+    Value* top(BasicBlock* block) {
+      Value* val = pop(block);
+      push(val);
+      return val;
+    }
+
+    /* Spill everything to the context's stack, bottom first. */
+    void flush(BasicBlock* block) {
+      for(std::vector<Value*>::iterator i = values_.begin(); i != values_.end(); i++) {
+        std::vector<Value*> args(1, *i);
+        calls_.push_back(call_function("jit_push", task_, js_, args, block));
+      }
+      values_.clear();
+    }
+
+    Value* local(int index, BasicBlock* block) {
+      std::map<int, Value*>::iterator i = locals_.find(index);
+      if(i != locals_.end()) return i->second;
+
+      std::vector<Value*> args(1, ConstantInt::get(Type::Int32Ty, index));
+      CallInst* val = call_function("jit_get_local", task_, js_, args, block);
+      val->setName("local");
+      calls_.push_back(val);
+      locals_[index] = val;
+      return val;
+    }
+
+    void set_local(int index, Value* val, BasicBlock* block) {
+      std::vector<Value*> args(0);
+      args.push_back(val);
+      args.push_back(ConstantInt::get(Type::Int32Ty, index));
+      calls_.push_back(call_function("jit_set_local", task_, js_, args, block));
+      locals_[index] = val;
+    }
+
+    void forget_locals() {
+      locals_.clear();
+    }
+
+    void reset() {
+      values_.clear();
+      locals_.clear();
+    }
+  };
+
+  static bool terminated_p(BasicBlock* block) {
+    return !block->empty() && isa<TerminatorInst>(block->back());
+  }
+
   CallInst* VMLLVMMethod::call_operation(Opcode* op, Value* task,
                                          Value* js, BasicBlock* block) {
     const char* name = InstructionSequence::get_instruction_name(op->op);
@@ -286,6 +414,91 @@ namespace rubinius {
     return blocks;
   }
 
+  /* Emit the fixnum case of a meta_send_op_* inline, on the two values on
+   * top of +stack+. The result is stored in +result+ and control goes to
+   * +done+, the block after the send, without touching the context's
+   * stack. Returns the block which should do the real send; the operands
+   * have been spilled back to memory there. */
+  static BasicBlock* emit_fast_fixnum(Opcode* op, JITStack& stack,
+      BasicBlock* cur, AllocaInst* result, BasicBlock* done) {
+    Value* right = stack.pop(cur);
+    Value* left = stack.pop(cur);
+    stack.flush(cur);
+
+    Function* func = cur->getParent();
+    BasicBlock* slow = BasicBlock::Create("slow", func);
+
+    if(done) {
+      const Type* int_type = stack.int_type();
+      BasicBlock* fast = BasicBlock::Create("fast", func);
+
+      Value* l = new PtrToIntInst(left, int_type, "left", cur);
+      Value* r = new PtrToIntInst(right, int_type, "right", cur);
+
+      Value* tags = BinaryOperator::Create(Instruction::And, l, r, "tags", cur);
+      tags = BinaryOperator::Create(Instruction::And, tags,
+          ConstantInt::get(int_type, TAG_FIXNUM), "tags", cur);
+      Value* both = new ICmpInst(ICmpInst::ICMP_NE, tags,
+          ConstantInt::get(int_type, 0), "both_fixnum", cur);
+      BranchInst::Create(fast, slow, both, cur);
+      fast->moveAfter(cur);
+
+      Value* res = NULL;
+
+      switch(op->op) {
+      case InstructionSequence::insn_meta_send_op_plus:
+      case InstructionSequence::insn_meta_send_op_minus: {
+        Value* shift = ConstantInt::get(int_type, TAG_FIXNUM_SHIFT);
+        Value* a = BinaryOperator::Create(Instruction::AShr, l, shift, "a", fast);
+        Value* b = BinaryOperator::Create(Instruction::AShr, r, shift, "b", fast);
+        Value* n = BinaryOperator::Create(
+            op->op == InstructionSequence::insn_meta_send_op_plus ?
+              Instruction::Add : Instruction::Sub, a, b, "n", fast);
+
+        /* Both operands are fixnums, so +n+ can't overflow a native_int,
+         * only the fixnum range. Out of range goes to the real send,
+         * which promotes to a Bignum. */
+        Value* big = new ICmpInst(ICmpInst::ICMP_SGT, n,
+            ConstantInt::get(int_type, (uint64_t)FIXNUM_MAX), "big", fast);
+        Value* small = new ICmpInst(ICmpInst::ICMP_SLT, n,
+            ConstantInt::get(int_type, (uint64_t)FIXNUM_MIN), "small", fast);
+        Value* out = BinaryOperator::Create(Instruction::Or, big, small, "out", fast);
+
+        BasicBlock* tag = BasicBlock::Create("tag", func);
+        BranchInst::Create(slow, tag, out, fast);
+        tag->moveAfter(fast);
+        fast = tag;
+
+        Value* tagged = BinaryOperator::Create(Instruction::Shl, n, shift, "tagged", fast);
+        tagged = BinaryOperator::Create(Instruction::Or, tagged,
+            ConstantInt::get(int_type, TAG_FIXNUM), "tagged", fast);
+        res = new IntToPtrInst(tagged, left->getType(), "sum", fast);
+        break;
+      }
+      default: {
+        /* Comparing the tagged values gives the same answer. */
+        Value* cmp = new ICmpInst(
+            op->op == InstructionSequence::insn_meta_send_op_lt ?
+              ICmpInst::ICMP_SLT : ICmpInst::ICMP_SGT, l, r, "cmp", fast);
+        res = SelectInst::Create(cmp, stack.object(Qtrue),
+            stack.object(Qfalse), "bool", fast);
+      }
+      }
+
+      new StoreInst(res, result, fast);
+      BranchInst::Create(done, fast);
+      slow->moveAfter(fast);
+    } else {
+      BranchInst::Create(slow, cur);
+    }
+
+    stack.push(left);
+    stack.push(right);
+    stack.flush(slow);
+
+    return slow;
+  }
+
   void VMLLVMMethod::compile(STATE) {
     const char* name = original->name()->c_str(state);
     Function* func = create_function(name);
@@ -303,66 +516,152 @@ namespace rubinius {
     std::vector<Opcode*> ops = create_opcodes();
     BasicBlock** blocks = construct_blocks(func, ops, next_pos);
 
-    BasicBlock* last = NULL;
-    BasicBlock* cur  = NULL;
-    int cur_block = -1;
-
     /* We collect up all the calls to the operation functions so we can
      * inline them later. */
     std::vector<CallInst*> calls(0);
 
+    const Type* obj_type = operations->getFunction("jit_pop")->getReturnType();
+    JITStack stack(task, js, obj_type, calls);
+
+    /* The value a send leaves on the stack is picked up by the block after
+     * it. That block pops it from memory when it's entered by the switch
+     * or once the send returns, but a fixnum fast path hands it over in
+     * +send_result+ directly, so mem2reg turns it into a phi. */
+    BasicBlock* entry = &func->getEntryBlock();
+    AllocaInst* send_result = new AllocaInst(obj_type, "send_result",
+        entry->getTerminator());
+
+    std::map<size_t, BasicBlock*> after_send;
     for(std::vector<Opcode*>::iterator i = ops.begin(); i != ops.end(); i++) {
       Opcode* op = *i;
-      /* Having this be conditional lets us change +cur+ for the rest of a block.
-       * This is used to implement branch's 2nd position without allocating
-       * continuation style slots. */
-      if(cur_block < 0 || (int)op->block != cur_block) {
-        cur = blocks[op->block];
+      if(op->is_send() && i + 1 != ops.end()) {
+        std::stringstream stream;
+        stream << "after_send" << op->block + 1;
+        after_send[op->block + 1] = BasicBlock::Create(stream.str(), func);
       }
+    }
 
-      cur_block = op->block;
+    BasicBlock* cur = blocks[0];
+    int cur_block = 0;
 
+    for(std::vector<Opcode*>::iterator i = ops.begin(); i != ops.end(); i++) {
+      Opcode* op = *i;
+
+      /* A block only changes at a start_block. Until then, +cur+ can be
+       * changed for the rest of a block; this is used to implement
+       * branch's 2nd position without allocating continuation style
+       * slots. */
       if(op->start_block) {
         /* Setup a branch from the last block to this one if it doesn't have a
          * terminator on the end. */
-        if(!isa<TerminatorInst>(last->back())) {
-          BranchInst::Create(cur, last);
+        if(!terminated_p(cur)) {
+          stack.flush(cur);
+          BranchInst::Create(blocks[op->block], cur);
+        }
+
+        stack.reset();
+        cur = blocks[op->block];
+
+        std::map<size_t, BasicBlock*>::iterator body = after_send.find(op->block);
+        if(body != after_send.end()) {
+          new StoreInst(stack.pop(cur), send_result, cur);
+          BranchInst::Create(body->second, cur);
+
+          body->second->moveAfter(cur);
+          cur = body->second;
+          stack.push(new LoadInst(send_result, "result", cur));
         }
       }
 
-      last = cur;
+      cur_block = op->block;
 
       // show(InstructionSequence::get_instruction_name(op->op), cur);
 
       CallInst* call = NULL;
 
       switch(op->op) {
+      case InstructionSequence::insn_push_nil:
+        stack.push(stack.object(Qnil));
+        break;
+      case InstructionSequence::insn_push_true:
+        stack.push(stack.object(Qtrue));
+        break;
+      case InstructionSequence::insn_push_false:
+        stack.push(stack.object(Qfalse));
+        break;
+      case InstructionSequence::insn_push_int:
+        stack.push(stack.object(Fixnum::from(op->arg1)));
+        break;
+      case InstructionSequence::insn_meta_push_neg_1:
+        stack.push(stack.object(Fixnum::from(-1)));
+        break;
+      case InstructionSequence::insn_meta_push_0:
+        stack.push(stack.object(Fixnum::from(0)));
+        break;
+      case InstructionSequence::insn_meta_push_1:
+        stack.push(stack.object(Fixnum::from(1)));
+        break;
+      case InstructionSequence::insn_meta_push_2:
+        stack.push(stack.object(Fixnum::from(2)));
+        break;
+      case InstructionSequence::insn_pop:
+        stack.pop(cur);
+        break;
+      case InstructionSequence::insn_dup_top:
+        stack.push(stack.top(cur));
+        break;
+      case InstructionSequence::insn_swap_stack: {
+        Value* t1 = stack.pop(cur);
+        Value* t2 = stack.pop(cur);
+        stack.push(t1);
+        stack.push(t2);
+        break;
+      }
+      case InstructionSequence::insn_push_local:
+        stack.push(stack.local(op->arg1, cur));
+        break;
+      case InstructionSequence::insn_set_local:
+        stack.set_local(op->arg1, stack.top(cur), cur);
+        break;
+      case InstructionSequence::insn_meta_send_op_plus:
+      case InstructionSequence::insn_meta_send_op_minus:
+      case InstructionSequence::insn_meta_send_op_lt:
+      case InstructionSequence::insn_meta_send_op_gt: {
+        std::map<size_t, BasicBlock*>::iterator done = after_send.find(op->block + 1);
+        BasicBlock* slow = emit_fast_fixnum(op, stack, cur, send_result,
+            done == after_send.end() ? NULL : done->second);
+
+        cur = slow;
+        call = call_operation(op, task, js, cur);
+        break;
+      }
       case InstructionSequence::insn_goto:
+        stack.flush(cur);
         BranchInst::Create(blocks[ops[op->arg1]->block], cur);
         break;
       case InstructionSequence::insn_goto_if_true:
       case InstructionSequence::insn_goto_if_false:
       case InstructionSequence::insn_goto_if_defined: {
-        /* Remove the argument from being used, since we used it directly
-         * here. */
-        op->args--;
-        std::string func_name;
-        switch(op->op) {
-        case InstructionSequence::insn_goto_if_true:
-          func_name = std::string("jit_goto_if_true");
-          break;
-        case InstructionSequence::insn_goto_if_false:
-          func_name = std::string("jit_goto_if_false");
-          break;
-        case InstructionSequence::insn_goto_if_defined:
-          func_name = std::string("jit_goto_if_defined");
-          break;
+        /* The condition is tested directly, rather than popped from the
+         * context by one of the jit_goto_if_* operations. */
+        Value* val = stack.pop(cur);
+        stack.flush(cur);
+
+        Value* cmp;
+        if(op->op == InstructionSequence::insn_goto_if_defined) {
+          cmp = new ICmpInst(ICmpInst::ICMP_NE, val,
+              stack.object(Qundef), "defined", cur);
+        } else {
+          Value* bits = new PtrToIntInst(val, stack.int_type(), "bits", cur);
+          Value* masked = BinaryOperator::Create(Instruction::And, bits,
+              ConstantInt::get(stack.int_type(), FALSE_MASK), "masked", cur);
+          cmp = new ICmpInst(
+              op->op == InstructionSequence::insn_goto_if_true ?
+                ICmpInst::ICMP_NE : ICmpInst::ICMP_EQ,
+              masked, ConstantInt::get(stack.int_type(), (uintptr_t)Qfalse),
+              "cmp", cur);
         }
 
-        call = call_function(func_name, task, js, cur);
-        call->setName("goto");
-        ICmpInst* cmp = new ICmpInst(ICmpInst::ICMP_EQ, call,
-            ConstantInt::get(Type::Int8Ty, 1), "cmp", cur);
         BasicBlock* bb = BasicBlock::Create("span", func);
         bb->moveAfter(cur);
         BranchInst::Create(blocks[ops[op->arg1]->block], bb, cmp, cur);
@@ -370,9 +669,13 @@ namespace rubinius {
         break;
       }
       case InstructionSequence::insn_halt:
+        stack.flush(cur);
         new StoreInst(ConstantInt::get(Type::Int32Ty, (uint64_t)-1), next_pos, cur);
         break;
       default:
+        /* Anything else may send, allocate or use the stack directly. */
+        stack.flush(cur);
+        stack.forget_locals();
         call = call_operation(op, task, js, cur);
       }
 
@@ -398,8 +701,6 @@ namespace rubinius {
 
         // Make this flow look sane in the LLVM debugging output
         send->moveAfter(cur);
-        // The current block is now the one after 'send'
-        cur = stay;
 
       } else if(op->op == InstructionSequence::insn_ret) {
         /* -2 signals that we're done for reals now. */
@@ -418,7 +719,8 @@ namespace rubinius {
     }
 
     /* stick a return on the end if there isn't already one. */
-    if(!isa<ReturnInst>(cur->back())) {
+    if(!terminated_p(cur)) {
+      stack.flush(cur);
       ReturnInst::Create(cur);
     }
 
@@ -7,6 +7,7 @@
 #include "builtin/compiledmethod.hpp"
 #include "builtin/exception.hpp"
 #include "builtin/fixnum.hpp"
+#include "builtin/float.hpp"
 #include "builtin/sendsite.hpp"
 #include "builtin/string.hpp"
 #include "builtin/symbol.hpp"
@@ -60,6 +61,12 @@ using namespace rubinius;
 #define state task->state
 
 #define both_fixnum_p(_p1, _p2) ((uintptr_t)(_p1) & (uintptr_t)(_p2) & TAG_FIXNUM)
+#define both_flonum_p(_p1, _p2) (FLONUM_P(_p1) && FLONUM_P(_p2))
+
+/* True if one is an immediate Float and the other a Fixnum, which can be
+ * == without being identical. */
+#define flonum_fixnum_p(_p1, _p2) \
+  ((FLONUM_P(_p1) && FIXNUM_P(_p2)) || (FIXNUM_P(_p1) && FLONUM_P(_p2)))
 
 #define cache_ip()
 
@@ -126,6 +133,24 @@ CODE
     return val != Qundef;
   }
 
+  /* Used by the translator to move values between the context's stack
+   * and the SSA values it keeps for the current block. */
+  OP2(Object*, jit_pop) {
+    return stack_pop();
+  }
+
+  OP2(void, jit_push, Object* val) {
+    stack_push(val);
+  }
+
+  OP2(Object*, jit_get_local, int index) {
+    return task->home()->get_local(index);
+  }
+
+  OP2(void, jit_set_local, Object* val, int index) {
+    task->home()->set_local(index, val);
+  }
+
   ExecuteStatus send_slowly(VMMethod* vmm, Task* task, MethodContext* const ctx, Symbol* name, size_t args) {
     Message& msg = *task->msg;
     msg.recv = stack_back(args);
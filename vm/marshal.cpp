@@ -86,7 +86,7 @@ namespace rubinius {
   void Marshaller::set_sendsite(SendSite* ss) {
     String* str = ss->name()->to_str(state);
     stream << "S" << endl << str->size() << endl;
-    stream.write(str->c_str(), str->size()) << endl;
+    stream.write(str->c_str(state), str->size()) << endl;
   }
 
   SendSite* UnMarshaller::get_sendsite() {
@@ -151,7 +151,7 @@ namespace rubinius {
 #define FLOAT_MAX_BUFFER    65
 
   void Marshaller::set_float(Float* flt) {
-    double val = flt->val;
+    double val = flt->val();
 
     stream << "d" << endl;
 
@@ -173,17 +173,8 @@ namespace rubinius {
     stream << endl;
   }
 
-  Float* UnMarshaller::get_float() {
-    char data[1024];
-
-    // discard the delimiter
-    stream.get();
-
-    stream.getline(data, 1024);
-    if(stream.fail()) {
-      Exception::type_error(state, "Unable to unmarshal Float: failed to read value");
-    }
-
+  /* Parses the text representation of a Float written by set_float. */
+  static Float* parse_float(STATE, const char* data) {
     if(data[0] == ' ') {
       double x;
       long   e;
@@ -217,6 +208,20 @@ namespace rubinius {
     }
   }
 
+  Float* UnMarshaller::get_float() {
+    char data[1024];
+
+    // discard the delimiter
+    stream.get();
+
+    stream.getline(data, 1024);
+    if(stream.fail()) {
+      Exception::type_error(state, "Unable to unmarshal Float: failed to read value");
+    }
+
+    return parse_float(state, data);
+  }
+
   void Marshaller::set_iseq(InstructionSequence* iseq) {
     Tuple* ops = iseq->opcodes();
     stream << "i" << endl << ops->num_fields() << endl;
@@ -343,5 +348,280 @@ namespace rubinius {
     }
   }
 
+  BinaryUnMarshaller::BinaryUnMarshaller(STATE, uint8_t* data, size_t size, bool lazy)
+    : state(state)
+    , data_(data)
+    , size_(size)
+    , pos_(0)
+    , swap_(false)
+    , opcodes_(NULL)
+    , num_opcodes_(0)
+    , objects_(0)
+    , objects_end_(0)
+    , lazy_(lazy)
+  { }
+
+  static inline uint32_t swap_word(uint32_t word) {
+    return (word >> 24) | ((word >> 8) & 0xff00) |
+      ((word << 8) & 0xff0000) | (word << 24);
+  }
+
+  void BinaryUnMarshaller::invalid(const char* what) {
+    std::string str = "Unable to unmarshal binary .rbc: ";
+    str.append(what);
+    Exception::type_error(state, str.c_str());
+  }
+
+  uint32_t BinaryUnMarshaller::read_word(size_t& pos, size_t end) {
+    if(pos + sizeof(uint32_t) > end) invalid("truncated");
+
+    uint32_t word;
+    std::memcpy(&word, data_ + pos, sizeof(uint32_t));
+    pos += sizeof(uint32_t);
+
+    return swap_ ? swap_word(word) : word;
+  }
+
+  static inline size_t padded(size_t bytes) {
+    return (bytes + 3) & ~(size_t)3;
+  }
+
+  void BinaryUnMarshaller::read_strings(size_t end) {
+    size_t pos = pos_;
+    uint32_t count = read_word(pos, end);
+
+    strings_.reserve(count);
+    for(uint32_t i = 0; i < count; i++) {
+      uint32_t bytes = read_word(pos, end);
+      if(pos + bytes > end) invalid("string overruns its section");
+
+      strings_.push_back(std::make_pair((const char*)data_ + pos, (size_t)bytes));
+      pos += padded(bytes);
+    }
+  }
+
+  void BinaryUnMarshaller::read_sections() {
+    if(reinterpret_cast<uintptr_t>(data_) % sizeof(uint32_t) != 0) {
+      invalid("misaligned");
+    }
+
+    uint32_t mark = read_word(pos_, size_);
+    if(mark != cByteOrderMark) {
+      if(swap_word(mark) != cByteOrderMark) invalid("bad byte order mark");
+      swap_ = true;
+    }
+
+    uint32_t sections = read_word(pos_, size_);
+
+    for(uint32_t i = 0; i < sections; i++) {
+      uint32_t kind = read_word(pos_, size_);
+      uint32_t bytes = read_word(pos_, size_);
+      size_t end = pos_ + bytes;
+      if(end > size_) invalid("section overruns the file");
+
+      switch(kind) {
+      case cStrings:
+        read_strings(end);
+        break;
+      case cOpcodes:
+        opcodes_ = reinterpret_cast<uint32_t*>(data_ + pos_);
+        num_opcodes_ = bytes / sizeof(uint32_t);
+
+        if(swap_) {
+          for(size_t j = 0; j < num_opcodes_; j++) {
+            opcodes_[j] = swap_word(opcodes_[j]);
+          }
+        }
+        break;
+      case cObjects:
+        objects_ = pos_;
+        objects_end_ = end;
+        break;
+      default:
+        // Sections added by later versions are skipped.
+        break;
+      }
+
+      pos_ = padded(end);
+    }
+
+    if(objects_end_ == 0) invalid("no objects section");
+  }
+
+  uint32_t BinaryUnMarshaller::next() {
+    return read_word(objects_, objects_end_);
+  }
+
+  const std::pair<const char*, size_t>& BinaryUnMarshaller::next_string() {
+    uint32_t index = next();
+    if(index >= strings_.size()) invalid("string index out of range");
+    return strings_[index];
+  }
+
+  InstructionSequence* BinaryUnMarshaller::next_iseq() {
+    uint32_t offset = next();
+    uint32_t count = next();
+    if((size_t)offset + count > num_opcodes_) invalid("opcodes out of range");
+
+    uint32_t* ops = opcodes_ + offset;
+    InstructionSequence* iseq = InstructionSequence::create(state, count);
+    Tuple* tup = iseq->opcodes();
+
+    for(size_t i = 0; i < count; i++) {
+      tup->put(state, i, Fixnum::from(ops[i]));
+    }
+
+    iseq->set_mapped_opcodes(ops);
+    iseq->post_marshal(state);
+
+    return iseq;
+  }
+
+  CompiledMethod* BinaryUnMarshaller::next_cmethod() {
+    uint32_t ver = next();
+    if(ver != 1) invalid("unknown CompiledMethod version");
+
+    CompiledMethod* cm = CompiledMethod::create(state);
+
+    cm->ivars(state, next_object());
+    cm->primitive(state, (Symbol*)next_object());
+    cm->name(state, (Symbol*)next_object());
+    cm->iseq(state, (InstructionSequence*)next_object());
+    cm->stack_size(state, (Fixnum*)next_object());
+    cm->local_count(state, (Fixnum*)next_object());
+    cm->required_args(state, (Fixnum*)next_object());
+    cm->total_args(state, (Fixnum*)next_object());
+    cm->splat(state, next_object());
+    cm->literals(state, (Tuple*)next_object());
+    cm->exceptions(state, (Tuple*)next_object());
+    cm->lines(state, (Tuple*)next_object());
+    cm->file(state, (Symbol*)next_object());
+    cm->local_names(state, (Tuple*)next_object());
+
+    cm->post_marshal(state);
+
+    return cm;
+  }
+
+  CompiledMethod* BinaryUnMarshaller::next_lazy_cmethod() {
+    uint32_t ver = next();
+    if(ver != 1) invalid("unknown CompiledMethod version");
+
+    CompiledMethod* cm = CompiledMethod::create(state);
+
+    cm->ivars(state, next_object());
+    cm->primitive(state, (Symbol*)next_object());
+    cm->name(state, (Symbol*)next_object());
+    cm->stack_size(state, (Fixnum*)next_object());
+    cm->local_count(state, (Fixnum*)next_object());
+    cm->required_args(state, (Fixnum*)next_object());
+    cm->total_args(state, (Fixnum*)next_object());
+    cm->splat(state, next_object());
+    cm->file(state, (Symbol*)next_object());
+
+    size_t bytes = next() * sizeof(uint32_t);
+    size_t body = objects_;
+    if(body + bytes > objects_end_) invalid("method body overruns its section");
+
+    if(lazy_) {
+      cm->set_lazy_body(this, body);
+      objects_ += bytes;
+    } else {
+      read_method_body(cm);
+      if(objects_ != body + bytes) invalid("method body is the wrong size");
+      cm->post_marshal(state);
+    }
+
+    return cm;
+  }
+
+  void BinaryUnMarshaller::read_method_body(CompiledMethod* cm) {
+    cm->iseq(state, (InstructionSequence*)next_object());
+    cm->literals(state, (Tuple*)next_object());
+    cm->exceptions(state, (Tuple*)next_object());
+    cm->lines(state, (Tuple*)next_object());
+    cm->local_names(state, (Tuple*)next_object());
+  }
+
+  void BinaryUnMarshaller::materialize(CompiledMethod* cm, size_t offset) {
+    size_t saved = objects_;
+
+    objects_ = offset;
+    read_method_body(cm);
+    objects_ = saved;
+  }
 
+  Object* BinaryUnMarshaller::next_object() {
+    uint32_t code = next();
+
+    switch(code) {
+    case 'n':
+      return Qnil;
+    case 't':
+      return Qtrue;
+    case 'f':
+      return Qfalse;
+    case 'I':
+      // Beyond the Fixnum range on 32 bit machines; Integer::from copes.
+      return Integer::from(state, (int)(int32_t)next());
+    case 'B': {
+      const std::pair<const char*, size_t>& str = next_string();
+      std::string digits(str.first, str.second);
+      return Bignum::from_string(state, digits.c_str(), 10);
+    }
+    case 's': {
+      const std::pair<const char*, size_t>& str = next_string();
+      // A NULL source keeps String::create from measuring with strlen.
+      return String::create(state, str.second ? str.first : NULL, str.second);
+    }
+    case 'x': {
+      const std::pair<const char*, size_t>& str = next_string();
+      return state->symbol(std::string(str.first, str.second));
+    }
+    case 'S': {
+      const std::pair<const char*, size_t>& str = next_string();
+      return SendSite::create(state, state->symbol(std::string(str.first, str.second)));
+    }
+    case 'A': {
+      uint32_t count = next();
+      Array* ary = Array::create(state, count);
+
+      for(size_t i = 0; i < count; i++) {
+        ary->set(state, i, next_object());
+      }
+
+      return ary;
+    }
+    case 'p': {
+      uint32_t count = next();
+      Tuple* tup = Tuple::create(state, count);
+
+      for(size_t i = 0; i < count; i++) {
+        tup->put(state, i, next_object());
+      }
+
+      return tup;
+    }
+    case 'd': {
+      const std::pair<const char*, size_t>& str = next_string();
+      return parse_float(state, std::string(str.first, str.second).c_str());
+    }
+    case 'i':
+      return next_iseq();
+    case 'M':
+      return next_cmethod();
+    case 'm':
+      return next_lazy_cmethod();
+    default:
+      std::string str = "unknown marshal code: ";
+      str.append(1, (char)code);
+      Exception::type_error(state, str.c_str());
+      return Qnil;    // make compiler happy
+    }
+  }
+
+  Object* BinaryUnMarshaller::unmarshal() {
+    read_sections();
+    return next_object();
+  }
 }
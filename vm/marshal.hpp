@@ -3,6 +3,8 @@
 
 #include <iostream>
 #include <sstream>
+#include <vector>
+#include <stdint.h>
 
 #include "prelude.hpp"
 
@@ -62,6 +64,96 @@ namespace rubinius {
     InstructionSequence* get_iseq();
     CompiledMethod* get_cmethod();
   };
+
+  /**
+   *  Reads the body of a binary .rbc (CompiledFile::cBinaryVersion).
+   *
+   *  The body is a sequence of 32 bit words starting on a 4 byte
+   *  boundary. CompiledFile::BinaryMarshal writes them little endian;
+   *  the mark tells a reader of the other byte order to swap:
+   *
+   *    0x01020304          byte order mark
+   *    count               number of sections
+   *    kind size payload   each section, padded to a whole word
+   *
+   *  The sections are, in order:
+   *
+   *    cStrings   count, then each string as length, bytes and padding.
+   *               Symbols, strings, send site names, Bignums and Floats
+   *               all refer to the table by index, so each is stored once.
+   *    cOpcodes   the opcodes of every InstructionSequence in the file,
+   *               back to back.
+   *    cObjects   the object graph, using the type codes of the text
+   *               format followed by their operands. Integers which fit in
+   *               32 bits are 'I' value; others are 'B' string index.
+   *               An iseq is 'i' offset count into cOpcodes.
+   *
+   *  A CompiledMethod is written as 'm' so that it can be loaded as a
+   *  stub: version 1, then ivars, primitive, name, stack_size,
+   *  local_count, required_args, total_args, splat and file, then the
+   *  number of words holding iseq, literals, exceptions, lines and
+   *  local_names, then those. With +lazy+ set, those last five are
+   *  skipped over and only read when CompiledMethod::materialize is
+   *  called. Stubs point back at this BinaryUnMarshaller, so it must
+   *  then live as long as the data does.
+   *
+   *  The data must stay put for as long as the VM runs: each
+   *  InstructionSequence points its mapped_opcodes() into the cOpcodes
+   *  section, so the VMMethod can run them without a copy. If the byte
+   *  order doesn't match, the opcodes are swapped in place first.
+   */
+  class BinaryUnMarshaller {
+  public:
+    const static uint32_t cByteOrderMark = 0x01020304;
+
+    enum Section {
+      cStrings = 1,
+      cOpcodes = 2,
+      cObjects = 3
+    };
+
+  private:
+    STATE;
+    uint8_t* data_;
+    size_t size_;
+    size_t pos_;
+    bool swap_;
+
+    std::vector<std::pair<const char*, size_t> > strings_;
+
+    uint32_t* opcodes_;
+    size_t num_opcodes_;
+
+    // Where the next word of cObjects is read from, and where it ends.
+    size_t objects_;
+    size_t objects_end_;
+
+    bool lazy_;
+
+  public:
+    BinaryUnMarshaller(STATE, uint8_t* data, size_t size, bool lazy = false);
+
+    // Reads every section and returns the top level object.
+    Object* unmarshal();
+
+    // Reads the rest of the stub +cm+, whose body is at +offset+.
+    void materialize(CompiledMethod* cm, size_t offset);
+
+  private:
+    uint32_t read_word(size_t& pos, size_t end);
+    void read_sections();
+    void read_strings(size_t end);
+
+    uint32_t next();
+    const std::pair<const char*, size_t>& next_string();
+    Object* next_object();
+    InstructionSequence* next_iseq();
+    CompiledMethod* next_cmethod();
+    CompiledMethod* next_lazy_cmethod();
+    void read_method_body(CompiledMethod* cm);
+
+    void invalid(const char* what);
+  };
 }
 
 #endif
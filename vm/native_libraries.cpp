@@ -26,7 +26,7 @@ namespace rubinius {
   // Also, rbx_dldefault returns different values on different systems.
   void* NativeLibrary::find_symbol(STATE, String* name, Object* library_name, bool raise) {
     rbx_dlhandle library = NativeLibrary::open(state, library_name, raise);
-    void* symbol = rbx_dlsym(library, name->c_str());
+    void* symbol = rbx_dlsym(library, name->c_str(state));
 
     if(rbx_dlnosuch(symbol)) {
       if(raise) {
@@ -46,7 +46,7 @@ namespace rubinius {
     }
 
     /* We should always get path without file extension. */
-    std::string path(as<String>(name)->c_str());
+    std::string path(as<String>(name)->c_str(state));
     std::ostringstream error_message("NativeLibrary::open(): ");
 
     rbx_dlhandle library = rbx_dlopen((path + RBX_LIBSUFFIX).c_str());
@@ -4,6 +4,7 @@
 #include "vm.hpp"
 #include "objectmemory.hpp"
 #include "gc_marksweep.hpp"
+#include "code_cache.hpp"
 #include "builtin/class.hpp"
 #include "builtin/fixnum.hpp"
 #include "builtin/tuple.hpp"
@@ -88,6 +89,12 @@ namespace rubinius {
 
   void ObjectMemory::collect_mature(Roots &roots) {
     mature.collect(roots);
+
+    // Only a full collection marks every live context; the young one
+    // skips mature contexts outside the remember set, which may still
+    // be running retired code.
+    state->code_cache->sweep();
+
     young.clear_marks();
     clear_context_marks();
   }
@@ -134,13 +141,13 @@ namespace rubinius {
     if(bytes > large_object_threshold) {
       obj = mature.allocate(bytes, &collect_mature_now);
       if(collect_mature_now) {
-        state->interrupts.check = true;
+        state->interrupts.set_perform_gc();
       }
     } else {
       obj = young.allocate(bytes, &collect_young_now);
       if(obj == NULL) {
         collect_young_now = true;
-        state->interrupts.check = true;
+        state->interrupts.set_perform_gc();
         obj = mature.allocate(bytes, &collect_mature_now);
       }
     }
@@ -16,6 +16,7 @@
 #include "builtin/executable.hpp"
 #include "builtin/fixnum.hpp"
 #include "builtin/float.hpp"
+#include "builtin/hash.hpp"
 #include "builtin/io.hpp"
 #include "builtin/iseq.hpp"
 #include "builtin/list.hpp"
@@ -99,10 +100,6 @@ namespace rubinius {
     GO(lookuptable).set(new_basic_class(object));
     G(lookuptable)->set_object_type(state, LookupTableType);
 
-    /* Create LookupTableBucket */
-    GO(lookuptablebucket).set(new_basic_class(object));
-    G(lookuptablebucket)->set_object_type(state, LookupTableBucketType);
-
     /* Create LookupTableAssociation */
     GO(lookuptableassociation).set(new_basic_class(object));
     G(lookuptableassociation)->set_object_type(state, LookupTableAssociationType);
@@ -118,7 +115,6 @@ namespace rubinius {
      *  Object
      *  Tuple
      *  LookupTable
-     *  LookupTableBucket
      *  LookupTableAssociation
      *  MethodTable
      *
@@ -136,11 +132,10 @@ namespace rubinius {
     MetaClass::attach(this, G(metaclass), cls->metaclass(this));
     MetaClass::attach(this, G(tuple), G(object)->metaclass(this));
     MetaClass::attach(this, G(lookuptable), G(object)->metaclass(this));
-    MetaClass::attach(this, G(lookuptablebucket), G(object)->metaclass(this));
     MetaClass::attach(this, G(lookuptableassociation), G(object)->metaclass(this));
     MetaClass::attach(this, G(methtbl), G(lookuptable)->metaclass(this));
 
-    // Now, finish initializing the special 9
+    // Now, finish initializing the special 8
     G(object)->setup(this, "Object");
     G(klass)->setup(this, "Class");
     G(module)->setup(this, "Module");
@@ -148,8 +143,6 @@ namespace rubinius {
     G(tuple)->setup(this, "Tuple");
     G(lookuptable)->setup(this, "LookupTable");
     G(methtbl)->setup(this, "MethodTable");
-    G(lookuptablebucket)->setup(this, "Bucket", G(lookuptable));
-    G(lookuptablebucket)->name(state, symbol("LookupTable::Bucket"));
     G(lookuptableassociation)->setup(this, "Association", G(lookuptable));
     G(lookuptableassociation)->name(state, symbol("LookupTable::Association"));
   }
@@ -199,6 +192,7 @@ namespace rubinius {
     StaticScope::init(this);
     Dir::init(this);
     CompactLookupTable::init(this);
+    Hash::init(this);
     Time::init(this);
     Regexp::init(this);
     Bignum::init(this);
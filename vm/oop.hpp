@@ -6,6 +6,7 @@
 #include <stdint.h>
 
 #include "object_types.hpp"
+#include "detection.hpp"
 
 namespace rubinius {
 
@@ -17,10 +18,15 @@ namespace rubinius {
  *  00 == rest is an object reference
  * 010 == rest is a boolean literal
  * 110 == rest is a symbol
+ * 100 == rest is a float (64-bit only, see FLONUM_P)
 */
 
 #define TAG_REF          0x0
+#ifdef IS_X8664
+#define TAG_REF_MASK     7
+#else
 #define TAG_REF_MASK     3
+#endif
 
 #define TAG_FIXNUM       0x1
 #define TAG_FIXNUM_SHIFT 1
@@ -32,6 +38,9 @@ namespace rubinius {
 #define TAG_SYMBOL_SHIFT 3
 #define TAG_SYMBOL_MASK  7
 
+#define TAG_FLONUM       0x4
+#define TAG_FLONUM_MASK  7
+
 #define APPLY_FIXNUM_TAG(v) ((Object*)(((intptr_t)(v) << TAG_FIXNUM_SHIFT) | TAG_FIXNUM))
 #define STRIP_FIXNUM_TAG(v) (((intptr_t)v) >> TAG_FIXNUM_SHIFT)
 
@@ -42,6 +51,19 @@ namespace rubinius {
 #define FIXNUM_P(v)    (((intptr_t)(v) & TAG_FIXNUM_MASK) == TAG_FIXNUM)
 #define SYMBOL_P(v)    (((intptr_t)(v) & TAG_SYMBOL_MASK) == TAG_SYMBOL)
 
+/* Objects are 8 byte aligned on 64-bit, which frees up 100 for Floats.
+ * A double whose top 4 exponent bits are 0111 or 1000 (roughly
+ * 2**-127 <= |x| < 2**129) is stored rotated left by 4 with those 3
+ * redundant bits replaced by the tag. +0.0 takes the slot that 2**-127
+ * would use. Everything else, and every Float on 32-bit, is boxed.
+ * See Float::create and Float::val. */
+#ifdef IS_X8664
+#define FLONUM_P(v)    (((intptr_t)(v) & TAG_FLONUM_MASK) == TAG_FLONUM)
+#define FLONUM_ZERO    0x8000000000000004UL
+#else
+#define FLONUM_P(v)    0
+#endif
+
 /* How many bits of data are available in fixnum, not including the sign. */
 #define FIXNUM_WIDTH ((8 * sizeof(native_int)) - TAG_FIXNUM_SHIFT - 1)
 #define FIXNUM_MAX   (((native_int)1 << FIXNUM_WIDTH) - 1)
@@ -38,7 +38,7 @@ namespace rubinius {
 #define string_new(s, c)         (Object*)String::create(s, c)
 #define string_concat(s, d, o)   (Object*)as<String>(d)->append(s, as<String>(o))
 #define string_append(s, d, o)   (Object*)as<String>(d)->append(s, o)
-#define string_c_str(s, d)       (char*)as<String>(d)->c_str()
+#define string_c_str(s, d)       (char*)as<String>(d)->c_str(s)
 
 #define float_from_string(s, d)  (Object*)String::create(s, d)->to_f(s)
 
@@ -0,0 +1,209 @@
+#include "vm/perf_map.hpp"
+
+#include "vm.hpp"
+#include "vmmethod.hpp"
+#include "detection.hpp"
+#include "vm/object_utils.hpp"
+
+#include "builtin/compiledmethod.hpp"
+#include "builtin/module.hpp"
+#include "builtin/staticscope.hpp"
+#include "builtin/symbol.hpp"
+
+#include <sstream>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+namespace rubinius {
+
+  // The layouts are fixed by perf; see tools/perf/util/jitdump.h in the
+  // Linux source.
+  struct JitDumpHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t total_size;
+    uint32_t elf_mach;
+    uint32_t pad1;
+    uint32_t pid;
+    uint64_t timestamp;
+    uint64_t flags;
+  };
+
+  struct JitDumpCodeLoad {
+    uint32_t id;
+    uint32_t total_size;
+    uint64_t timestamp;
+    uint32_t pid;
+    uint32_t tid;
+    uint64_t vma;
+    uint64_t code_addr;
+    uint64_t code_size;
+    uint64_t code_index;
+  };
+
+  const static uint32_t cJitDumpMagic = 0x4A695444;
+  const static uint32_t cJitDumpVersion = 1;
+  const static uint32_t cJitCodeLoad = 0;
+
+  // perf matches jitdump records up with samples by time, and it uses the
+  // monotonic clock (perf record -k mono).
+  static uint64_t monotonic_time() {
+#ifdef CLOCK_MONOTONIC
+    timespec tp;
+    if(clock_gettime(CLOCK_MONOTONIC, &tp) == 0) {
+      return tp.tv_sec * 1000000000ULL + tp.tv_nsec;
+    }
+#endif
+    return 0;
+  }
+
+  static uint32_t thread_id() {
+#if defined(__linux__) && defined(SYS_gettid)
+    return syscall(SYS_gettid);
+#else
+    return getpid();
+#endif
+  }
+
+  PerfMap::PerfMap(Format format, const char* path)
+    : format_(format)
+    , file_(NULL)
+    , marker_(NULL)
+    , code_index_(0)
+  {
+    if(path) {
+      path_ = path;
+    } else {
+      std::ostringstream name;
+      if(format == cMap) {
+        name << "/tmp/perf-" << getpid() << ".map";
+      } else {
+        name << "jit-" << getpid() << ".dump";
+      }
+      path_ = name.str();
+    }
+
+    file_ = fopen(path_.c_str(), format == cMap ? "a" : "w+");
+    if(!file_) return;
+
+    if(format == cJitDump) write_jitdump_header();
+  }
+
+  PerfMap::~PerfMap() {
+    if(marker_) munmap(marker_, sysconf(_SC_PAGESIZE));
+    if(file_) fclose(file_);
+  }
+
+  PerfMap* PerfMap::create(const std::string& name) {
+    PerfMap* map;
+
+    if(name == "map") {
+      map = new PerfMap(cMap);
+    } else if(name == "jitdump") {
+      map = new PerfMap(cJitDump);
+    } else {
+      return NULL;
+    }
+
+    if(!map->open_p()) {
+      delete map;
+      return NULL;
+    }
+
+    return map;
+  }
+
+  void PerfMap::write_jitdump_header() {
+    JitDumpHeader header;
+
+    header.magic = cJitDumpMagic;
+    header.version = cJitDumpVersion;
+    header.total_size = sizeof(JitDumpHeader);
+#if defined(IS_X8664)
+    header.elf_mach = 62;   // EM_X86_64
+#elif defined(IS_X86)
+    header.elf_mach = 3;    // EM_386
+#else
+    header.elf_mach = 0;
+#endif
+    header.pad1 = 0;
+    header.pid = getpid();
+    header.timestamp = monotonic_time();
+    header.flags = 0;
+
+    fwrite(&header, sizeof(header), 1, file_);
+    fflush(file_);
+
+    // perf record only picks up the dump if it sees it mapped executable.
+    void* marker = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ | PROT_EXEC,
+                        MAP_PRIVATE, fileno(file_), 0);
+    if(marker != MAP_FAILED) marker_ = marker;
+  }
+
+  void PerfMap::record(const void* code, size_t size, const std::string& name) {
+    if(!file_) return;
+
+    if(format_ == cMap) {
+      fprintf(file_, "%lx %lx %s\n", (unsigned long)(uintptr_t)code,
+              (unsigned long)size, name.c_str());
+    } else {
+      JitDumpCodeLoad rec;
+
+      rec.id = cJitCodeLoad;
+      rec.total_size = sizeof(rec) + name.size() + 1 + size;
+      rec.timestamp = monotonic_time();
+      rec.pid = getpid();
+      rec.tid = thread_id();
+      rec.vma = reinterpret_cast<uintptr_t>(code);
+      rec.code_addr = reinterpret_cast<uintptr_t>(code);
+      rec.code_size = size;
+      rec.code_index = code_index_++;
+
+      fwrite(&rec, sizeof(rec), 1, file_);
+      fwrite(name.c_str(), name.size() + 1, 1, file_);
+      fwrite(code, size, 1, file_);
+    }
+
+    // So that nothing is lost if we crash
+    fflush(file_);
+  }
+
+  void PerfMap::record(STATE, VMMethod* vmm, const void* code, size_t size) {
+    record(code, size, method_name(state, vmm));
+  }
+
+  std::string PerfMap::method_name(STATE, VMMethod* vmm) {
+    CompiledMethod* cm = vmm->original.get();
+    std::ostringstream name;
+
+    Module* mod = NULL;
+    if(StaticScope* scope = try_as<StaticScope>(cm->scope())) {
+      mod = try_as<Module>(scope->module());
+    }
+
+    if(mod && !mod->name()->nil_p()) {
+      name << mod->name()->c_str(state);
+    } else {
+      name << "<unknown>";
+    }
+
+    name << "#";
+
+    if(cm->name()->nil_p()) {
+      name << "<unknown>";
+    } else {
+      name << cm->name()->c_str(state);
+    }
+
+    if(!cm->file()->nil_p()) {
+      name << " " << cm->file()->c_str(state) << ":" << cm->start_line(state);
+    }
+
+    return name.str();
+  }
+}
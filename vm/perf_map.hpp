@@ -0,0 +1,76 @@
+#ifndef RBX_VM_PERF_MAP_HPP
+#define RBX_VM_PERF_MAP_HPP
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+#include "prelude.hpp"
+
+namespace rubinius {
+  class VMMethod;
+
+  /**
+   *  Tells Linux perf what the machine code we generate is, so profiles
+   *  show method names rather than bare addresses.
+   *
+   *  cMap appends "start size name" lines to /tmp/perf-<pid>.map, which
+   *  perf report reads on its own. cJitDump writes ./jit-<pid>.dump in
+   *  the jitdump format, including a copy of the code, so that
+   *  `perf inject --jit` can annotate the instructions. The dump is
+   *  mmap'd executable once so that perf record notices it.
+   *
+   *  Only created when rbx.jit.perf is set; otherwise VM::perf_map is
+   *  NULL and installing code doesn't touch this at all.
+   */
+  class PerfMap {
+  public:
+    enum Format {
+      cMap,
+      cJitDump
+    };
+
+  private:
+    Format format_;
+    std::string path_;
+    FILE* file_;
+    void* marker_;
+    uint64_t code_index_;
+
+  public:
+    // Opens the file for +format+ at +path+, or at the default location
+    // for this process if +path+ is NULL.
+    PerfMap(Format format, const char* path = NULL);
+    ~PerfMap();
+
+    // Returns a PerfMap for the format named by +name+ ("map" or
+    // "jitdump"), or NULL if the name is unknown or the file can't be
+    // opened.
+    static PerfMap* create(const std::string& name);
+
+    bool open_p() {
+      return file_ != NULL;
+    }
+
+    const std::string& path() {
+      return path_;
+    }
+
+    Format format() {
+      return format_;
+    }
+
+    // Record +size+ bytes of code at +code+ as +name+.
+    void record(const void* code, size_t size, const std::string& name);
+
+    // Record the machine code for +vmm+, named like "Class#method file:line".
+    void record(STATE, VMMethod* vmm, const void* code, size_t size);
+
+    static std::string method_name(STATE, VMMethod* vmm);
+
+  private:
+    void write_jitdump_header();
+  };
+}
+
+#endif
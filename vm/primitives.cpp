@@ -11,7 +11,7 @@
 namespace rubinius {
   ExecuteStatus Primitives::unknown_primitive(STATE, Task* task, Message& msg) {
     std::string message = std::string("Called unbound or invalid primitive from: ");
-    message += msg.name->to_str(state)->c_str();
+    message += msg.name->to_str(state)->c_str(state);
 
     Exception::assertion_error(state, message.c_str());
 
@@ -0,0 +1,30 @@
+#include "oniguruma.h" // Must be first.
+
+#include "region_pool.hpp"
+
+namespace rubinius {
+
+  RegionPool::~RegionPool() {
+    for(std::vector<OnigRegion*>::iterator i = regions_.begin();
+        i != regions_.end(); i++) {
+      onig_region_free(*i, 1);
+    }
+  }
+
+  OnigRegion* RegionPool::acquire() {
+    if(regions_.empty()) return onig_region_new();
+
+    OnigRegion* region = regions_.back();
+    regions_.pop_back();
+    onig_region_clear(region);
+    return region;
+  }
+
+  void RegionPool::release(OnigRegion* region) {
+    if(regions_.size() < cMaxRegions) {
+      regions_.push_back(region);
+    } else {
+      onig_region_free(region, 1);
+    }
+  }
+}
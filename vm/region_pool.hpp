@@ -0,0 +1,45 @@
+#ifndef RBX_VM_REGION_POOL_HPP
+#define RBX_VM_REGION_POOL_HPP
+
+#include <vector>
+#include <stddef.h>
+
+// OnigRegion is a typedef of this; see the note in builtin/regexp.hpp
+// about not pulling oniguruma.h into everything.
+struct re_registers;
+
+namespace rubinius {
+
+  /**
+   *  Spare Oniguruma match regions, so that a match doesn't have to
+   *  malloc and free one each time.
+   *
+   *  A region is only looked at by the primitive doing the match, which
+   *  copies what it needs into the MatchData before handing the region
+   *  back. Oniguruma grows a region to fit the regex it's used with, so
+   *  a returned region keeps its arrays for the next match.
+   */
+  class RegionPool {
+  public:
+    // Regions beyond this many are freed when they are released
+    const static size_t cMaxRegions = 4;
+
+  private:
+    std::vector<re_registers*> regions_;
+
+  public:
+    ~RegionPool();
+
+    /** A cleared region, from the pool if there is one. */
+    re_registers* acquire();
+
+    /** Returns +region+ to the pool, or frees it if the pool is full. */
+    void release(re_registers* region);
+
+    size_t size() {
+      return regions_.size();
+    }
+  };
+}
+
+#endif
@@ -0,0 +1,152 @@
+#include "vm/sha1.hpp"
+
+#include <cstring>
+#include <fstream>
+
+namespace rubinius {
+
+  static inline uint32_t rotl(uint32_t x, int n) {
+    return (x << n) | (x >> (32 - n));
+  }
+
+  SHA1::SHA1()
+    : length_(0)
+    , buffered_(0)
+  {
+    state_[0] = 0x67452301;
+    state_[1] = 0xEFCDAB89;
+    state_[2] = 0x98BADCFE;
+    state_[3] = 0x10325476;
+    state_[4] = 0xC3D2E1F0;
+  }
+
+  void SHA1::transform(const uint8_t block[64]) {
+    uint32_t w[80];
+
+    for(int i = 0; i < 16; i++) {
+      w[i] = ((uint32_t)block[i * 4] << 24) | ((uint32_t)block[i * 4 + 1] << 16) |
+             ((uint32_t)block[i * 4 + 2] << 8) | (uint32_t)block[i * 4 + 3];
+    }
+
+    for(int i = 16; i < 80; i++) {
+      w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+
+    uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3], e = state_[4];
+
+    for(int i = 0; i < 80; i++) {
+      uint32_t f, k;
+
+      if(i < 20) {
+        f = (b & c) | (~b & d);
+        k = 0x5A827999;
+      } else if(i < 40) {
+        f = b ^ c ^ d;
+        k = 0x6ED9EBA1;
+      } else if(i < 60) {
+        f = (b & c) | (b & d) | (c & d);
+        k = 0x8F1BBCDC;
+      } else {
+        f = b ^ c ^ d;
+        k = 0xCA62C1D6;
+      }
+
+      uint32_t t = rotl(a, 5) + f + e + k + w[i];
+      e = d;
+      d = c;
+      c = rotl(b, 30);
+      b = a;
+      a = t;
+    }
+
+    state_[0] += a;
+    state_[1] += b;
+    state_[2] += c;
+    state_[3] += d;
+    state_[4] += e;
+  }
+
+  void SHA1::update(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    length_ += size;
+
+    if(buffered_ > 0) {
+      size_t take = 64 - buffered_;
+      if(take > size) take = size;
+
+      std::memcpy(buffer_ + buffered_, bytes, take);
+      buffered_ += take;
+      bytes += take;
+      size -= take;
+
+      if(buffered_ < 64) return;
+
+      transform(buffer_);
+      buffered_ = 0;
+    }
+
+    while(size >= 64) {
+      transform(bytes);
+      bytes += 64;
+      size -= 64;
+    }
+
+    std::memcpy(buffer_, bytes, size);
+    buffered_ = size;
+  }
+
+  void SHA1::digest(uint8_t out[cDigestSize]) {
+    uint64_t bits = length_ * 8;
+
+    uint8_t pad = 0x80;
+    update(&pad, 1);
+
+    pad = 0;
+    while(buffered_ != 56) update(&pad, 1);
+
+    uint8_t len[8];
+    for(int i = 0; i < 8; i++) {
+      len[i] = (uint8_t)(bits >> (56 - i * 8));
+    }
+    update(len, 8);
+
+    for(int i = 0; i < 5; i++) {
+      out[i * 4]     = (uint8_t)(state_[i] >> 24);
+      out[i * 4 + 1] = (uint8_t)(state_[i] >> 16);
+      out[i * 4 + 2] = (uint8_t)(state_[i] >> 8);
+      out[i * 4 + 3] = (uint8_t)state_[i];
+    }
+  }
+
+  std::string SHA1::hexdigest() {
+    static const char hex[] = "0123456789abcdef";
+
+    uint8_t out[cDigestSize];
+    digest(out);
+
+    std::string str;
+    for(size_t i = 0; i < cDigestSize; i++) {
+      str += hex[out[i] >> 4];
+      str += hex[out[i] & 0xf];
+    }
+
+    return str;
+  }
+
+  std::string SHA1::file_hexdigest(const char* path) {
+    std::ifstream stream(path, std::ios::binary);
+    if(!stream) return std::string();
+
+    SHA1 sha;
+    char buf[8192];
+
+    while(stream) {
+      stream.read(buf, sizeof(buf));
+      if(stream.gcount() > 0) sha.update(buf, stream.gcount());
+    }
+
+    if(stream.bad()) return std::string();
+
+    return sha.hexdigest();
+  }
+}
@@ -0,0 +1,43 @@
+#ifndef RBX_VM_SHA1_HPP
+#define RBX_VM_SHA1_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace rubinius {
+
+  /**
+   *  SHA-1, as in FIPS 180-1. Used to name compiled files by the
+   *  contents of their source, so it only needs to be collision free in
+   *  practice, not secure.
+   */
+  class SHA1 {
+  public:
+    const static size_t cDigestSize = 20;
+
+  private:
+    uint32_t state_[5];
+    uint64_t length_;
+    uint8_t buffer_[64];
+    size_t buffered_;
+
+  public:
+    SHA1();
+
+    void update(const void* data, size_t size);
+
+    // Finishes the hash; no more data may be added after.
+    void digest(uint8_t out[cDigestSize]);
+    std::string hexdigest();
+
+    // The hex digest of the contents of the file at +path+, or an empty
+    // string if it can't be read.
+    static std::string file_hexdigest(const char* path);
+
+  private:
+    void transform(const uint8_t block[64]);
+  };
+}
+
+#endif
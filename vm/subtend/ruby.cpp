@@ -11,6 +11,7 @@
 #include "builtin/data.hpp"
 #include "builtin/exception.hpp"
 #include "builtin/fixnum.hpp"
+#include "builtin/float.hpp"
 #include "builtin/integer.hpp"
 #include "builtin/lookuptable.hpp"
 #include "builtin/module.hpp"
@@ -40,6 +41,7 @@ using rubinius::Class;
 using rubinius::ClassType;
 using rubinius::Data;
 using rubinius::Fixnum;
+using rubinius::Float;
 using rubinius::Integer;
 using rubinius::Message;
 using rubinius::MethodVisibility;
@@ -340,6 +342,11 @@ extern "C" {
 
     String* string = as<String>(context->object_from(string_handle));
 
+    // The extension may write through the pointer.
+    if(string->shared()->true_p() || string->window_p()) {
+      string->unshare(context->state());
+    }
+
     return string->byte_address();
   }
 
@@ -482,6 +489,33 @@ extern "C" {
     return hidden_native2num<unsigned int>(number);
   }
 
+  VALUE rb_float_new(double value) {
+    NativeMethodContext* context = NativeMethodContext::current();
+    return context->handle_for(Float::create(context->state(), value));
+  }
+
+  double rb_num2dbl(VALUE number_handle) {
+    NativeMethodContext* context = NativeMethodContext::current();
+
+    Object* number = context->object_from(number_handle);
+
+    if(Float* flt = try_as<Float>(number)) {
+      return flt->val();
+    }
+    else if(Fixnum* fix = try_as<Fixnum>(number)) {
+      return (double)fix->to_native();
+    }
+    else if(Bignum* big = try_as<Bignum>(number)) {
+      return big->to_double(context->state());
+    }
+    else {
+      rb_raise(rb_eTypeError, "Argument must be a Float or an Integer!");
+    }
+
+    /* Compiler Appreciation Project */
+    return 0.0;
+  }
+
   VALUE rb_Array(VALUE obj_handle) {
     NativeMethodContext* context = NativeMethodContext::current();
 
@@ -1196,7 +1230,7 @@ extern "C" {
       return '\0';
     }
 
-    return self->c_str()[offset_as_size];
+    return self->byte_address()[offset_as_size];
   }
 
   size_t rb_str_get_char_len(VALUE self_handle) {
@@ -1213,7 +1247,7 @@ extern "C" {
     size_t length = string->size();
 
     char* buffer = ALLOC_N(char, (length + 1));
-    std::memcpy(buffer, string->c_str(), length);
+    std::memcpy(buffer, string->byte_address(), length);
     buffer[length] = '\0';
 
     return buffer;
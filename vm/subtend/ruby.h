@@ -325,6 +325,12 @@ extern "C" {
 /** Whether object is nil. */
 #define NIL_P(v)          rbx_subtend_hidden_nil_p((v))
 
+/** Convert a Numeric into a double. */
+#define NUM2DBL(v)        rb_num2dbl((v))
+
+/** The double value of a Float. RFLOAT(v)->value is not available. */
+#define RFLOAT_VALUE(v)   rb_num2dbl((v))
+
 /** The length of string str. */
 #define RSTRING_LEN(str)  rbx_subtend_hidden_rstring_len((str))
 
@@ -442,6 +448,12 @@ extern "C" {
   /** Convert unsigned int into a Numeric. */
   VALUE   UINT2NUM(unsigned int number);
 
+  /** Create a Float. It may be an immediate, but C code only sees a handle. */
+  VALUE   rb_float_new(double value);
+
+  /** Convert a Float or Integer into a double. */
+  double  rb_num2dbl(VALUE number_handle);
+
   char*   StringValuePtr(VALUE str);
 
 #define   Data_Make_Struct(klass, type, mark, free, sval) (\
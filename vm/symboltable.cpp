@@ -1,11 +1,14 @@
 #include "vm/symboltable.hpp"
 #include "vm/exception.hpp"
+#include "vm/bytes.hpp"
 
 #include "builtin/array.hpp"
 #include "builtin/exception.hpp"
 #include "builtin/string.hpp"
 #include "builtin/symbol.hpp"
 
+#include <cstring>
+
 namespace rubinius {
 
   SymbolTable::Kind SymbolTable::detect_kind(const char* str, int size) {
@@ -40,43 +43,116 @@ namespace rubinius {
   }
 
   SymbolTable::Kind SymbolTable::kind(STATE, const Symbol* sym) {
-    return kinds[sym->index()];
+    return entries[sym->index()].kind;
   }
 
-  size_t SymbolTable::add(std::string str) {
-    strings.push_back(str);
-    kinds.push_back(detect_kind(str.c_str(), str.size()));
-    return strings.size() - 1;
+  SymbolTable::SymbolTable()
+    : slots(cInitialSlots, 0)
+    , slot_mask(cInitialSlots - 1)
+    , arena_cur(NULL)
+    , arena_end(NULL)
+  { }
+
+  SymbolTable::~SymbolTable() {
+    for(ArenaChunks::iterator i = chunks.begin(); i != chunks.end(); i++) {
+      delete[] *i;
+    }
   }
 
-  Symbol* SymbolTable::lookup(STATE, std::string str) {
-    size_t sym;
+  const char* SymbolTable::intern_bytes(const char* str, size_t length) {
+    size_t needed = length + 1;
+    char* bytes;
 
-    if(str.size() == 0) {
-      Exception::argument_error(state, "Cannot create a symbol from an empty string");
+    if(needed > cArenaChunkSize) {
+      bytes = new char[needed];
+      chunks.push_back(bytes);
+    } else {
+      if(needed > (size_t)(arena_end - arena_cur)) {
+        arena_cur = new char[cArenaChunkSize];
+        arena_end = arena_cur + cArenaChunkSize;
+        chunks.push_back(arena_cur);
+      }
+
+      bytes = arena_cur;
+      arena_cur += needed;
+    }
+
+    std::memcpy(bytes, str, length);
+    bytes[length] = 0;
+
+    return bytes;
+  }
+
+  void SymbolTable::insert_slot(size_t index) {
+    size_t slot = entries[index].hash & slot_mask;
+
+    while(slots[slot]) {
+      slot = (slot + 1) & slot_mask;
+    }
+
+    slots[slot] = index + 1;
+  }
+
+  void SymbolTable::grow() {
+    size_t size = slots.size() * 2;
+
+    slots.assign(size, 0);
+    slot_mask = size - 1;
+
+    for(size_t i = 0; i < entries.size(); i++) {
+      insert_slot(i);
     }
+  }
+
+  size_t SymbolTable::add(const char* str, size_t length, hashval hash) {
+    Entry entry;
 
-    hashval hash = String::hash_str((unsigned char*)str.c_str(), str.size());
+    entry.bytes = intern_bytes(str, length);
+    entry.length = length;
+    entry.hash = hash;
+    entry.kind = detect_kind(entry.bytes, length);
 
-    SymbolMap::iterator entry = symbols.find(hash);
-    if(entry == symbols.end()) {
-      sym = add(str);
-      SymbolIds v(1, sym);
-      symbols[hash] = v;
+    entries.push_back(entry);
+
+    // Keep the table at most half full so probe runs stay short.
+    size_t index = entries.size() - 1;
+    if(entries.size() * 2 > slots.size()) {
+      grow();
     } else {
-      SymbolIds& v = entry->second;
-      for(SymbolIds::iterator i = v.begin(); i != v.end(); i++) {
-        if(strings[*i] == str) return Symbol::from_index(state, *i);
+      insert_slot(index);
+    }
+
+    return index;
+  }
+
+  Symbol* SymbolTable::lookup(STATE, const char* str, size_t length) {
+    if(length == 0) {
+      Exception::argument_error(state, "Cannot create a symbol from an empty string");
+    }
+
+    hashval hash = String::hash_str((unsigned char*)str, length);
+    size_t slot = hash & slot_mask;
+
+    while(size_t index = slots[slot]) {
+      Entry& entry = entries[index - 1];
+
+      if(entry.hash == hash && entry.length == length &&
+          bytes::equal(entry.bytes, str, length)) {
+        return Symbol::from_index(state, index - 1);
       }
-      sym = add(str);
-      v.push_back(sym);
+
+      slot = (slot + 1) & slot_mask;
     }
 
-    return Symbol::from_index(state, sym);
+    return Symbol::from_index(state, add(str, length, hash));
+  }
+
+  Symbol* SymbolTable::lookup(STATE, std::string str) {
+    return lookup(state, str.data(), str.size());
   }
 
   Symbol* SymbolTable::lookup(STATE, const char* str) {
-    return lookup(state, std::string(str));
+    return lookup(state, str, std::strlen(str));
   }
 
   Symbol* SymbolTable::lookup(STATE, String* str) {
@@ -84,16 +160,15 @@ namespace rubinius {
       Exception::argument_error(state, "Cannot look up Symbol from nil");
     }
 
-    const char* bytes = str->c_str();
+    const char* bytes = str->byte_address();
+    size_t size = str->size();
 
-    for(std::size_t i = 0; i < str->size(); i++) {
-      if(bytes[i] == 0) {
-        Exception::argument_error(state,
-            "cannot create a symbol from a string containing `\\0'");
-      }
+    if(std::memchr(bytes, 0, size)) {
+      Exception::argument_error(state,
+          "cannot create a symbol from a string containing `\\0'");
     }
 
-    return lookup(state, bytes);
+    return lookup(state, bytes, size);
   }
 
   String* SymbolTable::lookup_string(STATE, const Symbol* sym) {
@@ -101,8 +176,8 @@ namespace rubinius {
       Exception::argument_error(state, "Cannot look up Symbol from nil");
     }
 
-    std::string& str = strings[sym->index()];
-    return String::create(state, str.c_str());
+    Entry& entry = entries[sym->index()];
+    return String::create(state, entry.bytes, entry.length);
   }
 
   const char* SymbolTable::lookup_cstring(STATE, const Symbol* sym) {
@@ -110,22 +185,18 @@ namespace rubinius {
       Exception::argument_error(state, "Cannot look up Symbol from nil");
     }
 
-    std::string& str = strings[sym->index()];
-    return str.c_str();
+    return entries[sym->index()].bytes;
   }
 
   size_t SymbolTable::size() {
-    return strings.size();
+    return entries.size();
   }
 
   Array* SymbolTable::all_as_array(STATE) {
-    size_t idx = 0;
     Array* ary = Array::create(state, this->size());
 
-    for(SymbolMap::iterator s = symbols.begin(); s != symbols.end(); s++) {
-      for(SymbolIds::iterator i = s->second.begin(); i != s->second.end(); i++) {
-        ary->set(state, idx++, (Object*)Symbol::from_index(state, *i));
-      }
+    for(size_t i = 0; i < entries.size(); i++) {
+      ary->set(state, i, (Object*)Symbol::from_index(state, i));
     }
 
     return ary;
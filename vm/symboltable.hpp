@@ -6,22 +6,23 @@
 
 #include <string>
 #include <vector>
-#include <tr1/unordered_map>
 
 /* SymbolTable provides a one-to-one map between a symbol ID
- * and a string. The hashing algorithm used to generate a
- * hashval from a string is not perfect. For instance, the
- * strings "__uint_fast64_t" and "TkIF_MOD" generate the same
- * hashval. SymbolTable handles this by first looking up a
- * symbol ID for a string by the string's hashval and then
- * comparing the candidate string with the stored string that
- * corresponds to the possible symbol ID.
+ * and a string.
  *
- * When a symbol ID is generated, the string corresponding to
- * that symbol ID is stored in a vector. The symbol ID is the
- * index of that string in the vector. The symbol ID becomes
- * a Symbol* by adding the tag value for symbols. (See builtin
- * class Symbol::from_index and oop.hpp.)
+ * The bytes of every interned string are copied, NUL terminated,
+ * into a contiguous arena that is only ever appended to, so the
+ * char* handed out by lookup_cstring stays valid for the life of
+ * the table. The symbol ID is the index of the string's entry in
+ * a vector; the ID becomes a Symbol* by adding the tag value for
+ * symbols. (See builtin class Symbol::from_index and oop.hpp.)
+ *
+ * Finding the ID for a string goes through an open addressing
+ * table of entry indexes, keyed by the string's hashval and
+ * length and probed linearly. Different strings can share a
+ * hashval, so a candidate only matches once its bytes compare
+ * equal too. Looking up a string that is already interned never
+ * allocates.
  */
 namespace rubinius {
 
@@ -29,10 +30,6 @@ namespace rubinius {
   class String;
   class Symbol;
 
-  typedef std::vector<std::string> SymbolStrings;
-  typedef std::vector<std::size_t> SymbolIds;
-  typedef std::tr1::unordered_map<hashval, SymbolIds> SymbolMap;
-
   class SymbolTable {
   public: // Types
 
@@ -48,11 +45,28 @@ namespace rubinius {
       System
     };
 
-    typedef std::vector<Kind> SymbolKinds;
+    struct Entry {
+      const char* bytes;
+      size_t length;
+      hashval hash;
+      Kind kind;
+    };
+
+    typedef std::vector<Entry> SymbolEntries;
+    typedef std::vector<size_t> SymbolSlots;
+    typedef std::vector<char*> ArenaChunks;
+
+    // Strings longer than this get a chunk of their own
+    const static size_t cArenaChunkSize = 64 * 1024;
+    const static size_t cInitialSlots = 1024;
 
   public:
+    SymbolTable();
+    ~SymbolTable();
+
     Symbol* lookup(STATE, std::string str);
     Symbol* lookup(STATE, const char* str);
+    Symbol* lookup(STATE, const char* str, size_t length);
     Symbol* lookup(STATE, String* str);
     String* lookup_string(STATE, const Symbol* sym);
     const char* lookup_cstring(STATE, const Symbol* sym);
@@ -62,11 +76,20 @@ namespace rubinius {
     Kind kind(STATE, const Symbol* sym);
 
   private:
-    SymbolMap symbols;
-    SymbolStrings strings;
-    SymbolKinds kinds;
+    SymbolEntries entries;
+
+    // Each slot holds an index into +entries+ plus one; 0 is empty.
+    SymbolSlots slots;
+    size_t slot_mask;
+
+    ArenaChunks chunks;
+    char* arena_cur;
+    char* arena_end;
 
-    size_t add(std::string str);
+    size_t add(const char* str, size_t length, hashval hash);
+    const char* intern_bytes(const char* str, size_t length);
+    void insert_slot(size_t index);
+    void grow();
     Kind   detect_kind(const char* str, int size);
   };
 };
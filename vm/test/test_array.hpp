@@ -1,11 +1,14 @@
 #include "builtin/array.hpp"
 #include "builtin/fixnum.hpp"
+#include "builtin/float.hpp"
+#include "builtin/string.hpp"
 #include "builtin/tuple.hpp"
 
 #include "vm.hpp"
 #include "vm/object_utils.hpp"
 #include "objectmemory.hpp"
 #include "ffi_util.hpp"
+#include "primitives.hpp"
 
 #include <cxxtest/TestSuite.h>
 
@@ -171,4 +174,283 @@ class TestArray : public CxxTest::TestSuite {
     TS_ASSERT_EQUALS(ary->start(), as<Integer>(Fixnum::from(4)));
     TS_ASSERT_EQUALS(ary->total(), as<Integer>(Fixnum::from(0)));
   }
+
+  Array* fixnums(size_t count) {
+    Array* ary = Array::create(state, count);
+    for(size_t i = 0; i < count; i++) {
+      ary->set(state, i, Fixnum::from(i));
+    }
+    return ary;
+  }
+
+  void test_pop_shrinks_large_tuples() {
+    Array* ary = fixnums(64);
+
+    for(size_t i = 0; i < 60; i++) ary->pop(state);
+
+    TS_ASSERT(ary->tuple()->num_fields() < 64);
+    TS_ASSERT_EQUALS(ary->size(), 4U);
+    for(size_t i = 0; i < 4; i++) {
+      TS_ASSERT_EQUALS(ary->get(state, i), Fixnum::from(i));
+    }
+  }
+
+  void test_shift_shrinks_large_tuples() {
+    Array* ary = fixnums(64);
+
+    for(size_t i = 0; i < 60; i++) ary->shift(state);
+
+    TS_ASSERT(ary->tuple()->num_fields() < 64);
+    TS_ASSERT_EQUALS(ary->size(), 4U);
+    for(size_t i = 0; i < 4; i++) {
+      TS_ASSERT_EQUALS(ary->get(state, i), Fixnum::from(60 + i));
+    }
+  }
+
+  void test_push() {
+    Array* ary = Array::create(state, 0);
+
+    TS_ASSERT_EQUALS(ary->push(state, Qtrue), ary);
+    TS_ASSERT_EQUALS(ary->push(state, Qfalse), ary);
+    TS_ASSERT_EQUALS(ary->size(), 2U);
+    TS_ASSERT_EQUALS(ary->get(state, 1), Qfalse);
+  }
+
+  void test_concat() {
+    Array* ary = fixnums(3);
+    Array* other = fixnums(2);
+
+    TS_ASSERT_EQUALS(ary->concat(state, other), ary);
+    TS_ASSERT_EQUALS(ary->size(), 5U);
+    TS_ASSERT_EQUALS(ary->get(state, 3), Fixnum::from(0));
+    TS_ASSERT_EQUALS(ary->get(state, 4), Fixnum::from(1));
+  }
+
+  void test_concat_self() {
+    Array* ary = fixnums(3);
+    ary->shift(state);
+
+    ary->concat(state, ary);
+    TS_ASSERT_EQUALS(ary->size(), 4U);
+    TS_ASSERT_EQUALS(ary->get(state, 0), Fixnum::from(1));
+    TS_ASSERT_EQUALS(ary->get(state, 2), Fixnum::from(1));
+    TS_ASSERT_EQUALS(ary->get(state, 3), Fixnum::from(2));
+  }
+
+  void test_dup_prim() {
+    Array* ary = fixnums(3);
+    ary->IsTainted = TRUE;
+
+    Array* copy = ary->dup_prim(state);
+    TS_ASSERT(copy != ary);
+    TS_ASSERT(copy->tuple() != ary->tuple());
+    TS_ASSERT_EQUALS(copy->size(), 3U);
+    TS_ASSERT_EQUALS(copy->get(state, 2), Fixnum::from(2));
+    TS_ASSERT(copy->IsTainted);
+  }
+
+  void test_dup_prim_fails_for_subclasses() {
+    Class* sub = state->new_class("ArraySub", G(array), 0);
+    Array* ary = Array::allocate(state, sub);
+
+    TS_ASSERT_EQUALS(ary->dup_prim(state), Primitives::failure());
+  }
+
+  void test_index() {
+    Array* ary = fixnums(3);
+
+    TS_ASSERT_EQUALS(ary->index(state, Fixnum::from(2)), Fixnum::from(2));
+    TS_ASSERT_EQUALS(ary->index(state, Fixnum::from(3)), Qnil);
+    TS_ASSERT_EQUALS(ary->include_p(state, Fixnum::from(1)), Qtrue);
+    TS_ASSERT_EQUALS(ary->include_p(state, Qnil), Qfalse);
+  }
+
+  void test_index_compares_strings_by_contents() {
+    Array* ary = Array::create(state, 2);
+    ary->set(state, 0, state->symbol("blah"));
+    ary->set(state, 1, String::create(state, "blah"));
+
+    TS_ASSERT_EQUALS(ary->index(state, String::create(state, "blah")), Fixnum::from(1));
+  }
+
+  void test_index_fails_when_equal_must_be_sent() {
+    Array* ary = fixnums(2);
+    Object* obj = state->new_object<Object>(G(object));
+
+    TS_ASSERT_EQUALS(ary->index(state, obj), Primitives::failure());
+
+    ary->set(state, 0, obj);
+    TS_ASSERT_EQUALS(ary->index(state, obj), Fixnum::from(0));
+  }
+
+  void test_elements_equal() {
+    Array* ary = fixnums(3);
+
+    TS_ASSERT_EQUALS(ary->elements_equal(state, fixnums(3)), Qtrue);
+    TS_ASSERT_EQUALS(ary->elements_equal(state, fixnums(2)), Qfalse);
+
+    Array* other = fixnums(3);
+    other->set(state, 0, Qnil);
+    TS_ASSERT_EQUALS(ary->elements_equal(state, other), Qfalse);
+
+    other->set(state, 1, state->new_object<Object>(G(object)));
+    TS_ASSERT_EQUALS(ary->elements_equal(state, other), Primitives::failure());
+  }
+
+  void test_hash_elements() {
+    Array* ary = Array::create(state, 2);
+    ary->set(state, 0, String::create(state, "blah"));
+    ary->set(state, 1, Fixnum::from(3));
+
+    Array* other = Array::create(state, 2);
+    other->set(state, 0, String::create(state, "blah"));
+    other->set(state, 1, Fixnum::from(3));
+
+    TS_ASSERT(ary->hash_elements(state)->fixnum_p());
+    TS_ASSERT_EQUALS(ary->hash_elements(state), other->hash_elements(state));
+    TS_ASSERT(ary->hash_elements(state) != fixnums(2)->hash_elements(state));
+
+    ary->set(state, 1, state->new_object<Object>(G(object)));
+    TS_ASSERT_EQUALS(ary->hash_elements(state), Primitives::failure());
+  }
+
+  void test_flatten() {
+    Array* inner = fixnums(2);
+    Array* ary = Array::create(state, 3);
+    ary->set(state, 0, Qtrue);
+    ary->set(state, 1, inner);
+    ary->set(state, 2, inner);
+
+    Array* flat = ary->flatten(state);
+    TS_ASSERT_EQUALS(flat->size(), 5U);
+    TS_ASSERT_EQUALS(flat->get(state, 0), Qtrue);
+    TS_ASSERT_EQUALS(flat->get(state, 2), Fixnum::from(1));
+    TS_ASSERT_EQUALS(flat->get(state, 4), Fixnum::from(1));
+  }
+
+  void test_flatten_fails_for_recursive_arrays() {
+    Array* ary = fixnums(2);
+    ary->set(state, 1, ary);
+
+    TS_ASSERT_EQUALS(ary->flatten(state), Primitives::failure());
+  }
+
+  void test_compact() {
+    Array* ary = fixnums(4);
+    ary->set(state, 1, Qnil);
+    ary->set(state, 3, Qnil);
+
+    Array* out = ary->compact(state);
+    TS_ASSERT(out != ary);
+    TS_ASSERT_EQUALS(out->size(), 2U);
+    TS_ASSERT_EQUALS(out->get(state, 1), Fixnum::from(2));
+    TS_ASSERT_EQUALS(ary->size(), 4U);
+  }
+
+  void test_uniq() {
+    Array* ary = Array::create(state, 5);
+    ary->set(state, 0, Fixnum::from(1));
+    ary->set(state, 1, String::create(state, "blah"));
+    ary->set(state, 2, Fixnum::from(1));
+    ary->set(state, 3, String::create(state, "blah"));
+    ary->set(state, 4, Qnil);
+
+    Array* out = ary->uniq(state);
+    TS_ASSERT_EQUALS(out->size(), 3U);
+    TS_ASSERT_EQUALS(out->get(state, 0), Fixnum::from(1));
+    TS_ASSERT_EQUALS(out->get(state, 1), ary->get(state, 1));
+    TS_ASSERT_EQUALS(out->get(state, 2), Qnil);
+  }
+
+  void test_uniq_fails_for_other_elements() {
+    Array* ary = fixnums(2);
+    ary->set(state, 0, state->new_object<Object>(G(object)));
+
+    TS_ASSERT_EQUALS(ary->uniq(state), Primitives::failure());
+  }
+
+  void test_sort_fixnums() {
+    Array* ary = Array::create(state, 4);
+    ary->set(state, 0, Fixnum::from(3));
+    ary->set(state, 1, Fixnum::from(-7));
+    ary->set(state, 2, Fixnum::from(3));
+    ary->set(state, 3, Fixnum::from(0));
+
+    TS_ASSERT_EQUALS(ary->sort(state), ary);
+    TS_ASSERT_EQUALS(ary->get(state, 0), Fixnum::from(-7));
+    TS_ASSERT_EQUALS(ary->get(state, 1), Fixnum::from(0));
+    TS_ASSERT_EQUALS(ary->get(state, 3), Fixnum::from(3));
+  }
+
+  void test_sort_floats() {
+    Array* ary = Array::create(state, 3);
+    ary->set(state, 0, Float::create(state, 2.5));
+    ary->set(state, 1, Float::create(state, -1.0));
+    ary->set(state, 2, Float::create(state, 0.5));
+
+    ary->sort(state);
+    TS_ASSERT_EQUALS(as<Float>(ary->get(state, 0))->val(), -1.0);
+    TS_ASSERT_EQUALS(as<Float>(ary->get(state, 2))->val(), 2.5);
+  }
+
+  void test_sort_strings() {
+    Array* ary = Array::create(state, 3);
+    ary->set(state, 0, String::create(state, "b"));
+    ary->set(state, 1, String::create(state, "ab"));
+    ary->set(state, 2, String::create(state, "a"));
+
+    ary->sort(state);
+    TS_ASSERT_SAME_DATA(as<String>(ary->get(state, 0))->byte_address(), "a", 1);
+    TS_ASSERT_SAME_DATA(as<String>(ary->get(state, 1))->byte_address(), "ab", 2);
+    TS_ASSERT_SAME_DATA(as<String>(ary->get(state, 2))->byte_address(), "b", 1);
+  }
+
+  void test_sort_after_shift() {
+    Array* ary = fixnums(4);
+    ary->set(state, 0, Fixnum::from(10));
+    ary->shift(state);
+    ary->set(state, 0, Fixnum::from(5));
+
+    ary->sort(state);
+    TS_ASSERT_EQUALS(ary->size(), 3U);
+    TS_ASSERT_EQUALS(ary->get(state, 0), Fixnum::from(2));
+    TS_ASSERT_EQUALS(ary->get(state, 2), Fixnum::from(5));
+  }
+
+  void test_sort_fails_for_mixed_elements() {
+    Array* ary = fixnums(2);
+    ary->set(state, 1, Float::create(state, 0.5));
+
+    TS_ASSERT_EQUALS(ary->sort(state), Primitives::failure());
+
+    ary->set(state, 0, Float::create(state, 0.0)->div(state, Float::create(state, 0.0)));
+    TS_ASSERT_EQUALS(ary->sort(state), Primitives::failure());
+  }
+
+  void test_sort_by_keys_is_stable() {
+    Array* ary = fixnums(4);
+    Array* keys = Array::create(state, 4);
+    keys->set(state, 0, Fixnum::from(1));
+    keys->set(state, 1, Fixnum::from(0));
+    keys->set(state, 2, Fixnum::from(1));
+    keys->set(state, 3, Fixnum::from(0));
+
+    TS_ASSERT_EQUALS(ary->sort_by_keys(state, keys), ary);
+    TS_ASSERT_EQUALS(ary->get(state, 0), Fixnum::from(1));
+    TS_ASSERT_EQUALS(ary->get(state, 1), Fixnum::from(3));
+    TS_ASSERT_EQUALS(ary->get(state, 2), Fixnum::from(0));
+    TS_ASSERT_EQUALS(ary->get(state, 3), Fixnum::from(2));
+    TS_ASSERT_EQUALS(keys->get(state, 1), Fixnum::from(0));
+    TS_ASSERT_EQUALS(keys->get(state, 2), Fixnum::from(1));
+  }
+
+  void test_sort_by_keys_fails() {
+    Array* ary = fixnums(2);
+
+    TS_ASSERT_EQUALS(ary->sort_by_keys(state, fixnums(3)), Primitives::failure());
+
+    Array* keys = fixnums(2);
+    keys->set(state, 0, Qnil);
+    TS_ASSERT_EQUALS(ary->sort_by_keys(state, keys), Primitives::failure());
+  }
 };
@@ -0,0 +1,95 @@
+#include "vm.hpp"
+#include "vmmethod.hpp"
+#include "background_compiler.hpp"
+#include "builtin/compiledmethod.hpp"
+#include "builtin/iseq.hpp"
+#include "builtin/machine_method.hpp"
+
+#include <cxxtest/TestSuite.h>
+
+using namespace rubinius;
+
+class TestBackgroundCompiler : public CxxTest::TestSuite {
+public:
+
+  VM *state;
+
+  void setUp() {
+    state = new VM();
+  }
+
+  void tearDown() {
+    delete state;
+  }
+
+  VMMethod* create_vmmethod() {
+    CompiledMethod* cm = CompiledMethod::create(state);
+    cm->literals(state, Tuple::create(state, 0));
+
+    InstructionSequence* iseq = InstructionSequence::create(state, 2);
+    iseq->opcodes()->put(state, 0, Fixnum::from(InstructionSequence::insn_push_nil));
+    iseq->opcodes()->put(state, 1, Fixnum::from(InstructionSequence::insn_ret));
+
+    cm->iseq(state, iseq);
+    cm->stack_size(state, Fixnum::from(1));
+    cm->local_count(state, Fixnum::from(0));
+    cm->total_args(state, Fixnum::from(0));
+    cm->required_args(state, Fixnum::from(0));
+    cm->splat(state, Qnil);
+
+    return cm->formalize(state, false);
+  }
+
+  void test_install_finished() {
+    VMMethod* vmm = create_vmmethod();
+    Runner before = vmm->run;
+
+    BackgroundCompiler compiler(state);
+    compiler.enqueue(vmm);
+    compiler.wait_until_idle();
+
+    TS_ASSERT(state->interrupts.install_code);
+    TS_ASSERT(state->interrupts.check);
+    TS_ASSERT_EQUALS(compiler.queue_length(), 1U);
+
+    TS_ASSERT_EQUALS(compiler.install_finished(state), 1U);
+    TS_ASSERT_EQUALS(compiler.queue_length(), 0U);
+
+    TS_ASSERT(vmm->machine_method());
+    TS_ASSERT(vmm->run != before);
+    TS_ASSERT_EQUALS(vmm->run, (Runner)vmm->machine_method()->function());
+    TS_ASSERT_EQUALS(state->stats.jitted_methods, 1U);
+  }
+
+  void test_install_finished_skips_changed_opcodes() {
+    VMMethod* vmm = create_vmmethod();
+    Runner before = vmm->run;
+    vmm->call_count = -1;
+
+    BackgroundCompiler compiler(state);
+    compiler.enqueue(vmm);
+
+    // Like a breakpoint being set while the compiler works.
+    vmm->set_breakpoint_flags(state, 0, cBreakpoint);
+
+    compiler.wait_until_idle();
+
+    TS_ASSERT_EQUALS(compiler.install_finished(state), 0U);
+    TS_ASSERT_EQUALS(vmm->run, before);
+    TS_ASSERT_EQUALS(vmm->call_count, 0);
+    TS_ASSERT_EQUALS(state->stats.jitted_methods, 0U);
+  }
+
+  void test_compile_in_background() {
+    VMMethod* vmm = create_vmmethod();
+
+    state->compile_in_background(vmm);
+    TS_ASSERT(state->background_compiler);
+
+    state->background_compiler->wait_until_idle();
+    state->install_compiled_code();
+
+    TS_ASSERT(!state->interrupts.install_code);
+    TS_ASSERT(vmm->machine_method());
+  }
+};
@@ -124,7 +124,7 @@ class TestBignum : public CxxTest::TestSuite {
   }
 
   void check_float(Float* f, Float* g) {
-    TS_ASSERT_DELTA(f->val, g->val, TOLERANCE);
+    TS_ASSERT_DELTA(f->val(), g->val(), TOLERANCE);
   }
 
   void test_add_positive_range() {
@@ -407,6 +407,41 @@ class TestBignum : public CxxTest::TestSuite {
     TS_ASSERT_EQUALS(FIXNUM_MIN-1, min_minus1->to_native());
   }
 
+  void test_mul_past_64_bits() {
+#if __WORDSIZE != 64
+    TS_WARN("the expected values assume 64-bit Fixnums");
+    return;
+#endif
+    Bignum* max = Bignum::from(state, FIXNUM_MAX);
+    Integer* sq = max->mul(state, max);
+
+    TS_ASSERT(kind_of<Bignum>(sq));
+    TS_ASSERT_EQUALS(std::string("21267647932558653957237540927630737409"),
+        as<Bignum>(sq)->to_s(state, Fixnum::from(10))->byte_address());
+
+    Integer* cube = as<Bignum>(sq)->mul(state, max);
+    TS_ASSERT_EQUALS(std::string("98079714615416886871131265939943825866051622981576163327"),
+        as<Bignum>(cube)->to_s(state, Fixnum::from(10))->byte_address());
+
+    Integer* neg = as<Bignum>(sq)->mul(state, Fixnum::from(-1));
+    TS_ASSERT_EQUALS(std::string("-21267647932558653957237540927630737409"),
+        as<Bignum>(neg)->to_s(state, Fixnum::from(10))->byte_address());
+
+    Integer* diff = as<Bignum>(sq)->sub(state, as<Bignum>(sq));
+    TS_ASSERT_EQUALS(diff, Fixnum::from(0));
+  }
+
+  void test_compare_small_bignums() {
+    Bignum* big = Bignum::from(state, FIXNUM_MAX + 1);
+    Bignum* neg = Bignum::from(state, FIXNUM_MIN - 1);
+
+    TS_ASSERT_EQUALS(big->compare(state, Fixnum::from(FIXNUM_MAX)), Fixnum::from(1));
+    TS_ASSERT_EQUALS(neg->compare(state, Fixnum::from(FIXNUM_MIN)), Fixnum::from(-1));
+    TS_ASSERT_EQUALS(neg->compare(state, big), Fixnum::from(-1));
+    TS_ASSERT_EQUALS(big->compare(state, Bignum::from(state, FIXNUM_MAX + 1)), Fixnum::from(0));
+    TS_ASSERT_EQUALS(big->equal(state, Fixnum::from(FIXNUM_MAX)), Qfalse);
+  }
+
   void test_mul_with_positive_fixnum() {
     Fixnum* two = Fixnum::from(2);
     Fixnum* three = Fixnum::from(3);
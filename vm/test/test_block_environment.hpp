@@ -1,5 +1,12 @@
+#include "vm/config.h"
+
 #include "builtin/block_environment.hpp"
+#include "builtin/compiledmethod.hpp"
+#include "builtin/contexts.hpp"
+#include "builtin/iseq.hpp"
+#include "builtin/tuple.hpp"
 #include "vm.hpp"
+#include "vmmethod.hpp"
 #include "objectmemory.hpp"
 
 #include <cxxtest/TestSuite.h>
@@ -17,4 +24,51 @@ class TestBlockEnvironment : public CxxTest::TestSuite {
   void tearDown() {
     delete state;
   }
+
+  // push_nil; ret
+  CompiledMethod* create_block() {
+    CompiledMethod* cm = CompiledMethod::create(state);
+    cm->literals(state, Tuple::create(state, 0));
+
+    InstructionSequence* iseq = InstructionSequence::create(state, 2);
+    iseq->opcodes()->put(state, 0, Fixnum::from(InstructionSequence::insn_push_nil));
+    iseq->opcodes()->put(state, 1, Fixnum::from(InstructionSequence::insn_ret));
+
+    cm->iseq(state, iseq);
+    cm->stack_size(state, Fixnum::from(1));
+    cm->local_count(state, Fixnum::from(0));
+    cm->total_args(state, Fixnum::from(0));
+    cm->required_args(state, Fixnum::from(0));
+    cm->splat(state, Qnil);
+    cm->formalize(state, false);
+
+    return cm;
+  }
+
+  void test_create_context_queues_block_for_jit() {
+#ifndef USE_USAGE_JIT
+    TS_WARN("usage based JIT is not built on this platform");
+    return;
+#endif
+    state->config.jit_enabled = true;
+    CompiledMethod* cm = create_block();
+    MethodContext* home = MethodContext::create(state, Qnil, cm);
+
+    BlockEnvironment* be = BlockEnvironment::allocate(state);
+    be->home(state, home);
+    be->home_block(state, home);
+    be->method(state, cm);
+    be->local_count(state, cm->local_count());
+    be->vmm = new VMMethod(state, cm);
+
+    for(int i = 0; i < 50; i++) {
+      be->create_context(state, home);
+    }
+    TS_ASSERT_EQUALS(be->vmm->call_count, 50);
+    TS_ASSERT(!state->background_compiler);
+
+    be->create_context(state, home);
+    TS_ASSERT_EQUALS(be->vmm->call_count, -1);
+    TS_ASSERT(state->background_compiler);
+  }
 };
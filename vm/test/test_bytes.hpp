@@ -0,0 +1,97 @@
+#include "vm/bytes.hpp"
+
+#include <cxxtest/TestSuite.h>
+
+#include <cstring>
+#include <set>
+#include <string>
+
+using namespace rubinius;
+
+class TestBytes : public CxxTest::TestSuite {
+public:
+
+  int sign(int i) {
+    return i < 0 ? -1 : i > 0 ? 1 : 0;
+  }
+
+  void test_hash_is_deterministic() {
+    TS_ASSERT_EQUALS(bytes::hash("blah", 4), bytes::hash("blah", 4));
+    TS_ASSERT_DIFFERS(bytes::hash("blah", 4), bytes::hash("blah", 3));
+  }
+
+  void test_hash_uses_every_byte() {
+    // Long enough to go through both the 16 and 8 byte steps and a tail
+    std::string str(61, 'x');
+    uint64_t h = bytes::hash(str.data(), str.size());
+
+    for(size_t i = 0; i < str.size(); i++) {
+      std::string other = str;
+      other[i] = 'y';
+      TS_ASSERT_DIFFERS(h, bytes::hash(other.data(), other.size()));
+    }
+  }
+
+  void test_hash_distributes_low_bits() {
+    std::set<uint64_t> buckets;
+    char buf[16];
+
+    for(int i = 0; i < 1024; i++) {
+      size_t len = snprintf(buf, sizeof(buf), "key%d", i);
+      buckets.insert(bytes::hash(buf, len) & 1023);
+    }
+
+    // A random function fills about 632 of the 1024 buckets.
+    TS_ASSERT(buckets.size() > 550);
+  }
+
+  void test_equal() {
+    const char* a = "the quick brown fox jumps over the lazy dog";
+    const char* b = "the quick brown fox jumps over the lazy cat";
+
+    TS_ASSERT(bytes::equal(a, a, strlen(a)));
+    TS_ASSERT(bytes::equal(a, b, 40));
+    TS_ASSERT(!bytes::equal(a, b, strlen(a)));
+    TS_ASSERT(bytes::equal(a, b, 0));
+  }
+
+  void test_equal_every_length_and_position() {
+    char a[80], b[80];
+
+    for(size_t len = 1; len < sizeof(a); len++) {
+      memset(a, 'z', len);
+      memcpy(b, a, len);
+      TS_ASSERT(bytes::equal(a, b, len));
+
+      for(size_t i = 0; i < len; i++) {
+        b[i] = 'q';
+        TS_ASSERT(!bytes::equal(a, b, len));
+        b[i] = 'z';
+      }
+    }
+  }
+
+  void test_equal_with_embedded_null() {
+    TS_ASSERT(!bytes::equal("ab\0cd", "ab\0xy", 5));
+  }
+
+  void test_compare_matches_memcmp() {
+    unsigned char a[70], b[70];
+
+    for(size_t len = 1; len < sizeof(a); len++) {
+      for(size_t i = 0; i < len; i++) {
+        memset(a, 0x41, len);
+        memset(b, 0x41, len);
+        TS_ASSERT_EQUALS(bytes::compare(a, b, len), 0);
+
+        b[i] = 0x20;
+        TS_ASSERT_EQUALS(sign(bytes::compare(a, b, len)), sign(memcmp(a, b, len)));
+
+        // High bytes are unsigned
+        b[i] = 0xf0;
+        TS_ASSERT_EQUALS(sign(bytes::compare(a, b, len)), -1);
+        TS_ASSERT_EQUALS(sign(bytes::compare(b, a, len)), 1);
+      }
+    }
+  }
+};
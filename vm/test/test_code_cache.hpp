@@ -0,0 +1,145 @@
+#include "vm.hpp"
+#include "objectmemory.hpp"
+#include "vmmethod.hpp"
+#include "code_cache.hpp"
+#include "background_compiler.hpp"
+#include "builtin/compiledmethod.hpp"
+#include "builtin/iseq.hpp"
+#include "builtin/machine_method.hpp"
+
+#include <cxxtest/TestSuite.h>
+
+using namespace rubinius;
+
+class TestCodeCache : public CxxTest::TestSuite {
+public:
+
+  VM *state;
+
+  void setUp() {
+    state = new VM();
+  }
+
+  void tearDown() {
+    delete state;
+  }
+
+  VMMethod* create_vmmethod() {
+    CompiledMethod* cm = CompiledMethod::create(state);
+    cm->literals(state, Tuple::create(state, 0));
+
+    InstructionSequence* iseq = InstructionSequence::create(state, 2);
+    iseq->opcodes()->put(state, 0, Fixnum::from(InstructionSequence::insn_push_nil));
+    iseq->opcodes()->put(state, 1, Fixnum::from(InstructionSequence::insn_ret));
+
+    cm->iseq(state, iseq);
+    cm->stack_size(state, Fixnum::from(1));
+    cm->local_count(state, Fixnum::from(0));
+    cm->total_args(state, Fixnum::from(0));
+    cm->required_args(state, Fixnum::from(0));
+    cm->splat(state, Qnil);
+
+    return cm->formalize(state, false);
+  }
+
+  void test_allocate_rounds_to_pages() {
+    CodeCache cache;
+    size_t page = CodeCache::page_size();
+
+    uint8_t* one = static_cast<uint8_t*>(cache.allocate(NULL, 10));
+    uint8_t* two = static_cast<uint8_t*>(cache.allocate(NULL, page + 1));
+
+    TS_ASSERT(one);
+    TS_ASSERT_EQUALS(two, one + page);
+    TS_ASSERT_EQUALS(cache.used_bytes(), page * 3);
+    TS_ASSERT_EQUALS(cache.mapped_bytes(), CodeCache::cSegmentSize);
+
+    // Writable until committed
+    one[0] = 0xc3;
+    cache.commit(one);
+  }
+
+  void test_allocate_respects_limit() {
+    CodeCache cache(CodeCache::cSegmentSize);
+
+    TS_ASSERT(cache.allocate(NULL, CodeCache::cSegmentSize));
+    TS_ASSERT(!cache.allocate(NULL, 1));
+    TS_ASSERT_EQUALS(cache.mapped_bytes(), CodeCache::cSegmentSize);
+  }
+
+  void test_sweep_frees_retired_code() {
+    CodeCache cache;
+
+    void* code = cache.allocate(NULL, 10);
+    cache.commit(code);
+
+    TS_ASSERT_EQUALS(cache.sweep(), 0U);
+
+    cache.retire(code);
+    TS_ASSERT_EQUALS(cache.sweep(), CodeCache::page_size());
+    TS_ASSERT_EQUALS(cache.used_bytes(), 0U);
+    TS_ASSERT(!cache.find(code));
+
+    // The segment is empty again, so it's reused from the start.
+    TS_ASSERT_EQUALS(cache.allocate(NULL, 10), code);
+  }
+
+  void test_sweep_keeps_running_code() {
+    CodeCache cache;
+
+    uint8_t* code = static_cast<uint8_t*>(cache.allocate(NULL, 100));
+    cache.commit(code);
+    cache.retire(code);
+
+    cache.mark_running(code + 50);
+    TS_ASSERT_EQUALS(cache.sweep(), 0U);
+
+    // Nothing ran it since the last sweep
+    TS_ASSERT_EQUALS(cache.sweep(), CodeCache::page_size());
+  }
+
+  void test_evict_cold() {
+    state->config.jit_enabled = true;
+    VMMethod* vmm = create_vmmethod();
+    Runner interpreter = vmm->run;
+
+    state->compile_in_background(vmm);
+    state->background_compiler->wait_until_idle();
+    state->install_compiled_code();
+
+    MachineMethod* mm = vmm->machine_method();
+    TS_ASSERT(mm);
+    TS_ASSERT(state->code_cache->find(mm->function()));
+    TS_ASSERT(state->code_cache->used_bytes() > 0);
+
+    // Just installed, so it gets an epoch to be called in.
+    TS_ASSERT_EQUALS(state->code_cache->evict_cold(), 0U);
+    TS_ASSERT(vmm->machine_method());
+
+    vmm->epoch_calls = CodeCache::cColdCalls;
+    TS_ASSERT_EQUALS(state->code_cache->evict_cold(), 0U);
+    TS_ASSERT_EQUALS(vmm->epoch_calls, 0);
+
+    TS_ASSERT_EQUALS(state->code_cache->evict_cold(), 1U);
+    TS_ASSERT(!vmm->machine_method());
+    TS_ASSERT_EQUALS(vmm->run, interpreter);
+    TS_ASSERT_EQUALS(vmm->call_count, 0);
+  }
+
+  void test_collected_machine_method_frees_code() {
+    VMMethod* vmm = create_vmmethod();
+
+    JITCompiler jit;
+    jit.compile(state, vmm);
+
+    MachineMethod* mm = MachineMethod::create(state, vmm, jit);
+    void* code = mm->function();
+    TS_ASSERT(state->code_cache->find(code));
+
+    // Nothing refers to mm
+    state->om->collect_young(state->globals.roots);
+
+    TS_ASSERT(!state->code_cache->find(code));
+    TS_ASSERT_EQUALS(state->code_cache->used_bytes(), 0U);
+  }
+};
@@ -1,18 +1,22 @@
 #include "compiled_file.hpp"
+#include "vmmethod.hpp"
 #include "vm/object_utils.hpp"
 #include "objectmemory.hpp"
 #include "builtin/task.hpp"
 #include "builtin/class.hpp"
 #include "builtin/compiledmethod.hpp"
+#include "builtin/iseq.hpp"
 #include "builtin/lookuptable.hpp"
 #include "builtin/staticscope.hpp"
 #include "builtin/symbol.hpp"
+#include "builtin/tuple.hpp"
 
 #include <cxxtest/TestSuite.h>
 
 #include <iostream>
 #include <sstream>
 #include <fstream>
+#include <unistd.h>
 
 using namespace rubinius;
 
@@ -48,6 +52,215 @@ public:
     TS_ASSERT_EQUALS(cf->body(state), Qtrue);
   }
 
+  void word(std::string& str, uint32_t w, bool swap = false) {
+    if(swap) {
+      w = (w >> 24) | ((w >> 8) & 0xff00) | ((w << 8) & 0xff0000) | (w << 24);
+    }
+    str.append(reinterpret_cast<char*>(&w), sizeof(w));
+  }
+
+  // A binary .rbc holding the Tuple [:foo, <iseq push_nil ret>]
+  std::string binary_rbc(bool swap = false) {
+    std::string str("!RBIX\n2\nx\n\0\0", 12);
+
+    word(str, 0x01020304, swap);
+    word(str, 3, swap);
+
+    word(str, 1, swap);
+    word(str, 12, swap);
+    word(str, 1, swap);
+    word(str, 3, swap);
+    str.append("foo\0", 4);
+
+    word(str, 2, swap);
+    word(str, 8, swap);
+    word(str, InstructionSequence::insn_push_nil, swap);
+    word(str, InstructionSequence::insn_ret, swap);
+
+    word(str, 3, swap);
+    word(str, 28, swap);
+    word(str, 'p', swap);
+    word(str, 2, swap);
+    word(str, 'x', swap);
+    word(str, 0, swap);
+    word(str, 'i', swap);
+    word(str, 0, swap);
+    word(str, 2, swap);
+
+    return str;
+  }
+
+  void check_binary_body(Object* obj) {
+    Tuple* tup = try_as<Tuple>(obj);
+    TS_ASSERT(tup);
+    TS_ASSERT_EQUALS(tup->num_fields(), 2U);
+    TS_ASSERT_EQUALS(tup->at(state, 0), state->symbol("foo"));
+
+    InstructionSequence* iseq = try_as<InstructionSequence>(tup->at(state, 1));
+    TS_ASSERT(iseq);
+    TS_ASSERT_EQUALS(iseq->opcodes()->at(state, 0),
+                     Fixnum::from(InstructionSequence::insn_push_nil));
+    TS_ASSERT_EQUALS(iseq->opcodes()->at(state, 1),
+                     Fixnum::from(InstructionSequence::insn_ret));
+
+    uint32_t* ops = iseq->mapped_opcodes();
+    TS_ASSERT(ops);
+    TS_ASSERT_EQUALS(ops[0], (uint32_t)InstructionSequence::insn_push_nil);
+    TS_ASSERT_EQUALS(ops[1], (uint32_t)InstructionSequence::insn_ret);
+  }
+
+  void test_binary_body() {
+    std::istringstream stream;
+    stream.str(binary_rbc());
+
+    CompiledFile* cf = CompiledFile::load(stream);
+    TS_ASSERT_EQUALS(cf->version, CompiledFile::cBinaryVersion);
+    check_binary_body(cf->body(state));
+    TS_ASSERT_EQUALS(state->mapped_files.size(), 1U);
+  }
+
+  void test_binary_body_other_byte_order() {
+    std::istringstream stream;
+    stream.str(binary_rbc(true));
+
+    CompiledFile* cf = CompiledFile::load(stream);
+    check_binary_body(cf->body(state));
+  }
+
+  void test_binary_body_mapped_from_file() {
+    std::ostringstream name;
+    name << "/tmp/rbx-test-rbc-" << getpid();
+    std::string path = name.str();
+
+    {
+      std::ofstream out(path.c_str(), std::ios::binary);
+      out << binary_rbc();
+    }
+
+    std::ifstream stream(path.c_str(), std::ios::binary);
+    CompiledFile* cf = CompiledFile::load(stream, path);
+    check_binary_body(cf->body(state));
+    unlink(path.c_str());
+  }
+
+  // A binary .rbc holding the method foo, from bar, which returns nil
+  std::string lazy_method_rbc() {
+    std::string str("!RBIX\n2\nx\n\0\0", 12);
+
+    word(str, 0x01020304);
+    word(str, 3);
+
+    word(str, 1);
+    word(str, 20);
+    word(str, 2);
+    word(str, 3);
+    str.append("foo\0", 4);
+    word(str, 3);
+    str.append("bar\0", 4);
+
+    word(str, 2);
+    word(str, 8);
+    word(str, InstructionSequence::insn_push_nil);
+    word(str, InstructionSequence::insn_ret);
+
+    word(str, 3);
+    word(str, 104);
+    word(str, 'm');
+    word(str, 1);
+    word(str, 'n');         // ivars
+    word(str, 'n');         // primitive
+    word(str, 'x');         // name
+    word(str, 0);
+    word(str, 'I');         // stack_size
+    word(str, 1);
+    word(str, 'I');         // local_count
+    word(str, 0);
+    word(str, 'I');         // required_args
+    word(str, 0);
+    word(str, 'I');         // total_args
+    word(str, 0);
+    word(str, 'n');         // splat
+    word(str, 'x');         // file
+    word(str, 1);
+    word(str, 8);           // size of the rest
+    word(str, 'i');         // iseq
+    word(str, 0);
+    word(str, 2);
+    word(str, 'p');         // literals
+    word(str, 0);
+    word(str, 'n');         // exceptions
+    word(str, 'n');         // lines
+    word(str, 'n');         // local_names
+
+    return str;
+  }
+
+  CompiledMethod* load_lazy_method() {
+    std::istringstream stream;
+    stream.str(lazy_method_rbc());
+
+    CompiledFile* cf = CompiledFile::load(stream);
+    CompiledMethod* cm = as<CompiledMethod>(cf->body(state));
+    delete cf;
+
+    return cm;
+  }
+
+  void test_binary_method_loaded_as_stub() {
+    CompiledMethod* cm = load_lazy_method();
+
+    TS_ASSERT(cm->lazy_p());
+    TS_ASSERT_EQUALS(cm->name(), state->symbol("foo"));
+    TS_ASSERT_EQUALS(cm->file(), state->symbol("bar"));
+    TS_ASSERT_EQUALS(cm->stack_size(), Fixnum::from(1));
+    TS_ASSERT(cm->iseq()->nil_p());
+    TS_ASSERT(cm->literals()->nil_p());
+
+    cm->materialize(state);
+
+    TS_ASSERT(!cm->lazy_p());
+    TS_ASSERT(cm->iseq()->mapped_opcodes());
+    TS_ASSERT_EQUALS(cm->iseq()->opcodes()->at(state, 1),
+                     Fixnum::from(InstructionSequence::insn_ret));
+    TS_ASSERT_EQUALS(cm->literals()->num_fields(), 0U);
+  }
+
+  void test_binary_method_materialized_by_reflection() {
+    CompiledMethod* cm = load_lazy_method();
+
+    Object* lits = cm->get_ivar(state, state->symbol("@literals"));
+    TS_ASSERT(!cm->lazy_p());
+    TS_ASSERT(kind_of<Tuple>(lits));
+  }
+
+  void test_binary_method_materialized_by_formalize() {
+    CompiledMethod* cm = load_lazy_method();
+
+    VMMethod* vmm = cm->formalize(state);
+    TS_ASSERT(!cm->lazy_p());
+    TS_ASSERT_EQUALS(vmm->total, 2U);
+    TS_ASSERT_EQUALS(vmm->opcodes, cm->iseq()->mapped_opcodes());
+  }
+
+  void test_binary_body_truncated() {
+    // Drop the last object word and shrink the objects section to
+    // match, so the stream runs out in the middle of the Tuple.
+    std::string str = binary_rbc();
+    str.resize(str.size() - 4);
+
+    std::string bytes;
+    word(bytes, 24);
+    str.replace(str.size() - 28, 4, bytes);
+
+    std::istringstream stream;
+    stream.str(str);
+
+    CompiledFile* cf = CompiledFile::load(stream);
+    TS_ASSERT_THROWS_ASSERT(cf->body(state), const RubyException &e,
+        TS_ASSERT_EQUALS(std::string(e.exception->message()->c_str(state)),
+                         "Unable to unmarshal binary .rbc: truncated"));
+  }
+
   void test_load_file() {
     std::fstream stream("vm/test/fixture.rbc_");
     TS_ASSERT(!!stream);
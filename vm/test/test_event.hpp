@@ -121,4 +121,75 @@ class TestEventLoop : public CxxTest::TestSuite {
     TS_ASSERT(chan.called);
     sig->stop();
   }
+
+  void test_wakeup() {
+    TS_ASSERT(!state->events->woken());
+    state->events->wakeup();
+    TS_ASSERT(state->events->woken());
+
+    state->events->poll();
+    TS_ASSERT(!state->events->woken());
+    TS_ASSERT_EQUALS(state->events->num_of_events(), 1U);
+  }
+
+  void test_vm_wakeup_raises_check() {
+    state->interrupts.check = false;
+    state->interrupts.check_events = false;
+
+    state->wakeup();
+    TS_ASSERT(state->interrupts.check);
+    TS_ASSERT(state->interrupts.check_events);
+    TS_ASSERT(state->events->woken());
+  }
+
+  void test_ready_p_for_fd() {
+    int fds[2];
+    TS_ASSERT(!pipe(fds));
+
+    TestChannelObject chan(state);
+    event::Read* read = new event::Read(state, &chan, fds[0]);
+
+    state->events->start(read);
+    TS_ASSERT(!state->events->ready_p());
+    TS_ASSERT_EQUALS(write(fds[1], "!", 1),1);
+    TS_ASSERT(state->events->ready_p());
+
+    state->events->poll();
+    TS_ASSERT(chan.called);
+    TS_ASSERT(!state->events->ready_p());
+
+    close(fds[0]);
+    close(fds[1]);
+  }
+
+  void test_ready_p_for_timer() {
+    TestChannelObject chan(state);
+    event::Timer* later = new event::Timer(state, &chan, 100);
+
+    state->events->start(later);
+    TS_ASSERT(!state->events->ready_p());
+
+    event::Timer* now = new event::Timer(state, &chan, 0);
+    state->events->start(now);
+    TS_ASSERT(state->events->ready_p());
+
+    state->events->clear_by_channel(&chan);
+  }
+
+  void test_signal_raises_wakeup() {
+    TestChannelObject chan(state);
+    event::Signal* sig = new event::Signal(state, &chan, SIGUSR1);
+    state->events->start(sig);
+
+    state->events->poll();
+    state->interrupts.check_events = false;
+    TS_ASSERT(!state->events->woken());
+
+    kill(getpid(), SIGUSR1);
+    TS_ASSERT(state->events->woken());
+    TS_ASSERT(state->interrupts.check_events);
+
+    state->events->poll();
+    TS_ASSERT(chan.called);
+  }
 };
@@ -2,6 +2,9 @@
 #include "vm/object_utils.hpp"
 #include "objectmemory.hpp"
 
+#include <float.h>
+#include <cmath>
+
 #include <cxxtest/TestSuite.h>
 
 using namespace rubinius;
@@ -21,12 +24,73 @@ class TestFloat : public CxxTest::TestSuite {
   }
 
   void check_float(Float* f, Float* g) {
-    TS_ASSERT_DELTA(f->val, g->val, TOLERANCE);
+    TS_ASSERT_DELTA(f->val(), g->val(), TOLERANCE);
   }
 
   void test_create() {
     Float* flt = Float::create(state, 1.0);
-    TS_ASSERT_EQUALS(flt->val, 1.0);
+    TS_ASSERT_EQUALS(flt->val(), 1.0);
+  }
+
+  void test_create_immediate() {
+#if __WORDSIZE != 64
+    TS_WARN("Floats are only immediates on 64-bit");
+    return;
+#endif
+    double vals[] = { 1.0, -1.0, 0.0, 0.1, 1.5e38, -2.5e-38 };
+
+    for(size_t i = 0; i < sizeof(vals) / sizeof(double); i++) {
+      Float* flt = Float::create(state, vals[i]);
+      TS_ASSERT(FLONUM_P(flt));
+      TS_ASSERT(!flt->reference_p());
+      TS_ASSERT(kind_of<Float>(flt));
+      TS_ASSERT_EQUALS(flt->get_type(), FloatType);
+      TS_ASSERT_EQUALS(flt->class_object(state), G(floatpoint));
+      TS_ASSERT_EQUALS(flt->val(), vals[i]);
+      TS_ASSERT_EQUALS(Float::create(state, vals[i]), flt);
+    }
+  }
+
+  void test_create_boxed() {
+    double vals[] = { -0.0, 1.0e300, 1.0e-300, DBL_MAX, HUGE_VAL, ldexp(1.0, -127) };
+
+    for(size_t i = 0; i < sizeof(vals) / sizeof(double); i++) {
+      Float* flt = Float::create(state, vals[i]);
+      TS_ASSERT(flt->reference_p());
+      TS_ASSERT(kind_of<Float>(flt));
+      TS_ASSERT_EQUALS(flt->val(), vals[i]);
+    }
+
+    Float* neg_zero = Float::create(state, -0.0);
+    TS_ASSERT(signbit(neg_zero->val()));
+    TS_ASSERT(std::isnan(Float::create(state, NAN)->val()));
+  }
+
+  void test_immediate_and_boxed_mix() {
+#if __WORDSIZE != 64
+    TS_WARN("Floats are only immediates on 64-bit");
+    return;
+#endif
+    Float* a = Float::create(state, 1.0e100);
+    Float* b = Float::create(state, 2.0);
+
+    TS_ASSERT_EQUALS(a->mul(state, b)->val(), 2.0e100);
+    TS_ASSERT_EQUALS(b->mul(state, a)->val(), 2.0e100);
+    TS_ASSERT_EQUALS(a->div(state, Float::create(state, 1.0e100))->val(), 1.0);
+    TS_ASSERT(FLONUM_P(a->div(state, Float::create(state, 1.0e100))));
+  }
+
+  void test_hash_and_id() {
+#if __WORDSIZE != 64
+    TS_WARN("Floats are only immediates on 64-bit");
+    return;
+#endif
+    Float* a = Float::create(state, 0.5);
+    Float* b = Float::create(state, 0.25);
+
+    TS_ASSERT_EQUALS(a->hash(state), Float::create(state, 0.5)->hash(state));
+    TS_ASSERT(a->id(state) != b->id(state));
+    TS_ASSERT_EQUALS(a->id(state)->to_native() & 1, 1);
   }
 
   void test_coerce() {
@@ -41,7 +105,7 @@ class TestFloat : public CxxTest::TestSuite {
     String* str = String::create(state, "blah");
     Float* coercedStr = Float::coerce(state, str);
     TS_ASSERT(kind_of<Float>(coercedStr));
-    TS_ASSERT_EQUALS(coercedStr->val, 0.0);
+    TS_ASSERT_EQUALS(coercedStr->val(), 0.0);
   }
 
   void test_add() {
@@ -311,7 +375,7 @@ class TestFloat : public CxxTest::TestSuite {
 
     String* s = f->to_s_formatted(state, format);
 
-    TS_ASSERT_SAME_DATA("3.14159000000000", s->c_str(), 16);
+    TS_ASSERT_SAME_DATA("3.14159000000000", s->c_str(state), 16);
     TS_ASSERT_EQUALS(16U, s->size());
 
     format = String::create(state, "%#.1280g");
@@ -0,0 +1,185 @@
+#include "vm.hpp"
+#include "primitives.hpp"
+#include "builtin/hash.hpp"
+
+#include <cxxtest/TestSuite.h>
+
+using namespace rubinius;
+
+class TestHash : public CxxTest::TestSuite {
+  public:
+
+  VM *state;
+  Hash *hash;
+
+  void setUp() {
+    state = new VM(1024);
+    hash = Hash::create(state);
+  }
+
+  void tearDown() {
+    delete state;
+  }
+
+  void test_create() {
+    TS_ASSERT(kind_of<Hash>(hash));
+    TS_ASSERT_EQUALS(hash->count()->to_native(), 0);
+    TS_ASSERT_EQUALS(hash->index()->num_fields(), Hash::cMinSize);
+  }
+
+  void test_allocate() {
+    Class* sub = state->new_class("HashSub", G(hash), 0);
+    Hash* hsh = Hash::allocate(state, sub);
+
+    TS_ASSERT_EQUALS(hsh->klass(), sub);
+  }
+
+  void test_store_aref() {
+    Symbol* sym = state->symbol("blah");
+
+    hash->store(state, Fixnum::from(1), Fixnum::from(47));
+    hash->store(state, sym, Fixnum::from(48));
+    hash->store(state, Qnil, Fixnum::from(49));
+
+    TS_ASSERT_EQUALS(hash->count()->to_native(), 3);
+    TS_ASSERT_EQUALS(hash->aref(state, Fixnum::from(1)), Fixnum::from(47));
+    TS_ASSERT_EQUALS(hash->aref(state, sym), Fixnum::from(48));
+    TS_ASSERT_EQUALS(hash->aref(state, Qnil), Fixnum::from(49));
+  }
+
+  void test_store_overwrites_previous() {
+    hash->store(state, Fixnum::from(1), Fixnum::from(47));
+    hash->store(state, Fixnum::from(1), Fixnum::from(42));
+
+    TS_ASSERT_EQUALS(hash->count()->to_native(), 1);
+    TS_ASSERT_EQUALS(hash->used()->to_native(), 1);
+    TS_ASSERT_EQUALS(hash->aref(state, Fixnum::from(1)), Fixnum::from(42));
+  }
+
+  void test_string_keys_compare_by_contents() {
+    String* key = String::create(state, "blah");
+    hash->store(state, key, Fixnum::from(47));
+
+    Object* stored = hash->entries()->at(state, 1);
+    TS_ASSERT(stored != key);
+    TS_ASSERT(stored->IsFrozen);
+
+    String* other = String::create(state, "blah");
+    TS_ASSERT_EQUALS(hash->aref(state, other), Fixnum::from(47));
+  }
+
+  void test_frozen_string_keys_are_not_copied() {
+    String* key = String::create(state, "blah");
+    key->freeze();
+    hash->store(state, key, Fixnum::from(47));
+
+    TS_ASSERT_EQUALS(hash->entries()->at(state, 1), key);
+  }
+
+  void test_fails_for_other_keys() {
+    Object* key = state->new_object<Object>(G(object));
+
+    TS_ASSERT_EQUALS(hash->store(state, key, Qtrue), Primitives::failure());
+    TS_ASSERT_EQUALS(hash->aref(state, key), Primitives::failure());
+    TS_ASSERT_EQUALS(hash->find_entry(state, key), Primitives::failure());
+  }
+
+  void test_aref_fails_on_miss() {
+    TS_ASSERT_EQUALS(hash->aref(state, Fixnum::from(1)), Primitives::failure());
+    TS_ASSERT_EQUALS(hash->find_entry(state, Fixnum::from(1)), Qnil);
+  }
+
+  void test_colliding_keys() {
+    size_t size = Hash::cMinSize;
+
+    for(size_t i = 0; i < 8; i++) {
+      hash->store(state, Fixnum::from(i * size), Fixnum::from(i));
+    }
+
+    for(size_t i = 0; i < 8; i++) {
+      TS_ASSERT_EQUALS(hash->aref(state, Fixnum::from(i * size)), Fixnum::from(i));
+    }
+  }
+
+  void test_keeps_insertion_order() {
+    for(native_int i = 20; i > 0; i--) {
+      hash->store(state, Fixnum::from(i), Fixnum::from(i * 2));
+    }
+
+    TS_ASSERT(hash->index()->num_fields() > Hash::cMinSize);
+
+    Tuple* entries = hash->entries();
+    for(native_int i = 0; i < 20; i++) {
+      TS_ASSERT_EQUALS(entries->at(state, i * 3 + 1), Fixnum::from(20 - i));
+      TS_ASSERT_EQUALS(entries->at(state, i * 3 + 2), Fixnum::from((20 - i) * 2));
+    }
+  }
+
+  void test_remove() {
+    hash->store(state, Fixnum::from(1), Fixnum::from(47));
+    hash->store(state, Fixnum::from(2), Fixnum::from(48));
+
+    TS_ASSERT_EQUALS(hash->remove(state, Fixnum::from(1)), Fixnum::from(47));
+    TS_ASSERT_EQUALS(hash->count()->to_native(), 1);
+    TS_ASSERT_EQUALS(hash->aref(state, Fixnum::from(1)), Primitives::failure());
+    TS_ASSERT_EQUALS(hash->aref(state, Fixnum::from(2)), Fixnum::from(48));
+    TS_ASSERT_EQUALS(hash->remove(state, Fixnum::from(1)), Primitives::failure());
+  }
+
+  void test_deleted_entries_are_reused() {
+    size_t capacity = Hash::capacity(Hash::cMinSize);
+
+    for(size_t i = 0; i < capacity * 4; i++) {
+      hash->store(state, Fixnum::from(i), Fixnum::from(i));
+      hash->remove(state, Fixnum::from(i));
+    }
+
+    TS_ASSERT_EQUALS(hash->count()->to_native(), 0);
+    TS_ASSERT_EQUALS(hash->index()->num_fields(), Hash::cMinSize);
+  }
+
+  void test_insert() {
+    Object* key = state->new_object<Object>(G(object));
+    hash->insert(state, Fixnum::from(5), key, Fixnum::from(47));
+
+    TS_ASSERT_EQUALS(hash->count()->to_native(), 1);
+    TS_ASSERT_EQUALS(hash->entries()->at(state, 0), Fixnum::from(5));
+    TS_ASSERT_EQUALS(hash->entries()->at(state, 1), key);
+  }
+
+  void test_delete_entry() {
+    hash->store(state, Fixnum::from(1), Fixnum::from(47));
+
+    TS_ASSERT_EQUALS(hash->delete_entry(state, Fixnum::from(0)), Fixnum::from(47));
+    TS_ASSERT_EQUALS(hash->entries()->at(state, 0), Qnil);
+    TS_ASSERT_EQUALS(hash->count()->to_native(), 0);
+  }
+
+  void test_rehash() {
+    hash->store(state, Fixnum::from(1), Fixnum::from(47));
+    hash->store(state, Fixnum::from(2), Fixnum::from(48));
+    hash->remove(state, Fixnum::from(1));
+    hash->entries()->put(state, 3, Fixnum::from(0));
+
+    TS_ASSERT_EQUALS(hash->rehash(state), hash);
+    TS_ASSERT_EQUALS(hash->used()->to_native(), 1);
+    TS_ASSERT_EQUALS(hash->entries()->at(state, 0), Fixnum::from(2));
+    TS_ASSERT_EQUALS(hash->aref(state, Fixnum::from(2)), Fixnum::from(48));
+  }
+
+  void test_rehash_fails_for_other_keys() {
+    Object* key = state->new_object<Object>(G(object));
+    hash->insert(state, Fixnum::from(5), key, Fixnum::from(47));
+
+    TS_ASSERT_EQUALS(hash->rehash(state), Primitives::failure());
+  }
+
+  void test_clear() {
+    hash->store(state, Fixnum::from(1), Fixnum::from(47));
+    Tuple* entries = hash->entries();
+
+    hash->clear(state);
+    TS_ASSERT_EQUALS(hash->count()->to_native(), 0);
+    TS_ASSERT(hash->entries() != entries);
+  }
+};
@@ -67,15 +67,9 @@ class TestLookupTable : public CxxTest::TestSuite {
     tbl->store(state, k3, v3);
     TS_ASSERT_EQUALS(as<Integer>(tbl->entries())->to_native(), 3);
 
-    LookupTableBucket* entry = tbl->find_entry(state, k1);
-    TS_ASSERT(entry != Qnil);
-
-    TS_ASSERT(entry->next() != Qnil);
-    TS_ASSERT_EQUALS(entry->next()->key(), k2);
-
-    entry = tbl->find_entry(state, k3);
-    TS_ASSERT(entry != Qnil);
-    TS_ASSERT_EQUALS(entry->key(), k3);
+    TS_ASSERT_EQUALS(tbl->aref(state, k1), v1);
+    TS_ASSERT_EQUALS(tbl->aref(state, k2), v2);
+    TS_ASSERT_EQUALS(tbl->aref(state, k3), v3);
   }
 
   void test_store_resizes_table() {
@@ -113,17 +107,56 @@ class TestLookupTable : public CxxTest::TestSuite {
     TS_ASSERT((size_t)(tbl-> bins()->to_native()) > bins);
   }
 
-  void test_find_entry() {
+  void test_find_bin() {
     Object* k = Fixnum::from(47);
     tbl->store(state, k, Qtrue);
 
-    LookupTableBucket* entry = tbl->find_entry(state, k);
-    TS_ASSERT(entry != Qnil);
-    TS_ASSERT_EQUALS(entry->key(),k);
-    TS_ASSERT_EQUALS(entry->value(),Qtrue);
+    native_int bin = tbl->find_bin(state, k);
+    TS_ASSERT(bin >= 0);
+    TS_ASSERT_EQUALS(tbl->keys()->at(state, bin), k);
+    TS_ASSERT_EQUALS(tbl->values()->at(state, bin), Qtrue);
+
+    TS_ASSERT_EQUALS(tbl->find_bin(state, Fixnum::from(40)), -1);
+  }
+
+  void test_empty_bins_are_undef() {
+    tbl->store(state, Qnil, Qtrue);
+
+    size_t bins = tbl->bins()->to_native();
+    size_t empty = 0;
+    for(size_t i = 0; i < bins; i++) {
+      if(tbl->keys()->at(state, i) == Qundef) empty++;
+    }
 
-    entry = tbl->find_entry(state, Fixnum::from(40));
-    TS_ASSERT(entry == Qnil);
+    TS_ASSERT_EQUALS(empty, bins - 1);
+  }
+
+  void test_remove_keeps_probe_runs_intact() {
+    size_t bound = tbl->bins()->to_native() / 2;
+
+    for(size_t i = 0; i < bound; i++) {
+      tbl->store(state, Fixnum::from(i), Fixnum::from(i));
+    }
+
+    for(size_t i = 0; i < bound; i += 2) {
+      TS_ASSERT_EQUALS(tbl->remove(state, Fixnum::from(i)), Fixnum::from(i));
+    }
+
+    for(size_t i = 0; i < bound; i++) {
+      if(i % 2 == 0) {
+        TS_ASSERT_EQUALS(tbl->find_bin(state, Fixnum::from(i)), -1);
+      } else {
+        TS_ASSERT_EQUALS(tbl->aref(state, Fixnum::from(i)), Fixnum::from(i));
+      }
+    }
+  }
+
+  void test_next_entry() {
+    tbl->store(state, Fixnum::from(4), Qtrue);
+    native_int bin = tbl->find_bin(state, Fixnum::from(4));
+
+    TS_ASSERT_EQUALS(tbl->next_entry(state, Fixnum::from(0)), Fixnum::from(bin));
+    TS_ASSERT_EQUALS(tbl->next_entry(state, Fixnum::from(bin + 1)), Qnil);
   }
 
   void test_find() {
@@ -209,6 +242,9 @@ class TestLookupTable : public CxxTest::TestSuite {
     LookupTable* tbl2 = tbl->dup(state);
 
     TS_ASSERT_EQUALS(tbl2->aref(state, k1), Qtrue);
+
+    tbl2->store(state, k1, Qfalse);
+    TS_ASSERT_EQUALS(tbl->aref(state, k1), Qtrue);
   }
 
   void test_all_keys() {
@@ -232,6 +268,18 @@ class TestLookupTable : public CxxTest::TestSuite {
 
   }
 
+  void test_all_entries() {
+    Object* k1 = Fixnum::from(4);
+
+    tbl->store(state, k1, Qtrue);
+    Array* ary = tbl->all_entries(state);
+
+    TS_ASSERT_EQUALS(ary->total()->to_native(), 1);
+    Array* pair = as<Array>(ary->get(state, 0));
+    TS_ASSERT_EQUALS(pair->get(state, 0), k1);
+    TS_ASSERT_EQUALS(pair->get(state, 1), Qtrue);
+  }
+
   void test_fetch_returns_found() {
     TS_ASSERT_EQUALS(as<Integer>(tbl->entries())->to_native(), 0);
     tbl->store(state, Qnil, Fixnum::from(47));
@@ -0,0 +1,145 @@
+#include "vm.hpp"
+#include "vmmethod.hpp"
+#include "perf_map.hpp"
+#include "builtin/class.hpp"
+#include "builtin/compiledmethod.hpp"
+#include "builtin/iseq.hpp"
+#include "builtin/module.hpp"
+#include "builtin/staticscope.hpp"
+#include "builtin/symbol.hpp"
+#include "builtin/tuple.hpp"
+
+#include <cxxtest/TestSuite.h>
+
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+using namespace rubinius;
+
+class TestPerfMap : public CxxTest::TestSuite {
+public:
+
+  VM *state;
+  std::string path;
+
+  void setUp() {
+    state = new VM();
+
+    std::ostringstream name;
+    name << "/tmp/rbx-test-perf-" << getpid();
+    path = name.str();
+    unlink(path.c_str());
+  }
+
+  void tearDown() {
+    unlink(path.c_str());
+    delete state;
+  }
+
+  VMMethod* create_vmmethod() {
+    CompiledMethod* cm = CompiledMethod::create(state);
+    cm->literals(state, Tuple::create(state, 0));
+
+    InstructionSequence* iseq = InstructionSequence::create(state, 2);
+    iseq->opcodes()->put(state, 0, Fixnum::from(InstructionSequence::insn_push_nil));
+    iseq->opcodes()->put(state, 1, Fixnum::from(InstructionSequence::insn_ret));
+
+    cm->iseq(state, iseq);
+    cm->stack_size(state, Fixnum::from(1));
+    cm->local_count(state, Fixnum::from(0));
+    cm->total_args(state, Fixnum::from(0));
+    cm->required_args(state, Fixnum::from(0));
+    cm->splat(state, Qnil);
+
+    cm->name(state, state->symbol("blah"));
+    cm->file(state, state->symbol("foo.rb"));
+    cm->lines(state, Tuple::from(state, 1,
+          Tuple::from(state, 3, Fixnum::from(0), Fixnum::from(2), Fixnum::from(12))));
+
+    StaticScope* scope = StaticScope::create(state);
+    scope->module(state, G(object));
+    cm->scope(state, scope);
+
+    return cm->formalize(state, false);
+  }
+
+  void test_off_by_default() {
+    TS_ASSERT(!state->perf_map);
+  }
+
+  void test_create_unknown_format() {
+    TS_ASSERT(!PerfMap::create("oprofile"));
+  }
+
+  void test_method_name() {
+    VMMethod* vmm = create_vmmethod();
+    TS_ASSERT_EQUALS(PerfMap::method_name(state, vmm),
+                     std::string("Object#blah foo.rb:12"));
+  }
+
+  void test_map_file_is_well_formed() {
+    PerfMap* map = new PerfMap(PerfMap::cMap, path.c_str());
+    TS_ASSERT(map->open_p());
+
+    VMMethod* vmm = create_vmmethod();
+    map->record((void*)0x1000, 0x40, "rubinius::dynamic_interpreter");
+    map->record(state, vmm, (void*)0x2000, 0x123);
+    delete map;
+
+    std::ifstream file(path.c_str());
+    std::string line;
+    int lines = 0;
+
+    while(std::getline(file, line)) {
+      unsigned long start = 0, size = 0;
+      int name_at = 0;
+
+      // "<hex start> <hex size> <name>", one per line
+      TS_ASSERT_EQUALS(sscanf(line.c_str(), "%lx %lx %n", &start, &size, &name_at), 2);
+      TS_ASSERT(name_at > 0);
+      TS_ASSERT(line.size() > (size_t)name_at);
+      TS_ASSERT(start > 0);
+      TS_ASSERT(size > 0);
+
+      if(lines == 1) {
+        TS_ASSERT_EQUALS(start, 0x2000UL);
+        TS_ASSERT_EQUALS(size, 0x123UL);
+        TS_ASSERT_EQUALS(line.substr(name_at), "Object#blah foo.rb:12");
+      }
+
+      lines++;
+    }
+
+    TS_ASSERT_EQUALS(lines, 2);
+  }
+
+  void test_jitdump() {
+    PerfMap* map = new PerfMap(PerfMap::cJitDump, path.c_str());
+    TS_ASSERT(map->open_p());
+
+    uint8_t code[4] = { 0x90, 0x90, 0x90, 0xc3 };
+    map->record(code, sizeof(code), "nops");
+    delete map;
+
+    std::ifstream file(path.c_str(), std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+
+    // 40 byte header, then a 56 byte load record, the name and the code
+    TS_ASSERT_EQUALS(data.size(), 40U + 56U + 5U + 4U);
+
+    uint32_t magic, header_size, id, record_size;
+    memcpy(&magic, data.data(), 4);
+    memcpy(&header_size, data.data() + 8, 4);
+    memcpy(&id, data.data() + 40, 4);
+    memcpy(&record_size, data.data() + 44, 4);
+
+    TS_ASSERT_EQUALS(magic, 0x4A695444U);
+    TS_ASSERT_EQUALS(header_size, 40U);
+    TS_ASSERT_EQUALS(id, 0U);
+    TS_ASSERT_EQUALS(record_size, 56U + 5U + 4U);
+    TS_ASSERT_EQUALS(data.substr(40 + 56, 5), std::string("nops\0", 5));
+    TS_ASSERT_EQUALS((uint8_t)data[data.size() - 1], 0xc3);
+  }
+};
@@ -1,5 +1,6 @@
 #include "builtin/regexp.hpp"
 #include "vm.hpp"
+#include "region_pool.hpp"
 
 #include <cxxtest/TestSuite.h>
 
@@ -86,9 +87,9 @@ class TestRegexp : public CxxTest::TestSuite {
 
     MatchData* matches = (MatchData*)re->match_region(state, input, start, end, forward);
     TS_ASSERT(!matches->nil_p());
-    TS_ASSERT_EQUALS(matches->region()->num_fields(), 0U);
-    TS_ASSERT_EQUALS(as<Integer>(matches->full()->at(state, 0))->to_native(), 0);
-    TS_ASSERT_EQUALS(as<Integer>(matches->full()->at(state, 1))->to_native(), 1);
+    TS_ASSERT_EQUALS(matches->region()->num_fields(), 2U);
+    TS_ASSERT_EQUALS(as<Integer>(matches->region()->at(state, 0))->to_native(), 0);
+    TS_ASSERT_EQUALS(as<Integer>(matches->region()->at(state, 1))->to_native(), 1);
   }
 
   void test_match_region_without_matches() {
@@ -119,12 +120,12 @@ class TestRegexp : public CxxTest::TestSuite {
 
     MatchData* matches = (MatchData*)re->match_region(state, input, start, end, forward);
     TS_ASSERT(!matches->nil_p());
-    TS_ASSERT_EQUALS(as<Integer>(matches->full()->at(state, 0))->to_native(), 0);
-    TS_ASSERT_EQUALS(as<Integer>(matches->full()->at(state, 1))->to_native(), 2);
+    TS_ASSERT_EQUALS(as<Integer>(matches->region()->at(state, 0))->to_native(), 0);
+    TS_ASSERT_EQUALS(as<Integer>(matches->region()->at(state, 1))->to_native(), 2);
 
-    TS_ASSERT_EQUALS(matches->region()->num_fields(), 1U);
-    TS_ASSERT_EQUALS(as<Integer>(as<Tuple>(matches->region()->at(state, 0))->at(state, 0))->to_native(), 1);
-    TS_ASSERT_EQUALS(as<Integer>(as<Tuple>(matches->region()->at(state, 0))->at(state, 1))->to_native(), 2);
+    TS_ASSERT_EQUALS(matches->region()->num_fields(), 4U);
+    TS_ASSERT_EQUALS(as<Integer>(matches->region()->at(state, 2))->to_native(), 1);
+    TS_ASSERT_EQUALS(as<Integer>(matches->region()->at(state, 3))->to_native(), 2);
   }
 
   void test_match_region_with_backward_captures() {
@@ -140,12 +141,12 @@ class TestRegexp : public CxxTest::TestSuite {
 
     MatchData* matches = (MatchData*)re->match_region(state, input, start, end, forward);
     TS_ASSERT(!matches->nil_p());
-    TS_ASSERT_EQUALS(as<Integer>(matches->full()->at(state, 0))->to_native(), 1);
-    TS_ASSERT_EQUALS(as<Integer>(matches->full()->at(state, 1))->to_native(), 3);
+    TS_ASSERT_EQUALS(as<Integer>(matches->region()->at(state, 0))->to_native(), 1);
+    TS_ASSERT_EQUALS(as<Integer>(matches->region()->at(state, 1))->to_native(), 3);
 
-    TS_ASSERT_EQUALS(matches->region()->num_fields(), 1U);
-    TS_ASSERT_EQUALS(as<Integer>(as<Tuple>(matches->region()->at(state, 0))->at(state, 0))->to_native(), 2);
-    TS_ASSERT_EQUALS(as<Integer>(as<Tuple>(matches->region()->at(state, 0))->at(state, 1))->to_native(), 3);
+    TS_ASSERT_EQUALS(matches->region()->num_fields(), 4U);
+    TS_ASSERT_EQUALS(as<Integer>(matches->region()->at(state, 2))->to_native(), 2);
+    TS_ASSERT_EQUALS(as<Integer>(matches->region()->at(state, 3))->to_native(), 3);
   }
 
   void test_match_start() {
@@ -159,9 +160,85 @@ class TestRegexp : public CxxTest::TestSuite {
 
     MatchData* matches = (MatchData*)re->match_start(state, input, start);
     TS_ASSERT(!matches->nil_p());
-    TS_ASSERT_EQUALS(matches->region()->num_fields(), 0U);
-    TS_ASSERT_EQUALS(as<Integer>(matches->full()->at(state, 0))->to_native(), 1);
-    TS_ASSERT_EQUALS(as<Integer>(matches->full()->at(state, 1))->to_native(), 2);
+    TS_ASSERT_EQUALS(matches->region()->num_fields(), 2U);
+    TS_ASSERT_EQUALS(as<Integer>(matches->region()->at(state, 0))->to_native(), 1);
+    TS_ASSERT_EQUALS(as<Integer>(matches->region()->at(state, 1))->to_native(), 2);
+  }
+
+  void test_match_region_with_unmatched_group() {
+    String *pat = String::create(state, "a(x)?b");
+    Regexp* re = Regexp::create(state);
+    re->initialize(state, pat, Fixnum::from(0), Qnil);
+
+    String *input = String::create(state, "ab");
+
+    MatchData* matches = (MatchData*)re->match_region(state, input,
+        Fixnum::from(0), Fixnum::from(2), Qtrue);
+    TS_ASSERT(!matches->nil_p());
+    TS_ASSERT_EQUALS(matches->region()->num_fields(), 4U);
+    TS_ASSERT_EQUALS(as<Integer>(matches->region()->at(state, 2))->to_native(), -1);
+    TS_ASSERT_EQUALS(as<Integer>(matches->region()->at(state, 3))->to_native(), -1);
+  }
+
+  void test_match_region_reuses_regions() {
+    String *pat = String::create(state, ".(.)");
+    Regexp* re = Regexp::create(state);
+    re->initialize(state, pat, Fixnum::from(0), Qnil);
+
+    String *input = String::create(state, "abc");
+
+    re->match_region(state, input, Fixnum::from(0), Fixnum::from(3), Qtrue);
+    TS_ASSERT_EQUALS(state->regions->size(), 1U);
+
+    re->match_region(state, input, Fixnum::from(0), Fixnum::from(3), Qtrue);
+    re->match_start(state, input, Fixnum::from(1));
+    TS_ASSERT_EQUALS(state->regions->size(), 1U);
+  }
+
+  void test_search_from() {
+    String *pat = String::create(state, "c");
+    Regexp* re = Regexp::create(state);
+    re->initialize(state, pat, Fixnum::from(0), Qnil);
+
+    String *input = String::create(state, "abcabc");
+
+    TS_ASSERT_EQUALS(re->search_from(state, input, Fixnum::from(0)), Fixnum::from(2));
+    TS_ASSERT_EQUALS(re->search_from(state, input, Fixnum::from(3)), Fixnum::from(5));
+    TS_ASSERT_EQUALS(re->search_from(state, input, Fixnum::from(6)), Qnil);
+  }
+
+  void test_match_region_with_literal() {
+    String *pat = String::create(state, "Length: (\\d+)");
+    Regexp* re = Regexp::create(state);
+    re->initialize(state, pat, Fixnum::from(0), Qnil);
+
+    String *input = String::create(state, "Host: x\r\nLength: 42\r\n");
+    Object* forward = Qtrue;
+
+    MatchData* matches = (MatchData*)re->match_region(state, input,
+        Fixnum::from(0), Fixnum::from(21), forward);
+    TS_ASSERT(!matches->nil_p());
+    TS_ASSERT_EQUALS(as<Integer>(matches->region()->at(state, 0))->to_native(), 9);
+    TS_ASSERT_EQUALS(as<Integer>(matches->region()->at(state, 2))->to_native(), 17);
+
+    TS_ASSERT(re->match_region(state, input, Fixnum::from(10), Fixnum::from(21), forward)->nil_p());
+    TS_ASSERT(re->match_region(state, input, Fixnum::from(0), Fixnum::from(9), forward)->nil_p());
+  }
+
+  void test_match_region_with_literal_after_start() {
+    String *pat = String::create(state, "\\Gb");
+    Regexp* re = Regexp::create(state);
+    re->initialize(state, pat, Fixnum::from(0), Qnil);
+
+    String *input = String::create(state, "abab");
+    Object* forward = Qtrue;
+
+    TS_ASSERT(re->match_region(state, input, Fixnum::from(0), Fixnum::from(4), forward)->nil_p());
+
+    MatchData* matches = (MatchData*)re->match_region(state, input,
+        Fixnum::from(1), Fixnum::from(4), forward);
+    TS_ASSERT(!matches->nil_p());
+    TS_ASSERT_EQUALS(as<Integer>(matches->region()->at(state, 0))->to_native(), 1);
   }
 
 };
@@ -0,0 +1,62 @@
+#include "vm/sha1.hpp"
+
+#include <cxxtest/TestSuite.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+using namespace rubinius;
+
+class TestSHA1 : public CxxTest::TestSuite {
+public:
+
+  std::string hexdigest(const char* str) {
+    SHA1 sha;
+    sha.update(str, strlen(str));
+    return sha.hexdigest();
+  }
+
+  void test_empty() {
+    TS_ASSERT_EQUALS(hexdigest(""), "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+  }
+
+  void test_abc() {
+    TS_ASSERT_EQUALS(hexdigest("abc"), "a9993e364706816aba3e25717850c26c9cd0d89d");
+  }
+
+  void test_two_blocks() {
+    TS_ASSERT_EQUALS(hexdigest("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+                     "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+  }
+
+  void test_update_in_pieces() {
+    std::string str(1000000, 'a');
+    SHA1 sha;
+
+    for(size_t i = 0; i < str.size(); i += 7) {
+      sha.update(str.data() + i, std::min((size_t)7, str.size() - i));
+    }
+
+    TS_ASSERT_EQUALS(sha.hexdigest(), "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+  }
+
+  void test_file_hexdigest() {
+    std::ostringstream name;
+    name << "/tmp/rbx-test-sha1-" << getpid();
+    std::string path = name.str();
+
+    {
+      std::ofstream out(path.c_str());
+      out << "abc";
+    }
+
+    TS_ASSERT_EQUALS(SHA1::file_hexdigest(path.c_str()),
+                     "a9993e364706816aba3e25717850c26c9cd0d89d");
+    unlink(path.c_str());
+
+    TS_ASSERT_EQUALS(SHA1::file_hexdigest(path.c_str()), "");
+  }
+};
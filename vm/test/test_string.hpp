@@ -143,6 +143,20 @@ class TestString : public CxxTest::TestSuite {
     TS_ASSERT_EQUALS(str1->equal(state, str3), Qfalse);
   }
 
+  void test_equal_with_embedded_null() {
+    String* str1 = String::create(state, "ab\0cd", 5);
+    String* str2 = String::create(state, "ab\0xy", 5);
+
+    TS_ASSERT_EQUALS(str1->equal(state, str2), Qfalse);
+  }
+
+  void test_hash_string_is_a_fixnum() {
+    str = String::create(state, "a string long enough to take a few words");
+    str->hash_string(state);
+
+    TS_ASSERT(str->hash_value()->fixnum_p());
+  }
+
   void test_to_double() {
     str = String::create(state, "2.10");
     double val = 2.10;
@@ -524,17 +538,17 @@ class TestString : public CxxTest::TestSuite {
   void test_crypt() {
     String* str = String::create(state, "nutmeg");
     String* salt = String::create(state, "Mi");
-    TS_ASSERT_SAME_DATA(str->crypt(state, salt)->c_str(), "MiqkFWCm1fNJI", 14);
+    TS_ASSERT_SAME_DATA(str->crypt(state, salt)->c_str(state), "MiqkFWCm1fNJI", 14);
   }
 
   void test_c_str() {
     String* str = String::create(state, "blah");
     TS_ASSERT(str->data()->size() > 4);
     TS_ASSERT_EQUALS(str->byte_address()[4], 0);
-    TS_ASSERT_EQUALS(str->c_str()[4], 0);
+    TS_ASSERT_EQUALS(str->c_str(state)[4], 0);
     str->byte_address()[4] = '!';
 
-    TS_ASSERT_EQUALS(str->c_str()[4], 0);
+    TS_ASSERT_EQUALS(str->c_str(state)[4], 0);
 
   }
 
@@ -543,6 +557,92 @@ class TestString : public CxxTest::TestSuite {
     Integer* six = Integer::from(state, 6);
     String* s = String::from_bytearray(state, ba, six, six);
     TS_ASSERT_EQUALS(six, s->num_bytes());
-    TS_ASSERT_SAME_DATA("l to r", s->c_str(), 6);
+    TS_ASSERT_SAME_DATA("l to r", s->c_str(state), 6);
+  }
+
+  String* long_string() {
+    return String::create(state,
+        "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"
+        "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ");
+  }
+
+  void test_substring_short_copies() {
+    String* str = long_string();
+    String* sub = str->substring(state, Fixnum::from(10), Fixnum::from(5));
+
+    TS_ASSERT_EQUALS(std::string(sub->byte_address(), sub->size()), "abcde");
+    TS_ASSERT(!sub->window_p());
+    TS_ASSERT_DIFFERS(sub->data(), str->data());
+    TS_ASSERT_EQUALS(str->shared(), Qfalse);
+  }
+
+  void test_substring_shares_parent() {
+    String* str = long_string();
+    native_int cnt = String::cMinSharedBytes;
+    String* sub = str->substring(state, Fixnum::from(10), Fixnum::from(cnt));
+
+    TS_ASSERT(sub->window_p());
+    TS_ASSERT_EQUALS(sub->data(), str->data());
+    TS_ASSERT_EQUALS(sub->byte_offset(), 10);
+    TS_ASSERT_EQUALS(sub->size(), (size_t)cnt);
+    TS_ASSERT_EQUALS(sub->byte_address()[0], 'a');
+    TS_ASSERT_EQUALS(sub->shared(), Qtrue);
+    TS_ASSERT_EQUALS(str->shared(), Qtrue);
+  }
+
+  void test_substring_negative_start() {
+    String* str = long_string();
+    String* sub = str->substring(state, Fixnum::from(-3), Fixnum::from(10));
+
+    TS_ASSERT_EQUALS(std::string(sub->byte_address(), sub->size()), "XYZ");
+  }
+
+  void test_substring_out_of_range() {
+    String* str = long_string();
+
+    TS_ASSERT(str->substring(state, Fixnum::from(0), Fixnum::from(-1))->nil_p());
+    TS_ASSERT(str->substring(state, Fixnum::from(200), Fixnum::from(1))->nil_p());
+    TS_ASSERT(str->substring(state, Fixnum::from(-200), Fixnum::from(1))->nil_p());
+  }
+
+  void test_substring_of_substring() {
+    String* str = long_string();
+    String* sub = str->substring(state, Fixnum::from(10), Fixnum::from(100));
+    String* sub2 = sub->substring(state, Fixnum::from(26), Fixnum::from(70));
+
+    TS_ASSERT_EQUALS(sub2->data(), str->data());
+    TS_ASSERT_EQUALS(sub2->byte_offset(), 36);
+    TS_ASSERT_EQUALS(sub2->byte_address()[0], 'A');
+  }
+
+  void test_substring_c_str_leaves_parent_alone() {
+    String* str = long_string();
+    String* sub = str->substring(state, Fixnum::from(0), Fixnum::from(70));
+
+    TS_ASSERT_EQUALS(std::string(sub->c_str(state)), std::string(str->byte_address(), 70));
+    TS_ASSERT(!sub->window_p());
+    TS_ASSERT_EQUALS(str->byte_address()[70], '8');
+  }
+
+  void test_substring_append_leaves_parent_alone() {
+    String* str = long_string();
+    String* sub = str->substring(state, Fixnum::from(0), Fixnum::from(70));
+
+    sub->append(state, "!");
+    TS_ASSERT_EQUALS(sub->byte_address()[70], '!');
+    TS_ASSERT_EQUALS(str->byte_address()[70], '8');
+    TS_ASSERT_EQUALS(sub->size(), 71U);
+  }
+
+  void test_substring_data_ivar_materializes() {
+    String* str = long_string();
+    String* sub = str->substring(state, Fixnum::from(10), Fixnum::from(70));
+
+    ByteArray* ba = as<ByteArray>(sub->get_ivar(state, state->symbol("@data")));
+
+    TS_ASSERT(!sub->window_p());
+    TS_ASSERT_DIFFERS(ba, str->data());
+    TS_ASSERT_EQUALS(ba->bytes[0], 'a');
+    TS_ASSERT_EQUALS(ba->bytes[70], 0);
   }
 };
@@ -22,6 +22,7 @@ class TestSymbolTable : public CxxTest::TestSuite {
   }
 
   void tearDown() {
+    delete symbols;
     delete state;
   }
 
@@ -65,9 +66,6 @@ class TestSymbolTable : public CxxTest::TestSuite {
     const char* str = "__uint_fast64_t";
     const char* str2 = "TkIF_MOD";
 
-    TS_ASSERT_EQUALS(String::hash_str((unsigned char*)str, std::strlen(str)),
-                     String::hash_str((unsigned char*)str2, std::strlen(str2)));
-
     sym  = symbols->lookup(state, str);
     sym2 = symbols->lookup(state, str2);
 
@@ -78,8 +76,6 @@ class TestSymbolTable : public CxxTest::TestSuite {
     String* a = String::create(state, "__uint_fast64_t");
     String* b = String::create(state, "TkIF_MOD");
 
-    TS_ASSERT_EQUALS(a->hash_string(state), b->hash_string(state));
-
     Object* sym;
     Object* sym2;
 
@@ -89,11 +85,78 @@ class TestSymbolTable : public CxxTest::TestSuite {
     TS_ASSERT(sym != sym2);
   }
 
+  void test_lookup_with_length() {
+    Symbol* sym = symbols->lookup(state, "unique");
+    Symbol* sym2 = symbols->lookup(state, "uniquely", 6);
+
+    TS_ASSERT_EQUALS(sym, sym2);
+    TS_ASSERT_DIFFERS(sym, symbols->lookup(state, "uniquely", 7));
+  }
+
+  void test_lookup_with_string_object() {
+    String* str = String::create(state, "unique");
+
+    TS_ASSERT_EQUALS(symbols->lookup(state, str), symbols->lookup(state, "unique"));
+  }
+
+  void test_lookup_cstring_is_stable() {
+    Symbol* sym = symbols->lookup(state, "circle");
+    const char* cstr = symbols->lookup_cstring(state, sym);
+
+    for(size_t i = 0; i < 10000; i++) {
+      std::stringstream stream;
+      stream << "sym" << i;
+      symbols->lookup(state, stream.str().c_str());
+    }
+
+    TS_ASSERT_EQUALS(cstr, symbols->lookup_cstring(state, sym));
+    TS_ASSERT_EQUALS(std::string(cstr), "circle");
+  }
+
+  void test_lookup_after_grow() {
+    std::vector<Symbol*> syms;
+
+    for(size_t i = 0; i < 5000; i++) {
+      std::stringstream stream;
+      stream << "sym" << i;
+      syms.push_back(symbols->lookup(state, stream.str()));
+    }
+
+    for(size_t i = 0; i < 5000; i++) {
+      std::stringstream stream;
+      stream << "sym" << i;
+      TS_ASSERT_EQUALS(syms[i], symbols->lookup(state, stream.str()));
+    }
+
+    TS_ASSERT_EQUALS(symbols->size(), 5000U);
+  }
+
+  void test_lookup_long_string() {
+    std::string str(SymbolTable::cArenaChunkSize + 10, 'a');
+
+    Symbol* sym = symbols->lookup(state, str);
+    TS_ASSERT_EQUALS(sym, symbols->lookup(state, str));
+    TS_ASSERT_EQUALS(std::string(symbols->lookup_cstring(state, sym)), str);
+  }
+
+  void test_kind() {
+    TS_ASSERT_EQUALS(symbols->kind(state, symbols->lookup(state, "Foo")),
+                     SymbolTable::Constant);
+    TS_ASSERT_EQUALS(symbols->kind(state, symbols->lookup(state, "@foo")),
+                     SymbolTable::IVar);
+    TS_ASSERT_EQUALS(symbols->kind(state, symbols->lookup(state, "@@foo")),
+                     SymbolTable::CVar);
+    TS_ASSERT_EQUALS(symbols->kind(state, symbols->lookup(state, "__foo")),
+                     SymbolTable::System);
+    TS_ASSERT_EQUALS(symbols->kind(state, symbols->lookup(state, "foo")),
+                     SymbolTable::Normal);
+  }
+
   void test_lookup_string() {
     Symbol* sym = symbols->lookup(state, "circle");
     String* str = symbols->lookup_string(state, sym);
 
-    TS_ASSERT(!strncmp("circle", str->c_str(), 6));
+    TS_ASSERT(!strncmp("circle", str->c_str(state), 6));
   }
 
   void test_lookup_nil() {
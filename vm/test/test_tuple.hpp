@@ -188,4 +188,77 @@ public:
       TS_ASSERT_EQUALS(ten, tuple->at(state, i));
     }
   }
+
+  void test_copy_from_overlapping() {
+    Tuple* tuple = Tuple::create(state, 4);
+    tuple->put(state, 0, Fixnum::from(1));
+    tuple->put(state, 1, Fixnum::from(4));
+    tuple->put(state, 2, Fixnum::from(9));
+
+    tuple->copy_from(state, tuple, Fixnum::from(0), Fixnum::from(3), Fixnum::from(1));
+
+    TS_ASSERT_EQUALS(Fixnum::from(1), tuple->at(state, 1));
+    TS_ASSERT_EQUALS(Fixnum::from(4), tuple->at(state, 2));
+    TS_ASSERT_EQUALS(Fixnum::from(9), tuple->at(state, 3));
+
+    tuple->copy_from(state, tuple, Fixnum::from(1), Fixnum::from(3), Fixnum::from(0));
+
+    TS_ASSERT_EQUALS(Fixnum::from(1), tuple->at(state, 0));
+    TS_ASSERT_EQUALS(Fixnum::from(4), tuple->at(state, 1));
+    TS_ASSERT_EQUALS(Fixnum::from(9), tuple->at(state, 2));
+  }
+
+  void test_copy_from_remembers_mature_tuple_once() {
+    Tuple* tuple = Tuple::create(state, 3);
+    for(size_t i = 0; i < 3; i++) {
+      tuple->put(state, i, Tuple::create(state, 1));
+    }
+
+    Tuple* dest = Tuple::create(state, 3);
+    dest->zone = MatureObjectZone;
+    size_t remembered = state->om->remember_set->size();
+
+    dest->copy_from(state, tuple, Fixnum::from(0), Fixnum::from(3), Fixnum::from(0));
+
+    TS_ASSERT_EQUALS(dest->Remember, 1U);
+    TS_ASSERT_EQUALS(state->om->remember_set->size(), remembered + 1);
+  }
+
+  void test_copy_from_immediates_doesnt_remember() {
+    Tuple* dest = Tuple::create(state, 3);
+    dest->zone = MatureObjectZone;
+
+    dest->copy_from(state, new_tuple(), Fixnum::from(0), Fixnum::from(3), Fixnum::from(0));
+    TS_ASSERT_EQUALS(dest->Remember, 0U);
+  }
+
+  void test_fill() {
+    Tuple* tuple = new_tuple();
+
+    TS_ASSERT_EQUALS(tuple->fill(state, Fixnum::from(1), Fixnum::from(2), Qnil), tuple);
+    TS_ASSERT_EQUALS(Fixnum::from(1), tuple->at(state, 0));
+    TS_ASSERT_EQUALS(Qnil, tuple->at(state, 1));
+    TS_ASSERT_EQUALS(Qnil, tuple->at(state, 2));
+  }
+
+  void test_fill_bounds() {
+    Tuple* tuple = new_tuple();
+
+    TS_ASSERT_THROWS_ASSERT(tuple->fill(state, Fixnum::from(2), Fixnum::from(2), Qnil),
+			    const RubyException &e,
+			    TS_ASSERT(Exception::object_bounds_exceeded_error_p(state, e.exception)));
+    TS_ASSERT_THROWS_ASSERT(tuple->fill(state, Fixnum::from(-1), Fixnum::from(1), Qnil),
+			    const RubyException &e,
+			    TS_ASSERT(Exception::object_bounds_exceeded_error_p(state, e.exception)));
+  }
+
+  void test_concat() {
+    Tuple* tuple = new_tuple();
+    Tuple* other = Tuple::from(state, 1, Qtrue);
+
+    Tuple* tup = tuple->concat(state, other);
+    TS_ASSERT_EQUALS(4U, tup->num_fields());
+    TS_ASSERT_EQUALS(Fixnum::from(9), tup->at(state, 2));
+    TS_ASSERT_EQUALS(Qtrue, tup->at(state, 3));
+  }
 };
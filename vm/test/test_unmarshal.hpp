@@ -140,7 +140,7 @@ public:
 
     Float* flt = as<Float>(obj);
 
-    TS_ASSERT_EQUALS(flt->val, 1.0 / 6.0);
+    TS_ASSERT_EQUALS(flt->val(), 1.0 / 6.0);
 
     mar->sstream.str(
         std::string("d\n +0.999999999999999888977697537484345957636833190917968750  1024\n"));
@@ -150,7 +150,7 @@ public:
 
     flt = as<Float>(obj);
 
-    TS_ASSERT_EQUALS(flt->val, DBL_MAX);
+    TS_ASSERT_EQUALS(flt->val(), DBL_MAX);
   }
 
   void test_float_infinity() {
@@ -162,7 +162,7 @@ public:
 
     Float* flt = as<Float>(obj);
 
-    TS_ASSERT(std::isinf(flt->val));
+    TS_ASSERT(std::isinf(flt->val()));
   }
 
   void test_float_neg_infinity() {
@@ -174,8 +174,8 @@ public:
 
     Float* flt = as<Float>(obj);
 
-    TS_ASSERT(std::isinf(flt->val));
-    TS_ASSERT(flt->val < 0.0);
+    TS_ASSERT(std::isinf(flt->val()));
+    TS_ASSERT(flt->val() < 0.0);
   }
 
   void test_float_nan() {
@@ -187,7 +187,7 @@ public:
 
     Float* flt = as<Float>(obj);
 
-    TS_ASSERT(std::isnan(flt->val));
+    TS_ASSERT(std::isnan(flt->val()));
   }
 
   void test_iseq() {
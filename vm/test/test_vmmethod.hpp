@@ -1,5 +1,11 @@
 
 #include "vmmethod.hpp"
+#include "background_compiler.hpp"
+#include "vm/config.h"
+#include "builtin/contexts.hpp"
+#include "builtin/iseq.hpp"
+#include "builtin/machine_method.hpp"
+#include "builtin/symbol.hpp"
 
 #include <cxxtest/TestSuite.h>
 
@@ -103,6 +109,29 @@ public:
     TS_ASSERT_EQUALS(vmm.opcodes[1], 0U);
   }
 
+  void test_mapped_opcodes_are_shared_until_written() {
+    CompiledMethod* cm = CompiledMethod::create(state);
+    cm->literals(state, Tuple::create(state, 0));
+
+    InstructionSequence* iseq = InstructionSequence::create(state, 2);
+    iseq->opcodes()->put(state, 0, Fixnum::from(InstructionSequence::insn_push_nil));
+    iseq->opcodes()->put(state, 1, Fixnum::from(InstructionSequence::insn_ret));
+
+    uint32_t ops[2] = { InstructionSequence::insn_push_nil, InstructionSequence::insn_ret };
+    iseq->set_mapped_opcodes(ops);
+
+    cm->iseq(state, iseq);
+
+    VMMethod vmm(state, cm);
+    TS_ASSERT_EQUALS(vmm.opcodes, ops);
+
+    vmm.set_breakpoint_flags(state, 0, 1 << 24);
+    TS_ASSERT_DIFFERS(vmm.opcodes, ops);
+    TS_ASSERT_EQUALS(vmm.opcodes[0], (1U << 24) | static_cast<unsigned int>(InstructionSequence::insn_push_nil));
+    TS_ASSERT_EQUALS(vmm.opcodes[1], static_cast<unsigned int>(InstructionSequence::insn_ret));
+    TS_ASSERT_EQUALS(ops[0], static_cast<unsigned int>(InstructionSequence::insn_push_nil));
+  }
+
   void test_get_breakpoint_flags() {
     CompiledMethod* cm = CompiledMethod::create(state);
     Tuple* tup = Tuple::from(state, 1, state->symbol("@blah"));
@@ -121,4 +150,173 @@ public:
     TS_ASSERT_EQUALS(vmm.get_breakpoint_flags(state, 2), (4U << 24));
     TS_ASSERT_EQUALS(vmm.get_breakpoint_flags(state, 1), 0U);
   }
+
+  // push_nil; pop; goto 0
+  CompiledMethod* create_loop() {
+    CompiledMethod* cm = CompiledMethod::create(state);
+    cm->literals(state, Tuple::create(state, 0));
+
+    InstructionSequence* iseq = InstructionSequence::create(state, 4);
+    iseq->opcodes()->put(state, 0, Fixnum::from(InstructionSequence::insn_push_nil));
+    iseq->opcodes()->put(state, 1, Fixnum::from(InstructionSequence::insn_pop));
+    iseq->opcodes()->put(state, 2, Fixnum::from(InstructionSequence::insn_goto));
+    iseq->opcodes()->put(state, 3, Fixnum::from(0));
+
+    cm->iseq(state, iseq);
+    cm->stack_size(state, Fixnum::from(1));
+    cm->local_count(state, Fixnum::from(0));
+    cm->total_args(state, Fixnum::from(0));
+    cm->required_args(state, Fixnum::from(0));
+    cm->splat(state, Qnil);
+    cm->formalize(state, false);
+
+    return cm;
+  }
+
+  void test_backedge_queues_method_for_jit() {
+#ifndef USE_USAGE_JIT
+    TS_WARN("usage based JIT is not built on this platform");
+    return;
+#endif
+    state->config.jit_enabled = true;
+    CompiledMethod* cm = create_loop();
+    VMMethod* vmm = cm->backend_method_;
+    MethodContext* ctx = MethodContext::create(state, Qnil, cm);
+
+    for(int i = 0; i < 999; i++) {
+      TS_ASSERT(!vmm->backedge(state, ctx));
+    }
+    TS_ASSERT_EQUALS(vmm->call_count, 0);
+    TS_ASSERT(!state->background_compiler);
+
+    TS_ASSERT(!vmm->backedge(state, ctx));
+    TS_ASSERT_EQUALS(vmm->call_count, -1);
+    TS_ASSERT(state->background_compiler);
+  }
+
+  void test_backedge_replaces_context_on_stack() {
+#ifndef USE_USAGE_JIT
+    TS_WARN("usage based JIT is not built on this platform");
+    return;
+#endif
+    state->config.jit_enabled = true;
+    CompiledMethod* cm = create_loop();
+    VMMethod* vmm = cm->backend_method_;
+    MethodContext* ctx = MethodContext::create(state, Qnil, cm);
+
+    state->compile_in_background(vmm);
+    state->background_compiler->wait_until_idle();
+
+    // Back at the loop header
+    ctx->ip = 0;
+    TS_ASSERT(vmm->backedge(state, ctx));
+
+    MachineMethod* mm = vmm->machine_method();
+    TS_ASSERT(mm);
+    TS_ASSERT_EQUALS(ctx->run, reinterpret_cast<Runner>(mm->function()));
+    TS_ASSERT_EQUALS(ctx->native_ip, mm->resolve_virtual_ip(0));
+    TS_ASSERT(ctx->native_ip);
+  }
+
+  void test_backedge_ignores_disabled_jit() {
+#ifndef USE_USAGE_JIT
+    TS_WARN("usage based JIT is not built on this platform");
+    return;
+#endif
+    CompiledMethod* cm = create_loop();
+    VMMethod* vmm = cm->backend_method_;
+    MethodContext* ctx = MethodContext::create(state, Qnil, cm);
+
+    for(int i = 0; i < 2000; i++) {
+      TS_ASSERT(!vmm->backedge(state, ctx));
+    }
+    TS_ASSERT(!state->background_compiler);
+  }
+
+  // meta_push_1; meta_push_1; meta_send_op_plus; ret
+  CompiledMethod* create_addition() {
+    CompiledMethod* cm = CompiledMethod::create(state);
+    cm->literals(state, Tuple::create(state, 0));
+
+    InstructionSequence* iseq = InstructionSequence::create(state, 4);
+    iseq->opcodes()->put(state, 0, Fixnum::from(InstructionSequence::insn_meta_push_1));
+    iseq->opcodes()->put(state, 1, Fixnum::from(InstructionSequence::insn_meta_push_1));
+    iseq->opcodes()->put(state, 2, Fixnum::from(InstructionSequence::insn_meta_send_op_plus));
+    iseq->opcodes()->put(state, 3, Fixnum::from(InstructionSequence::insn_ret));
+
+    cm->iseq(state, iseq);
+    cm->stack_size(state, Fixnum::from(2));
+    cm->local_count(state, Fixnum::from(0));
+    cm->total_args(state, Fixnum::from(0));
+    cm->required_args(state, Fixnum::from(0));
+    cm->splat(state, Qnil);
+    cm->formalize(state, false);
+
+    return cm;
+  }
+
+  void test_jit_guards_fixnum_math() {
+#ifndef USE_USAGE_JIT
+    TS_WARN("usage based JIT is not built on this platform");
+    return;
+#endif
+    CompiledMethod* cm = create_addition();
+    VMMethod* vmm = cm->backend_method_;
+
+    state->compile_in_background(vmm);
+    state->background_compiler->wait_until_idle();
+    state->install_compiled_code();
+
+    MachineMethod* mm = vmm->machine_method();
+    TS_ASSERT(mm);
+    TS_ASSERT(mm->deopt_point(2));
+    TS_ASSERT(!mm->deopt_point(0));
+  }
+
+  void test_deoptimize() {
+#ifndef USE_USAGE_JIT
+    TS_WARN("usage based JIT is not built on this platform");
+    return;
+#endif
+    state->config.jit_enabled = true;
+    CompiledMethod* cm = create_addition();
+    VMMethod* vmm = cm->backend_method_;
+    Runner interpreter = vmm->run;
+
+    state->compile_in_background(vmm);
+    state->background_compiler->wait_until_idle();
+    state->install_compiled_code();
+
+    MachineMethod* mm = vmm->machine_method();
+    TS_ASSERT(mm);
+
+    MethodContext* ctx = MethodContext::create(state, Qnil, cm);
+    ctx->run = vmm->run;
+    ctx->native_ip = mm->deopt_point(2);
+
+    MethodContext* other = MethodContext::create(state, Qnil, cm);
+    other->run = vmm->run;
+
+    vmm->deoptimize(state, ctx, 2);
+
+    TS_ASSERT_EQUALS(ctx->ip, 2);
+    TS_ASSERT(!ctx->native_ip);
+    TS_ASSERT_EQUALS(ctx->run, interpreter);
+    TS_ASSERT_EQUALS(vmm->run, interpreter);
+    TS_ASSERT_EQUALS(vmm->deoptimizations, 1);
+    TS_ASSERT_EQUALS(vmm->call_count, 0);
+
+    // Another context running the old code only moves itself over.
+    vmm->deoptimize(state, other, 2);
+    TS_ASSERT_EQUALS(other->run, interpreter);
+    TS_ASSERT_EQUALS(vmm->deoptimizations, 1);
+
+    // The recompiled code sends + rather than guarding.
+    state->compile_in_background(vmm);
+    state->background_compiler->wait_until_idle();
+    state->install_compiled_code();
+
+    TS_ASSERT(vmm->machine_method() != mm);
+    TS_ASSERT(!vmm->machine_method()->deopt_point(2));
+  }
 };
@@ -2,6 +2,11 @@
 #include "objectmemory.hpp"
 #include "event.hpp"
 #include "global_cache.hpp"
+#include "background_compiler.hpp"
+#include "code_cache.hpp"
+#include "compiled_file.hpp"
+#include "perf_map.hpp"
+#include "region_pool.hpp"
 #include "llvm.hpp"
 
 #include "vm/object_utils.hpp"
@@ -31,7 +36,11 @@
 
 namespace rubinius {
   VM::VM(size_t bytes, bool boot)
-    : current_mark(NULL)
+    : background_compiler(NULL)
+    , code_cache(new CodeCache())
+    , perf_map(NULL)
+    , regions(new RegionPool())
+    , current_mark(NULL)
     , reuse_llvm(true)
     , use_safe_position(false)
   {
@@ -50,8 +59,21 @@ namespace rubinius {
   }
 
   VM::~VM() {
+    // Stop the compiler thread before anything it might look at goes away
+    delete background_compiler;
     delete user_config;
     delete om;
+    // After om, since collecting MachineMethods retires their code
+    delete code_cache;
+    delete perf_map;
+    delete regions;
+
+    // After om, since VMMethods may be running opcodes out of these
+    for(std::list<MappedFile*>::iterator i = mapped_files.begin();
+        i != mapped_files.end(); i++) {
+      delete *i;
+    }
+
     delete signal_events;
     delete global_cache;
 #ifdef ENABLE_LLVM
@@ -64,6 +86,12 @@ namespace rubinius {
     if(user_config->find("rbx.jit")) {
       config.jit_enabled = true;
     }
+
+    if(ConfigParser::Entry* ent = user_config->find("rbx.jit.code_cache_size")) {
+      if(ent->is_number()) {
+        code_cache->set_limit(strtoul(ent->value.c_str(), NULL, 10));
+      }
+    }
 #endif
 
 #ifdef USE_DYNAMIC_INTERPRETER
@@ -72,6 +100,14 @@ namespace rubinius {
     }
 #endif
 
+    if(ConfigParser::Entry* ent = user_config->find("rbx.jit.perf")) {
+      perf_map = PerfMap::create(ent->value);
+      if(!perf_map) {
+        std::cout << "Unable to write perf symbols for rbx.jit.perf=" <<
+          ent->value << "\n";
+      }
+    }
+
     MethodContext::initialize_cache(this);
     TypeInfo::auto_learn_fields(this);
 
@@ -198,7 +234,7 @@ namespace rubinius {
   void VM::run_gc_soon() {
     om->collect_young_now = true;
     om->collect_mature_now = true;
-    interrupts.check = true;
+    interrupts.set_perform_gc();
   }
 
   void VM::collect() {
@@ -211,6 +247,8 @@ namespace rubinius {
   }
 
   void VM::collect_maybe() {
+    interrupts.perform_gc = false;
+
     if(om->collect_young_now) {
       om->collect_young_now = false;
 
@@ -274,8 +312,27 @@ namespace rubinius {
   }
 
   void VM::check_events() {
-    interrupts.check = true;
-    interrupts.check_events = true;
+    interrupts.set_check_events();
+  }
+
+  void VM::wakeup() {
+    interrupts.set_check_events();
+    events->wakeup();
+  }
+
+  void VM::compile_in_background(VMMethod* vmm) {
+    if(!background_compiler) {
+      background_compiler = new BackgroundCompiler(this);
+    }
+
+    background_compiler->enqueue(vmm);
+  }
+
+  void VM::install_compiled_code() {
+    interrupts.install_code = false;
+    if(background_compiler) {
+      background_compiler->install_finished(this);
+    }
   }
 
   bool VM::run_best_thread() {
@@ -288,7 +345,7 @@ namespace rubinius {
         throw DeadLock("no runnable threads, present or future.");
       }
 
-      interrupts.check_events = true;
+      interrupts.set_check_events();
       return false;
     }
     return true;
@@ -428,14 +485,17 @@ namespace rubinius {
     for(;;) {
       if(interrupts.check_events) {
         interrupts.check_events = false;
+        interrupts.reschedule = false;
         interrupts.enable_preempt = false;
 
         Thread* current = G(current_thread);
         // The current thread isn't asleep, so we're being preemptive
         if(current->alive() == Qtrue && current->sleep() != Qtrue) {
           // Order is important here. We poll so any threads
-          // might get woken up if they need to be.
-          events->poll();
+          // might get woken up if they need to be. A plain
+          // preemption tick leaves woken() false, so the poll
+          // only happens when a timer, fd or signal is ready.
+          if(events->woken()) events->poll();
 
           // Only then do we reschedule the current thread if
           // we need to. queue_thread() puts the thread at the end
@@ -451,6 +511,8 @@ namespace rubinius {
         interrupts.enable_preempt = interrupts.use_preempt;
       }
 
+      if(interrupts.install_code) install_compiled_code();
+
       collect_maybe();
       G(current_task)->execute();
     }
@@ -470,7 +532,10 @@ namespace rubinius {
     }
   }
 
-  // Runs forever, telling the VM to reschedule threads ever 10 milliseconds
+  // Runs forever, telling the VM to reschedule threads every 10 milliseconds.
+  // The interpreter only sees this through interrupts.check, so it pays
+  // nothing for preemption between ticks. Ready timers and fds also raise
+  // wakeup() here, so the VM polls the event loop only when it must.
   void VM::scheduler_loop() {
     // First off, we don't want this thread ever receiving a signal.
     sigset_t mask;
@@ -488,8 +553,8 @@ namespace rubinius {
     for(;;) {
       nanosleep(&requested, &actual);
       if(interrupts.enable_preempt) {
-        interrupts.reschedule = true;
-        interrupts.check_events = true;
+        if(events->ready_p()) wakeup();
+        interrupts.set_reschedule();
       }
     }
   }
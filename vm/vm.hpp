@@ -7,6 +7,7 @@
 
 #include <pthread.h>
 #include <setjmp.h>
+#include <list>
 
 namespace llvm {
   class Module;
@@ -21,6 +22,12 @@ namespace rubinius {
   }
 
   class GlobalCache;
+  class BackgroundCompiler;
+  class CodeCache;
+  class PerfMap;
+  class RegionPool;
+  class MappedFile;
+  class VMMethod;
   class TaskProbe;
   class Primitives;
   class ObjectMemory;
@@ -39,14 +46,22 @@ namespace rubinius {
     bool dynamic_interpreter_enabled;
   };
 
+  /**
+   *  Pending work for the interpreter. +check+ is the only word tested on
+   *  the hot path (at back-edges and sends); the other members record why
+   *  it was raised. They are written from the preemption thread and from
+   *  the allocator, so always go through the set_* helpers, which raise
+   *  the reason before raising +check+.
+   */
   struct Interrupts {
-    bool check;
-    bool switch_task;
-    bool perform_gc;
-    bool check_events;
-    bool reschedule;
+    volatile bool check;
+    volatile bool switch_task;
+    volatile bool perform_gc;
+    volatile bool check_events;
+    volatile bool reschedule;
+    volatile bool install_code;
     bool use_preempt;
-    bool enable_preempt;
+    volatile bool enable_preempt;
 
     Interrupts() :
       check(false),
@@ -54,9 +69,32 @@ namespace rubinius {
       perform_gc(false),
       check_events(false),
       reschedule(false),
+      install_code(false),
       use_preempt(false),
       enable_preempt(false)
     { }
+
+    void set_perform_gc() {
+      perform_gc = true;
+      check = true;
+    }
+
+    void set_check_events() {
+      check_events = true;
+      check = true;
+    }
+
+    void set_reschedule() {
+      reschedule = true;
+      check_events = true;
+      check = true;
+    }
+
+    // Raised by the BackgroundCompiler thread when machine code is ready.
+    void set_install_code() {
+      install_code = true;
+      check = true;
+    }
   };
 
   struct Stats {
@@ -66,12 +104,17 @@ namespace rubinius {
     // How many methods have been compiled by the JIT
     uint64_t jitted_methods;
 
+    // Total time between queueing methods for the JIT and installing
+    // their machine code
+    uint64_t jit_install_latency;
+
     // How much time is spent in the GC
     uint64_t time_in_gc;
 
     Stats()
       : jit_timing(0)
       , jitted_methods(0)
+      , jit_install_latency(0)
       , time_in_gc(0)
     {}
   };
@@ -93,6 +136,21 @@ namespace rubinius {
 
     Stats stats;
 
+    // Created the first time a method is queued for the JIT
+    BackgroundCompiler* background_compiler;
+
+    // Holds the machine code of every MachineMethod
+    CodeCache* code_cache;
+
+    // Where machine code is reported to perf, if rbx.jit.perf is set
+    PerfMap* perf_map;
+
+    // Spare match regions for the Regexp primitives
+    RegionPool* regions;
+
+    // The bodies of the binary .rbc files loaded so far
+    std::list<MappedFile*> mapped_files;
+
     // Temporary holder for rb_gc_mark() in subtend
     ObjectMark current_mark;
 
@@ -198,10 +256,21 @@ namespace rubinius {
     // Check the flags in ObjectMemory and collect if we need to.
     void collect_maybe();
 
+    // Queue +vmm+ to be compiled by the JIT without blocking. The machine
+    // code is installed by install_compiled_code() once it's ready.
+    void compile_in_background(VMMethod* vmm);
+
+    // Activate any methods the background compiler has finished.
+    void install_compiled_code();
+
     void return_value(Object* val);
 
     void check_events();
 
+    // Like check_events(), but also wakes the event loop if it is
+    // blocked. Safe to call from other threads and signal handlers.
+    void wakeup();
+
     bool find_and_activate_thread();
 
     bool run_best_thread();
@@ -18,11 +18,16 @@
 #include "builtin/machine_method.hpp"
 
 #include "profiler.hpp"
+#include "code_cache.hpp"
+#include "perf_map.hpp"
 
-#include "timing.hpp"
 #include "config.h"
 
+#include <cstring>
+#include <stdexcept>
+
 #define CALLS_TIL_JIT 50
+#define BACKEDGES_TIL_JIT 1000
 #define JIT_MAX_METHOD_SIZE 2048
 
 /*
@@ -33,6 +38,7 @@ namespace rubinius {
 
   static Runner standard_interpreter = 0;
   static Runner dynamic_interpreter = 0;
+  static size_t dynamic_interpreter_size = 0;
 
   void VMMethod::init(STATE) {
 #ifdef USE_DYNAMIC_INTERPRETER
@@ -43,17 +49,37 @@ namespace rubinius {
     }
 
     if(dynamic_interpreter == NULL) {
-      uint8_t* buffer = new uint8_t[1024 * 1024 * 1024];
+      // The interpreter is shared by every VM in the process, so it lives
+      // outside of any VM's CodeCache. Untouched pages of the mapping
+      // cost nothing, and the tail is returned once we know the size.
+      const size_t reserved = 16 * 1024 * 1024;
+      uint8_t* buffer = CodeCache::map(reserved);
+      if(!buffer) {
+        throw std::runtime_error("Unable to map memory for the interpreter");
+      }
+
       JITCompiler jit(buffer);
       jit.create_interpreter(state);
       if(getenv("DUMP_DYN")) {
         jit.assembler().show();
       }
 
+      size_t used = (jit.assembler().used_bytes() + CodeCache::page_size() - 1) &
+                    ~(CodeCache::page_size() - 1);
+      if(used < reserved) CodeCache::unmap(buffer + used, reserved - used);
+
+      CodeCache::protect(buffer, used, true);
+
       dynamic_interpreter = reinterpret_cast<Runner>(buffer);
+      dynamic_interpreter_size = jit.assembler().used_bytes();
     }
 
     standard_interpreter = dynamic_interpreter;
+
+    if(state->perf_map) {
+      state->perf_map->record(reinterpret_cast<void*>(dynamic_interpreter),
+          dynamic_interpreter_size, "rubinius::dynamic_interpreter");
+    }
 #else
     dynamic_interpreter = NULL;
     standard_interpreter = interpreter;
@@ -69,6 +95,8 @@ namespace rubinius {
     , original(state, meth)
     , type(NULL)
   {
+    // Blocks get here without going through CompiledMethod::formalize.
+    meth->materialize(state);
     meth->set_executor(VMMethod::execute);
 
     total = meth->iseq()->opcodes()->num_fields();
@@ -76,7 +104,6 @@ namespace rubinius {
       blocks.resize(tup->num_fields(), NULL);
     }
 
-    opcodes = new opcode[total];
     Tuple* literals = meth->literals();
     if(literals->nil_p()) {
       sendsites = NULL;
@@ -84,16 +111,30 @@ namespace rubinius {
       sendsites = new TypedRoot<SendSite*>[literals->num_fields()];
     }
 
+    // Opcodes loaded from a binary .rbc are used where they are.
+    mapped_opcodes = meth->iseq()->mapped_opcodes() != NULL;
+    if(mapped_opcodes) {
+      opcodes = meth->iseq()->mapped_opcodes();
+    } else {
+      opcodes = new opcode[total];
+    }
+
     Tuple* ops = meth->iseq()->opcodes();
     Object* val;
     for(size_t index = 0; index < total;) {
-      val = ops->at(state, index);
-      if(val->nil_p()) {
-        opcodes[index++] = 0;
-      } else {
+      if(!mapped_opcodes) {
+        val = ops->at(state, index);
+        if(val->nil_p()) {
+          opcodes[index++] = 0;
+          continue;
+        }
+
         opcodes[index] = as<Fixnum>(val)->to_native();
-        size_t width = InstructionSequence::instruction_width(opcodes[index]);
+      }
+
+      size_t width = InstructionSequence::instruction_width(opcodes[index]);
 
+      if(!mapped_opcodes) {
         switch(width) {
         case 2:
           opcodes[index + 1] = as<Fixnum>(ops->at(state, index + 1))->to_native();
@@ -103,20 +144,20 @@ namespace rubinius {
           opcodes[index + 2] = as<Fixnum>(ops->at(state, index + 2))->to_native();
           break;
         }
+      }
 
-        switch(opcodes[index]) {
-        case InstructionSequence::insn_send_method:
-        case InstructionSequence::insn_send_stack:
-        case InstructionSequence::insn_send_stack_with_block:
-        case InstructionSequence::insn_send_stack_with_splat:
-        case InstructionSequence::insn_send_super_stack_with_block:
-        case InstructionSequence::insn_send_super_stack_with_splat:
-          native_int which = opcodes[index + 1];
-          sendsites[which].set(as<SendSite>(literals->at(state, which)), &state->globals.roots);
-        }
-
-        index += width;
+      switch(opcodes[index]) {
+      case InstructionSequence::insn_send_method:
+      case InstructionSequence::insn_send_stack:
+      case InstructionSequence::insn_send_stack_with_block:
+      case InstructionSequence::insn_send_stack_with_splat:
+      case InstructionSequence::insn_send_super_stack_with_block:
+      case InstructionSequence::insn_send_super_stack_with_splat:
+        native_int which = opcodes[index + 1];
+        sendsites[which].set(as<SendSite>(literals->at(state, which)), &state->globals.roots);
       }
+
+      index += width;
     }
 
     stack_size =    meth->stack_size()->to_native();
@@ -142,17 +183,47 @@ namespace rubinius {
 #else
     call_count = 0;
 #endif
+
+    backedge_count = 0;
+    deoptimizations = 0;
+    epoch_calls = 0;
   }
 
   VMMethod::~VMMethod() {
-    delete[] opcodes;
+    if(!mapped_opcodes) delete[] opcodes;
     delete[] sendsites;
   }
 
+  void VMMethod::own_opcodes() {
+    if(!mapped_opcodes) return;
+
+    opcode* ops = new opcode[total];
+    std::memcpy(ops, opcodes, total * sizeof(opcode));
+
+    opcodes = ops;
+    mapped_opcodes = false;
+  }
+
   void VMMethod::set_machine_method(MachineMethod* mm) {
     machine_method_.set(mm);
   }
 
+  void VMMethod::discard_machine_method() {
+    MachineMethod* mm = machine_method();
+    if(!mm) return;
+
+    if(reinterpret_cast<void*>(run) == mm->function()) {
+      run = standard_interpreter;
+    }
+
+    set_machine_method(NULL);
+
+#ifdef USE_USAGE_JIT
+    call_count = 0;
+    backedge_count = 0;
+#endif
+  }
+
   // Argument handler implementations
 
   // For when the method expects no arguments at all (no splat, nothing)
@@ -297,6 +368,8 @@ namespace rubinius {
    */
 
   void VMMethod::specialize(STATE, TypeInfo* ti) {
+    own_opcodes();
+
     type = ti;
     for(size_t i = 0; i < total;) {
       opcode op = opcodes[i];
@@ -325,28 +398,78 @@ namespace rubinius {
     }
   }
 
-  template <typename ArgumentHandler>
-  ExecuteStatus VMMethod::execute_specialized(STATE, Task* task, Message& msg) {
-    CompiledMethod* cm = as<CompiledMethod>(msg.method);
+  bool VMMethod::backedge(STATE, MethodContext* ctx) {
+#ifdef USE_USAGE_JIT
+    // A loop without sends never returns to VM::run_and_monitor, so
+    // pick up finished machine code here too.
+    if(unlikely(state->interrupts.install_code)) {
+      state->install_compiled_code();
+    }
 
-    VMMethod* vmm = cm->backend_method_;
+    if(MachineMethod* mm = machine_method()) {
+      if(ctx->run == debugger_interpreter) return false;
+
+      // Machine code that was deoptimized stays around for contexts
+      // still running it, but nothing new should enter it.
+      if(reinterpret_cast<void*>(run) == mm->function()) {
+        return mm->replace_on_stack(ctx);
+      }
+    }
+
+    // A negative call_count means the JIT is disabled for this method,
+    // or it's already been queued.
+    if(call_count >= 0 && ++backedge_count >= BACKEDGES_TIL_JIT) {
+      call_count = -1;
+      state->compile_in_background(this);
+    }
+#endif
+
+    return false;
+  }
 
+  void VMMethod::deoptimize(STATE, MethodContext* ctx, int ip) {
+    // Only the first context to fail a guard in the current code needs
+    // to demote the method; others may still be running older code.
+    if(ctx->run == run) {
+      run = standard_interpreter;
+      deoptimizations++;
+
+#ifdef USE_USAGE_JIT
+      call_count = 0;
+      backedge_count = 0;
+#endif
+    }
+
+    ctx->ip = ip;
+    ctx->native_ip = NULL;
+    ctx->run = standard_interpreter;
+  }
+
+  void VMMethod::called(STATE) {
 #ifdef USE_USAGE_JIT
     // A negative call_count means we've disabled usage based JIT
     // for this method.
-    if(vmm->call_count >= 0) {
-      if(vmm->call_count >= CALLS_TIL_JIT) {
-        state->stats.jitted_methods++;
-        uint64_t start = get_current_time();
-        MachineMethod* mm = cm->make_machine_method(state);
-        mm->activate();
-        vmm->call_count = -1;
-        state->stats.jit_timing += (get_current_time() - start);
+    if(call_count >= 0) {
+      if(call_count >= CALLS_TIL_JIT) {
+        // Keep interpreting; the machine code is swapped into run
+        // at a safe point once the background compiler is done.
+        call_count = -1;
+        state->compile_in_background(this);
       } else {
-        vmm->call_count++;
+        call_count++;
       }
+    } else {
+      epoch_calls++;
     }
 #endif
+  }
+
+  template <typename ArgumentHandler>
+  ExecuteStatus VMMethod::execute_specialized(STATE, Task* task, Message& msg) {
+    CompiledMethod* cm = as<CompiledMethod>(msg.method);
+
+    VMMethod* vmm = cm->backend_method_;
+    vmm->called(state);
 
     MethodContext* ctx = MethodContext::create(state, msg.recv, cm);
 
@@ -547,6 +670,7 @@ namespace rubinius {
    */
   void VMMethod::set_breakpoint_flags(STATE, size_t ip, bpflags flags) {
     if(validate_ip(state, ip)) {
+      own_opcodes();
       opcodes[ip] &= 0x00ffffff;    // Clear the high byte
       opcodes[ip] |= flags & 0xff000000;
     }
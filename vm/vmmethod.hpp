@@ -39,6 +39,10 @@ namespace rubinius {
 
     opcode* opcodes;
     std::size_t total;
+
+    // opcodes points into a binary .rbc rather than being ours. It's
+    // copied before being changed (see own_opcodes).
+    bool mapped_opcodes;
     TypedRoot<CompiledMethod*> original;
     TypeInfo* type;
     std::vector<VMMethod*> blocks;
@@ -53,6 +57,19 @@ namespace rubinius {
 
     native_int call_count;
 
+    // Backward jumps taken by the interpreter, so methods which spend
+    // their time in a loop rather than being called often still get
+    // compiled.
+    native_int backedge_count;
+
+    // How many times machine code for this method hit a failed guard.
+    // Once non-zero, the JIT stops speculating on this method.
+    native_int deoptimizations;
+
+    // Calls since the code cache last looked for cold machine code. Only
+    // counted once the method has been queued for the JIT.
+    native_int epoch_calls;
+
   public: // Methods
     static void init(STATE);
 
@@ -65,8 +82,35 @@ namespace rubinius {
 
     void set_machine_method(MachineMethod* mm);
 
+    // Stop using the machine code for new calls, and start counting
+    // toward compiling the method again. Contexts already running the
+    // machine code carry on in it.
+    void discard_machine_method();
+
     void specialize(STATE, TypeInfo* ti);
+
+    // Make opcodes a private copy, if it isn't already, so that it can be
+    // changed without affecting other users of a mapped .rbc.
+    void own_opcodes();
     void compile(STATE);
+
+    // Called by the interpreter after +ctx+ jumps backwards. Counts
+    // toward compiling this method, and once machine code has been
+    // installed, moves +ctx+ into it at the loop header (on-stack
+    // replacement). Returns true if the interpreter should return so
+    // that +ctx+ continues in the machine code.
+    bool backedge(STATE, MethodContext* ctx);
+
+    // Called by machine code whose speculation about the values at +ip+
+    // turned out wrong. Switches +ctx+ over to the interpreter at +ip+,
+    // and stops running the machine code for new calls, so that the
+    // method is recompiled without speculating.
+    void deoptimize(STATE, MethodContext* ctx, int ip);
+
+    // Called each time a context is created to run this method or block.
+    // Counts toward compiling it.
+    void called(STATE);
+
     static ExecuteStatus execute(STATE, Task* task, Message& msg);
 
     template <typename ArgumentHandler>